@@ -0,0 +1,170 @@
+/**
+ * @file arena.c
+ * @author xcernoj00
+ * @brief Region (arena) allocator for compiler-phase objects
+ */
+
+#include "arena.h"
+#include <stdalign.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ARENA_ALIGNMENT alignof(max_align_t)
+#define ARENA_CLASS_SIZE 16 ///< granularity of the recycled size classes
+
+/**
+ * @brief Header of a block of arena memory; the objects follow it.
+ */
+struct ArenaBlock {
+    ArenaBlock *next; ///< older block
+    size_t size;      ///< usable bytes after the header
+    alignas(max_align_t) char data[];
+};
+
+static _Thread_local Arena phase_arenas[ARENA_PHASE_COUNT]; // per thread
+
+static inline size_t align_up(size_t size) {
+    return (size + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1);
+}
+
+/**
+ * @brief Size class of a recycled object, or -1 when it is too large.
+ */
+static inline int recycle_class(size_t size) {
+    size_t class = (size + ARENA_CLASS_SIZE - 1) / ARENA_CLASS_SIZE;
+    return class >= 1 && class <= ARENA_RECYCLE_CLASSES ? (int)class - 1 : -1;
+}
+
+void arena_init(Arena *arena) { memset(arena, 0, sizeof(*arena)); }
+
+/**
+ * @brief Start a new block that can hold at least `size` bytes.
+ *
+ * Blocks double in size up to ARENA_MAX_BLOCK_SIZE, so an arena needs
+ * only a logarithmic number of mallocs.
+ */
+static int arena_grow(Arena *arena, size_t size) {
+    size_t block_size = arena->blocks ? arena->blocks->size * 2
+                                      : ARENA_BLOCK_SIZE;
+    if (block_size > ARENA_MAX_BLOCK_SIZE) {
+        block_size = ARENA_MAX_BLOCK_SIZE;
+    }
+    if (block_size < size) {
+        block_size = size;
+    }
+
+    ArenaBlock *block = malloc(sizeof(ArenaBlock) + block_size);
+    if (!block) {
+        return -1;
+    }
+    block->next = arena->blocks;
+    block->size = block_size;
+    arena->blocks = block;
+    arena->next = block->data;
+    arena->end = block->data + block_size;
+    arena->stats.blocks++;
+    arena->stats.reserved += sizeof(ArenaBlock) + block_size;
+    return 0;
+}
+
+void *arena_alloc(Arena *arena, size_t size) {
+    size = align_up(size ? size : 1);
+
+    int class = recycle_class(size);
+    if (class >= 0 && arena->released[class]) {
+        void *object = arena->released[class];
+        arena->released[class] = *(void **)object;
+        arena->stats.allocations++;
+        arena->stats.recycled++;
+        return object;
+    }
+
+    if ((size_t)(arena->end - arena->next) < size &&
+        arena_grow(arena, size) != 0) {
+        return NULL;
+    }
+    void *object = arena->next;
+    arena->next += size;
+    arena->stats.allocations++;
+    arena->stats.bytes += size;
+    return object;
+}
+
+void arena_release(Arena *arena, void *object, size_t size) {
+    int class = recycle_class(align_up(size ? size : 1));
+    if (object == NULL || class < 0) {
+        return;
+    }
+    *(void **)object = arena->released[class];
+    arena->released[class] = object;
+}
+
+char *arena_strndup(Arena *arena, const char *s, size_t n) {
+    size_t length = 0;
+    while (length < n && s[length] != '\0') {
+        length++;
+    }
+    char *copy = arena_alloc(arena, length + 1);
+    if (!copy) {
+        return NULL;
+    }
+    memcpy(copy, s, length);
+    copy[length] = '\0';
+    return copy;
+}
+
+void arena_merge(Arena *into, Arena *from) {
+    if (!from->blocks) {
+        return;
+    }
+    ArenaBlock *oldest = from->blocks;
+    while (oldest->next) {
+        oldest = oldest->next;
+    }
+    if (into->blocks) {
+        // Behind the newest block of `into`, which keeps bump allocating
+        oldest->next = into->blocks->next;
+        into->blocks->next = from->blocks;
+    } else {
+        into->blocks = from->blocks;
+        into->next = from->next;
+        into->end = from->end;
+    }
+    into->stats.allocations += from->stats.allocations;
+    into->stats.recycled += from->stats.recycled;
+    into->stats.bytes += from->stats.bytes;
+    into->stats.blocks += from->stats.blocks;
+    into->stats.reserved += from->stats.reserved;
+    arena_init(from);
+}
+
+void arena_free(Arena *arena) {
+    ArenaBlock *block = arena->blocks;
+    while (block) {
+        ArenaBlock *next = block->next;
+        free(block);
+        block = next;
+    }
+    arena_init(arena);
+}
+
+Arena *phase_arena(ArenaPhase phase) { return &phase_arenas[phase]; }
+
+const char *phase_arena_name(ArenaPhase phase) {
+    switch (phase) {
+    case ARENA_PARSE:
+        return "parse";
+    case ARENA_SEMANTIC:
+        return "semantic";
+    case ARENA_CODEGEN:
+        return "codegen";
+    default:
+        return "unknown";
+    }
+}
+
+void phase_arenas_free_all(void) {
+    for (int phase = 0; phase < ARENA_PHASE_COUNT; phase++) {
+        arena_free(&phase_arenas[phase]);
+    }
+}
@@ -0,0 +1,144 @@
+/**
+ * @file arena.h
+ * @author xcernoj00
+ * @brief Region (arena) allocator for compiler-phase objects.
+ *
+ * Objects that live until the end of a compiler phase (AST and expression
+ * nodes, symbol table entries, scratch data of the generator) are bump
+ * allocated from large blocks and released all at once, instead of being
+ * malloc'ed and freed one by one.
+ */
+
+#ifndef _ARENA_H
+#define _ARENA_H
+
+#include <stddef.h>
+
+#define ARENA_BLOCK_SIZE 65536   ///< size of the first block of an arena
+#define ARENA_MAX_BLOCK_SIZE (1u << 22) ///< blocks stop doubling here
+#define ARENA_RECYCLE_CLASSES 8  ///< released objects up to 8 * 16 bytes are reused
+
+typedef struct ArenaBlock ArenaBlock;
+
+/**
+ * @brief Allocation counters of one arena.
+ */
+typedef struct {
+    size_t allocations; ///< objects handed out
+    size_t recycled;    ///< of those, served from released objects
+    size_t bytes;       ///< bytes handed out (after alignment)
+    size_t blocks;      ///< blocks obtained from malloc
+    size_t reserved;    ///< bytes obtained from malloc
+} ArenaStats;
+
+/**
+ * @brief Region of bump-allocated objects that are freed together.
+ *
+ * A zero-initialized Arena is empty and ready to use.
+ */
+typedef struct {
+    ArenaBlock *blocks; ///< newest block first
+    char *next;         ///< first free byte in the newest block
+    char *end;          ///< end of the newest block
+    void *released[ARENA_RECYCLE_CLASSES]; ///< free lists by size class
+    ArenaStats stats;   ///< counters since the last `arena_free`
+} Arena;
+
+/**
+ * @brief Compiler phases owning an arena each.
+ *
+ * - ARENA_PARSE: the AST with its expressions and string literals,
+ *   including nodes semantic analysis adds to it.
+ * - ARENA_SEMANTIC: scopes and symbol tables.
+ * - ARENA_CODEGEN: scratch data of the code generator.
+ */
+typedef enum {
+    ARENA_PARSE,
+    ARENA_SEMANTIC,
+    ARENA_CODEGEN,
+    ARENA_PHASE_COUNT
+} ArenaPhase;
+
+/**
+ * @brief Initialize an empty arena.
+ *
+ * @param arena Arena to initialize.
+ */
+void arena_init(Arena *arena);
+
+/**
+ * @brief Allocate `size` bytes, aligned for any object type.
+ *
+ * The memory is not zeroed and stays valid until `arena_free`.
+ *
+ * @param arena Arena to allocate from.
+ * @param size Number of bytes.
+ * @return Pointer to the memory or NULL on allocation failure.
+ */
+void *arena_alloc(Arena *arena, size_t size);
+
+/**
+ * @brief Hand a small object back for reuse by later allocations.
+ *
+ * Optional: the memory is reclaimed by `arena_free` either way. Objects
+ * larger than the recycled size classes are simply left alone.
+ *
+ * @param arena Arena the object was allocated from.
+ * @param object Object to release (may be NULL).
+ * @param size Size the object was allocated with.
+ */
+void arena_release(Arena *arena, void *object, size_t size);
+
+/**
+ * @brief Copy at most `n` bytes of a string into the arena.
+ *
+ * Copying stops early at an embedded NUL, like `my_strndup`.
+ *
+ * @param arena Arena to allocate from.
+ * @param s Source characters (need not be NUL-terminated).
+ * @param n Maximum number of bytes to copy.
+ * @return NUL-terminated copy or NULL on allocation failure.
+ */
+char *arena_strndup(Arena *arena, const char *s, size_t n);
+
+/**
+ * @brief Move every object of `from` into `into`.
+ *
+ * The blocks change owner without being copied, so objects allocated from
+ * `from` stay valid until `into` is freed. `from` is empty afterwards.
+ *
+ * @param into Arena receiving the objects.
+ * @param from Arena to empty.
+ */
+void arena_merge(Arena *into, Arena *from);
+
+/**
+ * @brief Free every object of the arena at once.
+ *
+ * The arena is empty afterwards and can be used again.
+ *
+ * @param arena Arena to free.
+ */
+void arena_free(Arena *arena);
+
+/**
+ * @brief The arena of a compiler phase.
+ *
+ * Each thread has its own set of phase arenas.
+ *
+ * @param phase Compiler phase.
+ * @return The phase arena (never NULL).
+ */
+Arena *phase_arena(ArenaPhase phase);
+
+/**
+ * @brief Human-readable name of a compiler phase.
+ */
+const char *phase_arena_name(ArenaPhase phase);
+
+/**
+ * @brief Free the arenas of all compiler phases.
+ */
+void phase_arenas_free_all(void);
+
+#endif // _ARENA_H
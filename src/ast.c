@@ -4,8 +4,10 @@
  * @author xmalikm00
  *
  * This file implements the core AST (Abstract Syntax Tree) functionality for
- * the IFJ25 compiler. It provides functions for creating and destroying AST
- * nodes, which represent the hierarchical structure of the parsed source code.
+ * the IFJ25 compiler. It provides functions for creating AST nodes, which
+ * represent the hierarchical structure of the parsed source code. Nodes are
+ * bump-allocated from the ARENA_PARSE arena, which releases the whole tree
+ * at once.
  *
  * The AST is a tree-based representation of the source program's syntactic
  * structure, built by the parser and used by semantic analysis and code
@@ -13,25 +15,24 @@
  */
 
 #include "ast.h"
+#include "arena.h"
 #include "expr_ast.h"
+#include "intern.h"
 #include "symtable.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-// Forward declaration for my_strdup from symtable.c
-// (Used to duplicate strings safely)
-char *my_strdup(const char *s);
-
 /**
  * @brief Creates and initializes a new AST node
  * 
  * @param type The type of AST node to create (from ASTNodeType enum)
- * @param name Optional name/identifier for the node (will be duplicated using
- * my_strdup) May be NULL for nodes that don't require names
+ * @param name Optional name/identifier for the node (will be interned)
+ * May be NULL for nodes that don't require names
  *
  * @return Pointer to the newly created and initialized AST node
  * @retval NULL if memory allocation fails
+ * @note The node lives in the ARENA_PARSE arena until that arena is freed
  * 
  * Example usage:
  * @code
@@ -42,8 +43,25 @@ char *my_strdup(const char *s);
  * @endcode
  */
 ASTNode *create_ast_node(ASTNodeType type, const char *name) {
+    return create_ast_node_n(type, name, name ? strlen(name) : 0);
+}
+
+/**
+ * @brief Creates an AST node whose name is given as a length-bounded slice
+ *
+ * Lets callers name nodes straight from slices that point into the source
+ * buffer (and are therefore not NUL-terminated).
+ *
+ * @param type The type of AST node to create
+ * @param name Name characters or NULL for unnamed nodes
+ * @param length Number of characters of `name` to use
+ *
+ * @return Pointer to the newly created node, NULL if allocation fails
+ */
+ASTNode *create_ast_node_n(ASTNodeType type, const char *name, size_t length) {
     // Allocate memory for the new node
-    ASTNode *node = (ASTNode *)malloc(sizeof(ASTNode));
+    ASTNode *node =
+        (ASTNode *)arena_alloc(phase_arena(ARENA_PARSE), sizeof(ASTNode));
     if (!node)
         return NULL; // Allocation failed
 
@@ -51,7 +69,7 @@ ASTNode *create_ast_node(ASTNodeType type, const char *name) {
     node->type = type;
 
     // Duplicate name if provided, otherwise set to NULL
-    node->name = name ? my_strdup(name) : NULL;
+    node->name = name ? intern_n(name, length) : NULL;
 
     // Initialize tree structure pointers to NULL
     node->left = NULL;
@@ -70,40 +88,3 @@ ASTNode *create_ast_node(ASTNodeType type, const char *name) {
 
     return node;
 }
-
-/**
- * @brief Recursively frees an entire AST tree and all associated resources
- * 
- * The function uses post-order traversal to ensure that parent nodes are only
- * freed after all their children have been freed, preventing access to freed
- * memory.
- *
- * @param node Pointer to the root node of the tree to free
- *             May be NULL (function safely handles NULL pointers)
- */
-void free_ast_tree(ASTNode *node) {
-    // Base case: NULL pointer - nothing to free
-    if (!node)
-        return;
-
-    // Recursively free left subtree (post-order traversal)
-    free_ast_tree(node->left);
-
-    // Recursively free right subtree (post-order traversal)
-    free_ast_tree(node->right);
-
-    // Free expression tree if present
-    if (node->expr)
-        free_expr_node(node->expr);
-
-    // Free node name (dynamically allocated string)
-    if (node->name)
-        free(node->name);
-
-    // Free symbol table if present
-    if (node->current_table)
-        symtable_free(node->current_table);
-
-    // Finally, free the node itself
-    free(node);
-}
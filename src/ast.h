@@ -200,6 +200,15 @@ typedef enum {
      */
     AST_EXPRESSION,
 
+    /**
+     * @brief Function body not parsed yet (lazy mode, see
+     * parser_parse_body); takes the place of the AST_BLOCK
+     * - left:  NULL
+     * - right: Next definition, as for the body block
+     * - current_table, current_scope: Scope of the function, once known
+     */
+    AST_LAZY_BODY,
+
 } ASTNodeType;
 
 /**
@@ -210,9 +219,9 @@ typedef enum {
  * The interpretation of each field depends on the node's type (see
  * ASTNodeType).
  *
- * @note Memory management: All dynamically allocated fields (name, left, right,
- *       expr, current_table) must be freed when the node is destroyed using
- *       free_ast_tree().
+ * @note Memory management: nodes, their expressions and string literals are
+ *       allocated from the ARENA_PARSE arena (see arena.h) and released all
+ *       at once when that arena is freed; names are interned.
  */
 typedef struct ASTNode {
     /** @brief Type of this AST node (determines interpretation of other fields)
@@ -220,8 +229,8 @@ typedef struct ASTNode {
     ASTNodeType type;
 
     /** @brief Name/identifier (for variables, functions, getters, setters)
-     *  Dynamically allocated string, may be NULL for nodes without names */
-    char *name;
+     *  Interned string (see intern.h), may be NULL for nodes without names */
+    const char *name;
 
     /** @brief Left child node in the tree structure
      *  Usage varies by node type (see ASTNodeType documentation) */
@@ -263,36 +272,28 @@ typedef struct ASTNode {
  * default values. The name is copied if provided.
  *
  * @param type The type of AST node to create
- * @param name Optional name/identifier for the node (will be duplicated), may
+ * @param name Optional name/identifier for the node (will be interned), may
  * be NULL
  * @return Pointer to newly created AST node, or NULL if allocation fails
  *
- * @note The returned node must be freed using free_ast_tree() when no longer
- * needed
+ * @note The node lives in the ARENA_PARSE arena until that arena is freed
  * @note All pointers (left, right, expr, etc.) are initialized to NULL
  * @note data_type is initialized to TYPE_UNDEF
  */
 ASTNode *create_ast_node(ASTNodeType type, const char *name);
 
 /**
- * @brief Recursively frees an entire AST tree
+ * @brief Creates an AST node named by a length-bounded character slice
  *
- * Performs a post-order traversal of the tree, freeing all child nodes
- * before freeing the parent. Also frees associated resources like the
- * node name, expression tree, and symbol table.
+ * Same as create_ast_node(), but the name does not have to be
+ * NUL-terminated; at most `length` characters are interned. This lets
+ * callers name nodes directly from slices of the source buffer.
  *
- * @param node Root node of the tree to free (may be NULL)
- *
- * @note This function safely handles NULL pointers
- * @note Frees:
- *       - Left and right subtrees (recursively)
- *       - Expression tree (if present)
- *       - Node name (if present)
- *       - Symbol table (if present)
- *       - The node itself
- * @warning Do not access the node or any of its children after calling this
- * function
+ * @param type The type of AST node to create
+ * @param name Name characters, may be NULL
+ * @param length Number of characters of `name` to use
+ * @return Pointer to newly created AST node, or NULL if allocation fails
  */
-void free_ast_tree(ASTNode *node);
+ASTNode *create_ast_node_n(ASTNodeType type, const char *name, size_t length);
 
 #endif // AST_H
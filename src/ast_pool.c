@@ -0,0 +1,322 @@
+/**
+ * @file ast_pool.c
+ * @author xcernoj00
+ * @brief Builds the flat, index-based form of the AST (see ast_pool.h).
+ *
+ * The pool doubles as the work queue of the build: ids are handed out in
+ * breadth-first order and expanded in id order, each expansion appending
+ * the children of one node, a whole list at a time. Neither the depth nor
+ * the length of the program uses the C stack.
+ */
+
+#include "ast_pool.h"
+#include "error.h"
+#include "intern.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Grows all node columns to `capacity` entries.
+ */
+static int pool_reserve(AstPool *pool, size_t capacity) {
+    uint8_t *kinds = realloc(pool->kinds, capacity * sizeof(uint8_t));
+    if (!kinds) {
+        return ERROR_INTERNAL;
+    }
+    pool->kinds = kinds;
+    uint8_t *types = realloc(pool->types, capacity * sizeof(uint8_t));
+    if (!types) {
+        return ERROR_INTERNAL;
+    }
+    pool->types = types;
+    uint32_t *names = realloc(pool->names, capacity * sizeof(uint32_t));
+    if (!names) {
+        return ERROR_INTERNAL;
+    }
+    pool->names = names;
+    AstId *first = realloc(pool->first, capacity * sizeof(AstId));
+    if (!first) {
+        return ERROR_INTERNAL;
+    }
+    pool->first = first;
+    AstId *second = realloc(pool->second, capacity * sizeof(AstId));
+    if (!second) {
+        return ERROR_INTERNAL;
+    }
+    pool->second = second;
+    AstId *third = realloc(pool->third, capacity * sizeof(AstId));
+    if (!third) {
+        return ERROR_INTERNAL;
+    }
+    pool->third = third;
+    ASTNode **origin = realloc(pool->origin, capacity * sizeof(ASTNode *));
+    if (!origin) {
+        return ERROR_INTERNAL;
+    }
+    pool->origin = origin;
+    pool->capacity = capacity;
+    return NO_ERROR;
+}
+
+/**
+ * @brief Appends a node; its children are filled in when it is expanded.
+ * @return Its id, or AST_POOL_NONE for a NULL node or on allocation failure.
+ */
+static AstId pool_add(AstPool *pool, ASTNode *node) {
+    if (node == NULL || pool->count > UINT32_MAX - 1 ||
+        (pool->count == pool->capacity &&
+         pool_reserve(pool, pool->capacity * 2) != NO_ERROR)) {
+        return AST_POOL_NONE;
+    }
+    AstId id = (AstId)pool->count++;
+    pool->kinds[id] = (uint8_t)node->type;
+    pool->types[id] = (uint8_t)node->data_type;
+    pool->names[id] = 0;
+    if (node->name != NULL) {
+        unsigned name = intern_id(node->name);
+        if (name < pool->name_count) {
+            pool->name_table[name] = node->name;
+            pool->names[id] = name;
+        }
+    }
+    pool->first[id] = AST_POOL_NONE;
+    pool->second[id] = AST_POOL_NONE;
+    pool->third[id] = AST_POOL_NONE;
+    pool->origin[id] = node;
+    return id;
+}
+
+/**
+ * @brief The statement following `statement` in its block.
+ * @details The pointer tree links the next statement behind the last
+ * branch of an if and behind the body of a while.
+ */
+static ASTNode *next_statement(const ASTNode *statement) {
+    const ASTNode *last = statement;
+    if (statement->type == AST_IF) {
+        const ASTNode *then_block = statement->right;
+        const ASTNode *else_node = then_block ? then_block->right : NULL;
+        last = else_node ? else_node->right : NULL;
+    } else if (statement->type == AST_WHILE) {
+        last = statement->right;
+    }
+    return last ? last->right : NULL;
+}
+
+/**
+ * @brief Appends the nodes of a list as consecutive ids.
+ * @param step 0 to follow `right`, 1 for definitions (the next one hangs
+ * off the body), 2 for statements, 3 for AST_FUNC_ARG chains (following
+ * `left` and appending their `right`).
+ * @return Number of nodes appended, or -1 on error.
+ */
+static long pool_add_list(AstPool *pool, ASTNode *node, int step,
+                          AstId *first) {
+    long count = 0;
+    *first = (AstId)pool->count;
+    while (node != NULL) {
+        ASTNode *element = step == 3 ? node->right : node;
+        if (step == 3 && node->type != AST_FUNC_ARG) {
+            break;
+        }
+        if (pool_add(pool, element) == AST_POOL_NONE) {
+            return -1;
+        }
+        count++;
+        switch (step) {
+        case 1:
+            node = node->right ? node->right->right : NULL;
+            break;
+        case 2:
+            node = next_statement(node);
+            break;
+        case 3:
+            node = node->left;
+            break;
+        default:
+            node = node->right;
+            break;
+        }
+    }
+    if (count == 0) {
+        *first = AST_POOL_NONE;
+    }
+    return count;
+}
+
+/**
+ * @brief Sets a list of children of node `id`: first id and length.
+ */
+static int expand_list(AstPool *pool, AstId id, ASTNode *node, int step) {
+    AstId first;
+    long count = pool_add_list(pool, node, step, &first);
+    if (count < 0) {
+        return ERROR_INTERNAL;
+    }
+    pool->first[id] = first;
+    pool->second[id] = (AstId)count;
+    return NO_ERROR;
+}
+
+/**
+ * @brief Appends an optional child of node `id` into child slot `slot`.
+ * @details The slot is only located after the append, which may move the
+ * columns.
+ */
+static int expand_child(AstPool *pool, AstId id, unsigned slot,
+                        ASTNode *child) {
+    AstId child_id = AST_POOL_NONE;
+    if (child != NULL && (child_id = pool_add(pool, child)) == AST_POOL_NONE) {
+        return ERROR_INTERNAL;
+    }
+    AstId *column = slot == 0   ? pool->first
+                    : slot == 1 ? pool->second
+                                : pool->third;
+    column[id] = child_id;
+    return NO_ERROR;
+}
+
+/**
+ * @brief Stores the expression tree of an AST_EXPRESSION.
+ */
+static int add_expr(AstPool *pool, AstId id, ExprNode *expr) {
+    if (expr == NULL) {
+        return NO_ERROR;
+    }
+    if (pool->expr_count == pool->expr_capacity) {
+        size_t capacity = pool->expr_capacity ? pool->expr_capacity * 2 : 256;
+        ExprNode **exprs = realloc(pool->exprs, capacity * sizeof(ExprNode *));
+        if (!exprs) {
+            return ERROR_INTERNAL;
+        }
+        pool->exprs = exprs;
+        pool->expr_capacity = capacity;
+    }
+    pool->exprs[pool->expr_count++] = expr;
+    pool->third[id] = (AstId)pool->expr_count;
+    return NO_ERROR;
+}
+
+/**
+ * @brief Appends the children of node `id` (see the layout in ast_pool.h).
+ */
+static int expand(AstPool *pool, AstId id) {
+    ASTNode *node = pool->origin[id];
+    int rc = NO_ERROR;
+    switch (node->type) {
+    case AST_PROGRAM:
+        return expand_list(pool, id, node->left, 1);
+    case AST_MAIN_DEF:
+    case AST_FUNC_DEF:
+        rc = expand_list(pool, id, node->left, 3);
+        return rc != NO_ERROR ? rc
+                              : expand_child(pool, id, 2, node->right);
+    case AST_GETTER_DEF:
+        return expand_child(pool, id, 2, node->right);
+    case AST_SETTER_DEF:
+        rc = expand_list(pool, id, node->left, 0);
+        // The parameter is one identifier, not a list
+        if (rc == NO_ERROR && pool->second[id] > 1) {
+            rc = ERROR_INTERNAL;
+        }
+        return rc != NO_ERROR ? rc
+                              : expand_child(pool, id, 2, node->right);
+    case AST_BLOCK:
+        return expand_list(pool, id, node->left, 2);
+    case AST_VAR_DECL:
+    case AST_SETTER_CALL:
+        return expand_child(pool, id, 0, node->left);
+    case AST_ASSIGN: {
+        ASTNode *equals = node->left;
+        if (equals == NULL || equals->type != AST_EQUALS) {
+            return ERROR_INTERNAL;
+        }
+        rc = expand_child(pool, id, 0, equals->left);
+        return rc != NO_ERROR ? rc
+                              : expand_child(pool, id, 1, equals->right);
+    }
+    case AST_FUNC_CALL:
+        return expand_list(pool, id, node->left, 3);
+    case AST_IF: {
+        ASTNode *then_block = node->right;
+        ASTNode *else_node = then_block ? then_block->right : NULL;
+        if (else_node == NULL || else_node->type != AST_ELSE) {
+            return ERROR_INTERNAL;
+        }
+        rc = expand_child(pool, id, 0, node->left);
+        if (rc == NO_ERROR) {
+            rc = expand_child(pool, id, 1, then_block);
+        }
+        return rc != NO_ERROR ? rc
+                              : expand_child(pool, id, 2, else_node->right);
+    }
+    case AST_WHILE:
+        rc = expand_child(pool, id, 0, node->left);
+        return rc != NO_ERROR ? rc
+                              : expand_child(pool, id, 1, node->right);
+    case AST_RETURN:
+        return expand_child(pool, id, 0, node->left);
+    case AST_EXPRESSION:
+        rc = expand_child(pool, id, 0, node->left);
+        return rc != NO_ERROR ? rc : add_expr(pool, id, node->expr);
+    case AST_IDENTIFIER:
+    case AST_GETTER_CALL:
+    case AST_LAZY_BODY:
+        return NO_ERROR;
+    default:
+        // Wrappers are folded into their parents and never expanded
+        return ERROR_INTERNAL;
+    }
+}
+
+int ast_pool_build(AstPool *pool, ASTNode *program) {
+    memset(pool, 0, sizeof(*pool));
+    pool->name_count = intern_count() + 1;
+    pool->name_table = calloc(pool->name_count, sizeof(const char *));
+    if (pool->name_table == NULL || pool_reserve(pool, 1024) != NO_ERROR) {
+        ast_pool_free(pool);
+        return ERROR_INTERNAL;
+    }
+
+    // Id 0 is AST_POOL_NONE
+    pool->count = 1;
+    pool->kinds[0] = AST_PROGRAM;
+    pool->types[0] = TYPE_UNDEF;
+    pool->names[0] = 0;
+    pool->first[0] = pool->second[0] = pool->third[0] = AST_POOL_NONE;
+    pool->origin[0] = NULL;
+
+    int rc = program != NULL && program->type == AST_PROGRAM &&
+                     pool_add(pool, program) == AST_POOL_ROOT
+                 ? NO_ERROR
+                 : ERROR_INTERNAL;
+    for (AstId id = AST_POOL_ROOT; rc == NO_ERROR && id < pool->count; id++) {
+        rc = expand(pool, id);
+    }
+    if (rc != NO_ERROR) {
+        ast_pool_free(pool);
+    }
+    return rc;
+}
+
+void ast_pool_free(AstPool *pool) {
+    free(pool->kinds);
+    free(pool->types);
+    free(pool->names);
+    free(pool->first);
+    free(pool->second);
+    free(pool->third);
+    free(pool->origin);
+    free(pool->name_table);
+    free(pool->exprs);
+    memset(pool, 0, sizeof(*pool));
+}
+
+size_t ast_pool_bytes(const AstPool *pool, bool with_origin) {
+    size_t per_node = 2 * sizeof(uint8_t) + sizeof(uint32_t) +
+                      3 * sizeof(AstId) +
+                      (with_origin ? sizeof(ASTNode *) : 0);
+    return pool->capacity * per_node +
+           pool->name_count * sizeof(const char *) +
+           pool->expr_capacity * sizeof(ExprNode *);
+}
@@ -0,0 +1,159 @@
+/**
+ * @file ast_pool.h
+ * @author xcernoj00
+ * @brief Flat, index-based form of the AST (struct of arrays).
+ *
+ * `ast_pool_build` copies a program AST into a pool in which every node is
+ * a 32-bit id: its kind, data type, name and up to three children are
+ * stored in separate dense arrays, 18 bytes per node against the 72 of an
+ * ASTNode. Lists (definitions, parameters, statements, arguments) are
+ * contiguous ranges of ids, so walking a block is a loop over consecutive
+ * ids instead of a chase along `right`. The wrapper nodes of the pointer
+ * tree (AST_FUNC_ARG, AST_EQUALS, AST_ELSE) are folded into their parents.
+ *
+ * The pool is a read-only snapshot built from the pointer tree, not a
+ * replacement for it: the tree stays alive and the pool's memory comes on
+ * top of it. Each id remembers the ASTNode it was built from
+ * (`ast_pool_node`), so code can move from the pointer tree to the pool
+ * one access at a time, reading what the pool does not hold (scopes,
+ * symbol tables, variable lists) from the original node. No compiler pass
+ * reads the pool yet, so it is linked only into bench_flat_ast, not into
+ * the compiler.
+ *
+ * Layout by kind (`first`, `second`, `third` are the child slots):
+ * - AST_PROGRAM: first definition, number of definitions
+ * - AST_MAIN_DEF, AST_FUNC_DEF: first parameter (AST_IDENTIFIER), number
+ *   of parameters, body (AST_BLOCK or AST_LAZY_BODY)
+ * - AST_GETTER_DEF: -, -, body
+ * - AST_SETTER_DEF: parameter (AST_IDENTIFIER), 1, body
+ * - AST_BLOCK: first statement, number of statements
+ * - AST_VAR_DECL: variable (AST_IDENTIFIER)
+ * - AST_ASSIGN: target (AST_IDENTIFIER), value (AST_EXPRESSION)
+ * - AST_SETTER_CALL: value (AST_EXPRESSION); the name is the setter's
+ * - AST_FUNC_CALL: first argument (AST_EXPRESSION), number of arguments
+ * - AST_IF: condition, then block, else block
+ * - AST_WHILE: condition, body
+ * - AST_RETURN: value (AST_EXPRESSION) or AST_POOL_NONE
+ * - AST_EXPRESSION: call (AST_FUNC_CALL) or AST_POOL_NONE; the expression
+ *   tree is `ast_pool_expr`
+ * - AST_IDENTIFIER, AST_GETTER_CALL, AST_LAZY_BODY: no children
+ */
+
+#ifndef AST_POOL_H
+#define AST_POOL_H
+
+#include "ast.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/// Id of a node in an AstPool
+typedef uint32_t AstId;
+
+/// No node (id 0 is never used)
+#define AST_POOL_NONE 0
+
+/**
+ * @brief AST of one program as parallel arrays indexed by AstId.
+ *
+ * A zero-initialized AstPool is empty.
+ */
+typedef struct {
+    uint8_t *kinds;  ///< ASTNodeType of each node
+    uint8_t *types;  ///< DataType of each node
+    uint32_t *names; ///< intern id of the name, 0 for none
+    AstId *first;    ///< first child or first id of a range
+    AstId *second;   ///< second child or length of the range
+    AstId *third;    ///< third child
+    ASTNode **origin; ///< node each id was built from
+    size_t count;    ///< ids in use, AST_POOL_NONE included
+    size_t capacity; ///< allocated entries of each array
+
+    const char **name_table; ///< interned names by intern id
+    size_t name_count;       ///< entries of `name_table`
+    ExprNode **exprs;        ///< expression trees, see ast_pool_expr
+    size_t expr_count;       ///< used entries of `exprs`
+    size_t expr_capacity;    ///< allocated entries of `exprs`
+} AstPool;
+
+/**
+ * @brief Builds the pool of a program AST.
+ * @param pool Empty pool (zero-initialized or freed).
+ * @param program AST_PROGRAM node.
+ * @return NO_ERROR, or ERROR_INTERNAL on allocation failure or when the
+ * tree does not have the shape the parser gives it.
+ * @details The nodes are numbered breadth first, each list of children
+ * getting consecutive ids; the program is id 1. Runs without recursion,
+ * in time linear in the number of nodes.
+ */
+int ast_pool_build(AstPool *pool, ASTNode *program);
+
+/**
+ * @brief Frees the arrays of the pool and leaves it empty.
+ */
+void ast_pool_free(AstPool *pool);
+
+/**
+ * @brief Bytes held by the pool.
+ * @param with_origin Count the `origin` column, which only serves the
+ * migration from the pointer tree.
+ */
+size_t ast_pool_bytes(const AstPool *pool, bool with_origin);
+
+/// Id of the program node of a built pool
+#define AST_POOL_ROOT 1
+
+static inline ASTNodeType ast_pool_kind(const AstPool *pool, AstId id) {
+    return (ASTNodeType)pool->kinds[id];
+}
+
+static inline DataType ast_pool_type(const AstPool *pool, AstId id) {
+    return (DataType)pool->types[id];
+}
+
+/**
+ * @brief Interned name of a node, NULL for none.
+ */
+static inline const char *ast_pool_name(const AstPool *pool, AstId id) {
+    return pool->names[id] ? pool->name_table[pool->names[id]] : NULL;
+}
+
+/**
+ * @brief Child `slot` (0, 1 or 2) of a node, see the layout above.
+ */
+static inline AstId ast_pool_child(const AstPool *pool, AstId id,
+                                   unsigned slot) {
+    return slot == 0 ? pool->first[id]
+           : slot == 1 ? pool->second[id]
+                       : pool->third[id];
+}
+
+/**
+ * @brief The list of a node: definitions, parameters, statements or
+ * arguments.
+ * @param first Output: id of the first element.
+ * @return Number of elements; they are `first`, `first + 1`, ...
+ */
+static inline size_t ast_pool_list(const AstPool *pool, AstId id,
+                                   AstId *first) {
+    *first = pool->first[id];
+    return pool->second[id];
+}
+
+/**
+ * @brief Expression tree of an AST_EXPRESSION node, NULL for none.
+ */
+static inline ExprNode *ast_pool_expr(const AstPool *pool, AstId id) {
+    return pool->kinds[id] == AST_EXPRESSION && pool->third[id]
+               ? pool->exprs[pool->third[id] - 1]
+               : NULL;
+}
+
+/**
+ * @brief The node of the pointer tree an id was built from.
+ */
+static inline ASTNode *ast_pool_node(const AstPool *pool, AstId id) {
+    return pool->origin[id];
+}
+
+#endif // AST_POOL_H
@@ -0,0 +1,102 @@
+/**
+ * @file ast_walk.c
+ * @author xcernoj00
+ * @brief Traversal of the AST without recursion (see ast_walk.h).
+ *
+ * The stack holds one step per node whose left subtree is being walked.
+ * The first entries live in ast_walk's frame, so shallow walks (a call in
+ * an expression, a short body) do not allocate.
+ */
+
+#include "ast_walk.h"
+#include "error.h"
+#include <stdlib.h>
+#include <string.h>
+
+/// Steps kept in ast_walk's own frame before the stack moves to the heap
+#define AST_WALK_INLINE_DEPTH 32
+
+typedef struct {
+    AstWalkStep *steps;
+    size_t count;
+    size_t capacity;
+    AstWalkStep *inline_steps; ///< initial storage, not to be freed
+} WalkStack;
+
+/**
+ * @brief Pushes a step with the default contexts and children.
+ * @return The new step, or NULL on allocation failure.
+ */
+static AstWalkStep *walk_push(WalkStack *stack, ASTNode *node,
+                              void *context) {
+    if (stack->count == stack->capacity) {
+        size_t capacity = stack->capacity * 2;
+        AstWalkStep *steps;
+        if (stack->steps == stack->inline_steps) {
+            steps = malloc(capacity * sizeof(AstWalkStep));
+            if (steps) {
+                memcpy(steps, stack->steps,
+                       stack->count * sizeof(AstWalkStep));
+            }
+        } else {
+            steps = realloc(stack->steps, capacity * sizeof(AstWalkStep));
+        }
+        if (!steps) {
+            return NULL;
+        }
+        stack->steps = steps;
+        stack->capacity = capacity;
+    }
+    AstWalkStep *step = &stack->steps[stack->count++];
+    step->node = node;
+    step->context = context;
+    step->left_context = context;
+    step->right_context = context;
+    step->children = AST_WALK_CHILDREN;
+    return step;
+}
+
+int ast_walk(ASTNode *root, void *context, AstWalkVisit pre,
+             AstWalkVisit post, void *data) {
+    AstWalkStep inline_steps[AST_WALK_INLINE_DEPTH];
+    WalkStack stack = {inline_steps, 0, AST_WALK_INLINE_DEPTH, inline_steps};
+    int err = NO_ERROR;
+    ASTNode *node = root;
+
+    for (;;) {
+        if (node) {
+            // Enter the node, then go down its left subtree
+            AstWalkStep *step = walk_push(&stack, node, context);
+            if (!step) {
+                err = ERROR_INTERNAL;
+                break;
+            }
+            if (pre && (err = pre(step, data)) != NO_ERROR) {
+                break;
+            }
+            if ((step->children & AST_WALK_LEFT) && node->left) {
+                node = node->left;
+                context = step->left_context;
+                continue;
+            }
+        }
+        if (stack.count == 0) {
+            break;
+        }
+
+        // The left subtree of the top node is done: leave the node and
+        // continue with its right in its place
+        AstWalkStep *step = &stack.steps[stack.count - 1];
+        if (post && (err = post(step, data)) != NO_ERROR) {
+            break;
+        }
+        node = (step->children & AST_WALK_RIGHT) ? step->node->right : NULL;
+        context = step->right_context;
+        stack.count--;
+    }
+
+    if (stack.steps != inline_steps) {
+        free(stack.steps);
+    }
+    return err;
+}
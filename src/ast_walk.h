@@ -0,0 +1,66 @@
+/**
+ * @file ast_walk.h
+ * @author xcernoj00
+ * @brief Traversal of the AST without recursion.
+ *
+ * `ast_walk` visits a tree from an explicit stack. Definitions, statements
+ * and the rest of a block are chains along `right`, so the walker treats
+ * `right` as the continuation of a node: it is walked after the node's post
+ * visit, in the node's place on the stack. The stack therefore grows with
+ * the nesting of blocks and expressions, never with the length of a chain.
+ *
+ * Every visited node gets an AstWalkStep. The pre visit sees the context
+ * the node was reached with (a scope, a code generation state...) and
+ * chooses the children to walk and their contexts. The post visit runs
+ * after the left subtree and may still change how `right` is walked.
+ */
+
+#ifndef AST_WALK_H
+#define AST_WALK_H
+
+#include "ast.h"
+
+/// Children flags of AstWalkStep
+enum {
+    AST_WALK_SKIP_CHILDREN = 0, ///< walk neither child
+    AST_WALK_LEFT = 1,          ///< walk the subtree of `left`
+    AST_WALK_RIGHT = 2,         ///< continue with `right`
+    AST_WALK_CHILDREN = 3       ///< both (the default)
+};
+
+/**
+ * @brief Visit of one node.
+ *
+ * Before the pre visit, both child contexts are the node's context and
+ * `children` is AST_WALK_CHILDREN.
+ */
+typedef struct {
+    ASTNode *node;       ///< visited node, never NULL
+    void *context;       ///< context the node was reached with
+    void *left_context;  ///< context for the subtree of `left`
+    void *right_context; ///< context for `right`
+    unsigned children;   ///< AST_WALK_* flags of the children to walk
+} AstWalkStep;
+
+/**
+ * @brief Pre or post visit of a node.
+ * @param step The visit, which the callback may change.
+ * @param data Data passed to ast_walk.
+ * @return NO_ERROR to go on; anything else stops the walk.
+ */
+typedef int (*AstWalkVisit)(AstWalkStep *step, void *data);
+
+/**
+ * @brief Walks a tree: pre visit, subtree of `left`, post visit, then
+ * `right`, as the children flags allow.
+ * @param root First node, may be NULL.
+ * @param context Context of the first node.
+ * @param pre, post Visits, either may be NULL.
+ * @param data Passed to the visits.
+ * @return NO_ERROR, the first nonzero result of a visit, or
+ * ERROR_INTERNAL when the stack cannot grow.
+ */
+int ast_walk(ASTNode *root, void *context, AstWalkVisit pre,
+             AstWalkVisit post, void *data);
+
+#endif // AST_WALK_H
@@ -0,0 +1,211 @@
+/**
+ * @file batch.c
+ * @author xcernoj00
+ * @brief Compiling many programs in parallel inside one process
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "batch.h"
+#include "error.h"
+#include "ifj25.h"
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#define BATCH_SOURCE_SUFFIX ".wren"
+
+typedef struct {
+    Batch *batch;
+    Ifj25Context *contexts; ///< one per worker
+} BatchRun;
+
+void batch_init(Batch *batch) { memset(batch, 0, sizeof(*batch)); }
+
+int batch_add(Batch *batch, const char *path) {
+    if (batch->count == batch->capacity) {
+        size_t capacity = batch->capacity ? batch->capacity * 2 : 64;
+        BatchFile *files = realloc(batch->files, capacity * sizeof(BatchFile));
+        if (!files) {
+            return ERROR_INTERNAL;
+        }
+        batch->files = files;
+        batch->capacity = capacity;
+    }
+    char *copy = malloc(strlen(path) + 1);
+    if (!copy) {
+        return ERROR_INTERNAL;
+    }
+    strcpy(copy, path);
+    batch->files[batch->count++] = (BatchFile){copy, NO_ERROR, 0.0};
+    return NO_ERROR;
+}
+
+static int compare_names(const void *a, const void *b) {
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+static bool has_suffix(const char *name, const char *suffix) {
+    size_t length = strlen(name);
+    size_t suffix_length = strlen(suffix);
+    return length > suffix_length &&
+           strcmp(name + length - suffix_length, suffix) == 0;
+}
+
+/**
+ * @brief Add the sources of a directory in name order.
+ */
+static int collect_directory(Batch *batch, const char *dir_path) {
+    DIR *dir = opendir(dir_path);
+    if (!dir) {
+        return ERROR_INTERNAL;
+    }
+
+    char **names = NULL;
+    size_t count = 0, capacity = 0;
+    int result = NO_ERROR;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (!has_suffix(entry->d_name, BATCH_SOURCE_SUFFIX)) {
+            continue;
+        }
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 64;
+            char **grown = realloc(names, capacity * sizeof(char *));
+            if (!grown) {
+                result = ERROR_INTERNAL;
+                break;
+            }
+            names = grown;
+        }
+        size_t length = strlen(dir_path) + strlen(entry->d_name) + 2;
+        names[count] = malloc(length);
+        if (!names[count]) {
+            result = ERROR_INTERNAL;
+            break;
+        }
+        snprintf(names[count++], length, "%s/%s", dir_path, entry->d_name);
+    }
+    closedir(dir);
+
+    if (result == NO_ERROR) {
+        qsort(names, count, sizeof(char *), compare_names);
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (result == NO_ERROR) {
+            result = batch_add(batch, names[i]);
+        }
+        free(names[i]);
+    }
+    free(names);
+    return result;
+}
+
+/**
+ * @brief Add the paths listed in a file, one per line.
+ */
+static int collect_list(Batch *batch, const char *list_path) {
+    FILE *list = fopen(list_path, "r");
+    if (!list) {
+        return ERROR_INTERNAL;
+    }
+
+    char *line = NULL;
+    size_t size = 0;
+    ssize_t length;
+    int result = NO_ERROR;
+    while (result == NO_ERROR && (length = getline(&line, &size, list)) >= 0) {
+        while (length > 0 &&
+               (line[length - 1] == '\n' || line[length - 1] == '\r')) {
+            line[--length] = '\0';
+        }
+        if (length > 0) {
+            result = batch_add(batch, line);
+        }
+    }
+    free(line);
+    fclose(list);
+    return result;
+}
+
+int batch_collect(Batch *batch, const char *source) {
+    struct stat info;
+    if (stat(source, &info) != 0) {
+        return ERROR_INTERNAL;
+    }
+    return S_ISDIR(info.st_mode) ? collect_directory(batch, source)
+                                 : collect_list(batch, source);
+}
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Compile one input into `<input>.ifjcode`.
+ */
+static void compile_job(void *context, size_t job, unsigned worker) {
+    BatchRun *run = context;
+    BatchFile *file = &run->batch->files[job];
+    double start = now_seconds();
+
+    size_t length = strlen(file->path) + sizeof(BATCH_OUTPUT_SUFFIX);
+    char *output_path = malloc(length);
+    FILE *source = fopen(file->path, "rb");
+    FILE *sink = NULL;
+    if (output_path) {
+        snprintf(output_path, length, "%s%s", file->path, BATCH_OUTPUT_SUFFIX);
+        sink = fopen(output_path, "w");
+    }
+    if (source && sink) {
+        file->status =
+            ifj25_compile_file(&run->contexts[worker], source, sink);
+    } else {
+        fprintf(stderr, "Cannot open %s\n", source ? output_path : file->path);
+        file->status = ERROR_INTERNAL;
+    }
+    if (source) {
+        fclose(source);
+    }
+    if (sink) {
+        fclose(sink);
+    }
+    free(output_path);
+    file->seconds = now_seconds() - start;
+}
+
+size_t batch_compile(Batch *batch, unsigned threads,
+                     const Ifj25Context *options, WorkPoolStats *stats) {
+    BatchRun run = {batch, calloc(WORK_POOL_MAX_THREADS, sizeof(Ifj25Context))};
+    if (!run.contexts) {
+        for (size_t i = 0; i < batch->count; i++) {
+            batch->files[i].status = ERROR_INTERNAL;
+        }
+        return batch->count;
+    }
+    for (unsigned i = 0; i < WORK_POOL_MAX_THREADS; i++) {
+        run.contexts[i] = *options;
+    }
+
+    work_pool_run(batch->count, threads, compile_job, &run, stats);
+
+    size_t failed = 0;
+    for (size_t i = 0; i < batch->count; i++) {
+        failed += batch->files[i].status != NO_ERROR;
+    }
+    free(run.contexts);
+    return failed;
+}
+
+void batch_free(Batch *batch) {
+    for (size_t i = 0; i < batch->count; i++) {
+        free(batch->files[i].path);
+    }
+    free(batch->files);
+    batch_init(batch);
+}
@@ -0,0 +1,79 @@
+/**
+ * @file batch.h
+ * @author xcernoj00
+ * @brief Compiling many programs in parallel inside one process.
+ *
+ * The inputs are distributed over a work-stealing pool (work_pool.h); each
+ * worker compiles with its own copy of the caller's Ifj25Context, so every
+ * compiler option applies to the batch. The code generated for `<file>` is
+ * written to `<file>.ifjcode`.
+ */
+
+#ifndef _BATCH_H
+#define _BATCH_H
+
+#include "ifj25.h"
+#include "work_pool.h"
+#include <stddef.h>
+
+#define BATCH_OUTPUT_SUFFIX ".ifjcode"
+
+/**
+ * @brief One input of a batch and the outcome of its compilation.
+ */
+typedef struct {
+    char *path;     ///< input file
+    int status;     ///< error code of the compilation (error.h)
+    double seconds; ///< wall time of the compilation
+} BatchFile;
+
+/**
+ * @brief List of inputs compiled together.
+ */
+typedef struct {
+    BatchFile *files;
+    size_t count;
+    size_t capacity;
+} Batch;
+
+/**
+ * @brief Initialize an empty batch.
+ */
+void batch_init(Batch *batch);
+
+/**
+ * @brief Add one input file.
+ *
+ * @return NO_ERROR or ERROR_INTERNAL on allocation failure.
+ */
+int batch_add(Batch *batch, const char *path);
+
+/**
+ * @brief Add the inputs named by `source`.
+ *
+ * A directory contributes its `*.wren` files in name order, any other file
+ * is read as a list with one input path per line.
+ *
+ * @return NO_ERROR, or ERROR_INTERNAL when `source` cannot be read.
+ */
+int batch_collect(Batch *batch, const char *source);
+
+/**
+ * @brief Compile all inputs on up to `threads` workers.
+ *
+ * @param batch Inputs; receives the status of each.
+ * @param threads Number of workers (0 means one per processor).
+ * @param options Context copied into every worker; its options apply to
+ *                all inputs and it receives no results.
+ * @param stats Receives the pool counters (may be NULL).
+ * @return Number of inputs that failed to compile.
+ */
+size_t batch_compile(Batch *batch, unsigned threads,
+                     const Ifj25Context *options, WorkPoolStats *stats);
+
+/**
+ * @brief Free the batch.
+ */
+void batch_free(Batch *batch);
+
+#endif // _BATCH_H
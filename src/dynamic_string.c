@@ -6,6 +6,7 @@
 
 #include "dynamic_string.h"
 #include "error.h"
+#include <limits.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -15,62 +16,90 @@ void d_string_clear(DynamicString *s) {
 }
 
 int d_string_alloc(DynamicString *s) {
-    s->str = (char *)malloc(INITIAL_ALLOC_SIZE);
-    if (!s->str)
-        return ERROR_INTERNAL;
+    s->str = s->small;
+    s->max_length = D_STRING_INLINE_SIZE;
     d_string_clear(s);
-    s->max_length = INITIAL_ALLOC_SIZE;
 
     return NO_ERROR;
 }
 
-int d_string_add_char(DynamicString *s, char c) {
-    if (s->length + 1 >= s->max_length) {
-        unsigned int new_size = s->length * 2;
-        s->str = (char *)realloc(s->str, new_size);
-        if (!s->str)
+/**
+ * @brief Grow the buffer to hold `needed` bytes including the NUL.
+ *
+ * The size at least doubles, so repeated appends move every character an
+ * amortized constant number of times.
+ */
+static int d_string_grow(DynamicString *s, size_t needed) {
+    if (needed > UINT_MAX) {
+        return ERROR_INTERNAL;
+    }
+    size_t new_size = (size_t)s->max_length * 2;
+    if (new_size < needed) {
+        new_size = needed;
+    }
+    if (new_size > UINT_MAX) {
+        new_size = UINT_MAX;
+    }
+
+    char *str;
+    if (s->str == s->small) {
+        str = (char *)malloc(new_size);
+        if (!str)
+            return ERROR_INTERNAL;
+        memcpy(str, s->small, s->length + 1);
+    } else {
+        str = (char *)realloc(s->str, new_size);
+        if (!str)
             return ERROR_INTERNAL;
-        s->max_length = new_size;
     }
-    s->str[s->length++] = c;
-    s->str[s->length] = '\0';
+    s->str = str;
+    s->max_length = (unsigned int)new_size;
 
     return NO_ERROR;
 }
 
-int d_string_add_str(DynamicString *s, const char *const_str) {
-    unsigned int const_str_length = (unsigned int)strlen(const_str);
+int d_string_reserve(DynamicString *s, size_t capacity) {
+    if (capacity < s->max_length) {
+        return NO_ERROR;
+    }
+    return d_string_grow(s, capacity + 1);
+}
 
-    if (s->length + const_str_length + 1 >= s->max_length) {
-        unsigned int new_size = s->length + const_str_length + 1;
-        s->str = (char *)realloc(s->str, new_size);
-        if (!s->str)
-            return ERROR_INTERNAL;
-        s->max_length = new_size;
+int d_string_add_n(DynamicString *s, const char *data, size_t length) {
+    size_t needed = (size_t)s->length + length + 1;
+
+    if (needed > s->max_length && d_string_grow(s, needed) != NO_ERROR) {
+        return ERROR_INTERNAL;
     }
-    s->length += const_str_length;
-    strcat(s->str, const_str);
+    // Append at the known end instead of searching for it like strcat
+    memcpy(s->str + s->length, data, length);
+    s->length += (unsigned int)length;
     s->str[s->length] = '\0';
 
     return NO_ERROR;
 }
 
+int d_string_add_str(DynamicString *s, const char *const_str) {
+    return d_string_add_n(s, const_str, strlen(const_str));
+}
+
 int d_string_cmp(DynamicString *s, const char *const_str) {
     return strcmp(s->str, const_str);
 }
 
 int d_string_copy(DynamicString *src, DynamicString *dest) {
-    unsigned int new_length = src->length;
-    if (new_length >= dest->max_length) {
-        dest->str = (char *)realloc(dest->str, new_length + 1);
-        if (!dest->str)
-            return ERROR_INTERNAL;
-        dest->max_length = new_length + 1;
+    if (d_string_reserve(dest, src->length) != NO_ERROR) {
+        return ERROR_INTERNAL;
     }
-    strcpy(dest->str, src->str);
-    dest->length = new_length;
+    memcpy(dest->str, src->str, (size_t)src->length + 1);
+    dest->length = src->length;
 
     return NO_ERROR;
 }
 
-void d_string_free(DynamicString *s) { free(s->str); }
\ No newline at end of file
+void d_string_free(DynamicString *s) {
+    if (s->str != s->small) {
+        free(s->str);
+    }
+    d_string_alloc(s);
+}
@@ -4,28 +4,36 @@
  * @brief Dynamic, resizable string utility used across the project.
  *
  * The DynamicString type provides a small growable buffer for building
- * and copying character sequences. It is a minimal wrapper around a
- * heap-allocated char array and keeps track of used and allocated size.
+ * and copying character sequences. Short strings live in a buffer inside
+ * the structure itself; longer ones move to the heap, which grows
+ * geometrically so that any sequence of appends costs amortized O(1) per
+ * character.
  */
 
 #ifndef _DYNAMIC_STRING_H
 #define _DYNAMIC_STRING_H
 
+#include "error.h"
 #include <stddef.h>
 
-#define INITIAL_ALLOC_SIZE 8
+#define D_STRING_INLINE_SIZE 24 ///< bytes stored without a heap block
 
 /**
  * @brief Growable string container.
  *
- * - `str` points to a NUL-terminated buffer (heap allocated by the API).
+ * - `str` points to a NUL-terminated buffer, either `small` or a heap
+ *   block allocated by the API.
  * - `length` is the number of characters stored (excluding terminating NUL).
  * - `max_length` is the total buffer size including the terminating NUL.
+ *
+ * As `str` may point into the structure itself, an initialized
+ * DynamicString must not be copied by assignment; use `d_string_copy`.
  */
 typedef struct d_str {
     char *str;
     unsigned int length;
     unsigned int max_length;
+    char small[D_STRING_INLINE_SIZE]; ///< inline storage for short strings
 } DynamicString;
 
 /**
@@ -36,26 +44,46 @@ typedef struct d_str {
 void d_string_clear(DynamicString *s);
 
 /**
- * @brief Allocate initial storage for a DynamicString.
+ * @brief Initialize a DynamicString as an empty string.
  *
- * The function initializes the internal buffer and fields. The caller
- * must call `d_string_free` when the string is no longer needed.
+ * The string starts in its inline buffer, so this never allocates. The
+ * caller must call `d_string_free` when the string is no longer needed.
  *
  * @param s Pointer to DynamicString to initialize.
- * @return NO_ERROR on success or ERROR_INTERNAL on allocation failure.
+ * @return NO_ERROR (kept for callers written against the allocating API).
  */
 int d_string_alloc(DynamicString *s);
 
+/**
+ * @brief Make room for at least `capacity` characters plus the NUL.
+ *
+ * @param s Pointer to an initialized DynamicString.
+ * @param capacity Number of characters the string must be able to hold.
+ * @return NO_ERROR on success or ERROR_INTERNAL on allocation failure
+ *         (the string is then left unchanged).
+ */
+int d_string_reserve(DynamicString *s, size_t capacity);
+
 /**
  * @brief Append a single character to the dynamic string.
  *
- * The buffer will be grown automatically if needed.
+ * The buffer will be grown automatically if needed. Inline, since the
+ * scanner appends character by character.
  *
  * @param s Pointer to DynamicString.
  * @param c Character to append.
  * @return NO_ERROR on success or ERROR_INTERNAL on allocation failure.
  */
-int d_string_add_char(DynamicString *s, char c);
+static inline int d_string_add_char(DynamicString *s, char c) {
+    if (s->length + 1 >= s->max_length &&
+        d_string_reserve(s, (size_t)s->length + 1) != NO_ERROR) {
+        return ERROR_INTERNAL;
+    }
+    s->str[s->length++] = c;
+    s->str[s->length] = '\0';
+
+    return NO_ERROR;
+}
 
 /**
  * @brief Append a NUL-terminated C string to the dynamic string.
@@ -68,6 +96,16 @@ int d_string_add_char(DynamicString *s, char c);
  */
 int d_string_add_str(DynamicString *s, const char *const_str);
 
+/**
+ * @brief Append `length` bytes to the dynamic string.
+ *
+ * @param s Target DynamicString.
+ * @param data Bytes to append (need not be NUL-terminated).
+ * @param length Number of bytes to append.
+ * @return NO_ERROR on success or ERROR_INTERNAL on allocation failure.
+ */
+int d_string_add_n(DynamicString *s, const char *data, size_t length);
+
 /**
  * @brief Compare the dynamic string with a C string.
  *
@@ -91,7 +129,8 @@ int d_string_copy(DynamicString *src, DynamicString *dest);
 /**
  * @brief Free internal buffer of the dynamic string.
  *
- * After this call the `str` pointer is freed and must not be used.
+ * Heap storage is released and the string is left empty in its inline
+ * buffer, so freeing twice is harmless.
  *
  * @param s DynamicString to free.
  */
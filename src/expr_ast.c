@@ -2,15 +2,27 @@
  * @file expr_ast.c
  * @author xmikusm00
  * @brief Expression Abstract Syntax Tree (AST) implementations
+ *
+ * Expression nodes and string literal copies belong to the AST, so they are
+ * allocated from the ARENA_PARSE arena and released together with it.
  */
 
 #include "expr_ast.h"
+#include "arena.h"
 #include "error.h"
+#include "intern.h"
 #include "symtable.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+/**
+ * @brief Allocates an uninitialized expression node in the AST arena
+ */
+static ExprNode *alloc_expr_node(void) {
+    return (ExprNode *)arena_alloc(phase_arena(ARENA_PARSE), sizeof(ExprNode));
+}
+
 /**
  * @brief Creates a numeric literal expression node
  *
@@ -21,7 +33,7 @@
  * @return Pointer to newly created node, or NULL if allocation fails
  */
 ExprNode *create_num_literal_node(double value) {
-    ExprNode *node = (ExprNode *)malloc(sizeof(ExprNode));
+    ExprNode *node = alloc_expr_node();
     if (!node) {
         return NULL;
     }
@@ -40,14 +52,28 @@ ExprNode *create_num_literal_node(double value) {
  * @return Pointer to newly created node, or NULL if allocation fails
  */
 ExprNode *create_string_literal_node(const char *value) {
-    ExprNode *node = (ExprNode *)malloc(sizeof(ExprNode));
+    return create_string_literal_node_n(value, strlen(value));
+}
+
+/**
+ * @brief Creates a string literal expression node from a character slice
+ *
+ * Like create_string_literal_node(), but copies at most `length`
+ * characters, so the value may point into a non-terminated buffer.
+ *
+ * @param value The string characters
+ * @param length Number of characters to copy
+ * @return Pointer to newly created node, or NULL if allocation fails
+ */
+ExprNode *create_string_literal_node_n(const char *value, size_t length) {
+    ExprNode *node = alloc_expr_node();
     if (!node) {
         return NULL;
     }
     node->type = EXPR_STRING_LITERAL;
-    node->data.string_literal = my_strdup(value);
+    node->data.string_literal =
+        arena_strndup(phase_arena(ARENA_PARSE), value, length);
     if (!node->data.string_literal) {
-        free(node);
         return NULL;
     }
     return node;
@@ -61,7 +87,7 @@ ExprNode *create_string_literal_node(const char *value) {
  * @return Pointer to newly created node, or NULL if allocation fails
  */
 ExprNode *create_null_literal_node() {
-    ExprNode *node = (ExprNode *)malloc(sizeof(ExprNode));
+    ExprNode *node = alloc_expr_node();
     if (!node) {
         return NULL;
     }
@@ -73,20 +99,20 @@ ExprNode *create_null_literal_node() {
  * @brief Creates a type literal expression node
  *
  * Allocates and initializes a new expression node representing a type literal.
- * The type name is duplicated.
+ * The type name is interned.
  *
  * @param name The type name to store
  * @return Pointer to newly created node, or NULL if allocation fails
  */
 ExprNode *create_type_node(const char *name) {
-    ExprNode *node = (ExprNode *)malloc(sizeof(ExprNode));
+    ExprNode *node = alloc_expr_node();
     if (!node) {
         return NULL;
     }
     node->type = EXPR_TYPE_LITERAL;
-    node->data.identifier_name = my_strdup(name);
+    node->data.identifier_name = intern(name);
     if (!node->data.identifier_name) {
-        free(node);
+        arena_release(phase_arena(ARENA_PARSE), node, sizeof(ExprNode));
         return NULL;
     }
     return node;
@@ -96,22 +122,36 @@ ExprNode *create_type_node(const char *name) {
  * @brief Creates an identifier expression node
  *
  * Allocates and initializes a new expression node representing a variable
- * identifier. The identifier name is duplicated and the scope is initialized to
+ * identifier. The identifier name is interned and the scope is initialized to
  * NULL.
  *
  * @param name The identifier name to store
  * @return Pointer to newly created node, or NULL if allocation fails
  */
 ExprNode *create_identifier_node(const char *name) {
-    ExprNode *node = (ExprNode *)malloc(sizeof(ExprNode));
+    return create_identifier_node_n(name, strlen(name));
+}
+
+/**
+ * @brief Creates an identifier expression node from a character slice
+ *
+ * Like create_identifier_node(), but uses at most `length` characters,
+ * so the name may point into a non-terminated buffer.
+ *
+ * @param name The identifier characters
+ * @param length Number of characters of the name
+ * @return Pointer to newly created node, or NULL if allocation fails
+ */
+ExprNode *create_identifier_node_n(const char *name, size_t length) {
+    ExprNode *node = alloc_expr_node();
     if (!node) {
         return NULL;
     }
     node->type = EXPR_IDENTIFIER;
-    node->data.identifier_name = my_strdup(name);
+    node->data.identifier_name = intern_n(name, length);
     node->current_scope = NULL;
     if (!node->data.identifier_name) {
-        free(node);
+        arena_release(phase_arena(ARENA_PARSE), node, sizeof(ExprNode));
         return NULL;
     }
     return node;
@@ -130,7 +170,7 @@ ExprNode *create_identifier_node(const char *name) {
  */
 ExprNode *create_binary_op_node(BinaryOpType op, ExprNode *left,
                                 ExprNode *right) {
-    ExprNode *node = (ExprNode *)malloc(sizeof(ExprNode));
+    ExprNode *node = alloc_expr_node();
     if (!node) {
         return NULL;
     }
@@ -145,53 +185,20 @@ ExprNode *create_binary_op_node(BinaryOpType op, ExprNode *left,
  * @brief Creates a getter call expression node
  *
  * Allocates and initializes a new expression node representing a getter method
- * call. The getter name is duplicated.
+ * call. The getter name is interned.
  *
  * @param name The getter method name to store
  * @return Pointer to newly created node, or NULL if allocation fails
  */
 ExprNode *create_getter_call_node(const char *name) {
-    ExprNode *node = (ExprNode *)malloc(sizeof(ExprNode));
+    ExprNode *node = alloc_expr_node();
     if (!node)
         return NULL;
     node->type = EXPR_GETTER_CALL;
-    node->data.getter_name = my_strdup(name);
+    node->data.getter_name = intern(name);
     if (!node->data.getter_name) {
-        free(node);
+        arena_release(phase_arena(ARENA_PARSE), node, sizeof(ExprNode));
         return NULL;
     }
     return node;
 }
-
-/**
- * @brief Recursively frees an expression node and all its children
- *
- * Frees all dynamically allocated memory associated with an expression node,
- * including string data and child nodes (for binary operations). Safe to call
- * with NULL pointer.
- *
- * @param node Pointer to the expression node to free (can be NULL)
- */
-void free_expr_node(ExprNode *node) {
-    if (!node)
-        return;
-
-    switch (node->type) {
-    case EXPR_STRING_LITERAL:
-        free(node->data.string_literal);
-        break;
-    case EXPR_IDENTIFIER:
-        free(node->data.identifier_name);
-        break;
-    case EXPR_GETTER_CALL:
-        free(node->data.getter_name);
-        break;
-    case EXPR_BINARY_OP:
-        free_expr_node(node->data.binary.left);
-        free_expr_node(node->data.binary.right);
-        break;
-    default:
-        break;
-    }
-    free(node);
-}
@@ -6,6 +6,8 @@
 #ifndef EXPR_AST_H
 #define EXPR_AST_H
 
+#include <stddef.h>
+
 typedef struct Scope Scope;
 
 /**
@@ -51,8 +53,8 @@ typedef struct ExprNode {
     union {
         double num_literal;    ///< Numeric value (for EXPR_NUM_LITERAL)
         char *string_literal;  ///< String value (for EXPR_STRING_LITERAL)
-        char *identifier_name; ///< Identifier name (for EXPR_IDENTIFIER)
-        char *getter_name;     ///< Getter name (for EXPR_GETTER_CALL)
+        const char *identifier_name; ///< Interned identifier name
+        const char *getter_name;     ///< Interned getter name
         struct {
             BinaryOpType op;        ///< Binary operator type
             struct ExprNode *left;  ///< Left operand
@@ -75,6 +77,14 @@ ExprNode *create_num_literal_node(double value);
  */
 ExprNode *create_string_literal_node(const char *value);
 
+/**
+ * @brief Creates a string literal expression node from a character slice
+ * @param value The string characters (need not be NUL-terminated)
+ * @param length Number of characters to copy
+ * @return Pointer to the created node, or NULL on allocation failure
+ */
+ExprNode *create_string_literal_node_n(const char *value, size_t length);
+
 /**
  * @brief Creates a null literal expression node
  * @return Pointer to the created node, or NULL on allocation failure
@@ -95,6 +105,14 @@ ExprNode *create_type_node(const char *name);
  */
 ExprNode *create_identifier_node(const char *name);
 
+/**
+ * @brief Creates an identifier expression node from a character slice
+ * @param name The identifier characters (need not be NUL-terminated)
+ * @param length Number of characters of the name
+ * @return Pointer to the created node, or NULL on allocation failure
+ */
+ExprNode *create_identifier_node_n(const char *name, size_t length);
+
 /**
  * @brief Creates a getter call expression node
  * @param name The getter name
@@ -112,10 +130,4 @@ ExprNode *create_getter_call_node(const char *name);
 ExprNode *create_binary_op_node(BinaryOpType op, ExprNode *left,
                                 ExprNode *right);
 
-/**
- * @brief Frees an expression node and all its children
- * @param node The node to free (can be NULL)
- */
-void free_expr_node(ExprNode *node);
-
 #endif // EXPR_AST_H
@@ -22,6 +22,10 @@
  * (`ExprPstack`).
  *  3. Reduce according to rules TERM->E and E op E -> E until a single
  * expression remains.
+ *
+ * `climbing_expression_parser` builds the same trees by precedence climbing
+ * and falls back to the shift/reduce loop for malformed or deeply nested
+ * input.
  */
 #include "expr_parser.h"
 #include "ast.h"
@@ -98,65 +102,125 @@ static Sym token_to_sym(const Token *token) {
     }
 }
 
+/**
+ * @brief Creates the expression node of an operand token.
+ * @param scanner Scanner that produced the token.
+ * @param token Identifier, literal or type keyword.
+ * @return Newly created `ExprNode` pointer, or NULL when the token is no
+ * operand or on allocation failure.
+ * @details
+ * Handles identifiers, literals (number, string, null) and type keywords mapped
+ * for the `is` operator.
+ */
+static ExprNode *term_node(Scanner *scanner, const Token *token) {
+    const char *name;
+    size_t length;
+    switch (token->type) {
+    case TOKEN_IDENTIFIER:
+    case TOKEN_GLOBAL_VAR:
+        return create_identifier_node(token->value.name);
+    case TOKEN_INTEGER:
+    case TOKEN_DOUBLE:
+        return create_num_literal_node(token->value.integer);
+    case TOKEN_STRING:
+        name = token_text(scanner, token, &length);
+        return create_string_literal_node_n(name, length);
+
+    case TOKEN_KEYWORD:
+        if (token->value.keyword == KEYWORD_NULL_L) {
+            // Lowercase 'null' is a null literal value
+            return create_null_literal_node();
+        } else if (token->value.keyword == KEYWORD_NULL_C) {
+            // Uppercase 'Null' is a type (for 'is' operator)
+            return create_type_node("Null");
+        } else if (token->value.keyword == KEYWORD_NUM) {
+            return create_type_node("Num");
+        } else if (token->value.keyword == KEYWORD_STRING) {
+            return create_type_node("String");
+        }
+        return NULL;
+    default:
+        return NULL;
+    }
+}
+
 /**
  * @brief Reduces the top TERM symbol on the stack into an expression node.
+ * @param scanner Scanner that produced the tokens on the stack.
  * @param stack Pointer to precedence stack (top must be SYM_TERM).
  * @param rc Pointer to error code.
  * @return Newly created `ExprNode` pointer, or NULL on error.
  * @details
- * Handles identifiers, literals (number, string, null) and type keywords mapped
- * for the `is` operator. On success replaces the TERM with a NONTERM containing
- * the created node.
+ * On success replaces the TERM with a NONTERM containing the created node
+ * (see `term_node`).
  */
-ExprNode *reduce_term_to_node(ExprPstack *stack, int *rc) {
-    ExprNode *node = NULL;
-    switch (stack->top->type) {
-    case SYM_TERM:
-        switch (stack->top->token.type) {
-        case TOKEN_IDENTIFIER:
-        case TOKEN_GLOBAL_VAR:
-            node = create_identifier_node(stack->top->token.value.string->str);
-            break;
-        case TOKEN_INTEGER:
-        case TOKEN_DOUBLE:
-            node = create_num_literal_node(stack->top->token.value.integer);
-            break;
-        case TOKEN_STRING:
-            node =
-                create_string_literal_node(stack->top->token.value.string->str);
-            break;
-
-        case TOKEN_KEYWORD:
-            if (stack->top->token.value.keyword == KEYWORD_NULL_L) {
-                // Lowercase 'null' is a null literal value
-                node = create_null_literal_node();
-            } else if (stack->top->token.value.keyword == KEYWORD_NULL_C) {
-                // Uppercase 'Null' is a type (for 'is' operator)
-                node = create_type_node("Null");
-            } else if (stack->top->token.value.keyword == KEYWORD_NUM) {
-                node = create_type_node("Num");
-            } else if (stack->top->token.value.keyword == KEYWORD_STRING) {
-                node = create_type_node("String");
-            }
-            break;
-        default:
+ExprNode *reduce_term_to_node(Scanner *scanner, ExprPstack *stack,
+                              int *rc) {
+    ExprPstackNode *top = expr_Pstack_peek(stack, 0);
+    if (top->type != SYM_TERM) {
+        return NULL;
+    }
+    ExprNode *node = term_node(scanner, &top->token);
+    if (node) {
+        expr_Pstack_pop(stack);
+        int return_value = expr_Pstack_push_nonterm(stack, node);
+        if (return_value != NO_ERROR) {
+            *rc = ERROR_INTERNAL;
             return NULL;
         }
-        if (node) {
-            expr_Pstack_pop(stack);
-            int return_value = expr_Pstack_push_nonterm(stack, node);
-            if (return_value != NO_ERROR) {
-                *rc = ERROR_INTERNAL;
-                return NULL;
-            }
-        }
-        break;
+    }
+    return node;
+}
 
+/**
+ * @brief Maps an operator token to its binary operation.
+ * @param token Operator token.
+ * @param op Output: the operation.
+ * @return false when the token is no binary operator.
+ */
+static bool token_to_op(const Token *token, BinaryOpType *op) {
+    switch (token->type) {
+    case TOKEN_PLUS:
+        *op = OP_ADD;
+        return true;
+    case TOKEN_MINUS:
+        *op = OP_SUB;
+        return true;
+    case TOKEN_MULTIPLY:
+        *op = OP_MUL;
+        return true;
+    case TOKEN_DIVIDE:
+        *op = OP_DIV;
+        return true;
+    case TOKEN_LESSER:
+        *op = OP_LT;
+        return true;
+    case TOKEN_GREATER:
+        *op = OP_GT;
+        return true;
+    case TOKEN_LESSER_EQUAL:
+        *op = OP_LTE;
+        return true;
+    case TOKEN_GREATER_EQUAL:
+        *op = OP_GTE;
+        return true;
+    case TOKEN_LOGIC_EQUAL:
+        *op = OP_EQ;
+        return true;
+    case TOKEN_NEQUAL:
+        *op = OP_NEQ;
+        return true;
+    case TOKEN_KEYWORD:
+        if (token->value.keyword == KEYWORD_IS) {
+            *op = OP_IS;
+            return true;
+        }
+        return false;
     default:
-        return NULL;
+        return false;
     }
-    return node;
 }
+
 /**
  * @brief Operator precedence and associativity table.
  * @details
@@ -216,65 +280,26 @@ void reduce_expr_op_expr(ExprPstack *stack, int *rc) {
         *rc = SYNTAX_ERROR;
         return;
     }
-    if (stack->top->type != SYM_NONTERM) {
+    if (expr_Pstack_peek(stack, 0)->type != SYM_NONTERM) {
         *rc = SYNTAX_ERROR;
         return;
     }
     // Extract right operand E
-    ExprNode *right = stack->top->node;
+    ExprNode *right = expr_Pstack_peek(stack, 0)->node;
     expr_Pstack_pop(stack);
 
     if (expr_Pstack_is_empty(stack)) {
         *rc = SYNTAX_ERROR;
         return;
     }
-    if (stack->top->type != SYM_TERM) {
+    ExprPstackNode *operator = expr_Pstack_peek(stack, 0);
+    if (operator->type != SYM_TERM) {
         *rc = SYNTAX_ERROR;
         return;
     }
 
     BinaryOpType op;
-    switch (stack->top->token.type) {
-    case TOKEN_PLUS:
-        op = OP_ADD;
-        break;
-    case TOKEN_MINUS:
-        op = OP_SUB;
-        break;
-    case TOKEN_MULTIPLY:
-        op = OP_MUL;
-        break;
-    case TOKEN_DIVIDE:
-        op = OP_DIV;
-        break;
-    case TOKEN_LESSER:
-        op = OP_LT;
-        break;
-    case TOKEN_GREATER:
-        op = OP_GT;
-        break;
-    case TOKEN_LESSER_EQUAL:
-        op = OP_LTE;
-        break;
-    case TOKEN_GREATER_EQUAL:
-        op = OP_GTE;
-        break;
-    case TOKEN_LOGIC_EQUAL:
-        op = OP_EQ;
-        break;
-    case TOKEN_NEQUAL:
-        op = OP_NEQ;
-        break;
-    case TOKEN_KEYWORD:
-        if (stack->top->token.value.keyword == KEYWORD_IS) {
-            op = OP_IS;
-            break;
-        } else {
-            *rc = SYNTAX_ERROR;
-            return;
-        }
-
-    default:
+    if (!token_to_op(&operator->token, &op)) {
         *rc = SYNTAX_ERROR;
         return;
     }
@@ -286,11 +311,11 @@ void reduce_expr_op_expr(ExprPstack *stack, int *rc) {
         *rc = SYNTAX_ERROR;
         return;
     }
-    if (stack->top->type != SYM_NONTERM) {
+    if (expr_Pstack_peek(stack, 0)->type != SYM_NONTERM) {
         *rc = SYNTAX_ERROR;
         return;
     }
-    ExprNode *left = stack->top->node;
+    ExprNode *left = expr_Pstack_peek(stack, 0)->node;
     // Extract operator
     expr_Pstack_pop(stack);
 
@@ -307,6 +332,7 @@ void reduce_expr_op_expr(ExprPstack *stack, int *rc) {
 
 /**
  * @brief Performs one reduction step based on current stack top pattern.
+ * @param scanner Scanner that produced the tokens on the stack.
  * @param stack Precedence stack.
  * @param rc Pointer to error code.
  * @return void (errors reported via rc pointer).
@@ -316,18 +342,18 @@ void reduce_expr_op_expr(ExprPstack *stack, int *rc) {
  *  2. TERM   -> E
  *  3. E op E -> E
  */
-void reduce(ExprPstack *stack, int *rc) {
+void reduce(Scanner *scanner, ExprPstack *stack, int *rc) {
     if (expr_Pstack_is_empty(stack)) {
         *rc = SYNTAX_ERROR;
         return;
     }
     // Reduce ( E ) -> E
-    if (stack->top->type == SYM_TERM &&
-        stack->top->token.type == TOKEN_RPAREN && stack->top->next != NULL &&
-        stack->top->next->type == SYM_NONTERM &&
-        stack->top->next->next != NULL &&
-        stack->top->next->next->type == SYM_TERM &&
-        stack->top->next->next->token.type == TOKEN_LPAREN) {
+    ExprPstackNode *top = expr_Pstack_peek(stack, 0);
+    ExprPstackNode *middle = expr_Pstack_peek(stack, 1);
+    ExprPstackNode *bottom = expr_Pstack_peek(stack, 2);
+    if (top->type == SYM_TERM && top->token.type == TOKEN_RPAREN &&
+        middle != NULL && middle->type == SYM_NONTERM && bottom != NULL &&
+        bottom->type == SYM_TERM && bottom->token.type == TOKEN_LPAREN) {
 
         expr_Pstack_pop(stack); // Pop )
 
@@ -335,18 +361,18 @@ void reduce(ExprPstack *stack, int *rc) {
             *rc = SYNTAX_ERROR;
             return;
         }
-        if (stack->top->type != SYM_NONTERM) {
+        if (expr_Pstack_peek(stack, 0)->type != SYM_NONTERM) {
             *rc = SYNTAX_ERROR;
             return;
         }
-        ExprNode *node = stack->top->node;
+        ExprNode *node = expr_Pstack_peek(stack, 0)->node;
         expr_Pstack_pop(stack); // Pop E
 
         if (expr_Pstack_is_empty(stack)) {
             *rc = SYNTAX_ERROR;
             return;
         }
-        if (stack->top->sym != PS_LPAREN) {
+        if (expr_Pstack_peek(stack, 0)->sym != PS_LPAREN) {
             *rc = SYNTAX_ERROR;
             return;
         }
@@ -356,17 +382,15 @@ void reduce(ExprPstack *stack, int *rc) {
 
     }
     // Reduce TERM -> E
-    else if (stack->top->type == SYM_TERM) {
-        if (stack->top->sym == PS_PLUS || stack->top->sym == PS_MINUS ||
-            stack->top->sym == PS_MUL || stack->top->sym == PS_DIV ||
-            stack->top->sym == PS_LT || stack->top->sym == PS_GT ||
-            stack->top->sym == PS_LTE || stack->top->sym == PS_GTE ||
-            stack->top->sym == PS_EQ || stack->top->sym == PS_NEQ ||
-            stack->top->sym == PS_IS) {
+    else if (top->type == SYM_TERM) {
+        if (top->sym == PS_PLUS || top->sym == PS_MINUS ||
+            top->sym == PS_MUL || top->sym == PS_DIV || top->sym == PS_LT ||
+            top->sym == PS_GT || top->sym == PS_LTE || top->sym == PS_GTE ||
+            top->sym == PS_EQ || top->sym == PS_NEQ || top->sym == PS_IS) {
             *rc = SYNTAX_ERROR;
             return;
         }
-        ExprNode *node = reduce_term_to_node(stack, rc);
+        ExprNode *node = reduce_term_to_node(scanner, stack, rc);
         if (*rc != NO_ERROR) {
             return;
         }
@@ -376,7 +400,7 @@ void reduce(ExprPstack *stack, int *rc) {
         }
     }
     // Reduce E op E -> E
-    else if (stack->top->type == SYM_NONTERM) {
+    else if (top->type == SYM_NONTERM) {
         reduce_expr_op_expr(stack, rc);
         if (*rc != NO_ERROR) {
             return;
@@ -390,130 +414,101 @@ void reduce(ExprPstack *stack, int *rc) {
 }
 
 /**
- * @brief Entry point for precedence expression parsing.
- * @param token Pointer to current token; advanced past parsed expression.
- * @param rc Pointer to error code.
- * @return `AST_EXPRESSION` wrapping internal expression tree or `AST_FUNC_CALL`
- * shortcut, or NULL on error. Stack is properly freed on all error paths.
- * @details
- * Drives the shift/reduce loop using `prec_table`. Stops on EOL, COMMA, EOF.
- * After completion, converts final `ExprNode` stack content into an AST node.
+ * @brief Tells whether the token ends the shift/reduce loop (EOL, COMMA, EOF).
  */
-ASTNode *main_precedence_parser(Token *token, int *rc) {
-    ExprPstack stack;
-    ASTNode *ast_expr = NULL;
-
-    expr_Pstack_init(&stack);
-    if (*rc != NO_ERROR) {
-        expr_Pstack_free(&stack);
-        return NULL;
-    }
-    // Check for function call shortcut: ID (
-    if (token->type == TOKEN_IDENTIFIER) {
-        Token id_token = *token;
-        get_token(token);
-        if (*rc != NO_ERROR) {
-            expr_Pstack_free(&stack);
-            return NULL;
-        }
-        // Function call shortcut detected
-        if (token->type == TOKEN_LPAREN) {
-            ASTNode *call_node =
-                create_ast_node(AST_FUNC_CALL, id_token.value.string->str);
-            if (call_node == NULL) {
-                *rc = ERROR_INTERNAL;
-                expr_Pstack_free(&stack);
-                return NULL;
-            }
-            expr_Pstack_free(&stack);
-            return call_node; // return AST_FUNC_CALL directly, handeled in
-                              // parser - EXPRESSION
-        }
+static bool ends_expression(const Token *token) {
+    return token->type == TOKEN_EOF || token->type == TOKEN_EOL ||
+           token->type == TOKEN_COMMA;
+}
 
-        int return_value = expr_Pstack_push_term(&stack, &id_token, PS_TERM);
-        if (return_value != NO_ERROR) {
-            expr_Pstack_free(&stack);
-            *rc = return_value;
-            return NULL;
-        }
-    }
-    do {
-        ExprPstackNode *scan = stack.top;
-        while (scan && scan->type == SYM_NONTERM) {
-            scan = scan->next; // Skip the NONTERM
-        }
+/**
+ * @brief Runs the shift/reduce loop on a stack holding a parsed prefix.
+ * @param scanner Scanner providing the tokens.
+ * @param stack Precedence stack; freed on return.
+ * @param token Current token, not yet processed.
+ * @param rc Pointer to error code.
+ * @param at_end The token was read by the last shift and ends the expression,
+ * so only the final reductions are left.
+ * @return The single expression left on the stack, or NULL on error.
+ */
+static ExprNode *shift_reduce(Scanner *scanner, ExprPstack *stack,
+                              Token *token, int *rc, bool at_end) {
+    while (!at_end) {
+        ExprPstackNode *scan = expr_Pstack_top_term(stack);
         Sym stack_sym = scan ? token_to_sym(&scan->token) : PS_DOLLAR;
         Sym current_sym = token_to_sym(token);
 
         // Logic based on precedence table
         if (prec_table[stack_sym][current_sym] == '<') { // Shift
             int return_value =
-                expr_Pstack_push_term(&stack, token, current_sym);
+                expr_Pstack_push_term(stack, token, current_sym);
             if (return_value != NO_ERROR) {
-                expr_Pstack_free(&stack);
+                expr_Pstack_free(stack);
                 *rc = return_value;
                 return NULL;
             }
-            get_token(token);
+            *rc = get_token(scanner, token);
             if (*rc != NO_ERROR) {
-                expr_Pstack_free(&stack);
+                expr_Pstack_free(stack);
                 return NULL;
             }
 
         } else if (prec_table[stack_sym][current_sym] == '>') { // Reduce
-            reduce(&stack, rc);
+            reduce(scanner, stack, rc);
             if (*rc != NO_ERROR) {
-                expr_Pstack_free(&stack);
+                expr_Pstack_free(stack);
                 return NULL;
             }
         } else if (prec_table[stack_sym][current_sym] ==
                    '=') { // Shift then reduce
             int return_value =
-                expr_Pstack_push_term(&stack, token, current_sym);
+                expr_Pstack_push_term(stack, token, current_sym);
             if (return_value != NO_ERROR) {
-                expr_Pstack_free(&stack);
+                expr_Pstack_free(stack);
                 *rc = return_value;
                 return NULL;
             }
-            get_token(token);
+            *rc = get_token(scanner, token);
             if (*rc != NO_ERROR) {
-                expr_Pstack_free(&stack);
+                expr_Pstack_free(stack);
                 return NULL;
             }
-            reduce(&stack, rc);
+            reduce(scanner, stack, rc);
             if (*rc != NO_ERROR) {
-                expr_Pstack_free(&stack);
+                expr_Pstack_free(stack);
                 return NULL;
             }
         } else if (prec_table[stack_sym][current_sym] == 'T') // Terminate
             break;
         else {
             *rc = SYNTAX_ERROR;
-            expr_Pstack_free(&stack);
+            expr_Pstack_free(stack);
             return NULL;
         }
 
         // Stop parsing on EOL, COMMA, EOF
-    } while (token->type != TOKEN_EOF && token->type != TOKEN_EOL &&
-             token->type != TOKEN_COMMA);
+        at_end = ends_expression(token);
+    }
     // Final reductions
     while (true) { // Reduce until only single expression remains
-        if (stack.top->type == SYM_NONTERM && stack.top->next != NULL &&
-            stack.top->next->sym == PS_DOLLAR) {
+        ExprPstackNode *top = expr_Pstack_peek(stack, 0);
+        ExprPstackNode *below = expr_Pstack_peek(stack, 1);
+        if (top->type == SYM_NONTERM && below != NULL &&
+            below->sym == PS_DOLLAR) {
             break;
         }
-        Sym stack_sym = token_to_sym(&stack.top->token);
+        Sym stack_sym = token_to_sym(&top->token);
         Sym current_sym = PS_DOLLAR; // End marker
 
         if (prec_table[stack_sym][current_sym] == '<') {
             // Should not happen
             *rc = SYNTAX_ERROR;
-            expr_Pstack_free(&stack);
+            expr_Pstack_free(stack);
             return NULL;
         } else if (prec_table[stack_sym][current_sym] == '>') {
-            reduce(&stack, rc);
+            reduce(scanner, stack, rc);
             if (*rc != NO_ERROR) {
-                expr_Pstack_free(&stack);
+                expr_Pstack_free(stack);
                 return NULL;
             }
         } else if (prec_table[stack_sym][current_sym] == '=') {
@@ -522,18 +517,307 @@ ASTNode *main_precedence_parser(Token *token, int *rc) {
 
         else {
             *rc = SYNTAX_ERROR;
-            expr_Pstack_free(&stack);
+            expr_Pstack_free(stack);
             return NULL;
         }
     }
-    // Final expression node wrapper
-    // wraps ExprNode into AST_EXPRESSION
-    ExprNode *final_expr = expr_Pstack_top(&stack);
+    ExprNode *final_expr = expr_Pstack_top(stack);
+    expr_Pstack_free(stack);
+    return final_expr;
+}
+
+/**
+ * @brief Wraps an expression tree into an `AST_EXPRESSION` node.
+ */
+static ASTNode *wrap_expression(ExprNode *final_expr) {
+    ASTNode *ast_expr = NULL;
     if (final_expr) {
         ast_expr = create_ast_node(AST_EXPRESSION, NULL);
         ast_expr->expr = final_expr;
     }
-
-    expr_Pstack_free(&stack);
     return ast_expr;
 }
+
+/**
+ * @brief Handles the function call shortcut `ID (` shared by both parsers.
+ * @param scanner Scanner providing the tokens.
+ * @param token Current token; advanced to the ( for a call.
+ * @param rc Pointer to error code.
+ * @param call Output: the `AST_FUNC_CALL` node, NULL if the expression is no
+ * call.
+ * @return false when parsing must stop (error or call found).
+ */
+static bool call_shortcut(Scanner *scanner, Token *token, int *rc,
+                          ASTNode **call) {
+    *call = NULL;
+    if (token->type != TOKEN_IDENTIFIER) {
+        return true;
+    }
+    Token lookahead;
+    *rc = peek_token(scanner, 0, &lookahead);
+    if (*rc != NO_ERROR) {
+        return false;
+    }
+    // Otherwise the identifier is parsed as an ordinary term
+    if (lookahead.type != TOKEN_LPAREN) {
+        return true;
+    }
+    ASTNode *call_node = create_ast_node(AST_FUNC_CALL, token->value.name);
+    if (call_node == NULL) {
+        *rc = ERROR_INTERNAL;
+        return false;
+    }
+    *rc = get_token(scanner, token); // token is now '('
+    if (*rc != NO_ERROR) {
+        return false; // call_node is reclaimed with the AST arena
+    }
+    *call = call_node; // handled in parser - EXPRESSION
+    return false;
+}
+
+/**
+ * @brief Entry point for precedence expression parsing.
+ * @param scanner Scanner providing the tokens.
+ * @param token Pointer to current token; advanced past parsed expression.
+ * @param rc Pointer to error code.
+ * @return `AST_EXPRESSION` wrapping internal expression tree or `AST_FUNC_CALL`
+ * shortcut, or NULL on error. Stack is properly freed on all error paths.
+ * @details
+ * Drives the shift/reduce loop using `prec_table`. Stops on EOL, COMMA, EOF.
+ * After completion, converts final `ExprNode` stack content into an AST node.
+ */
+ASTNode *main_precedence_parser(Scanner *scanner, Token *token, int *rc) {
+    if (*rc != NO_ERROR) {
+        return NULL;
+    }
+    ASTNode *call;
+    if (!call_shortcut(scanner, token, rc, &call)) {
+        return call;
+    }
+    ExprPstack stack;
+    if (expr_Pstack_init(&stack) != NO_ERROR) {
+        *rc = ERROR_INTERNAL;
+        return NULL;
+    }
+    ExprNode *final_expr = shift_reduce(scanner, &stack, token, rc, false);
+    return *rc == NO_ERROR ? wrap_expression(final_expr) : NULL;
+}
+
+/**
+ * @brief Operator waiting for its right operand, or an open parenthesis, in
+ * the precedence climbing parser. The frames of the active calls form the
+ * stack the shift/reduce parser would hold at the same token.
+ */
+typedef struct ClimbFrame {
+    const struct ClimbFrame *outer; ///< enclosing frame, NULL at the top
+    ExprNode *left;                 ///< left operand, NULL for a (
+    Token token;                    ///< the operator or the (
+} ClimbFrame;
+
+/**
+ * @brief State of one precedence climbing run.
+ */
+typedef struct {
+    Scanner *scanner;
+    Token *token;       ///< current token
+    int *rc;            ///< error code
+    unsigned depth;     ///< frames of the active calls
+    bool first;         ///< `token` is the first token of the expression
+    bool handed_off;    ///< the shift/reduce parser finished the expression
+    ExprNode *result;   ///< its result
+} Climber;
+
+/**
+ * @brief Nesting (in frames) beyond which the rest of an expression is left
+ * to the shift/reduce parser, which keeps the C stack bounded.
+ */
+#define CLIMB_MAX_DEPTH 256
+
+static int climb_precedence(Sym sym) {
+    switch (sym) {
+    case PS_MUL:
+    case PS_DIV:
+        return 3;
+    case PS_PLUS:
+    case PS_MINUS:
+        return 2;
+    case PS_LT:
+    case PS_GT:
+    case PS_LTE:
+    case PS_GTE:
+    case PS_IS:
+    case PS_EQ:
+    case PS_NEQ:
+        return 1;
+    default:
+        return 0; // no binary operator
+    }
+}
+
+static bool climb_advance(Climber *climber) {
+    climber->first = false;
+    *climber->rc = get_token(climber->scanner, climber->token);
+    return *climber->rc == NO_ERROR;
+}
+
+static void push_frames(ExprPstack *stack, const ClimbFrame *frame, int *rc) {
+    if (frame == NULL) {
+        return;
+    }
+    push_frames(stack, frame->outer, rc);
+    if (frame->left != NULL &&
+        expr_Pstack_push_nonterm(stack, frame->left) != NO_ERROR) {
+        *rc = ERROR_INTERNAL;
+    }
+    Token token = frame->token;
+    if (expr_Pstack_push_term(stack, &token, token_to_sym(&token)) !=
+        NO_ERROR) {
+        *rc = ERROR_INTERNAL;
+    }
+}
+
+/**
+ * @brief Leaves the rest of the expression to the shift/reduce parser.
+ * @param climber Climbing state; receives the result.
+ * @param frame Innermost frame.
+ * @param operand Operand token just read (a TERM not reduced yet), or NULL.
+ * @param node Parenthesized expression just read, or NULL.
+ * @details The stack of the shift/reduce parser is rebuilt from the frames,
+ * so it goes on exactly as if it had parsed the expression from its start:
+ * malformed expressions fail at the same token and with the same error.
+ */
+static void climb_hand_off(Climber *climber, const ClimbFrame *frame,
+                           const Token *operand, ExprNode *node) {
+    ExprPstack stack;
+    climber->handed_off = true;
+    if (expr_Pstack_init(&stack) != NO_ERROR) {
+        *climber->rc = ERROR_INTERNAL;
+        return;
+    }
+    push_frames(&stack, frame, climber->rc);
+    if (operand != NULL) {
+        Token token = *operand;
+        if (expr_Pstack_push_term(&stack, &token, PS_TERM) != NO_ERROR) {
+            *climber->rc = ERROR_INTERNAL;
+        }
+    } else if (node != NULL &&
+               expr_Pstack_push_nonterm(&stack, node) != NO_ERROR) {
+        *climber->rc = ERROR_INTERNAL;
+    }
+    if (*climber->rc != NO_ERROR) {
+        expr_Pstack_free(&stack);
+        return;
+    }
+    // A token read by a shift that ends the expression is not looked at
+    bool at_end = !climber->first && ends_expression(climber->token);
+    climber->result = shift_reduce(climber->scanner, &stack, climber->token,
+                                   climber->rc, at_end);
+}
+
+static ExprNode *climb(Climber *climber, const ClimbFrame *outer,
+                       int min_precedence);
+
+/**
+ * @brief Checks the token following a complete operand.
+ * @return The operand, or NULL after handing off an operand followed by
+ * another operand or a (.
+ */
+static ExprNode *climb_operand_end(Climber *climber, const ClimbFrame *outer,
+                                   const Token *operand, ExprNode *node) {
+    Sym sym = token_to_sym(climber->token);
+    if (sym == PS_TERM || sym == PS_LPAREN) {
+        climb_hand_off(climber, outer, operand, node);
+        return NULL;
+    }
+    return node;
+}
+
+/**
+ * @brief Parses an operand: a term or a parenthesized expression.
+ */
+static ExprNode *climb_operand(Climber *climber, const ClimbFrame *outer) {
+    Token *token = climber->token;
+    if (token->type == TOKEN_LPAREN && climber->depth < CLIMB_MAX_DEPTH) {
+        ClimbFrame frame = {outer, NULL, *token};
+        if (!climb_advance(climber)) {
+            return NULL;
+        }
+        climber->depth++;
+        ExprNode *inner = climb(climber, &frame, 1);
+        climber->depth--;
+        if (inner == NULL) {
+            return NULL;
+        }
+        // The expression inside ended with EOL, COMMA or EOF
+        if (token->type != TOKEN_RPAREN) {
+            *climber->rc = SYNTAX_ERROR;
+            return NULL;
+        }
+        if (!climb_advance(climber)) {
+            return NULL;
+        }
+        return climb_operand_end(climber, outer, NULL, inner);
+    }
+    ExprNode *node = NULL;
+    if (token_to_sym(token) == PS_TERM) {
+        node = term_node(climber->scanner, token);
+    }
+    if (node == NULL) {
+        // Not an operand (or nesting too deep): malformed or rare input
+        climb_hand_off(climber, outer, NULL, NULL);
+        return NULL;
+    }
+    Token operand = *token;
+    if (!climb_advance(climber)) {
+        return NULL;
+    }
+    return climb_operand_end(climber, outer, &operand, node);
+}
+
+/**
+ * @brief Parses operands joined by operators of at least `min_precedence`.
+ */
+static ExprNode *climb(Climber *climber, const ClimbFrame *outer,
+                       int min_precedence) {
+    ExprNode *left = climb_operand(climber, outer);
+    while (left != NULL) {
+        int precedence = climb_precedence(token_to_sym(climber->token));
+        if (precedence == 0 || precedence < min_precedence) {
+            break;
+        }
+        ClimbFrame frame = {outer, left, *climber->token};
+        BinaryOpType op;
+        token_to_op(&frame.token, &op);
+        if (!climb_advance(climber)) {
+            return NULL;
+        }
+        climber->depth++;
+        ExprNode *right = climb(climber, &frame, precedence + 1);
+        climber->depth--;
+        if (right == NULL) {
+            return NULL;
+        }
+        left = create_binary_op_node(op, left, right);
+        if (left == NULL) {
+            *climber->rc = ERROR_INTERNAL;
+        }
+    }
+    return left;
+}
+
+ASTNode *climbing_expression_parser(Scanner *scanner, Token *token, int *rc) {
+    if (*rc != NO_ERROR) {
+        return NULL;
+    }
+    ASTNode *call;
+    if (!call_shortcut(scanner, token, rc, &call)) {
+        return call;
+    }
+    Climber climber = {
+        .scanner = scanner, .token = token, .rc = rc, .first = true};
+    ExprNode *final_expr = climb(&climber, NULL, 1);
+    if (climber.handed_off) {
+        final_expr = climber.result;
+    }
+    return *rc == NO_ERROR ? wrap_expression(final_expr) : NULL;
+}
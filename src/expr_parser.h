@@ -9,6 +9,11 @@
  * tree (`ExprNode`). It supports binary operators (+,-,*,/,<,>,<=,>=,==,!=,is)
  * grouping with parentheses, literals (numbers, strings, null), identifiers,
  * global variables, and type literals used with the `is` operator.
+ *
+ * Two parsers build identical trees: the operator-precedence (shift/reduce)
+ * parser and a precedence climbing parser that builds the tree in one
+ * recursive-descent pass. Which one the parser uses is selected at run time
+ * (see parser_set_expression_parser).
  */
 #ifndef EXPR_STACK_PRECEDENCE_H
 #define EXPR_STACK_PRECEDENCE_H
@@ -17,12 +22,21 @@
 #include "scanner.h"
 #include <stdbool.h>
 
+/**
+ * @brief Expression parser implementations.
+ */
+typedef enum {
+    EXPR_PARSER_PRECEDENCE, ///< shift/reduce against the precedence table
+    EXPR_PARSER_CLIMBING,   ///< precedence climbing
+} ExprParserKind;
+
 /**
  * @brief Parses an expression using operator precedence parsing.
+ * @param scanner Scanner providing the tokens.
  * @param token Pointer to the current token (the function advances it past the
  * expression).
- * @param rc Pointer to error code; set to SYNTAX_ERROR or ERROR_INTERNAL on
- * failure.
+ * @param rc Pointer to error code; set to SCANNER_ERROR, SYNTAX_ERROR or
+ * ERROR_INTERNAL on failure.
  * @return Pointer to an `AST_EXPRESSION` node wrapping the parsed expression
  * subtree, or a function call node (`AST_FUNC_CALL`) when the first token is an
  * identifier followed immediately by `(`. Returns NULL on error (and sets *rc
@@ -37,5 +51,22 @@
  * the parser returns an `AST_FUNC_CALL` node (argument list parsed by
  * higher-level parser).
  */
-ASTNode *main_precedence_parser(Token *token, int *rc);
+ASTNode *main_precedence_parser(Scanner *scanner, Token *token, int *rc);
+
+/**
+ * @brief Parses an expression by precedence climbing.
+ * @param scanner Scanner providing the tokens.
+ * @param token Pointer to the current token (the function advances it past the
+ * expression).
+ * @param rc Pointer to error code.
+ * @return The same as `main_precedence_parser`, which it matches exactly:
+ * same tree, same error code and the same tokens consumed.
+ * @details
+ * Each operator level is a loop, and only an operator of higher precedence or
+ * a parenthesis recurses, so well-formed expressions are built without a
+ * stack of symbols. Anything else (a malformed expression, or nesting deeper
+ * than a fixed limit) is finished by the shift/reduce parser from the
+ * equivalent stack.
+ */
+ASTNode *climbing_expression_parser(Scanner *scanner, Token *token, int *rc);
 #endif // EXPR_PARSER_H
@@ -0,0 +1,511 @@
+/**
+ * @file expr_pool.c
+ * @author xmikusm00
+ * @brief Compact expression trees (see expr_pool.h).
+ *
+ * Every constant table has an open-addressing index (linear probing,
+ * at most half full) from the value to its position, so adding a constant
+ * that is already there only returns its index.
+ */
+
+#include "expr_pool.h"
+#include "error.h"
+#include "intern.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define EXPR_POOL_INITIAL_CAPACITY 8
+
+/**
+ * @brief The constant tables of a pool.
+ */
+typedef enum {
+    CONST_NUMBER,
+    CONST_STRING,
+    CONST_NAME,
+    CONST_SCOPE,
+} ConstKind;
+
+/**
+ * @brief Makes room for one more entry of `size` bytes in `*array`.
+ */
+static int reserve(void **array, size_t *capacity, size_t count,
+                   size_t size) {
+    if (count < *capacity) {
+        return NO_ERROR;
+    }
+    size_t new_capacity =
+        *capacity ? *capacity * 2 : EXPR_POOL_INITIAL_CAPACITY;
+    void *grown = realloc(*array, new_capacity * size);
+    if (!grown) {
+        return ERROR_INTERNAL;
+    }
+    *array = grown;
+    *capacity = new_capacity;
+    return NO_ERROR;
+}
+
+static uint32_t hash_bytes(const void *data, size_t length) {
+    const unsigned char *bytes = data;
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static uint32_t hash_pointer(const void *pointer) {
+    uint64_t bits = (uint64_t)(uintptr_t)pointer;
+    return (uint32_t)((bits * 0x9E3779B97F4A7C15ull) >> 32);
+}
+
+static ExprConstIndex *index_of(ExprPool *pool, ConstKind kind) {
+    switch (kind) {
+    case CONST_NUMBER:
+        return &pool->number_index;
+    case CONST_STRING:
+        return &pool->string_index;
+    case CONST_NAME:
+        return &pool->name_index;
+    default:
+        return &pool->scope_index;
+    }
+}
+
+/**
+ * @brief Hash of the constant at `position` of a table.
+ */
+static uint32_t hash_at(const ExprPool *pool, ConstKind kind,
+                        uint32_t position) {
+    switch (kind) {
+    case CONST_NUMBER:
+        return hash_bytes(&pool->numbers[position], sizeof(double));
+    case CONST_STRING: {
+        const char *text = pool->chars + pool->strings[position];
+        return hash_bytes(text, strlen(text));
+    }
+    case CONST_NAME:
+        return hash_pointer(pool->names[position]);
+    default:
+        return hash_pointer(pool->scopes[position]);
+    }
+}
+
+/**
+ * @brief Tells whether the constant at `position` is `key`.
+ * @param length Length of a string key.
+ */
+static int equals_at(const ExprPool *pool, ConstKind kind, uint32_t position,
+                     const void *key, size_t length) {
+    switch (kind) {
+    case CONST_NUMBER:
+        return memcmp(&pool->numbers[position], key, sizeof(double)) == 0;
+    case CONST_STRING: {
+        const char *text = pool->chars + pool->strings[position];
+        return strncmp(text, key, length) == 0 && text[length] == '\0';
+    }
+    case CONST_NAME:
+        return pool->names[position] == key;
+    default:
+        return pool->scopes[position] == (const Scope *)key;
+    }
+}
+
+/**
+ * @brief Doubles an index (or creates it) and re-inserts `count` constants.
+ */
+static int grow_index(ExprPool *pool, ConstKind kind, size_t count) {
+    ExprConstIndex *index = index_of(pool, kind);
+    size_t capacity =
+        index->capacity ? index->capacity * 2 : EXPR_POOL_INITIAL_CAPACITY;
+    uint32_t *slots = calloc(capacity, sizeof(uint32_t));
+    if (!slots) {
+        return ERROR_INTERNAL;
+    }
+    for (uint32_t position = 0; position < count; position++) {
+        size_t i = hash_at(pool, kind, position) & (capacity - 1);
+        while (slots[i] != 0) {
+            i = (i + 1) & (capacity - 1);
+        }
+        slots[i] = position + 1;
+    }
+    free(index->slots);
+    index->slots = slots;
+    index->capacity = capacity;
+    return NO_ERROR;
+}
+
+/**
+ * @brief Finds a constant, or the empty slot where it belongs.
+ * @param count Constants in the table.
+ * @param slot Output: its slot.
+ * @return Its position, or -1 when it is not in the table (or on
+ * allocation failure, with `*slot` NULL).
+ */
+static long find_const(ExprPool *pool, ConstKind kind, const void *key,
+                       size_t length, uint32_t hash, size_t count,
+                       uint32_t **slot) {
+    ExprConstIndex *index = index_of(pool, kind);
+    *slot = NULL;
+    if ((count + 1) * 2 > index->capacity &&
+        grow_index(pool, kind, count) != NO_ERROR) {
+        return -1;
+    }
+    size_t mask = index->capacity - 1;
+    size_t i = hash & mask;
+    while (index->slots[i] != 0) {
+        uint32_t position = index->slots[i] - 1;
+        if (equals_at(pool, kind, position, key, length)) {
+            *slot = &index->slots[i];
+            return position;
+        }
+        i = (i + 1) & mask;
+    }
+    *slot = &index->slots[i];
+    return -1;
+}
+
+static long add_number(ExprPool *pool, double value) {
+    uint32_t *slot;
+    long position = find_const(pool, CONST_NUMBER, &value, 0,
+                               hash_bytes(&value, sizeof(double)),
+                               pool->number_count, &slot);
+    if (position >= 0 || slot == NULL) {
+        return position;
+    }
+    if (reserve((void **)&pool->numbers, &pool->number_capacity,
+                pool->number_count, sizeof(double)) != NO_ERROR) {
+        return -1;
+    }
+    pool->numbers[pool->number_count] = value;
+    *slot = (uint32_t)++pool->number_count;
+    return (long)pool->number_count - 1;
+}
+
+static long add_string(ExprPool *pool, const char *value, size_t length) {
+    const char *end = memchr(value, '\0', length);
+    if (end) {
+        length = (size_t)(end - value);
+    }
+    uint32_t *slot;
+    long position =
+        find_const(pool, CONST_STRING, value, length,
+                   hash_bytes(value, length), pool->string_count, &slot);
+    if (position >= 0 || slot == NULL) {
+        return position;
+    }
+    if (reserve((void **)&pool->strings, &pool->string_capacity,
+                pool->string_count, sizeof(uint32_t)) != NO_ERROR) {
+        return -1;
+    }
+    if (pool->char_count + length + 1 > pool->char_capacity) {
+        size_t capacity = pool->char_capacity ? pool->char_capacity
+                                              : EXPR_POOL_INITIAL_CAPACITY;
+        while (capacity < pool->char_count + length + 1) {
+            capacity *= 2;
+        }
+        char *chars = realloc(pool->chars, capacity);
+        if (!chars) {
+            return -1;
+        }
+        pool->chars = chars;
+        pool->char_capacity = capacity;
+    }
+    memcpy(pool->chars + pool->char_count, value, length);
+    pool->chars[pool->char_count + length] = '\0';
+    pool->strings[pool->string_count] = (uint32_t)pool->char_count;
+    pool->char_count += length + 1;
+    *slot = (uint32_t)++pool->string_count;
+    return (long)pool->string_count - 1;
+}
+
+static long add_name(ExprPool *pool, const char *name) {
+    if (name == NULL) {
+        return -1;
+    }
+    uint32_t *slot;
+    long position = find_const(pool, CONST_NAME, name, 0, hash_pointer(name),
+                               pool->name_count, &slot);
+    if (position >= 0 || slot == NULL) {
+        return position;
+    }
+    if (reserve((void **)&pool->names, &pool->name_capacity, pool->name_count,
+                sizeof(const char *)) != NO_ERROR) {
+        return -1;
+    }
+    pool->names[pool->name_count] = name;
+    *slot = (uint32_t)++pool->name_count;
+    return (long)pool->name_count - 1;
+}
+
+static long add_scope(ExprPool *pool, Scope *scope) {
+    uint32_t *slot;
+    long position = find_const(pool, CONST_SCOPE, scope, 0,
+                               hash_pointer(scope), pool->scope_count, &slot);
+    if (position >= 0 || slot == NULL) {
+        return position;
+    }
+    if (reserve((void **)&pool->scopes, &pool->scope_capacity,
+                pool->scope_count, sizeof(Scope *)) != NO_ERROR) {
+        return -1;
+    }
+    pool->scopes[pool->scope_count] = scope;
+    *slot = (uint32_t)++pool->scope_count;
+    return (long)pool->scope_count - 1;
+}
+
+/**
+ * @brief Appends a node.
+ * @param first Operand or constant position; -1 means a failed constant.
+ */
+static ExprId add_node(ExprPool *pool, ExprNodeType kind, BinaryOpType op,
+                       long first, ExprId second) {
+    if (first < 0 || pool->count >= UINT32_MAX) {
+        return EXPR_NONE;
+    }
+    if (pool->count == 0) {
+        pool->count = 1; // EXPR_NONE
+    }
+    if (reserve((void **)&pool->nodes, &pool->capacity, pool->count,
+                sizeof(CompactExpr)) != NO_ERROR) {
+        return EXPR_NONE;
+    }
+    ExprId id = (ExprId)pool->count++;
+    pool->nodes[id] = (CompactExpr){
+        .tag = (uint32_t)kind | (uint32_t)op << 8,
+        .first = (uint32_t)first,
+        .second = second,
+        .scope = 0,
+    };
+    return id;
+}
+
+ExprId expr_pool_num_literal(ExprPool *pool, double value) {
+    return add_node(pool, EXPR_NUM_LITERAL, 0, add_number(pool, value),
+                    EXPR_NONE);
+}
+
+ExprId expr_pool_string_literal(ExprPool *pool, const char *value) {
+    return expr_pool_string_literal_n(pool, value, strlen(value));
+}
+
+ExprId expr_pool_string_literal_n(ExprPool *pool, const char *value,
+                                  size_t length) {
+    return add_node(pool, EXPR_STRING_LITERAL, 0,
+                    add_string(pool, value, length), EXPR_NONE);
+}
+
+ExprId expr_pool_null_literal(ExprPool *pool) {
+    return add_node(pool, EXPR_NULL_LITERAL, 0, 0, EXPR_NONE);
+}
+
+ExprId expr_pool_type(ExprPool *pool, const char *name) {
+    return add_node(pool, EXPR_TYPE_LITERAL, 0, add_name(pool, intern(name)),
+                    EXPR_NONE);
+}
+
+ExprId expr_pool_identifier(ExprPool *pool, const char *name) {
+    return expr_pool_identifier_n(pool, name, strlen(name));
+}
+
+ExprId expr_pool_identifier_n(ExprPool *pool, const char *name,
+                              size_t length) {
+    return add_node(pool, EXPR_IDENTIFIER, 0,
+                    add_name(pool, intern_n(name, length)), EXPR_NONE);
+}
+
+ExprId expr_pool_getter_call(ExprPool *pool, const char *name) {
+    return add_node(pool, EXPR_GETTER_CALL, 0, add_name(pool, intern(name)),
+                    EXPR_NONE);
+}
+
+ExprId expr_pool_binary_op(ExprPool *pool, BinaryOpType op, ExprId left,
+                           ExprId right) {
+    if (left == EXPR_NONE || right == EXPR_NONE) {
+        return EXPR_NONE;
+    }
+    return add_node(pool, EXPR_BINARY_OP, op, left, right);
+}
+
+int expr_pool_set_scope(ExprPool *pool, ExprId id, Scope *scope) {
+    if (scope == NULL) {
+        pool->nodes[id].scope = 0;
+        return NO_ERROR;
+    }
+    long position = add_scope(pool, scope);
+    if (position < 0) {
+        return ERROR_INTERNAL;
+    }
+    pool->nodes[id].scope = (uint32_t)position + 1;
+    return NO_ERROR;
+}
+
+/**
+ * @brief Growing array of pointers or ids for the conversions.
+ */
+typedef struct {
+    uintptr_t *items;
+    size_t count;
+    size_t capacity;
+} WorkList;
+
+static int work_push(WorkList *list, uintptr_t item) {
+    if (reserve((void **)&list->items, &list->capacity, list->count,
+                sizeof(uintptr_t)) != NO_ERROR) {
+        return ERROR_INTERNAL;
+    }
+    list->items[list->count++] = item;
+    return NO_ERROR;
+}
+
+/*
+ * Both conversions list the nodes in preorder (node, left subtree, right
+ * subtree) and build them in the reverse order: every operand is built
+ * before its operator, and when an operator is reached the results of its
+ * left and right operands are the two topmost on the result stack.
+ */
+
+ExprId expr_pool_add_tree(ExprPool *pool, const ExprNode *tree) {
+    WorkList pending = {0}, order = {0}, results = {0};
+    ExprId root = EXPR_NONE;
+    int rc = tree ? work_push(&pending, (uintptr_t)tree) : ERROR_INTERNAL;
+    while (rc == NO_ERROR && pending.count > 0) {
+        const ExprNode *node = (const ExprNode *)pending.items[--pending.count];
+        rc = work_push(&order, (uintptr_t)node);
+        if (rc == NO_ERROR && node->type == EXPR_BINARY_OP) {
+            if (!node->data.binary.left || !node->data.binary.right) {
+                rc = ERROR_INTERNAL;
+                break;
+            }
+            rc = work_push(&pending, (uintptr_t)node->data.binary.right);
+            if (rc == NO_ERROR) {
+                rc = work_push(&pending, (uintptr_t)node->data.binary.left);
+            }
+        }
+    }
+    for (size_t i = order.count; rc == NO_ERROR && i > 0; i--) {
+        const ExprNode *node = (const ExprNode *)order.items[i - 1];
+        ExprId id = EXPR_NONE;
+        switch (node->type) {
+        case EXPR_NUM_LITERAL:
+            id = expr_pool_num_literal(pool, node->data.num_literal);
+            break;
+        case EXPR_STRING_LITERAL:
+            id = expr_pool_string_literal(pool, node->data.string_literal);
+            break;
+        case EXPR_NULL_LITERAL:
+            id = expr_pool_null_literal(pool);
+            break;
+        case EXPR_TYPE_LITERAL:
+        case EXPR_IDENTIFIER:
+        case EXPR_GETTER_CALL:
+            // Names are interned already
+            id = add_node(pool, node->type, 0,
+                          add_name(pool, node->data.identifier_name),
+                          EXPR_NONE);
+            if (id != EXPR_NONE && node->type != EXPR_TYPE_LITERAL &&
+                expr_pool_set_scope(pool, id, node->current_scope) !=
+                    NO_ERROR) {
+                id = EXPR_NONE;
+            }
+            break;
+        case EXPR_BINARY_OP: {
+            ExprId left = (ExprId)results.items[--results.count];
+            ExprId right = (ExprId)results.items[--results.count];
+            id = expr_pool_binary_op(pool, node->data.binary.op, left, right);
+            break;
+        }
+        }
+        rc = id == EXPR_NONE ? ERROR_INTERNAL : work_push(&results, id);
+    }
+    if (rc == NO_ERROR && results.count == 1) {
+        root = (ExprId)results.items[0];
+    }
+    free(pending.items);
+    free(order.items);
+    free(results.items);
+    return root;
+}
+
+ExprNode *expr_pool_to_tree(const ExprPool *pool, ExprId id) {
+    WorkList pending = {0}, order = {0}, results = {0};
+    ExprNode *root = NULL;
+    int rc = id != EXPR_NONE ? work_push(&pending, id) : ERROR_INTERNAL;
+    while (rc == NO_ERROR && pending.count > 0) {
+        ExprId node = (ExprId)pending.items[--pending.count];
+        rc = work_push(&order, node);
+        if (rc == NO_ERROR && expr_pool_kind(pool, node) == EXPR_BINARY_OP) {
+            rc = work_push(&pending, expr_pool_right(pool, node));
+            if (rc == NO_ERROR) {
+                rc = work_push(&pending, expr_pool_left(pool, node));
+            }
+        }
+    }
+    for (size_t i = order.count; rc == NO_ERROR && i > 0; i--) {
+        ExprId node = (ExprId)order.items[i - 1];
+        ExprNode *tree = NULL;
+        switch (expr_pool_kind(pool, node)) {
+        case EXPR_NUM_LITERAL:
+            tree = create_num_literal_node(expr_pool_number(pool, node));
+            break;
+        case EXPR_STRING_LITERAL:
+            tree = create_string_literal_node(expr_pool_string(pool, node));
+            break;
+        case EXPR_NULL_LITERAL:
+            tree = create_null_literal_node();
+            break;
+        case EXPR_TYPE_LITERAL:
+            tree = create_type_node(expr_pool_name(pool, node));
+            break;
+        case EXPR_IDENTIFIER:
+            tree = create_identifier_node(expr_pool_name(pool, node));
+            break;
+        case EXPR_GETTER_CALL:
+            tree = create_getter_call_node(expr_pool_name(pool, node));
+            break;
+        case EXPR_BINARY_OP: {
+            ExprNode *left = (ExprNode *)results.items[--results.count];
+            ExprNode *right = (ExprNode *)results.items[--results.count];
+            tree = create_binary_op_node(expr_pool_op(pool, node), left, right);
+            break;
+        }
+        }
+        if (tree) {
+            tree->current_scope = expr_pool_scope(pool, node);
+        }
+        rc = tree ? work_push(&results, (uintptr_t)tree) : ERROR_INTERNAL;
+    }
+    if (rc == NO_ERROR && results.count == 1) {
+        root = (ExprNode *)results.items[0];
+    }
+    free(pending.items);
+    free(order.items);
+    free(results.items);
+    return root;
+}
+
+void expr_pool_free(ExprPool *pool) {
+    free(pool->nodes);
+    free(pool->numbers);
+    free(pool->number_index.slots);
+    free(pool->strings);
+    free(pool->string_index.slots);
+    free(pool->chars);
+    free(pool->names);
+    free(pool->name_index.slots);
+    free(pool->scopes);
+    free(pool->scope_index.slots);
+    memset(pool, 0, sizeof(*pool));
+}
+
+size_t expr_pool_bytes(const ExprPool *pool) {
+    return pool->capacity * sizeof(CompactExpr) +
+           pool->number_capacity * sizeof(double) +
+           pool->string_capacity * sizeof(uint32_t) + pool->char_capacity +
+           pool->name_capacity * sizeof(const char *) +
+           pool->scope_capacity * sizeof(Scope *) +
+           (pool->number_index.capacity + pool->string_index.capacity +
+            pool->name_index.capacity + pool->scope_index.capacity) *
+               sizeof(uint32_t);
+}
@@ -0,0 +1,219 @@
+/**
+ * @file expr_pool.h
+ * @author xmikusm00
+ * @brief Compact expression trees: 16-byte nodes addressed by 32-bit ids.
+ *
+ * An ExprPool holds the expressions of one function. Its nodes carry the
+ * kind and operator in one word and refer to their operands by id, and to
+ * numbers, strings, names and scopes by index into constant tables in
+ * which every value is stored once: `x + 1` written a hundred times keeps
+ * one copy of 1 and of the name x. The builders mirror the create_*_node
+ * functions of expr_ast.h, with the pool as first argument and ExprId in
+ * place of ExprNode *, and expr_pool_add_tree / expr_pool_to_tree convert
+ * from and to the pointer form, so the parser, semantic analysis and the
+ * generator can move over one at a time. None of them has yet, so the pool
+ * is linked only into test_expr_pool, not into the compiler.
+ *
+ * Fields by kind:
+ * - EXPR_NUM_LITERAL: `first` indexes `numbers`
+ * - EXPR_STRING_LITERAL: `first` indexes `strings`
+ * - EXPR_IDENTIFIER, EXPR_GETTER_CALL, EXPR_TYPE_LITERAL: `first` indexes
+ *   `names` (interned)
+ * - EXPR_BINARY_OP: `first` and `second` are the operands
+ * - `scope`: 1 + index into `scopes`, 0 for none
+ */
+
+#ifndef EXPR_POOL_H
+#define EXPR_POOL_H
+
+#include "expr_ast.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/// Id of a node in an ExprPool
+typedef uint32_t ExprId;
+
+/// No node (id 0 is never used); also what the builders return on failure
+#define EXPR_NONE 0
+
+/**
+ * @brief One expression node.
+ */
+typedef struct {
+    uint32_t tag;    ///< ExprNodeType in bits 0-7, BinaryOpType in bits 8-15
+    uint32_t first;  ///< left operand or constant index
+    uint32_t second; ///< right operand
+    uint32_t scope;  ///< 1 + index into the scopes, 0 for none
+} CompactExpr;
+
+_Static_assert(sizeof(CompactExpr) == 16, "CompactExpr must stay 16 bytes");
+
+/**
+ * @brief Hash index over one constant table; slots hold 1 + index.
+ */
+typedef struct {
+    uint32_t *slots;
+    size_t capacity; ///< power of two, or 0
+} ExprConstIndex;
+
+/**
+ * @brief Expression nodes and constants of one function.
+ *
+ * A zero-initialized ExprPool is empty and ready to use.
+ */
+typedef struct {
+    CompactExpr *nodes; ///< nodes by id, entry 0 unused
+    size_t count;       ///< ids in use, EXPR_NONE included
+    size_t capacity;    ///< allocated entries of `nodes`
+
+    double *numbers;        ///< distinct numbers (by bit pattern)
+    size_t number_count;
+    size_t number_capacity;
+    ExprConstIndex number_index;
+
+    uint32_t *strings;      ///< offsets of distinct strings into `chars`
+    size_t string_count;
+    size_t string_capacity;
+    ExprConstIndex string_index;
+    char *chars;            ///< the strings, each NUL-terminated
+    size_t char_count;
+    size_t char_capacity;
+
+    const char **names;     ///< distinct interned names
+    size_t name_count;
+    size_t name_capacity;
+    ExprConstIndex name_index;
+
+    Scope **scopes;         ///< distinct scopes
+    size_t scope_count;
+    size_t scope_capacity;
+    ExprConstIndex scope_index;
+} ExprPool;
+
+/**
+ * @brief Frees everything the pool holds and leaves it empty.
+ */
+void expr_pool_free(ExprPool *pool);
+
+/**
+ * @brief Bytes held by the pool (allocated capacity).
+ */
+size_t expr_pool_bytes(const ExprPool *pool);
+
+/**
+ * @brief Creates a numeric literal node
+ * @return Its id, or EXPR_NONE on allocation failure
+ */
+ExprId expr_pool_num_literal(ExprPool *pool, double value);
+
+/**
+ * @brief Creates a string literal node; the value is pooled
+ * @return Its id, or EXPR_NONE on allocation failure
+ */
+ExprId expr_pool_string_literal(ExprPool *pool, const char *value);
+
+/**
+ * @brief Creates a string literal node from a character slice
+ * @param length Number of characters to copy (stops early at a NUL)
+ * @return Its id, or EXPR_NONE on allocation failure
+ */
+ExprId expr_pool_string_literal_n(ExprPool *pool, const char *value,
+                                  size_t length);
+
+/**
+ * @brief Creates a null literal node
+ * @return Its id, or EXPR_NONE on allocation failure
+ */
+ExprId expr_pool_null_literal(ExprPool *pool);
+
+/**
+ * @brief Creates a type literal node; the name is interned
+ * @return Its id, or EXPR_NONE on allocation failure
+ */
+ExprId expr_pool_type(ExprPool *pool, const char *name);
+
+/**
+ * @brief Creates an identifier node; the name is interned
+ * @return Its id, or EXPR_NONE on allocation failure
+ */
+ExprId expr_pool_identifier(ExprPool *pool, const char *name);
+
+/**
+ * @brief Creates an identifier node from a character slice
+ * @return Its id, or EXPR_NONE on allocation failure
+ */
+ExprId expr_pool_identifier_n(ExprPool *pool, const char *name,
+                              size_t length);
+
+/**
+ * @brief Creates a getter call node; the name is interned
+ * @return Its id, or EXPR_NONE on allocation failure
+ */
+ExprId expr_pool_getter_call(ExprPool *pool, const char *name);
+
+/**
+ * @brief Creates a binary operation node
+ * @param left, right Operands, nodes of the same pool
+ * @return Its id, or EXPR_NONE on allocation failure
+ */
+ExprId expr_pool_binary_op(ExprPool *pool, BinaryOpType op, ExprId left,
+                           ExprId right);
+
+/**
+ * @brief Sets the scope of an identifier or getter call node
+ * @return NO_ERROR, or ERROR_INTERNAL on allocation failure
+ */
+int expr_pool_set_scope(ExprPool *pool, ExprId id, Scope *scope);
+
+/**
+ * @brief Copies a pointer expression tree into the pool, scopes included
+ * @return Id of its root, or EXPR_NONE for a NULL tree or on allocation
+ * failure
+ * @details Uses no recursion, whatever the depth of the tree.
+ */
+ExprId expr_pool_add_tree(ExprPool *pool, const ExprNode *tree);
+
+/**
+ * @brief Builds the pointer form of a node with the create_*_node
+ * functions (in ARENA_PARSE)
+ * @return The tree, or NULL for EXPR_NONE or on allocation failure
+ */
+ExprNode *expr_pool_to_tree(const ExprPool *pool, ExprId id);
+
+static inline ExprNodeType expr_pool_kind(const ExprPool *pool, ExprId id) {
+    return (ExprNodeType)(pool->nodes[id].tag & 0xff);
+}
+
+static inline BinaryOpType expr_pool_op(const ExprPool *pool, ExprId id) {
+    return (BinaryOpType)(pool->nodes[id].tag >> 8 & 0xff);
+}
+
+static inline ExprId expr_pool_left(const ExprPool *pool, ExprId id) {
+    return pool->nodes[id].first;
+}
+
+static inline ExprId expr_pool_right(const ExprPool *pool, ExprId id) {
+    return pool->nodes[id].second;
+}
+
+static inline double expr_pool_number(const ExprPool *pool, ExprId id) {
+    return pool->numbers[pool->nodes[id].first];
+}
+
+static inline const char *expr_pool_string(const ExprPool *pool, ExprId id) {
+    return pool->chars + pool->strings[pool->nodes[id].first];
+}
+
+/**
+ * @brief Interned name of an identifier, getter call or type literal
+ */
+static inline const char *expr_pool_name(const ExprPool *pool, ExprId id) {
+    return pool->names[pool->nodes[id].first];
+}
+
+static inline Scope *expr_pool_scope(const ExprPool *pool, ExprId id) {
+    uint32_t scope = pool->nodes[id].scope;
+    return scope ? pool->scopes[scope - 1] : NULL;
+}
+
+#endif // EXPR_POOL_H
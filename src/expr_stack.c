@@ -1,11 +1,12 @@
-
 /**
  * @file expr_stack.c
  * @author xmikusm00
  * @brief Stack implementation for expression precedence parser
  * @details Implements a stack data structure used during precedence analysis
  *          of expressions. The stack stores both terminals (tokens) and non-terminals
- *          (AST nodes) during the bottom-up parsing process.
+ *          (AST nodes) during the bottom-up parsing process. The entries live
+ *          in a growable array that starts inside the stack structure, so
+ *          only unusually deep expressions allocate.
  */
 #include "expr_stack.h"
 #include "error.h"
@@ -16,36 +17,65 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 /**
- * @brief Initializes an empty expression precedence stack.
- * @param s Pointer to the stack to initialize.
+ * @brief Makes room for one more entry, moving the stack to the heap or
+ * doubling it when it is full.
+ * @return NO_ERROR or ERROR_INTERNAL on allocation failure.
  */
-void expr_Pstack_init(ExprPstack *s) {
-    ExprPstackNode *bottom = (ExprPstackNode *)malloc(sizeof(ExprPstackNode));
-    if (!bottom) {
-        fprintf(stderr, "Memory allocation error in expr_Pstack_init\n");
-        exit(ERROR_INTERNAL);
+static int reserve_entry(ExprPstack *stack) {
+    if (stack->count < stack->capacity) {
+        return NO_ERROR;
     }
-    bottom->next = NULL;
+    size_t capacity = stack->capacity * 2;
+    ExprPstackNode *items;
+    if (stack->items == stack->inline_items) {
+        items = malloc(capacity * sizeof(ExprPstackNode));
+        if (items != NULL) {
+            memcpy(items, stack->items, stack->count * sizeof(ExprPstackNode));
+        }
+    } else {
+        items = realloc(stack->items, capacity * sizeof(ExprPstackNode));
+    }
+    if (items == NULL) {
+        return ERROR_INTERNAL;
+    }
+    stack->items = items;
+    stack->capacity = capacity;
+    return NO_ERROR;
+}
+
+/**
+ * @brief Initializes an expression precedence stack holding the bottom marker.
+ * @param s Pointer to the stack to initialize.
+ * @return NO_ERROR (the bottom marker is stored inline).
+ */
+int expr_Pstack_init(ExprPstack *s) {
+    s->items = s->inline_items;
+    s->capacity = EXPR_PSTACK_INLINE_SIZE;
+    s->count = 1;
+    s->top_term = 1;
+    ExprPstackNode *bottom = &s->items[0];
     bottom->type = SYM_TERM;
     bottom->sym = PS_DOLLAR;
     bottom->token.type = TOKEN_DOLLAR;
-    s->top = bottom;
+    bottom->node = NULL;
+    bottom->below = 0;
+    return NO_ERROR;
 }
 /**
- * @brief Frees all nodes in the expression precedence stack.
+ * @brief Frees the entries of the expression precedence stack.
  * @param stack Pointer to the stack to free.
  */
 void expr_Pstack_free(ExprPstack *stack) {
-    ExprPstackNode *current = stack->top;
-    ExprPstackNode *temp;
-    while (current != NULL) {
-        temp = current;
-        current = current->next;
-        free(temp);
+    if (stack->items != stack->inline_items) {
+        free(stack->items);
     }
-    stack->top = NULL;
+    stack->items = stack->inline_items;
+    stack->capacity = EXPR_PSTACK_INLINE_SIZE;
+    stack->count = 0;
+    stack->top_term = 0;
 }
 /**
  * @brief Pushes a terminal symbol onto the expression precedence stack.
@@ -55,15 +85,16 @@ void expr_Pstack_free(ExprPstack *stack) {
  * @return int NO_ERROR on success, ERROR_INTERNAL on allocation failure.
  */
 int expr_Pstack_push_term(ExprPstack *stack, Token *token, Sym sym) {
-    ExprPstackNode *new_node = (ExprPstackNode *)malloc(sizeof(ExprPstackNode));
-    if (!new_node) {
+    if (reserve_entry(stack) != NO_ERROR) {
         return ERROR_INTERNAL;
     }
+    ExprPstackNode *new_node = &stack->items[stack->count++];
     new_node->token = *token;
     new_node->type = SYM_TERM;
     new_node->sym = sym;
-    new_node->next = stack->top;
-    stack->top = new_node;
+    new_node->node = NULL;
+    new_node->below = stack->top_term;
+    stack->top_term = stack->count;
     return NO_ERROR;
 }
 /**
@@ -74,27 +105,26 @@ int expr_Pstack_push_term(ExprPstack *stack, Token *token, Sym sym) {
  * @return int NO_ERROR on success, ERROR_INTERNAL on allocation failure.
  */
 int expr_Pstack_push_nonterm(ExprPstack *stack, ExprNode *node) {
-    ExprPstackNode *new_node = (ExprPstackNode *)malloc(sizeof(ExprPstackNode));
-    if (!new_node) {
+    if (reserve_entry(stack) != NO_ERROR) {
         return ERROR_INTERNAL;
     }
+    ExprPstackNode *new_node = &stack->items[stack->count++];
     new_node->node = node;
     new_node->type = SYM_NONTERM;
     new_node->sym = PS_TERM;
     new_node->token.type = TOKEN_UNDEFINED;
-    new_node->next = stack->top;
-    stack->top = new_node;
     return NO_ERROR;
 }
 /**
- * @brief Pops the top node from the expression precedence stack.
+ * @brief Pops the top entry from the expression precedence stack.
  * @param stack Pointer to the stack.
-     */
+ */
 void expr_Pstack_pop(ExprPstack *stack) {
-    if (stack->top != NULL) {
-        ExprPstackNode *temp = stack->top;
-        stack->top = stack->top->next;
-        free(temp);
+    if (stack->count > 0) {
+        ExprPstackNode *top = &stack->items[--stack->count];
+        if (top->type == SYM_TERM) {
+            stack->top_term = top->below;
+        }
     }
 }
 
@@ -105,11 +135,13 @@ void expr_Pstack_pop(ExprPstack *stack) {
  * @warning Does not check if the top element is actually a non-terminal.
  *          Caller must ensure the top contains a valid expression node.
  */
-ExprNode *expr_Pstack_top(ExprPstack *stack) { return (stack->top->node); }
+ExprNode *expr_Pstack_top(ExprPstack *stack) {
+    return stack->items[stack->count - 1].node;
+}
 
 /**
  * @brief Checks if the stack is empty
  * @param stack Pointer to the stack
  * @return true if the stack is empty, false otherwise
  */
-bool expr_Pstack_is_empty(ExprPstack *stack) { return (stack->top == NULL); }
+bool expr_Pstack_is_empty(ExprPstack *stack) { return (stack->count == 0); }
@@ -54,10 +54,16 @@ typedef enum {
     SYM_NONTERM, /**< Non-terminal symbol (reduced AST node) */
 } SymType;
 
+/**
+ * @brief Number of stack entries kept inside the ExprPstack itself; deeper
+ * expressions move the stack to the heap.
+ */
+#define EXPR_PSTACK_INLINE_SIZE 32
+
 /**
  * @struct ExprPstackNode
- * @brief Node in the expression precedence stack
- * @details Each node can hold either a terminal (token) or non-terminal (AST
+ * @brief Entry of the expression precedence stack
+ * @details Each entry can hold either a terminal (token) or non-terminal (AST
  * node)
  */
 typedef struct ExprPstackNode {
@@ -65,24 +71,54 @@ typedef struct ExprPstackNode {
     Sym sym;        /**< Precedence symbol type */
     Token token;    /**< Token data (for terminals) */
     ExprNode *node; /**< AST node pointer (for non-terminals) */
-    struct ExprPstackNode *next; /**< Pointer to next node in stack */
+    size_t below;   /**< Topmost terminal under this one (for terminals) */
 } ExprPstackNode;
 
 /**
  * @struct ExprPstack
  * @brief Expression precedence stack
  * @details Stack structure used during bottom-up precedence parsing of
- * expressions
+ * expressions. The entries form a growable array that starts in `inline_items`,
+ * so pushes and pops of a typical expression never allocate. The position of
+ * the topmost terminal is kept up to date, which makes the precedence lookup
+ * O(1). The stack must not be copied once initialized.
  */
 typedef struct ExprPstack {
-    ExprPstackNode *top; /**< Pointer to the top of the stack */
+    ExprPstackNode *items; /**< Entries, bottom first */
+    size_t count;          /**< Number of entries */
+    size_t capacity;       /**< Allocated entries */
+    size_t top_term;       /**< 1 + index of the topmost terminal, 0 if none */
+    ExprPstackNode inline_items[EXPR_PSTACK_INLINE_SIZE];
 } ExprPstack;
 
+/**
+ * @brief Returns the entry `depth` positions below the top of the stack
+ * @param stack Pointer to the stack
+ * @param depth 0 for the top entry
+ * @return Pointer to the entry (valid until the next push), or NULL
+ */
+static inline ExprPstackNode *expr_Pstack_peek(ExprPstack *stack,
+                                               size_t depth) {
+    return depth < stack->count ? &stack->items[stack->count - 1 - depth]
+                                : NULL;
+}
+
+/**
+ * @brief Returns the topmost terminal of the stack
+ * @param stack Pointer to the stack
+ * @return Pointer to the entry (valid until the next push), or NULL
+ */
+static inline ExprPstackNode *expr_Pstack_top_term(ExprPstack *stack) {
+    return stack->top_term ? &stack->items[stack->top_term - 1] : NULL;
+}
+
 /**
  * @brief Initializes the expression precedence stack
  * @param stack Pointer to the stack to initialize
+ * @return NO_ERROR (the stack starts with the bottom marker and needs no
+ * allocation)
  */
-void expr_Pstack_init(ExprPstack *stack);
+int expr_Pstack_init(ExprPstack *stack);
 
 /**
  * @brief Frees all memory allocated for the stack
@@ -5,101 +5,146 @@
  */
 
 #include "generator.h"
+#include "arena.h"
+#include "ast_walk.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
 
-bool in_main = false;
+_Thread_local bool in_main = false;
 
 
 
-void print_convert_string(const char* input , FILE *output) {
-    // Convert string to IFJcode25 format (section 10.3)
-    // Escape sequences: \XXX (3-digit decimal ASCII)
-    // Must escape: ASCII <= 32, #(35), \(92)
-    for (int i = 0; input[i] != '\0'; i++)
+// How print_convert_string treats each byte (IFJcode25 section 10.3)
+enum {
+    ESCAPE_NONE = 0,  // printable, copied as is
+    ESCAPE_CODE = 1,  // written as \XXX (ASCII <= 32 and #)
+    ESCAPE_SOURCE = 2 // backslash, starts a source escape sequence
+};
+
+static const unsigned char escape_class[256] = {
+    // 0..32: control characters and space
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    ['#'] = ESCAPE_CODE,
+    ['\\'] = ESCAPE_SOURCE,
+};
+
+// Append \XXX (3-digit decimal code of c)
+static inline char *put_code(char *out, unsigned char c) {
+    out[0] = '\\';
+    out[1] = (char)('0' + c / 100);
+    out[2] = (char)('0' + c / 10 % 10);
+    out[3] = (char)('0' + c % 10);
+    return out + 4;
+}
+
+// Input bytes print_convert_string escapes at a time
+#define CONVERT_CHUNK 256
+
+// An escape sequence started before the end of a chunk takes at most 3
+// more input bytes (\xHH); each input byte expands to at most 4 bytes
+#define CONVERT_BUFFER_SIZE (4 * (CONVERT_CHUNK + 3))
+
+/**
+ * @brief Escape the string from `*position` into `out`, stopping at the
+ * first sequence boundary at or after `limit`; return the end of the
+ * written text and advance `*position` past the escaped input.
+ * @details `out` must hold 4 bytes per input byte escaped, that is
+ * 4 * (limit - *position + 3).
+ */
+static char *convert_string(const char *input, size_t length,
+                            size_t *position, size_t limit, char *out) {
+    size_t i = *position;
+    while (i < limit)
     {
-        unsigned char c = (unsigned char)input[i];
-        
-        // Check if escape sequence in source
-        if (input[i] == '\\' && input[i+1] != '\0')
-        {
-            i++;
-            switch (input[i])
-            {
-                case 'n':  // newline
-                    fprintf(output, "\\010");
-                    break;
-                case 't':  // tab
-                    fprintf(output, "\\009");
-                    break;
-                case 's':  // space
-                    fprintf(output, "\\032");
-                    break;
-                case '\\': // backslash
-                    fprintf(output, "\\092");
-                    break;
-                case '"':  // quote
-                    fprintf(output, "\\034");
-                    break;
-                case 'x':  // hex escape \xHH
-                    if (input[i+1] != '\0' && input[i+2] != '\0') {
-                        char hex[3] = {input[i+1], input[i+2], '\0'};
-                        long decimal = strtol(hex, NULL, 16);
-                        fprintf(output, "\\%03ld", decimal);
-                        i += 2;
-                    } else {
-                        fprintf(output, "\\%03d", (int)input[i]);
-                    }
-                    break;
-                default:
-                    // Unknown escape, output the backslash and character
-                    fprintf(output, "\\092");
-                    fprintf(output, "\\%03d", (unsigned char)input[i]);
-                    break;
-            }
-        }
-        // Escape characters per IFJcode25 section 10.3
-        else if (c <= 32)  // Control chars and space
-        {
-            fprintf(output, "\\%03d", c);
+        // Copy the whole run of characters that need no escaping
+        size_t run = i;
+        while (run < limit && escape_class[(unsigned char)input[run]] == ESCAPE_NONE) {
+            run++;
         }
-        else if (c == 35)  // # must be escaped
-        {
-            fprintf(output, "\\035");
+        memcpy(out, input + i, run - i);
+        out += run - i;
+        i = run;
+        if (i == limit) {
+            break;
         }
-        else if (c == 92)  // \ must be escaped
-        {
-            fprintf(output, "\\092");
+
+        unsigned char c = (unsigned char)input[i];
+        if (escape_class[c] == ESCAPE_CODE || i + 1 == length) {
+            out = put_code(out, c); // also a backslash at the very end
+            i++;
+            continue;
         }
-        else  // Regular printable characters
+
+        // Escape sequence in source
+        i++;
+        switch (input[i])
         {
-            fprintf(output, "%c", c);
+            case 'n':  // newline
+                out = put_code(out, 10);
+                break;
+            case 't':  // tab
+                out = put_code(out, 9);
+                break;
+            case 's':  // space
+                out = put_code(out, 32);
+                break;
+            case '\\': // backslash
+                out = put_code(out, 92);
+                break;
+            case '"':  // quote
+                out = put_code(out, 34);
+                break;
+            case 'x':  // hex escape \xHH
+                if (i + 2 < length) {
+                    char hex[3] = {input[i+1], input[i+2], '\0'};
+                    long decimal = strtol(hex, NULL, 16);
+                    out += sprintf(out, "\\%03ld", decimal);
+                    i += 2;
+                } else {
+                    out = put_code(out, 'x');
+                }
+                break;
+            default:
+                // Unknown escape, output the backslash and character
+                out = put_code(out, 92);
+                out = put_code(out, (unsigned char)input[i]);
+                break;
         }
+        i++;
     }
+    *position = i;
+    return out;
 }
 
-// Code generation helper functions
-
-int get_scope_number(ASTNode *node) {
-    int scope_number = 0;
-    Scope *current_scope = node->current_scope;
-    while (current_scope) {
-        scope_number++;
-        current_scope = current_scope->parent;
+void print_convert_string(const char* input , FILE *output) {
+    // Convert string to IFJcode25 format (section 10.3)
+    // Escape sequences: \XXX (3-digit decimal ASCII)
+    // Must escape: ASCII <= 32, #(35), \(92)
+    // Streamed through a fixed buffer, chunk by chunk
+    char buffer[CONVERT_BUFFER_SIZE];
+    size_t length = strlen(input);
+    size_t position = 0;
+    while (position < length) {
+        size_t limit = length - position > CONVERT_CHUNK ? position + CONVERT_CHUNK : length;
+        char *end = convert_string(input, length, &position, limit, buffer);
+        fwrite(buffer, 1, (size_t)(end - buffer), output);
     }
-    return scope_number;
 }
 
+// Code generation helper functions
+
+// Semantic analysis stores the scope each identifier resolved to, which
+// knows its depth: no walk up the scope chain per emitted reference
+
 int get_scope_number_from_scope(Scope *scope) {
-    int scope_number = 0;
-    Scope *current_scope = scope;
-    while (current_scope) {
-        scope_number++;
-        current_scope = current_scope->parent;
-    }
-    return scope_number;
+    return scope ? (int)scope->depth : 0;
+}
+
+int get_scope_number(ASTNode *node) {
+    return get_scope_number_from_scope(node->current_scope);
 }
 
 int identifier (ASTNode *node, FILE *output) {
@@ -183,18 +228,14 @@ int assign (ASTNode *node, FILE *output) {
     fprintf(output, "POPS ");
     identifier(EQnode->left, output);
     fprintf(output, "\n");
-    if (node->right) {
-        return next_step(node->right, output);
-    }
     return 0;
 }
 
 //IF statement
-static int label_counter = 0;  // Global counter for unique labels
+static _Thread_local int label_counter = 0;  // Counter for unique labels
+static _Thread_local int str_label_counter = 0; // Counter for str() labels
 
-int if_stmt(ASTNode *node, FILE *output) {
-    int if_id = label_counter++;
-    
+int if_stmt(ASTNode *node, int if_id, FILE *output) {
     // Evaluate condition
     if (expression(node->left, output) != 0) return -1;
     
@@ -223,36 +264,11 @@ int if_stmt(ASTNode *node, FILE *output) {
     fprintf(output, "LABEL $then%d\n", if_id);
     fprintf(output, "POPFRAME\n");
     
-    // Generate 'then' block
-    if (node->right && node->right->type == AST_BLOCK) {
-        block(node->right, output);
-    }
-    node = node->right->right; // Move to next node (possibly else)
-
-    
-    // Check for else block
-    if (node && node->type == AST_ELSE) {
-        fprintf(output, "JUMP $endif%d\n", if_id);
-        fprintf(output, "LABEL $else%d\n", if_id);
-        fprintf(output, "POPFRAME\n");  // Pop condition frame when entering else
-        node = node->right; // Move to next node
-        if (node && node->type == AST_BLOCK) {
-            block(node, output);
-        }
-        fprintf(output, "LABEL $endif%d\n", if_id);
-    }
-    else {
-        // No else block - just pop the condition frame and continue
-        fprintf(output, "LABEL $else%d\n", if_id);
-        fprintf(output, "POPFRAME\n");  // Pop condition frame
-    }
-    next_step(node->right, output);
+    // The 'then' block follows, see generate_leave
     return 0;
 }
 
-int while_loop(ASTNode *node, FILE *output) {
-    int while_id = label_counter++;
-    
+int while_loop(ASTNode *node, int while_id, FILE *output) {
     fprintf(output, "LABEL $while%d\n", while_id);
     
     // Evaluate condition
@@ -261,31 +277,18 @@ int while_loop(ASTNode *node, FILE *output) {
     // Jump out if false
     fprintf(output, "PUSHS bool@false\n");
     fprintf(output, "JUMPIFEQS $endwhile%d\n", while_id);
-    node = node->right;
-    // Generate loop body
-    if (node && node->type == AST_BLOCK) {
-        block(node, output);
-        node = node->right;
-    }
     
-    fprintf(output, "JUMP $while%d\n", while_id);
-    fprintf(output, "LABEL $endwhile%d\n", while_id);
-    next_step(node, output);
-    return 0;
-}
-
-int block(ASTNode *node, FILE *output) {
-    if (!node || node->type != AST_BLOCK) return -1;
-    
-    // Process statements inside the block
-    if (node->left) {
-        next_step(node->left, output);
-    }
+    // The loop body follows, see generate_leave
     return 0;
 }
 
 int func_def(ASTNode *node, FILE *output) {
     if (!node || !node->name) return -1;
+
+    // A body never parsed in lazy mode is never called: no code for it
+    if (node->right && node->right->type == AST_LAZY_BODY) {
+        return 0;
+    }
     
     // Create function label
     fprintf(output, "JUMP $endfunc_%s\n", node->name);
@@ -311,19 +314,7 @@ int func_def(ASTNode *node, FILE *output) {
         param = param->left;
     }
     
-    // Generate function body
-    if (node->right && node->right->type == AST_BLOCK) {
-        block(node->right, output);
-    }
-    
-    // Default return (if no explicit return)
-    fprintf(output, "PUSHS nil@nil\n");
-    fprintf(output, "POPFRAME\n");
-    fprintf(output, "RETURN\n");
-    
-    fprintf(output, "LABEL $endfunc_%s\n", node->name);
-    next_step(node->right->right, output);
-    
+    // The function body follows, see generate_leave
     return 0;
 }
 
@@ -364,7 +355,7 @@ int func_call(ASTNode *node, FILE *output) {
     }
     
     // Store arguments in temporary array
-    ASTNode **args = malloc(sizeof(ASTNode*) * arg_count);
+    ASTNode **args = arena_alloc(phase_arena(ARENA_CODEGEN), sizeof(ASTNode*) * arg_count);
     arg = node->left;
     for (int i = 0; i < arg_count; i++) {
         args[i] = arg->right;  // The expression
@@ -377,7 +368,7 @@ int func_call(ASTNode *node, FILE *output) {
             expression(args[i], output);
         }
     }
-    free(args);
+    arena_release(phase_arena(ARENA_CODEGEN), args, sizeof(ASTNode*) * arg_count);
     
     fprintf(output, "CALL $func_%s\n", node->name);
     
@@ -421,19 +412,7 @@ int getter_def(ASTNode *node, FILE *output) {
     fprintf(output, "PUSHFRAME\n");
     vars_def(node->var_next, output);  // Variable definitions
     
-    // Generate function body
-    if (node->right && node->right->type == AST_BLOCK) {
-        block(node->right, output);
-    }
-    
-    // Default return (if no explicit return)
-    fprintf(output, "PUSHS nil@nil\n");
-    fprintf(output, "POPFRAME\n");
-    fprintf(output, "RETURN\n");
-    
-    fprintf(output, "LABEL $endgetter_%s\n", node->name);
-    next_step(node->right->right, output);
-    
+    // The getter body follows, see generate_leave
     return 0;
 }
 
@@ -462,19 +441,7 @@ int setter_def(ASTNode *node, FILE *output) {
     identifier(node->left, output);
     fprintf(output, "\n");
     
-    // Generate function body
-    if (node->right && node->right->type == AST_BLOCK) {
-        block(node->right, output);
-    }
-    
-    // Default return (if no explicit return)
-    fprintf(output, "PUSHS nil@nil\n");
-    fprintf(output, "POPFRAME\n");
-    fprintf(output, "RETURN\n");
-    
-    fprintf(output, "LABEL $endsetter_%s\n", node->name);
-    next_step(node->right->right, output);
-    
+    // The setter body follows, see generate_leave
     return 0;
 }
 
@@ -488,7 +455,7 @@ int getter_call(ASTNode *node, FILE *output) {
     return 0;
 }
 
-int expr_getter_call(char* name, FILE *output) {
+int expr_getter_call(const char* name, FILE *output) {
     if (!name) return -1;
     
     fprintf(output, "CALL $getter_%s\n", name);
@@ -513,7 +480,7 @@ int setter_call(ASTNode *node, FILE *output) {
     
     // Result is on stack
     
-    return next_step(node->right, output);
+    return 0;
 }
 
 int write_func(ASTNode *node, FILE *output) {
@@ -561,7 +528,6 @@ int write_func(ASTNode *node, FILE *output) {
 
 int str_func(ASTNode *node, FILE *output) {
     // Get argument
-    static int str_label_counter = 0;
     int label_id = str_label_counter++;
     
     ASTNode *arg = node->left;
@@ -1344,25 +1310,24 @@ int generate_expression_code(ExprNode *expr, FILE *output) {
     
     return 0;
 }
-void def_global(SNode *sym, FILE *output) {
-    if (!sym) return;
-    // Traverse entire tree so we don't miss variables under non-variable nodes
-    def_global(sym->left, output);
-    if (sym->data && sym->data->type == NODE_VAR) {
+// symtable_foreach callback: defines one global variable
+static bool def_global(const char *key, SymTableData *data, void *context) {
+    FILE *output = context;
+    if (data && data->type == NODE_VAR) {
         // Global variables prefixed with __ to avoid name clashes
-        fprintf(output, "DEFVAR GF@%s\n", sym->key);
+        fprintf(output, "DEFVAR GF@%s\n", key);
         // Initialize globals to nil to avoid uninitialized access in getters/setters
-        fprintf(output, "MOVE GF@%s nil@nil\n", sym->key);
+        fprintf(output, "MOVE GF@%s nil@nil\n", key);
     }
-    def_global(sym->right, output);
+    return false;
 }
 
 int gen_globals(ASTNode *node, Scope *scope, FILE *output){
     (void)node;
     if (!scope) return 0;
-    SymTable *table = &scope->symbols;
-    SNode *current = table->root;
-    def_global(current, output);
+    // Visit the entire table so we don't miss variables among the
+    // functions, getters and setters
+    symtable_foreach(&scope->symbols, def_global, output);
     return 0;
 }
 
@@ -1402,18 +1367,7 @@ int main_def(ASTNode *node, FILE *output) {
     fprintf(output, "PUSHFRAME\n");
     vars_def(node->var_next, output);  // Variable definitions
     
-    // Main body is in the block (right child)
-    if (node->right && node->right->type == AST_BLOCK) {
-        block(node->right, output);
-    }
-    fprintf(output, "POPFRAME\n");
-
-    in_main = false;
-    // Continue with next node (other functions)
-    if (node->right) {
-        return next_step(node->right->right, output);
-    }
-    
+    // Main body is in the block (right child), see generate_leave
     return 0;
 }
 
@@ -1433,6 +1387,11 @@ int vars_def(ASTNode *node, FILE *output) {
 // Code generation function
 int generate_code(ASTNode *root, FILE *output) {
     if (!root || !output) return -1;
+
+    // Labels are numbered from zero in every generated program
+    label_counter = 0;
+    str_label_counter = 0;
+    in_main = false;
     
     // 1. Write IFJcode25 header
     fprintf(output, ".IFJcode25\n");
@@ -1465,47 +1424,211 @@ int generate_code(ASTNode *root, FILE *output) {
     return 0;
 }
 
-int next_step(ASTNode *node, FILE *output) {
-    if (!node) return 0;
+/**
+ * @brief What leaving a body block has to generate
+ */
+typedef enum {
+    CLOSE_DEFINITION, // default return of a function, getter or setter
+    CLOSE_MAIN,       // end of main
+    CLOSE_THEN,       // then branch of an if
+    CLOSE_ELSE,       // else branch of an if
+    CLOSE_LOOP        // body of a while
+} BlockClose;
+
+/**
+ * @brief Walk context of a body block; statements are walked without one
+ * (NULL)
+ */
+typedef struct {
+    BlockClose close;
+    int id;              // label number of the if or while
+    ASTNode *definition; // function, getter or setter of the body
+} BlockContext;
+
+// Default return and end label of a function, getter or setter
+static void end_definition(ASTNode *definition, FILE *output) {
+    const char *kind = definition->type == AST_GETTER_DEF ? "getter"
+                       : definition->type == AST_SETTER_DEF ? "setter"
+                                                            : "func";
+    fprintf(output, "PUSHS nil@nil\n");
+    fprintf(output, "POPFRAME\n");
+    fprintf(output, "RETURN\n");
+
+    fprintf(output, "LABEL $end%s_%s\n", kind, definition->name);
+}
+
+// End of main
+static void end_main(FILE *output) {
+    fprintf(output, "POPFRAME\n");
+    in_main = false;
+}
+
+/**
+ * @brief Post visit of the code generation walk: generates what follows
+ * the body of a definition, a branch or a loop
+ */
+static int generate_leave(AstWalkStep *step, void *data) {
+    FILE *output = data;
+    BlockContext *context = step->context;
+    ASTNode *node = step->node;
+    if (node->type != AST_BLOCK || !context) {
+        return 0;
+    }
+
+    // Whatever follows the block is a statement or a definition
+    step->right_context = NULL;
+    switch (context->close) {
+        case CLOSE_DEFINITION:
+            end_definition(context->definition, output);
+            break;
+        case CLOSE_MAIN:
+            end_main(output);
+            break;
+        case CLOSE_THEN:
+            if (node->right && node->right->type == AST_ELSE) {
+                fprintf(output, "JUMP $endif%d\n", context->id);
+                fprintf(output, "LABEL $else%d\n", context->id);
+                fprintf(output, "POPFRAME\n");  // Pop condition frame when entering else
+                // The else block is ended with the same context
+                context->close = CLOSE_ELSE;
+                step->right_context = context;
+                return 0;
+            }
+            // No else block - just pop the condition frame and continue
+            fprintf(output, "LABEL $else%d\n", context->id);
+            fprintf(output, "POPFRAME\n");  // Pop condition frame
+            break;
+        case CLOSE_ELSE:
+            fprintf(output, "LABEL $endif%d\n", context->id);
+            break;
+        case CLOSE_LOOP:
+            fprintf(output, "JUMP $while%d\n", context->id);
+            fprintf(output, "LABEL $endwhile%d\n", context->id);
+            break;
+    }
+    arena_release(phase_arena(ARENA_CODEGEN), context, sizeof(BlockContext));
+    return 0;
+}
+
+/**
+ * @brief Pre visit of the code generation walk: generates a statement or
+ * the start of a definition, branch or loop
+ *
+ * Statements go on with node->right. The body block of a definition, an
+ * if or a while is walked with a BlockContext telling generate_leave how
+ * to end it.
+ */
+static int generate_enter(AstWalkStep *step, void *data) {
+    FILE *output = data;
+    ASTNode *node = step->node;
+    bool opens_body = false;
+    BlockClose close = CLOSE_DEFINITION;
+    int id = 0;
+    int err = 0;
+
+    step->children = AST_WALK_RIGHT;
+    step->left_context = NULL;
+    step->right_context = NULL;
 
-    
     switch(node->type) {
         case AST_VAR_DECL:
             // Variable already defined by vars_def at function start
             // Just continue to next statement
-            return next_step(node->right, output);
+            break;
         case AST_ASSIGN:
-            return assign(node, output);
+            err = assign(node, output);
+            break;
         case AST_FUNC_DEF:
-            return func_def(node, output);
         case AST_GETTER_DEF:
-            return getter_def(node, output);
         case AST_SETTER_DEF:
-            return setter_def(node, output);
+            if (node->type == AST_FUNC_DEF) {
+                err = func_def(node, output);
+            } else if (node->type == AST_GETTER_DEF) {
+                err = getter_def(node, output);
+            } else {
+                err = setter_def(node, output);
+            }
+            if (err != 0 || !node->right) {
+                break;
+            }
+            if (node->right->type == AST_BLOCK) {
+                opens_body = true;
+            } else if (node->right->type != AST_LAZY_BODY) {
+                end_definition(node, output);
+            }
+            break;
         case AST_MAIN_DEF:
-            return main_def(node, output);
+            err = main_def(node, output);
+            if (err != 0) {
+                break;
+            }
+            if (node->right && node->right->type == AST_BLOCK) {
+                opens_body = true;
+                close = CLOSE_MAIN;
+            } else {
+                end_main(output);
+            }
+            break;
         case AST_FUNC_CALL:
             func_call(node, output);
-            return next_step(node->right, output);
+            break;
         case AST_SETTER_CALL:
             setter_call(node, output);
-            return next_step(node->right, output);
+            break;
         case AST_GETTER_CALL:
             getter_call(node, output);
-            return next_step(node->right, output);
+            break;
         case AST_IF:
-            return if_stmt(node, output);
+            id = label_counter++;
+            err = if_stmt(node, id, output);
+            opens_body = true;
+            close = CLOSE_THEN;
+            break;
+        case AST_ELSE:
+            // Reached from the then block, with the context ending the else
+            step->right_context = step->context;
+            break;
         case AST_WHILE:
-            return while_loop(node, output);
+            id = label_counter++;
+            err = while_loop(node, id, output);
+            opens_body = true;
+            close = CLOSE_LOOP;
+            break;
         case AST_RETURN:
-            return return_stmt(node, output);
+            step->children = AST_WALK_SKIP_CHILDREN;
+            err = return_stmt(node, output);
+            break;
         case AST_BLOCK:
-            return block(node, output);
+            // A body block goes on after its statements (generate_leave),
+            // a block statement does not
+            step->children = step->context ? AST_WALK_CHILDREN : AST_WALK_LEFT;
+            break;
+        case AST_LAZY_BODY:
+            break;
         case AST_EXPRESSION:
-            return expression(node, output);
+            step->children = AST_WALK_SKIP_CHILDREN;
+            err = expression(node, output);
+            break;
         // Add other cases...
         default:
             fprintf(stderr, "[GENERATOR] Unknown AST node type: %d\n", node->type);
             return -1;
     }
+    if (err != 0 || !opens_body) {
+        return err;
+    }
+
+    BlockContext *body = arena_alloc(phase_arena(ARENA_CODEGEN), sizeof(BlockContext));
+    if (!body) {
+        return -1;
+    }
+    body->close = close;
+    body->id = id;
+    body->definition = node;
+    step->right_context = body;
+    return 0;
+}
+
+int next_step(ASTNode *node, FILE *output) {
+    return ast_walk(node, NULL, generate_enter, generate_leave, output);
 }
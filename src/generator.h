@@ -14,7 +14,7 @@
 #include <stdio.h>
 
 //---------- Global variables ----------
-extern bool in_main;
+extern _Thread_local bool in_main;
 
 
 //---------- Function declarations ----------
@@ -111,9 +111,8 @@ int assign (ASTNode *node, FILE *output);
 //funkcion ast types
 int funkc_call (ASTNode *node, FILE *output);
 int getter_call (ASTNode *node, FILE *output);
-int expr_getter_call(char* name, FILE *output);
+int expr_getter_call(const char* name, FILE *output);
 int setter_call (ASTNode *node, FILE *output);
-int block (ASTNode *node, FILE *output);
 int gen_globals(ASTNode *node, Scope *scope, FILE *output);
 
 //definitions ast types
@@ -123,8 +122,8 @@ int getter_def (ASTNode *node, FILE *output);
 int setter_def (ASTNode *node, FILE *output);
 
 //statements ast types
-int if_stmt (ASTNode *node, FILE *output);
-int while_loop (ASTNode *node, FILE *output);
+int if_stmt (ASTNode *node, int if_id, FILE *output);
+int while_loop (ASTNode *node, int while_id, FILE *output);
 int return_stmt (ASTNode *node, FILE *output);
 
 //expressions ast types
@@ -133,6 +132,12 @@ int expression (ASTNode *node, FILE *output);
 
 /**
  * @brief Function to handle the next step in code generation.
+ *
+ * Generates the node and the statements or definitions chained after it.
+ * The definition, statement and expression functions above generate their
+ * own node only; next_step walks the tree with ast_walk, so the C stack
+ * grows with the nesting of blocks, not with the number of statements.
+ *
  * @param node Current AST node.
  * @param output File pointer to write the generated code.
  * @return 0 on success, non-zero error code on failure.
@@ -0,0 +1,116 @@
+/**
+ * @file ifj25.c
+ * @author xcernoj00
+ * @brief Library interface of the IFJ25 compiler
+ *
+ * Runs the scanner, parser, semantic analysis and code generator over one
+ * source and tears down everything the run allocated.
+ */
+
+#include "ifj25.h"
+#include "ast.h"
+#include "generator.h"
+#include "intern.h"
+#include "parser.h"
+#include "scanner.h"
+#include "semantic.h"
+#include "token_pipe.h"
+#include <string.h>
+
+void ifj25_context_init(Ifj25Context *ctx) { memset(ctx, 0, sizeof(*ctx)); }
+
+/**
+ * @brief Record the outcome of a compilation in the context.
+ */
+static int finish(Ifj25Context *ctx, int status, Ifj25Phase phase) {
+    ctx->status = status;
+    ctx->failed_phase = status == NO_ERROR ? IFJ25_PHASE_NONE : phase;
+    ctx->compiled++;
+    if (status != NO_ERROR) {
+        ctx->failed++;
+    }
+    return status;
+}
+
+/**
+ * @brief Compile from an initialized scanner, then free the scanner and
+ *        all phase memory of the calling thread.
+ */
+static int compile_scanner(Ifj25Context *ctx, Scanner *scanner, FILE *sink) {
+    Ifj25Phase phase = IFJ25_PHASE_LOAD;
+    int status = NO_ERROR;
+
+    if (ctx->lex_first) {
+        status = scanner_tokenize_all(scanner) == NO_ERROR ? NO_ERROR
+                                                           : ERROR_INTERNAL;
+    } else if (ctx->pipelined) {
+        // Without a scanner thread the scanner simply keeps streaming
+        scanner_start_pipeline(scanner);
+    }
+
+    ASTNode *program = NULL;
+    if (status == NO_ERROR) {
+        phase = IFJ25_PHASE_PARSE;
+        parser_set_expression_parser(ctx->climbing_expressions
+                                         ? EXPR_PARSER_CLIMBING
+                                         : EXPR_PARSER_PRECEDENCE);
+        parser_set_lazy_bodies(ctx->lazy_bodies);
+        program = create_ast_node(AST_PROGRAM, NULL);
+        status = program ? parser_parallel(scanner, program,
+                                           ctx->parse_threads > 1
+                                               ? ctx->parse_threads
+                                               : 1)
+                         : ERROR_INTERNAL;
+    }
+    if (status == NO_ERROR) {
+        phase = IFJ25_PHASE_SEMANTIC;
+        status = semantic_analyze(program);
+    }
+    if (status == NO_ERROR) {
+        phase = IFJ25_PHASE_CODEGEN;
+        status = generate_code(program, sink);
+    }
+
+    for (int i = 0; i < ARENA_PHASE_COUNT; i++) {
+        ctx->arena_stats[i] = phase_arena((ArenaPhase)i)->stats;
+    }
+    ctx->names = intern_count();
+    phase_arenas_free_all();
+    scanner_free(scanner);
+    intern_free_all();
+    return finish(ctx, status, phase);
+}
+
+int ifj25_compile(Ifj25Context *ctx, const char *src, size_t len,
+                  FILE *sink) {
+    Scanner scanner;
+    if (scanner_init_buffer(&scanner, src, len) != NO_ERROR) {
+        return finish(ctx, ERROR_INTERNAL, IFJ25_PHASE_LOAD);
+    }
+    return compile_scanner(ctx, &scanner, sink);
+}
+
+int ifj25_compile_file(Ifj25Context *ctx, FILE *source, FILE *sink) {
+    Scanner scanner;
+    if (scanner_init_file(&scanner, source) != NO_ERROR) {
+        return finish(ctx, ERROR_INTERNAL, IFJ25_PHASE_LOAD);
+    }
+    return compile_scanner(ctx, &scanner, sink);
+}
+
+const char *ifj25_phase_name(Ifj25Phase phase) {
+    switch (phase) {
+    case IFJ25_PHASE_NONE:
+        return "none";
+    case IFJ25_PHASE_LOAD:
+        return "load";
+    case IFJ25_PHASE_PARSE:
+        return "parse";
+    case IFJ25_PHASE_SEMANTIC:
+        return "semantic";
+    case IFJ25_PHASE_CODEGEN:
+        return "codegen";
+    default:
+        return "unknown";
+    }
+}
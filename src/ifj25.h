@@ -0,0 +1,105 @@
+/**
+ * @file ifj25.h
+ * @author xcernoj00
+ * @brief Library interface of the IFJ25 compiler (libifj25.a).
+ *
+ * Compiles IFJ25 programs to IFJcode25 inside the calling process. A
+ * compilation never exits the process and leaves nothing behind: every
+ * error is returned as an error code from error.h, and all memory of the
+ * compilation is released before ifj25_compile() returns. Compiler state
+ * is private to the calling thread, so one process can compile any number
+ * of programs one after another, or on several threads with one context
+ * per thread.
+ *
+ * Diagnostics are written to stderr.
+ */
+
+#ifndef _IFJ25_H
+#define _IFJ25_H
+
+#include "arena.h"
+#include "error.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+/**
+ * @brief Compilation phase that reported an error.
+ */
+typedef enum {
+    IFJ25_PHASE_NONE,     ///< no error
+    IFJ25_PHASE_LOAD,     ///< reading the source or lexing it up front
+    IFJ25_PHASE_PARSE,    ///< lexical and syntactic analysis
+    IFJ25_PHASE_SEMANTIC, ///< semantic analysis
+    IFJ25_PHASE_CODEGEN,  ///< code generation
+} Ifj25Phase;
+
+/**
+ * @brief Options and results of compilations.
+ *
+ * Initialize with ifj25_context_init(), set the options, then pass the
+ * context to any number of compilations. A context must not be used by
+ * two threads at the same time.
+ */
+typedef struct {
+    // Options
+    bool lex_first; ///< tokenize the whole source before parsing
+    bool pipelined; ///< scan on a separate thread while parsing
+    unsigned parse_threads; ///< threads parsing function definitions
+                            ///< (0 or 1: none, see parser_parallel)
+    bool climbing_expressions; ///< parse expressions by precedence climbing
+    bool lazy_bodies; ///< parse function bodies once they are called
+                      ///< (see parser_set_lazy_bodies)
+
+    // Results of the last compilation
+    int status;              ///< error code returned by the last compilation
+    Ifj25Phase failed_phase; ///< phase that produced `status`
+    ArenaStats arena_stats[ARENA_PHASE_COUNT]; ///< allocations per phase
+    size_t names;            ///< distinct names interned
+
+    // Totals
+    size_t compiled; ///< compilations run with this context
+    size_t failed;   ///< of those, compilations that returned an error
+} Ifj25Context;
+
+/**
+ * @brief Initialize a context with default options.
+ *
+ * @param ctx Context to initialize.
+ */
+void ifj25_context_init(Ifj25Context *ctx);
+
+/**
+ * @brief Compile a program held in memory.
+ *
+ * The generated IFJcode25 is written to `sink`. On an error the sink may
+ * hold partial output.
+ *
+ * @param ctx Context with the options; receives the results.
+ * @param src Source text (need not be NUL-terminated).
+ * @param len Length of the source text in bytes.
+ * @param sink Stream receiving the generated code.
+ * @return NO_ERROR or the error code of the failing phase.
+ */
+int ifj25_compile(Ifj25Context *ctx, const char *src, size_t len,
+                  FILE *sink);
+
+/**
+ * @brief Compile a program read from a stream.
+ *
+ * Like ifj25_compile(), but the source is read from `source` to its end.
+ * The stream is not closed.
+ *
+ * @param ctx Context with the options; receives the results.
+ * @param source Stream with the source text.
+ * @param sink Stream receiving the generated code.
+ * @return NO_ERROR or the error code of the failing phase.
+ */
+int ifj25_compile_file(Ifj25Context *ctx, FILE *source, FILE *sink);
+
+/**
+ * @brief Human-readable name of a compilation phase.
+ */
+const char *ifj25_phase_name(Ifj25Phase phase);
+
+#endif // _IFJ25_H
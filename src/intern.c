@@ -0,0 +1,284 @@
+/**
+ * @file intern.c
+ * @author xcernoj00
+ * @brief String interning table (open addressing, FNV-1a hash)
+ */
+
+#include "intern.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define INTERN_INITIAL_CAPACITY 256
+
+/**
+ * @brief One interned string; handles point at `text`.
+ */
+typedef struct InternEntry {
+    unsigned id;     ///< sequential id, 1 for the first interned string
+    uint32_t hash;   ///< cached hash of the text
+    size_t length;   ///< text length without the terminating NUL
+    char text[];     ///< NUL-terminated text
+} InternEntry;
+
+/**
+ * @brief Open addressing table of entries.
+ *
+ * While `shared`, the table may be used by several threads and every
+ * access takes `lock`.
+ */
+struct InternTable {
+    InternEntry **slots; // Open addressing table of entries
+    size_t capacity;     // Number of slots (power of two)
+    size_t count;        // Number of used slots
+    bool shared;         // Accesses must lock
+    pthread_mutex_t lock;
+};
+
+// Every thread interns into its own table unless it attaches to another one
+static _Thread_local InternTable own_table = {
+    NULL, 0, 0, false, PTHREAD_MUTEX_INITIALIZER};
+static _Thread_local InternTable *attached;
+static _Thread_local InternLog *recording; // log of the calling thread
+
+static inline InternTable *current(void) {
+    return attached ? attached : &own_table;
+}
+
+static inline void table_lock(InternTable *table) {
+    if (table->shared) {
+        pthread_mutex_lock(&table->lock);
+    }
+}
+
+static inline void table_unlock(InternTable *table) {
+    if (table->shared) {
+        pthread_mutex_unlock(&table->lock);
+    }
+}
+
+static uint32_t hash_text(const char *str, size_t length) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (unsigned char)str[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static InternEntry *entry_of(const char *handle) {
+    return (InternEntry *)(handle - offsetof(InternEntry, text));
+}
+
+/**
+ * @brief Find the slot holding the text, or the empty slot where it belongs.
+ */
+static size_t find_slot(const InternTable *table, const char *str,
+                        size_t length, uint32_t hash) {
+    size_t mask = table->capacity - 1;
+    size_t i = hash & mask;
+    while (table->slots[i] != NULL) {
+        InternEntry *entry = table->slots[i];
+        if (entry->hash == hash && entry->length == length &&
+            memcmp(entry->text, str, length) == 0) {
+            return i;
+        }
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+static bool grow(InternTable *table) {
+    size_t new_capacity =
+        table->capacity ? table->capacity * 2 : INTERN_INITIAL_CAPACITY;
+    InternEntry **new_slots = calloc(new_capacity, sizeof(InternEntry *));
+    if (!new_slots) {
+        return false;
+    }
+    for (size_t i = 0; i < table->capacity; i++) {
+        InternEntry *entry = table->slots[i];
+        if (entry) {
+            size_t j = entry->hash & (new_capacity - 1);
+            while (new_slots[j] != NULL) {
+                j = (j + 1) & (new_capacity - 1);
+            }
+            new_slots[j] = entry;
+        }
+    }
+    free(table->slots);
+    table->slots = new_slots;
+    table->capacity = new_capacity;
+    return true;
+}
+
+/**
+ * @brief Find or add the text; the caller holds the table lock.
+ */
+static const char *insert(InternTable *table, const char *str,
+                          size_t length) {
+    // Keep the load factor below 3/4
+    if ((table->count + 1) * 4 > table->capacity * 3 && !grow(table)) {
+        return NULL;
+    }
+
+    uint32_t hash = hash_text(str, length);
+    size_t i = find_slot(table, str, length, hash);
+    if (table->slots[i] != NULL) {
+        return table->slots[i]->text;
+    }
+
+    InternEntry *entry = malloc(sizeof(InternEntry) + length + 1);
+    if (!entry) {
+        return NULL;
+    }
+    entry->id = (unsigned)++table->count;
+    entry->hash = hash;
+    entry->length = length;
+    memcpy(entry->text, str, length);
+    entry->text[length] = '\0';
+    table->slots[i] = entry;
+    return entry->text;
+}
+
+static void record(InternLog *log, const char *handle) {
+    if (log->count == log->capacity) {
+        size_t capacity = log->capacity ? log->capacity * 2 : 64;
+        const char **names = realloc(log->names, capacity * sizeof(char *));
+        if (!names) {
+            log->failed = true;
+            return;
+        }
+        log->names = names;
+        log->capacity = capacity;
+    }
+    log->names[log->count++] = handle;
+}
+
+const char *intern_n(const char *str, size_t length) {
+    if (!str) {
+        return NULL;
+    }
+    // Stop at an embedded NUL so the handle equals its C string
+    const char *nul = memchr(str, '\0', length);
+    if (nul) {
+        length = (size_t)(nul - str);
+    }
+
+    InternTable *table = current();
+    table_lock(table);
+    const char *handle = insert(table, str, length);
+    table_unlock(table);
+    if (recording && handle) {
+        record(recording, handle);
+    }
+    return handle;
+}
+
+const char *intern(const char *str) {
+    return str ? intern_n(str, strlen(str)) : NULL;
+}
+
+const char *intern_find(const char *str) {
+    InternTable *table = current();
+    if (!str) {
+        return NULL;
+    }
+    const char *handle = NULL;
+    size_t length = strlen(str);
+    table_lock(table);
+    if (table->count > 0) {
+        size_t i = find_slot(table, str, length, hash_text(str, length));
+        handle = table->slots[i] ? table->slots[i]->text : NULL;
+    }
+    table_unlock(table);
+    return handle;
+}
+
+unsigned intern_id(const char *handle) { return entry_of(handle)->id; }
+
+size_t intern_count(void) {
+    InternTable *table = current();
+    table_lock(table);
+    size_t count = table->count;
+    table_unlock(table);
+    return count;
+}
+
+InternTable *intern_table(void) { return current(); }
+
+void intern_attach(InternTable *table) { attached = table; }
+
+void intern_share(InternTable *table, bool shared) { table->shared = shared; }
+
+void intern_record(InternLog *log) { recording = log; }
+
+void intern_log_free(InternLog *log) {
+    free(log->names);
+    memset(log, 0, sizeof(*log));
+}
+
+bool intern_renumber(InternTable *table, size_t kept, const InternLog *logs,
+                     size_t count) {
+    size_t fresh = table->count - kept;
+    if (fresh == 0) {
+        return true;
+    }
+    bool *seen = calloc(fresh, sizeof(bool));
+    InternEntry **order = malloc(fresh * sizeof(InternEntry *));
+    InternEntry **slots = calloc(table->capacity, sizeof(InternEntry *));
+    if (!seen || !order || !slots) {
+        free(seen);
+        free(order);
+        free(slots);
+        return false;
+    }
+
+    // New names in order of first appearance
+    size_t ordered = 0;
+    for (size_t l = 0; l < count; l++) {
+        for (size_t i = 0; i < logs[l].count; i++) {
+            InternEntry *entry = entry_of(logs[l].names[i]);
+            if (entry->id > kept && !seen[entry->id - kept - 1]) {
+                seen[entry->id - kept - 1] = true;
+                order[ordered++] = entry;
+            }
+        }
+    }
+
+    // Rebuild the slots without the names no log mentions
+    size_t mask = table->capacity - 1;
+    for (size_t i = 0; i < table->capacity; i++) {
+        InternEntry *entry = table->slots[i];
+        if (entry && entry->id > kept && !seen[entry->id - kept - 1]) {
+            free(entry);
+        } else if (entry) {
+            size_t j = entry->hash & mask;
+            while (slots[j] != NULL) {
+                j = (j + 1) & mask;
+            }
+            slots[j] = entry;
+        }
+    }
+    for (size_t i = 0; i < ordered; i++) {
+        order[i]->id = (unsigned)(kept + 1 + i);
+    }
+    free(table->slots);
+    table->slots = slots;
+    table->count = kept + ordered;
+    free(seen);
+    free(order);
+    return true;
+}
+
+void intern_free_all(void) {
+    InternTable *table = current();
+    for (size_t i = 0; i < table->capacity; i++) {
+        free(table->slots[i]);
+    }
+    free(table->slots);
+    table->slots = NULL;
+    table->capacity = 0;
+    table->count = 0;
+}
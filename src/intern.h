@@ -0,0 +1,134 @@
+/**
+ * @file intern.h
+ * @author xcernoj00
+ * @brief String interning table shared by the scanner, AST and symbol tables.
+ *
+ * Every distinct name is stored exactly once. Interning returns a stable,
+ * NUL-terminated handle, so two names are equal exactly when their handles
+ * are the same pointer. Each handle also carries a small integer id that
+ * orders names by their first appearance.
+ *
+ * The table belongs to the calling thread: handles interned on one thread
+ * are not found by another, and intern_free_all() only frees the caller's.
+ * A helper thread can intern into the table of another thread through
+ * intern_attach() while that table is shared. When several threads intern
+ * at once, the ids follow their interleaving; an InternLog of each thread
+ * lets the owner restore the order a single thread would have produced
+ * (see intern_renumber).
+ */
+
+#ifndef _INTERN_H
+#define _INTERN_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct InternTable InternTable;
+
+/**
+ * @brief Handles returned to one thread, in the order it interned them.
+ */
+typedef struct {
+    const char **names; ///< handles, repeated names included
+    size_t count;       ///< number of handles in `names`
+    size_t capacity;    ///< allocated entries of `names`
+    bool failed;        ///< a handle could not be recorded
+} InternLog;
+
+/**
+ * @brief Intern a NUL-terminated string.
+ *
+ * @param str String to intern.
+ * @return Interned handle or NULL on allocation failure.
+ */
+const char *intern(const char *str);
+
+/**
+ * @brief Intern a length-bounded string.
+ *
+ * The text ends early at an embedded NUL, like a C string copy would.
+ *
+ * @param str String characters (need not be NUL-terminated).
+ * @param length Number of characters of `str` to intern.
+ * @return Interned handle or NULL on allocation failure.
+ */
+const char *intern_n(const char *str, size_t length);
+
+/**
+ * @brief Look up a string without adding it to the table.
+ *
+ * @param str NUL-terminated string to look up.
+ * @return Interned handle or NULL when the string was never interned.
+ */
+const char *intern_find(const char *str);
+
+/**
+ * @brief Sequential id of an interned handle (first interned name is 1).
+ *
+ * @param handle Handle returned by one of the intern functions.
+ * @return Id of the handle.
+ */
+unsigned intern_id(const char *handle);
+
+/**
+ * @brief Number of distinct strings currently interned.
+ */
+size_t intern_count(void);
+
+/**
+ * @brief The table the calling thread interns into.
+ */
+InternTable *intern_table(void);
+
+/**
+ * @brief Make the calling thread intern into `table` (NULL: its own table).
+ *
+ * `table` must be shared (see intern_share) while two threads use it.
+ */
+void intern_attach(InternTable *table);
+
+/**
+ * @brief Turn locking of a table on or off.
+ *
+ * Call it on the owning thread before another thread attaches, and turn it
+ * off only after that thread is done with the table.
+ */
+void intern_share(InternTable *table, bool shared);
+
+/**
+ * @brief Record every handle the calling thread interns into `log`.
+ *
+ * @param log Zero-initialized log to append to, or NULL to stop recording.
+ */
+void intern_record(InternLog *log);
+
+/**
+ * @brief Free the handles of a log.
+ */
+void intern_log_free(InternLog *log);
+
+/**
+ * @brief Reassign the ids of the names interned after the first `kept`.
+ *
+ * Those names get the ids kept + 1, kept + 2, ... in the order in which
+ * they first appear in `logs[0]`, `logs[1]`, ...; names that appear in no
+ * log are removed from the table and their handles become invalid. Call
+ * it on the owning thread while the table is not shared.
+ *
+ * @param table Table to renumber.
+ * @param kept Number of names whose ids stay.
+ * @param logs Logs of the names to keep, in order.
+ * @param count Number of logs.
+ * @return false on allocation failure (the table is left unchanged).
+ */
+bool intern_renumber(InternTable *table, size_t kept, const InternLog *logs,
+                     size_t count);
+
+/**
+ * @brief Free every interned string and the table itself.
+ *
+ * All handles become invalid.
+ */
+void intern_free_all(void);
+
+#endif // _INTERN_H
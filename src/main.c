@@ -10,16 +10,41 @@
  * 3. Code Generation
  *
  * The compiler reads source code from standard input and outputs IFJcode25
- * (a variant of IFJ instruction set) to standard output.
+ * (a variant of IFJ instruction set) to standard output. The pipeline
+ * itself lives in the compiler library (ifj25.h); this file only handles
+ * the command line.
  *
  * Compilation Pipeline:
  * - Input: IFJ25 source code (stdin)
  * - Scanner: Tokenizes the source code
- * - Parser: Builds Abstract Syntax Tree (AST) using recursive descent
+ * - Parser: Builds Abstract Syntax Tree (AST) with a table-driven LL(1)
+ *   driver and an explicit stack (table generated from grammar.txt into
+ *   src/parse_table.h; expressions are handed to the expression parser)
  * - Semantic Analyzer: Validates types, scopes, and semantic rules
  * - Code Generator: Produces IFJcode25 instructions
  * - Output: IFJcode25 executable code (stdout)
  *
+ * Options:
+ * - --lex-first: tokenize the whole input before parsing instead of
+ *   scanning tokens on demand (same output, different memory/time profile)
+ * - --pipeline: scan on a separate thread that feeds the parser through a
+ *   lock-free token ring (same output; ignored with --lex-first; under
+ *   --batch every worker runs its own scanner thread)
+ * - --parse-threads N: parse the function definitions on N threads (same
+ *   output; only used while streaming, i.e. without the two options above;
+ *   under --batch per worker)
+ * - --climbing: parse expressions by precedence climbing instead of the
+ *   shift/reduce precedence parser (same output; also in every file of a batch)
+ * - --lazy-bodies: parse the body of a function other than main only once
+ *   semantic analysis finds a call of it; functions that are never called
+ *   are neither parsed nor generated (only while streaming, as above; also
+ *   in every file of a batch)
+ * - --batch <dir|list>: compile every *.wren file of a directory, or every
+ *   file named in a list (one path per line), writing the code for `file`
+ *   to `file.ifjcode` and printing the exit code of each file; may be given
+ *   more than once, and the options above apply to every file
+ * - -j N: number of threads compiling a batch (default: one per processor)
+ *
  * Error Handling:
  * The compiler follows a fail-fast approach. If any phase encounters an error,
  * resources are cleaned up and an appropriate error code is returned:
@@ -37,75 +62,101 @@
  * - ERROR_INTERNAL (99): Internal compiler error (memory allocation, etc.)
  */
 
-#include "ast.h"
+#include "batch.h"
 #include "error.h"
-#include "expr_ast.h"
-#include "expr_parser.h"
-#include "generator.h"
-#include "parser.h"
-#include "scanner.h"
-#include "semantic.h"
-#include "symtable.h"
+#include "ifj25.h"
+#include <stdbool.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Compile the collected batch and print a per-file summary.
+ * @return NO_ERROR when every file compiled, otherwise the exit code of the
+ * first failing file in input order.
+ */
+static int run_batch(Batch *batch, unsigned threads,
+                     const Ifj25Context *ctx) {
+    WorkPoolStats stats;
+    size_t failed = batch_compile(batch, threads, ctx, &stats);
+
+    int error_code = NO_ERROR;
+    double busy = 0.0;
+    for (size_t i = 0; i < batch->count; i++) {
+        const BatchFile *file = &batch->files[i];
+        printf("%3d %s\n", file->status, file->path);
+        if (error_code == NO_ERROR) {
+            error_code = file->status;
+        }
+        busy += file->seconds;
+    }
+    printf("%zu files: %zu compiled, %zu failed (%u threads, %zu steals, "
+           "%.3f s compiling)\n",
+           batch->count, batch->count - failed, failed, stats.threads,
+           stats.steals, busy);
+    return error_code;
+}
 
 /**
  * @brief Main entry point of the IFJ25 compiler.
  * @details
- * Executes the complete compilation pipeline:
- * 1. Initializes the scanner with stdin as the source
+ * Executes the complete compilation pipeline through ifj25_compile_file():
+ * 1. Loads stdin into the scanner source buffer (and optionally lexes it
+ *    into a token array)
  * 2. Creates the root AST node (PROGRAM)
  * 3. Invokes the parser to build the AST
  * 4. Performs semantic analysis on the AST
  * 5. Generates IFJcode25 instructions to stdout
  * 6. Cleans up all allocated resources
  *
+ * @param argc Number of command line arguments.
+ * @param argv Command line arguments (see Options above).
  * @return Error code indicating compilation result:
  *         - NO_ERROR (0) on successful compilation
  *         - Non-zero error code if compilation fails at any stage
  */
-int main() {
-    // Initialize source file (stdin)
-    FILE *source_file = stdin;
-    set_source_file(source_file);
-
-    // Create root AST node for the program
-    ASTNode *PROGRAM = create_ast_node(AST_PROGRAM, NULL);
-
-    // Phase 1: Lexical and Syntactic Analysis
-    // Parse the source code and build the Abstract Syntax Tree
-    int error_code = parser(PROGRAM);
-    if (error_code != NO_ERROR) {
-        free_ast_tree(PROGRAM);
-        fclose(source_file);
-        return error_code;
-    }
-
-    FILE *fileOut = stdout;
-
-    // Phase 2: Semantic Analysis
-    // Validate types, scopes, function signatures, and semantic rules
-    error_code = semantic_analyze(PROGRAM);
-    if (error_code != NO_ERROR) {
-        free_ast_tree(PROGRAM);
-        fclose(source_file);
-        fclose(fileOut);
-        return error_code;
+int main(int argc, char **argv) {
+    Ifj25Context ctx;
+    ifj25_context_init(&ctx);
+    Batch batch;
+    batch_init(&batch);
+    bool batch_mode = false;
+    unsigned threads = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--lex-first") == 0) {
+            ctx.lex_first = true;
+        } else if (strcmp(argv[i], "--pipeline") == 0) {
+            ctx.pipelined = true;
+        } else if (strcmp(argv[i], "--parse-threads") == 0 && i + 1 < argc) {
+            ctx.parse_threads = (unsigned)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--climbing") == 0) {
+            ctx.climbing_expressions = true;
+        } else if (strcmp(argv[i], "--lazy-bodies") == 0) {
+            ctx.lazy_bodies = true;
+        } else if (strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
+            batch_mode = true;
+            if (batch_collect(&batch, argv[++i]) != NO_ERROR) {
+                fprintf(stderr, "Cannot read batch input: %s\n", argv[i]);
+                batch_free(&batch);
+                return ERROR_INTERNAL;
+            }
+        } else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            threads = (unsigned)strtoul(argv[++i], NULL, 10);
+        } else {
+            fprintf(stderr, "Unknown option: %s\n", argv[i]);
+            batch_free(&batch);
+            return ERROR_INTERNAL;
+        }
     }
 
-    // Phase 3: Code Generation
-    // Generate IFJcode25 instructions from the validated AST
-    error_code = generate_code(PROGRAM, fileOut);
-    if (error_code != NO_ERROR) {
-        free_ast_tree(PROGRAM);
-        fclose(source_file);
-        fclose(fileOut);
+    if (batch_mode) {
+        int error_code = run_batch(&batch, threads, &ctx);
+        batch_free(&batch);
         return error_code;
     }
 
-    // Cleanup: Free all allocated resources
-    free_ast_tree(PROGRAM);
-    fclose(source_file);
-    fclose(fileOut);
-
+    int error_code = ifj25_compile_file(&ctx, stdin, stdout);
+    fclose(stdin);
+    fclose(stdout);
     return error_code;
 }
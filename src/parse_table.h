@@ -0,0 +1,441 @@
+/**
+ * @file parse_table.h
+ * @brief LL(1) parse table of the parser.
+ *
+ * Generated by tools/ll1gen from grammar.txt, do not edit.
+ */
+
+#ifndef PARSE_TABLE_H
+#define PARSE_TABLE_H
+
+#include <stdint.h>
+
+/// Grammar symbol: kind in the top bits, index below
+#define LL_SYMBOL(kind, index) ((uint16_t)((kind) << 12 | (index)))
+#define LL_KIND(symbol) ((symbol) >> 12)
+#define LL_INDEX(symbol) ((symbol) & 0x0fff)
+
+enum {
+    LL_TERMINAL,
+    LL_NONTERMINAL,
+    LL_ACTION,
+    LL_HANDOFF
+};
+
+/// Terminals: token classes (the table columns), then tokens with a fixed text
+typedef enum {
+    LL_T_EOL,
+    LL_T_EOF,
+    LL_T_IMPORT,
+    LL_T_STRING,
+    LL_T_FOR,
+    LL_T_IFJ,
+    LL_T_CLASS,
+    LL_T_ID,
+    LL_T_LCURLY,
+    LL_T_RCURLY,
+    LL_T_STATIC,
+    LL_T_EQUAL,
+    LL_T_LPAREN,
+    LL_T_RPAREN,
+    LL_T_COMMA,
+    LL_T_GLOBAL_ID,
+    LL_T_VAR,
+    LL_T_IF,
+    LL_T_ELSE,
+    LL_T_WHILE,
+    LL_T_RETURN,
+    LL_T_CALL,
+    LL_T_OTHER,
+    LL_T_STRING_IFJ25,
+    LL_T_ID_PROGRAM,
+    LL_TERMINAL_COUNT
+} LLTerminal;
+
+#define LL_CLASS_COUNT (LL_T_OTHER + 1)
+
+typedef enum {
+    LL_N_PROGRAM,
+    LL_N_EOLS,
+    LL_N_PROLOG,
+    LL_N_CLASS,
+    LL_N_DEF_FUN_LIST,
+    LL_N_DEF_FUN,
+    LL_N_DEF_FUN_TAIL,
+    LL_N_ARGUMENT_LIST,
+    LL_N_ARGUMENT_TAIL,
+    LL_N_BLOCK,
+    LL_N_STML_LIST,
+    LL_N_STML_LINE,
+    LL_N_STML,
+    LL_N_STML_ID,
+    LL_N_VAR,
+    LL_N_IF,
+    LL_N_WHILE,
+    LL_N_RETURN,
+    LL_N_RETURN_VALUE,
+    LL_N_PARAMETER_LIST,
+    LL_N_PARAMETER_TAIL,
+    LL_N_EXPRESSION,
+    LL_N_EXPRESSION_TAIL,
+    LL_NONTERMINAL_COUNT
+} LLNonterminal;
+
+typedef enum {
+    LL_A_DEFINITIONS,
+    LL_A_LINK_DEFINITION,
+    LL_A_IDENTIFIER,
+    LL_A_GETTER,
+    LL_A_SET_RIGHT,
+    LL_A_SETTER,
+    LL_A_SET_LEFT,
+    LL_A_FUNCTION,
+    LL_A_ARGUMENTS,
+    LL_A_POP,
+    LL_A_LAZY_BODY,
+    LL_A_ARGUMENT,
+    LL_A_BLOCK,
+    LL_A_APPEND,
+    LL_A_NOTHING,
+    LL_A_CALL,
+    LL_A_ASSIGN,
+    LL_A_VAR,
+    LL_A_IF,
+    LL_A_REMAP_ON,
+    LL_A_REMAP_OFF,
+    LL_A_ELSE,
+    LL_A_WHILE,
+    LL_A_RETURN,
+    LL_A_REJECT,
+    LL_A_WRAP_CALL,
+    LL_ACTION_COUNT
+} LLAction;
+
+typedef enum {
+    LL_H_EXPRESSION,
+    LL_HANDOFF_COUNT
+} LLHandoff;
+
+/// Class of each terminal
+static const uint8_t ll_terminal_class[LL_TERMINAL_COUNT] = {
+    LL_T_EOL,
+    LL_T_EOF,
+    LL_T_IMPORT,
+    LL_T_STRING,
+    LL_T_FOR,
+    LL_T_IFJ,
+    LL_T_CLASS,
+    LL_T_ID,
+    LL_T_LCURLY,
+    LL_T_RCURLY,
+    LL_T_STATIC,
+    LL_T_EQUAL,
+    LL_T_LPAREN,
+    LL_T_RPAREN,
+    LL_T_COMMA,
+    LL_T_GLOBAL_ID,
+    LL_T_VAR,
+    LL_T_IF,
+    LL_T_ELSE,
+    LL_T_WHILE,
+    LL_T_RETURN,
+    LL_T_CALL,
+    LL_T_OTHER,
+    LL_T_STRING,
+    LL_T_ID,
+};
+
+/// Text a terminal must have (NULL: any)
+static const char *const ll_terminal_text[LL_TERMINAL_COUNT] = {
+    [LL_T_STRING_IFJ25] = "ifj25",
+    [LL_T_ID_PROGRAM] = "Program",
+};
+
+/// Right sides of the productions, last symbol first
+static const uint16_t ll_rhs[] = {
+    // PROGRAM -> EOLS PROLOG eol CLASS EOLS eof
+    LL_SYMBOL(LL_TERMINAL, LL_T_EOF),
+    LL_SYMBOL(LL_NONTERMINAL, LL_N_EOLS),
+    LL_SYMBOL(LL_NONTERMINAL, LL_N_CLASS),
+    LL_SYMBOL(LL_TERMINAL, LL_T_EOL),
+    LL_SYMBOL(LL_NONTERMINAL, LL_N_PROLOG),
+    LL_SYMBOL(LL_NONTERMINAL, LL_N_EOLS),
+    // EOLS -> eol
+    LL_SYMBOL(LL_TERMINAL, LL_T_EOL),
+    // EOLS -> ε
+    // PROLOG -> import EOLS string:ifj25 for EOLS Ifj
+    LL_SYMBOL(LL_TERMINAL, LL_T_IFJ),
+    LL_SYMBOL(LL_NONTERMINAL, LL_N_EOLS),
+    LL_SYMBOL(LL_TERMINAL, LL_T_FOR),
+    LL_SYMBOL(LL_TERMINAL, LL_T_STRING_IFJ25),
+    LL_SYMBOL(LL_NONTERMINAL, LL_N_EOLS),
+    LL_SYMBOL(LL_TERMINAL, LL_T_IMPORT),
+    // CLASS -> class id:Program { eol @definitions DEF_FUN_LIST }
+    LL_SYMBOL(LL_TERMINAL, LL_T_RCURLY),
+    LL_SYMBOL(LL_NONTERMINAL, LL_N_DEF_FUN_LIST),
+    LL_SYMBOL(LL_ACTION, LL_A_DEFINITIONS),
+    LL_SYMBOL(LL_TERMINAL, LL_T_EOL),
+    LL_SYMBOL(LL_TERMINAL, LL_T_LCURLY),
+    LL_SYMBOL(LL_TERMINAL, LL_T_ID_PROGRAM),
+    LL_SYMBOL(LL_TERMINAL, LL_T_CLASS),
+    // DEF_FUN_LIST -> DEF_FUN @link_definition DEF_FUN_LIST
+    LL_SYMBOL(LL_NONTERMINAL, LL_N_DEF_FUN_LIST),
+    LL_SYMBOL(LL_ACTION, LL_A_LINK_DEFINITION),
+    LL_SYMBOL(LL_NONTERMINAL, LL_N_DEF_FUN),
+    // DEF_FUN_LIST -> ε
+    // DEF_FUN -> static id @identifier DEF_FUN_TAIL
+    LL_SYMBOL(LL_NONTERMINAL, LL_N_DEF_FUN_TAIL),
+    LL_SYMBOL(LL_ACTION, LL_A_IDENTIFIER),
+    LL_SYMBOL(LL_TERMINAL, LL_T_ID),
+    LL_SYMBOL(LL_TERMINAL, LL_T_STATIC),
+    // DEF_FUN_TAIL -> @getter BLOCK @set_right eol
+    LL_SYMBOL(LL_TERMINAL, LL_T_EOL),
+    LL_SYMBOL(LL_ACTION, LL_A_SET_RIGHT),
+    LL_SYMBOL(LL_NONTERMINAL, LL_N_BLOCK),
+    LL_SYMBOL(LL_ACTION, LL_A_GETTER),
+    // DEF_FUN_TAIL -> = @setter ( id @identifier @set_left ) BLOCK @set_right eol
+    LL_SYMBOL(LL_TERMINAL, LL_T_EOL),
+    LL_SYMBOL(LL_ACTION, LL_A_SET_RIGHT),
+    LL_SYMBOL(LL_NONTERMINAL, LL_N_BLOCK),
+    LL_SYMBOL(LL_TERMINAL, LL_T_RPAREN),
+    LL_SYMBOL(LL_ACTION, LL_A_SET_LEFT),
+    LL_SYMBOL(LL_ACTION, LL_A_IDENTIFIER),
+    LL_SYMBOL(LL_TERMINAL, LL_T_ID),
+    LL_SYMBOL(LL_TERMINAL, LL_T_LPAREN),
+    LL_SYMBOL(LL_ACTION, LL_A_SETTER),
+    LL_SYMBOL(LL_TERMINAL, LL_T_EQUAL),
+    // DEF_FUN_TAIL -> ( @function @arguments ARGUMENT_LIST ) @pop @lazy_body BLOCK @set_right eol
+    LL_SYMBOL(LL_TERMINAL, LL_T_EOL),
+    LL_SYMBOL(LL_ACTION, LL_A_SET_RIGHT),
+    LL_SYMBOL(LL_NONTERMINAL, LL_N_BLOCK),
+    LL_SYMBOL(LL_ACTION, LL_A_LAZY_BODY),
+    LL_SYMBOL(LL_ACTION, LL_A_POP),
+    LL_SYMBOL(LL_TERMINAL, LL_T_RPAREN),
+    LL_SYMBOL(LL_NONTERMINAL, LL_N_ARGUMENT_LIST),
+    LL_SYMBOL(LL_ACTION, LL_A_ARGUMENTS),
+    LL_SYMBOL(LL_ACTION, LL_A_FUNCTION),
+    LL_SYMBOL(LL_TERMINAL, LL_T_LPAREN),
+    // ARGUMENT_LIST -> id @argument @identifier @set_right ARGUMENT_TAIL
+    LL_SYMBOL(LL_NONTERMINAL, LL_N_ARGUMENT_TAIL),
+    LL_SYMBOL(LL_ACTION, LL_A_SET_RIGHT),
+    LL_SYMBOL(LL_ACTION, LL_A_IDENTIFIER),
+    LL_SYMBOL(LL_ACTION, LL_A_ARGUMENT),
+    LL_SYMBOL(LL_TERMINAL, LL_T_ID),
+    // ARGUMENT_LIST -> ε
+    // ARGUMENT_TAIL -> , id @argument @identifier @set_right ARGUMENT_TAIL
+    LL_SYMBOL(LL_NONTERMINAL, LL_N_ARGUMENT_TAIL),
+    LL_SYMBOL(LL_ACTION, LL_A_SET_RIGHT),
+    LL_SYMBOL(LL_ACTION, LL_A_IDENTIFIER),
+    LL_SYMBOL(LL_ACTION, LL_A_ARGUMENT),
+    LL_SYMBOL(LL_TERMINAL, LL_T_ID),
+    LL_SYMBOL(LL_TERMINAL, LL_T_COMMA),
+    // ARGUMENT_TAIL -> ε
+    // BLOCK -> { @block eol STML_LIST @pop }
+    LL_SYMBOL(LL_TERMINAL, LL_T_RCURLY),
+    LL_SYMBOL(LL_ACTION, LL_A_POP),
+    LL_SYMBOL(LL_NONTERMINAL, LL_N_STML_LIST),
+    LL_SYMBOL(LL_TERMINAL, LL_T_EOL),
+    LL_SYMBOL(LL_ACTION, LL_A_BLOCK),
+    LL_SYMBOL(LL_TERMINAL, LL_T_LCURLY),
+    // STML_LIST -> STML_LINE @append STML_LIST
+    LL_SYMBOL(LL_NONTERMINAL, LL_N_STML_LIST),
+    LL_SYMBOL(LL_ACTION, LL_A_APPEND),
+    LL_SYMBOL(LL_NONTERMINAL, LL_N_STML_LINE),
+    // STML_LIST -> ε
+    // STML_LINE -> STML eol
+    LL_SYMBOL(LL_TERMINAL, LL_T_EOL),
+    LL_SYMBOL(LL_NONTERMINAL, LL_N_STML),
+    // STML -> VAR
+    LL_SYMBOL(LL_NONTERMINAL, LL_N_VAR),
+    // STML -> IF
+    LL_SYMBOL(LL_NONTERMINAL, LL_N_IF),
+    // STML -> WHILE
+    LL_SYMBOL(LL_NONTERMINAL, LL_N_WHILE),
+    // STML -> RETURN
+    LL_SYMBOL(LL_NONTERMINAL, LL_N_RETURN),
+    // STML -> id @identifier STML_ID
+    LL_SYMBOL(LL_NONTERMINAL, LL_N_STML_ID),
+    LL_SYMBOL(LL_ACTION, LL_A_IDENTIFIER),
+    LL_SYMBOL(LL_TERMINAL, LL_T_ID),
+    // STML -> global_id @identifier STML_ID
+    LL_SYMBOL(LL_NONTERMINAL, LL_N_STML_ID),
+    LL_SYMBOL(LL_ACTION, LL_A_IDENTIFIER),
+    LL_SYMBOL(LL_TERMINAL, LL_T_GLOBAL_ID),
+    // STML -> BLOCK
+    LL_SYMBOL(LL_NONTERMINAL, LL_N_BLOCK),
+    // STML -> ( @nothing @arguments PARAMETER_LIST ) @pop
+    LL_SYMBOL(LL_ACTION, LL_A_POP),
+    LL_SYMBOL(LL_TERMINAL, LL_T_RPAREN),
+    LL_SYMBOL(LL_NONTERMINAL, LL_N_PARAMETER_LIST),
+    LL_SYMBOL(LL_ACTION, LL_A_ARGUMENTS),
+    LL_SYMBOL(LL_ACTION, LL_A_NOTHING),
+    LL_SYMBOL(LL_TERMINAL, LL_T_LPAREN),
+    // STML_ID -> ( @call @arguments PARAMETER_LIST ) @pop
+    LL_SYMBOL(LL_ACTION, LL_A_POP),
+    LL_SYMBOL(LL_TERMINAL, LL_T_RPAREN),
+    LL_SYMBOL(LL_NONTERMINAL, LL_N_PARAMETER_LIST),
+    LL_SYMBOL(LL_ACTION, LL_A_ARGUMENTS),
+    LL_SYMBOL(LL_ACTION, LL_A_CALL),
+    LL_SYMBOL(LL_TERMINAL, LL_T_LPAREN),
+    // STML_ID -> = @assign EXPRESSION @set_right @pop
+    LL_SYMBOL(LL_ACTION, LL_A_POP),
+    LL_SYMBOL(LL_ACTION, LL_A_SET_RIGHT),
+    LL_SYMBOL(LL_NONTERMINAL, LL_N_EXPRESSION),
+    LL_SYMBOL(LL_ACTION, LL_A_ASSIGN),
+    LL_SYMBOL(LL_TERMINAL, LL_T_EQUAL),
+    // VAR -> var @var id @identifier @set_left
+    LL_SYMBOL(LL_ACTION, LL_A_SET_LEFT),
+    LL_SYMBOL(LL_ACTION, LL_A_IDENTIFIER),
+    LL_SYMBOL(LL_TERMINAL, LL_T_ID),
+    LL_SYMBOL(LL_ACTION, LL_A_VAR),
+    LL_SYMBOL(LL_TERMINAL, LL_T_VAR),
+    // IF -> if @if ( @remap_on EXPRESSION @set_left ) @remap_off @remap_on BLOCK @remap_off @set_right else @else @remap_on BLOCK @remap_off @set_right @pop
+    LL_SYMBOL(LL_ACTION, LL_A_POP),
+    LL_SYMBOL(LL_ACTION, LL_A_SET_RIGHT),
+    LL_SYMBOL(LL_ACTION, LL_A_REMAP_OFF),
+    LL_SYMBOL(LL_NONTERMINAL, LL_N_BLOCK),
+    LL_SYMBOL(LL_ACTION, LL_A_REMAP_ON),
+    LL_SYMBOL(LL_ACTION, LL_A_ELSE),
+    LL_SYMBOL(LL_TERMINAL, LL_T_ELSE),
+    LL_SYMBOL(LL_ACTION, LL_A_SET_RIGHT),
+    LL_SYMBOL(LL_ACTION, LL_A_REMAP_OFF),
+    LL_SYMBOL(LL_NONTERMINAL, LL_N_BLOCK),
+    LL_SYMBOL(LL_ACTION, LL_A_REMAP_ON),
+    LL_SYMBOL(LL_ACTION, LL_A_REMAP_OFF),
+    LL_SYMBOL(LL_TERMINAL, LL_T_RPAREN),
+    LL_SYMBOL(LL_ACTION, LL_A_SET_LEFT),
+    LL_SYMBOL(LL_NONTERMINAL, LL_N_EXPRESSION),
+    LL_SYMBOL(LL_ACTION, LL_A_REMAP_ON),
+    LL_SYMBOL(LL_TERMINAL, LL_T_LPAREN),
+    LL_SYMBOL(LL_ACTION, LL_A_IF),
+    LL_SYMBOL(LL_TERMINAL, LL_T_IF),
+    // WHILE -> while @while ( EXPRESSION @set_left ) BLOCK @set_right
+    LL_SYMBOL(LL_ACTION, LL_A_SET_RIGHT),
+    LL_SYMBOL(LL_NONTERMINAL, LL_N_BLOCK),
+    LL_SYMBOL(LL_TERMINAL, LL_T_RPAREN),
+    LL_SYMBOL(LL_ACTION, LL_A_SET_LEFT),
+    LL_SYMBOL(LL_NONTERMINAL, LL_N_EXPRESSION),
+    LL_SYMBOL(LL_TERMINAL, LL_T_LPAREN),
+    LL_SYMBOL(LL_ACTION, LL_A_WHILE),
+    LL_SYMBOL(LL_TERMINAL, LL_T_WHILE),
+    // RETURN -> return @return RETURN_VALUE
+    LL_SYMBOL(LL_NONTERMINAL, LL_N_RETURN_VALUE),
+    LL_SYMBOL(LL_ACTION, LL_A_RETURN),
+    LL_SYMBOL(LL_TERMINAL, LL_T_RETURN),
+    // RETURN_VALUE -> EXPRESSION @set_left
+    LL_SYMBOL(LL_ACTION, LL_A_SET_LEFT),
+    LL_SYMBOL(LL_NONTERMINAL, LL_N_EXPRESSION),
+    // RETURN_VALUE -> @reject eol
+    LL_SYMBOL(LL_TERMINAL, LL_T_EOL),
+    LL_SYMBOL(LL_ACTION, LL_A_REJECT),
+    // RETURN_VALUE -> @reject }
+    LL_SYMBOL(LL_TERMINAL, LL_T_RCURLY),
+    LL_SYMBOL(LL_ACTION, LL_A_REJECT),
+    // PARAMETER_LIST -> @argument @remap_on EXPRESSION @remap_off @set_right PARAMETER_TAIL
+    LL_SYMBOL(LL_NONTERMINAL, LL_N_PARAMETER_TAIL),
+    LL_SYMBOL(LL_ACTION, LL_A_SET_RIGHT),
+    LL_SYMBOL(LL_ACTION, LL_A_REMAP_OFF),
+    LL_SYMBOL(LL_NONTERMINAL, LL_N_EXPRESSION),
+    LL_SYMBOL(LL_ACTION, LL_A_REMAP_ON),
+    LL_SYMBOL(LL_ACTION, LL_A_ARGUMENT),
+    // PARAMETER_LIST -> ε
+    // PARAMETER_TAIL -> , @argument @remap_on EXPRESSION @remap_off @set_right PARAMETER_TAIL
+    LL_SYMBOL(LL_NONTERMINAL, LL_N_PARAMETER_TAIL),
+    LL_SYMBOL(LL_ACTION, LL_A_SET_RIGHT),
+    LL_SYMBOL(LL_ACTION, LL_A_REMAP_OFF),
+    LL_SYMBOL(LL_NONTERMINAL, LL_N_EXPRESSION),
+    LL_SYMBOL(LL_ACTION, LL_A_REMAP_ON),
+    LL_SYMBOL(LL_ACTION, LL_A_ARGUMENT),
+    LL_SYMBOL(LL_TERMINAL, LL_T_COMMA),
+    // PARAMETER_TAIL -> ε
+    // EXPRESSION -> expression EXPRESSION_TAIL
+    LL_SYMBOL(LL_NONTERMINAL, LL_N_EXPRESSION_TAIL),
+    LL_SYMBOL(LL_HANDOFF, LL_H_EXPRESSION),
+    // EXPRESSION_TAIL -> call @arguments PARAMETER_LIST ) @pop @wrap_call
+    LL_SYMBOL(LL_ACTION, LL_A_WRAP_CALL),
+    LL_SYMBOL(LL_ACTION, LL_A_POP),
+    LL_SYMBOL(LL_TERMINAL, LL_T_RPAREN),
+    LL_SYMBOL(LL_NONTERMINAL, LL_N_PARAMETER_LIST),
+    LL_SYMBOL(LL_ACTION, LL_A_ARGUMENTS),
+    LL_SYMBOL(LL_TERMINAL, LL_T_CALL),
+    // EXPRESSION_TAIL -> ε
+};
+
+/// Productions: offset into ll_rhs and length
+static const struct {
+    uint16_t offset;
+    uint8_t length;
+} ll_productions[] = {
+    {0, 6},
+    {6, 1},
+    {7, 0},
+    {7, 6},
+    {13, 7},
+    {20, 3},
+    {23, 0},
+    {23, 4},
+    {27, 4},
+    {31, 10},
+    {41, 10},
+    {51, 5},
+    {56, 0},
+    {56, 6},
+    {62, 0},
+    {62, 6},
+    {68, 3},
+    {71, 0},
+    {71, 2},
+    {73, 1},
+    {74, 1},
+    {75, 1},
+    {76, 1},
+    {77, 3},
+    {80, 3},
+    {83, 1},
+    {84, 6},
+    {90, 6},
+    {96, 5},
+    {101, 5},
+    {106, 19},
+    {125, 8},
+    {133, 3},
+    {136, 2},
+    {138, 2},
+    {140, 2},
+    {142, 6},
+    {148, 0},
+    {148, 7},
+    {155, 0},
+    {155, 2},
+    {157, 6},
+    {163, 0},
+};
+
+/// Production to expand a nonterminal by on a token class (-1: syntax error)
+static const int16_t ll_table[LL_NONTERMINAL_COUNT][LL_CLASS_COUNT] = {
+    {0, -1, 0, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {1, 2, 2, 2, -1, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {-1, -1, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {-1, -1, -1, -1, -1, -1, 4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {-1, -1, -1, -1, -1, -1, -1, -1, -1, 6, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {-1, -1, -1, -1, -1, -1, -1, -1, 8, -1, -1, 9, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {-1, -1, -1, -1, -1, -1, -1, 11, -1, -1, -1, -1, -1, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 14, 13, -1, -1, -1, -1, -1, -1, -1, -1},
+    {-1, -1, -1, -1, -1, -1, -1, -1, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {-1, -1, -1, -1, -1, -1, -1, 16, 16, 17, -1, -1, 16, -1, -1, 16, 16, 16, -1, 16, 16, -1, -1},
+    {-1, -1, -1, -1, -1, -1, -1, 18, 18, -1, -1, -1, 18, -1, -1, 18, 18, 18, -1, 18, 18, -1, -1},
+    {-1, -1, -1, -1, -1, -1, -1, 23, 25, -1, -1, -1, 26, -1, -1, 24, 19, 20, -1, 21, 22, -1, -1},
+    {-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 28, 27, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+    {-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 29, -1, -1, -1, -1, -1, -1},
+    {-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 30, -1, -1, -1, -1, -1},
+    {-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 31, -1, -1, -1},
+    {-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 32, -1, -1},
+    {34, 33, 33, 33, 33, 33, 33, 33, 33, 35, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33},
+    {36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 36, 37, 36, 36, 36, 36, 36, 36, 36, 36, 36},
+    {-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 39, 38, -1, -1, -1, -1, -1, -1, -1, -1},
+    {40, 40, 40, 40, 40, 40, 40, 40, 40, 40, 40, 40, 40, 40, 40, 40, 40, 40, 40, 40, 40, 40, 40},
+    {42, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 42, 42, -1, -1, -1, -1, -1, -1, 41, -1},
+};
+
+#endif // PARSE_TABLE_H
@@ -4,1086 +4,944 @@
  * @brief Performs syntactic analysis (parsing) of the IFJ25 code and constructs
  * the abstract syntax tree (AST).
  * @details
- * This module implements a recursive descent parser for the IFJ25 programming
- * language. It reads tokens from the scanner, creates nodes, and fills the AST
- * tree using recursive descent parsing technique.
+ * This module implements a table-driven LL(1) parser for the IFJ25 programming
+ * language. The parse table is generated from grammar.txt by tools/ll1gen
+ * (parse_table.h). The driver expands nonterminals on an explicit stack, so
+ * neither deeply nested blocks nor long statement lists use the C stack.
+ * Expressions are handed off to the precedence parser, and the semantic
+ * actions of the grammar (`@name`) build the AST on a stack of nodes.
+ * In lazy mode the bodies of functions are only skimmed for their closing
+ * brace and parsed later, when semantic analysis calls `parser_parse_body`.
  */
 #include "parser.h"
+#include "arena.h"
 #include "ast.h"
 #include "error.h"
 #include "expr_parser.h"
+#include "intern.h"
+#include "parse_table.h"
 #include "scanner.h"
 #include "symtable.h"
+#include "work_pool.h"
+#include <ctype.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
-static void next_token(Token *token);
-static void token_control(TokenType expected_type, const void *expected_value);
-static void eol();
-static void skip_eol();
+// State of the current parser run, private to the calling thread
+static _Thread_local Scanner *scanner; // Scanner of the current parser run
+static _Thread_local Token token;
+static _Thread_local int rc = NO_ERROR;
+static _Thread_local unsigned parse_threads; // threads parsing definitions
+static _Thread_local ExprParserKind expression_kind;
+static _Thread_local bool lazy_bodies; // defer bodies of functions
+static _Thread_local Scanner *lazy_source; // scanner skimmed, NULL if not
 
-static ASTNode *IF();
-static ASTNode *WHILE();
-static ASTNode *VAR();
-static ASTNode *STML();
-static ASTNode *STML_LINE();
-static void STML_LIST(ASTNode *function);
-static ASTNode *BLOCK();
-static ASTNode *PARAMETER_TAIL(ASTNode *node);
-static ASTNode *PARAMETER_LIST();
-static ASTNode *DEF_FUN_TAIL(char *id);
-static ASTNode *DEF_FUN();
-static ASTNode *DEF_FUN_LIST(ASTNode *current_token);
-static ASTNode *FUNC_CALL(ASTNode *id_node);
-static void CLASS(ASTNode *PROGRAM);
-static void PROLOG();
-static ASTNode *EXPRESSION();
-
-Keyword expected_keyword;
-Token token;
-int rc = NO_ERROR;
-int token_output = NO_ERROR;
-
-/**
- * @brief Skips EOL tokens and sets the global token variable to the next
- * non-EOL token.
- * @return int Error code.
- */
-static void skip_eol() {
-    while (token.type == TOKEN_EOL) {
-        next_token(&token);
-        if (rc != NO_ERROR)
-            return;
-    }
-    return;
-}
 /**
- * @brief Function to get the next token and update the global token
- * variable, checks for errors.
- * @param token Pointer to the Token structure to be updated.
+ * @brief State of one run of the LL(1) driver.
+ * @details A matched terminal is replaced by the next token only when the
+ * driver needs to look at it, so an action placed right after a terminal
+ * (such as `@remap_off`) runs before that token is read.
  */
-static void next_token(Token *token) {
-    if (rc != NO_ERROR)
-        return;
-    token_output = get_token(token);
-    if (token_output != NO_ERROR) {
-        rc = token_output;
-    }
-}
+typedef struct {
+    uint16_t *symbols; ///< grammar symbols still to parse, top at the end
+    size_t depth;
+    size_t symbol_capacity;
+    ASTNode **values; ///< nodes under construction, top at the end
+    size_t count;
+    size_t value_capacity;
+    Token matched;            ///< last matched terminal
+    bool pending;             ///< `token` is still the matched terminal
+    unsigned lookahead;       ///< token class of `token` (LL_T_...)
+    unsigned remap;           ///< open `@remap_on` regions
+    ASTNode *last_definition; ///< PROGRAM or the last linked definition
+} Driver;
+
+static ASTNode *parse_definitions_parallel(ASTNode *PROGRAM);
+static void lazy_body(Driver *driver);
 
 /**
- * @brief Function to control if the current token matches the expected
- * type and value.
- * @param expected_type The expected TokenType.
- * @param expected_value Pointer to the expected value (for keywords,
- * identifiers, strings).
+ * @brief Token class (parse table column) of a token.
  */
-static void token_control(TokenType expected_type, const void *expected_value) {
-    if (rc != NO_ERROR)
-        return;
-    if (token.type != expected_type) {
-        rc = SYNTAX_ERROR;
-
-        return;
-    }
-    switch (expected_type) {
-    case TOKEN_KEYWORD:
-        if (token.value.keyword != *(const Keyword *)expected_value) {
-            rc = SYNTAX_ERROR;
-            return;
-        }
-        return;
-    case TOKEN_STRING:
-        if (token.value.string == NULL ||
-            d_string_cmp(token.value.string, expected_value)) {
-            rc = SYNTAX_ERROR;
-            return;
-        }
-        return;
+static unsigned token_class(const Token *token) {
+    switch (token->type) {
+    case TOKEN_EOL:
+        return LL_T_EOL;
+    case TOKEN_EOF:
+        return LL_T_EOF;
     case TOKEN_IDENTIFIER:
-        if (expected_value != NULL) {
-            if (token.value.string == NULL ||
-                d_string_cmp(token.value.string, expected_value)) {
-                rc = SYNTAX_ERROR;
-                return;
-            }
+        return LL_T_ID;
+    case TOKEN_GLOBAL_VAR:
+        return LL_T_GLOBAL_ID;
+    case TOKEN_STRING:
+        return LL_T_STRING;
+    case TOKEN_LPAREN:
+        return LL_T_LPAREN;
+    case TOKEN_RPAREN:
+        return LL_T_RPAREN;
+    case TOKEN_LCURLY:
+        return LL_T_LCURLY;
+    case TOKEN_RCURLY:
+        return LL_T_RCURLY;
+    case TOKEN_EQUAL:
+        return LL_T_EQUAL;
+    case TOKEN_COMMA:
+        return LL_T_COMMA;
+    case TOKEN_KEYWORD:
+        switch (token->value.keyword) {
+        case KEYWORD_IMPORT:
+            return LL_T_IMPORT;
+        case KEYWORD_FOR:
+            return LL_T_FOR;
+        case KEYWORD_IFJ:
+            return LL_T_IFJ;
+        case KEYWORD_CLASS:
+            return LL_T_CLASS;
+        case KEYWORD_STATIC:
+            return LL_T_STATIC;
+        case KEYWORD_VAR:
+            return LL_T_VAR;
+        case KEYWORD_IF:
+            return LL_T_IF;
+        case KEYWORD_ELSE:
+            return LL_T_ELSE;
+        case KEYWORD_WHILE:
+            return LL_T_WHILE;
+        case KEYWORD_RETURN:
+            return LL_T_RETURN;
+        default:
+            return LL_T_OTHER;
         }
-        return;
     default:
-        return;
+        return LL_T_OTHER;
     }
 }
+
 /**
- * @brief Function to parse a function call, creating an AST node for it.
- * @param id_node The AST node representing the function identifier.
- * @return ASTNode* The AST node representing the function call.
- * Grammar: Function call is part of STML_ID -> ( ARGUMENT_LIST )
+ * @brief Stops the run with an error code.
+ * @details Inside a `@remap_on` region every parser error is a syntax
+ * error; lexical errors keep SCANNER_ERROR.
  */
-static ASTNode *FUNC_CALL(ASTNode *id_node) {
-    next_token(&token);
-    if (rc != NO_ERROR)
-        return NULL;
-    ASTNode *call_node = create_ast_node(AST_FUNC_CALL, id_node->name);
-    if (call_node == NULL) {
-        rc = ERROR_INTERNAL;
-        return NULL;
-    }
-
-    call_node->left = PARAMETER_LIST();
-    if (rc != NO_ERROR)
-        return NULL;
-
-    token_control(TOKEN_RPAREN, NULL);
-    if (rc != NO_ERROR)
-        return NULL;
-    next_token(&token);
-    if (rc != NO_ERROR)
-        return NULL;
-    return call_node;
+static void fail(Driver *driver, int code) {
+    rc = driver->remap > 0 && code != SCANNER_ERROR ? SYNTAX_ERROR : code;
 }
 
 /**
- * @brief Function parses an expression using the precedence parser and performs
- * additional handling for function calls (parsing argument list and wrapping
- * the resulting subtree).
- * @return ASTNode* The AST node representing the expression.
- * Grammar: EXPRESSION -> id ( ARGUMENT_LIST ) | EXPR_PARSER
- *          EXPR_PARSER handles operators, literals, and identifiers
+ * @brief Function to get the next token and update the global token
+ * variable, checks for errors.
  */
-static ASTNode *EXPRESSION() {
-    int error_code = NO_ERROR;
-    ASTNode *expressionTree = main_precedence_parser(&token, &error_code);
-    if (expressionTree == NULL || error_code != NO_ERROR) {
-        rc = SYNTAX_ERROR;
-        return NULL;
-    }
-    if (expressionTree->type == AST_FUNC_CALL) {
-        next_token(&token);
-        if (rc != NO_ERROR)
-            return NULL;
-        expressionTree->left = PARAMETER_LIST();
-        if (rc != NO_ERROR)
-            return NULL;
-        token_control(TOKEN_RPAREN, NULL);
-        if (rc != NO_ERROR)
-            return NULL;
-        next_token(&token);
-        if (rc != NO_ERROR)
-            return NULL;
-        ASTNode *expressionWrpaper = create_ast_node(AST_EXPRESSION, NULL);
-        if (expressionWrpaper == NULL) {
-            rc = ERROR_INTERNAL;
-            return NULL;
-        }
-        expressionWrpaper->left = expressionTree;
-        expressionTree = expressionWrpaper;
+static void next_token(Driver *driver) {
+    int result = get_token(scanner, &token);
+    if (result != NO_ERROR) {
+        fail(driver, result);
     }
-
-    return expressionTree;
+    driver->lookahead = token_class(&token);
 }
 
 /**
- * @brief Function to parse an if statement, creating an AST node for it.
- * @return ASTNode* The AST node representing the if statement.
- * Grammar: IF -> if ( EXPRESSION ) BLOCK else BLOCK
- * Note: 'if' keyword is already consumed before calling this function.
+ * @brief Replaces the matched terminal by the token following it.
  */
-static ASTNode *IF() {
-    ASTNode *node = create_ast_node(AST_IF, NULL);
-    if (node == NULL) {
-        rc = ERROR_INTERNAL;
-        return NULL;
-    }
-
-    next_token(&token);
-    if (rc != NO_ERROR) {
-        return NULL;
-    }
-
-    token_control(TOKEN_LPAREN, NULL);
-    if (rc != NO_ERROR) {
-        return NULL;
-    }
-
-    next_token(&token);
-    if (rc != NO_ERROR) {
-        return NULL;
+static void fetch(Driver *driver) {
+    if (driver->pending) {
+        driver->pending = false;
+        next_token(driver);
     }
+}
 
-    node->left = EXPRESSION();
-    if (rc != NO_ERROR) {
-        rc = SYNTAX_ERROR;
-        return NULL;
-    }
+/**
+ * @brief Grows the symbol stack to hold `count` more symbols.
+ */
+static bool reserve_symbols(Driver *driver, size_t count) {
+    size_t capacity =
+        driver->symbol_capacity ? driver->symbol_capacity * 2 : 256;
+    while (capacity < driver->depth + count) {
+        capacity *= 2;
+    }
+    uint16_t *grown = realloc(driver->symbols, capacity * sizeof(uint16_t));
+    if (grown == NULL) {
+        fail(driver, ERROR_INTERNAL);
+        return false;
+    }
+    driver->symbols = grown;
+    driver->symbol_capacity = capacity;
+    return true;
+}
 
-    token_control(TOKEN_RPAREN, NULL);
-    if (rc != NO_ERROR) {
-        rc = SYNTAX_ERROR;
-        return NULL;
+static inline void push_symbols(Driver *driver, const uint16_t *symbols,
+                                size_t count) {
+    if (driver->depth + count > driver->symbol_capacity &&
+        !reserve_symbols(driver, count)) {
+        return;
     }
-
-    next_token(&token);
-    if (rc != NO_ERROR) {
-        return NULL;
+    for (size_t i = 0; i < count; i++) {
+        driver->symbols[driver->depth + i] = symbols[i];
     }
+    driver->depth += count;
+}
 
-    node->right = BLOCK();
-    if (rc != NO_ERROR) {
-        rc = SYNTAX_ERROR;
-        return NULL;
-    };
-
-    next_token(&token);
-    if (rc != NO_ERROR) {
-        return NULL;
-    }
+/**
+ * @brief Grows the value stack by one slot at least.
+ */
+static bool reserve_value(Driver *driver) {
+    size_t capacity = driver->value_capacity ? driver->value_capacity * 2 : 64;
+    ASTNode **grown = realloc(driver->values, capacity * sizeof(ASTNode *));
+    if (grown == NULL) {
+        fail(driver, ERROR_INTERNAL);
+        return false;
+    }
+    driver->values = grown;
+    driver->value_capacity = capacity;
+    return true;
+}
 
-    expected_keyword = KEYWORD_ELSE;
-    token_control(TOKEN_KEYWORD, &expected_keyword);
-    if (rc != NO_ERROR) {
-        rc = SYNTAX_ERROR;
-        return NULL;
+static inline void push_value(Driver *driver, ASTNode *node) {
+    if (driver->count == driver->value_capacity && !reserve_value(driver)) {
+        return;
     }
+    driver->values[driver->count++] = node;
+}
 
-    // Create else node and attach to if statement
-    ASTNode *else_node = create_ast_node(AST_ELSE, NULL);
-    if (else_node == NULL) {
-        rc = ERROR_INTERNAL;
-        return NULL;
-    }
-    node->right->right = else_node;
+static inline ASTNode *pop_value(Driver *driver) {
+    return driver->values[--driver->count];
+}
 
-    next_token(&token);
-    if (rc != NO_ERROR) {
-        return NULL;
-    }
+static inline ASTNode *top_value(const Driver *driver) {
+    return driver->values[driver->count - 1];
+}
 
-    else_node->right = BLOCK();
-    else_node->left = NULL;
-    if (rc != NO_ERROR) {
-        rc = SYNTAX_ERROR;
+/**
+ * @brief Creates an AST node and pushes it on the value stack.
+ */
+static ASTNode *push_node(Driver *driver, ASTNodeType type, const char *name) {
+    ASTNode *node = create_ast_node(type, name);
+    if (node == NULL) {
+        fail(driver, ERROR_INTERNAL);
         return NULL;
     }
-
+    push_value(driver, node);
     return node;
 }
+
 /**
- * @brief Function to parse a while loop, creating an AST node for it.
- * @return ASTNode* The AST node representing the while loop.
- * Grammar: WHILE -> while ( EXPRESSION ) BLOCK
- * Note: 'while' keyword is already consumed before calling this function.
+ * @brief Matches the current token against a terminal of the grammar.
+ * @details `eol` matches one or more EOL tokens. Nothing is read past `eof`.
  */
-static ASTNode *WHILE() {
-    ASTNode *while_node = create_ast_node(AST_WHILE, NULL);
-    if (while_node == NULL) {
-        rc = ERROR_INTERNAL;
-        return NULL;
-    }
-    next_token(&token);
-    if (rc != NO_ERROR)
-        return NULL;
-
-    token_control(TOKEN_LPAREN, NULL);
+static void match(Driver *driver, unsigned terminal) {
+    fetch(driver);
     if (rc != NO_ERROR)
-        return NULL;
-    while_node->left = create_ast_node(AST_EXPRESSION, NULL);
-    if (while_node->left == NULL) {
-        rc = ERROR_INTERNAL;
-        return NULL;
+        return;
+    if (driver->lookahead != ll_terminal_class[terminal] ||
+        (ll_terminal_text[terminal] != NULL &&
+         token_text_cmp(scanner, &token, ll_terminal_text[terminal]) != 0)) {
+        fail(driver, SYNTAX_ERROR);
+        return;
     }
-    next_token(&token);
-    if (rc != NO_ERROR)
-        return NULL;
-
-    while_node->left = EXPRESSION();
-    if (rc != NO_ERROR)
-        return NULL;
-
-    token_control(TOKEN_RPAREN, NULL);
-    if (rc != NO_ERROR)
-        return NULL;
+    driver->matched = token;
+    if (terminal == LL_T_EOL) {
+        do {
+            next_token(driver);
+        } while (rc == NO_ERROR && token.type == TOKEN_EOL);
+    } else if (terminal != LL_T_EOF) {
+        driver->pending = true;
+    }
+}
 
-    next_token(&token);
+/**
+ * @brief Replaces a nonterminal by the production the table selects.
+ */
+static void expand(Driver *driver, unsigned nonterminal) {
+    fetch(driver);
     if (rc != NO_ERROR)
-        return NULL;
+        return;
+    int production = ll_table[nonterminal][driver->lookahead];
+    if (production < 0) {
+        fail(driver, SYNTAX_ERROR);
+        return;
+    }
+    push_symbols(driver, &ll_rhs[ll_productions[production].offset],
+                 ll_productions[production].length);
+}
 
-    while_node->right = BLOCK();
+/**
+ * @brief Function parses an expression using the selected expression parser.
+ * @details For the `id (` shortcut the expression parser returns the bare
+ * AST_FUNC_CALL and stops at the (; the arguments are then parsed by the
+ * grammar (EXPRESSION_TAIL), which sees the ( as `call`.
+ */
+static void expression(Driver *driver) {
+    fetch(driver);
     if (rc != NO_ERROR)
-        return NULL;
-    return while_node;
+        return;
+    int error_code = NO_ERROR;
+    ASTNode *expressionTree =
+        expression_kind == EXPR_PARSER_CLIMBING
+            ? climbing_expression_parser(scanner, &token, &error_code)
+            : main_precedence_parser(scanner, &token, &error_code);
+    if (expressionTree == NULL || error_code != NO_ERROR) {
+        fail(driver, error_code != NO_ERROR ? error_code : SYNTAX_ERROR);
+        return;
+    }
+    driver->lookahead = expressionTree->type == AST_FUNC_CALL
+                            ? LL_T_CALL
+                            : token_class(&token);
+    push_value(driver, expressionTree);
 }
+
 /**
- * @brief Function to parse a variable declaration, creating an AST node for
- * it.
- * @return ASTNode* The AST node representing the variable declaration.
- * Grammar: VAR -> var IDENTIFIER
- * Note: 'var' keyword is already consumed before calling this function.
+ * @brief Links a definition behind the previous one (or into the program).
+ * @param previous PROGRAM or the previous definition.
+ * @param function The definition to link.
+ * @details The first definition is the left child of PROGRAM, every other
+ * one the right sibling of the body of the previous definition.
  */
-static ASTNode *VAR() {
-    ASTNode *var_node = create_ast_node(AST_VAR_DECL, NULL);
-    if (var_node == NULL) {
-        rc = ERROR_INTERNAL;
-        return NULL;
+static void link_definition(ASTNode *previous, ASTNode *function) {
+    if (previous->right == NULL) {
+        if (previous->type == AST_PROGRAM) {
+            previous->left = function;
+        }
+    } else if (previous->right->right == NULL) {
+        previous->right->right = function;
     }
-    next_token(&token);
-    if (rc != NO_ERROR)
-        return NULL;
+}
 
-    token_control(TOKEN_IDENTIFIER, NULL);
-    if (rc != NO_ERROR)
-        return NULL;
-    var_node->left = create_ast_node(AST_IDENTIFIER, token.value.string->str);
-    if (var_node->left == NULL) {
-        rc = ERROR_INTERNAL;
-        return NULL;
+/**
+ * @brief Action `append`: links a statement behind the previous one of its block.
+ * @details Value stack: block, previous statement (or the block), statement.
+ * The first statement is the left child of the block, every other one goes
+ * to the end of the right chain of the previous one (which for an if runs
+ * through its branches). The parenthesized argument statement is NULL and
+ * leaves no trace.
+ */
+static void append_statement(Driver *driver) {
+    ASTNode *statement = pop_value(driver);
+    ASTNode *last = pop_value(driver);
+    ASTNode *block = top_value(driver);
+    if (statement != NULL) {
+        if (block->left == NULL) {
+            block->left = statement;
+        } else {
+            while (last->right != NULL) {
+                last = last->right;
+            }
+            last->right = statement;
+        }
+        last = statement;
     }
-
-    return var_node;
+    push_value(driver, last);
 }
+
 /**
- * @brief Function to parse a statement or list of statements and create AST
- * nodes for them.
- * @return ASTNode* The AST node representing the statement or list of
- * statements.
- * Grammar: STML -> VAR | IF | WHILE | RETURN | id STML_ID | BLOCK
- *          STML_ID -> ( ARGUMENT_LIST ) | = EXPRESSION
+ * @brief Runs a semantic action of the grammar.
+ * @details Lists (arguments, parameters, statements) are built through a
+ * cursor on the value stack: the node whose `left` receives the next item.
  */
-static ASTNode *STML() {
-    ASTNode *statement = NULL;
-
-    switch (token.type) {
-    case TOKEN_KEYWORD:
-        switch (token.value.keyword) {
-        case KEYWORD_VAR:
-            statement = VAR();
-            if (rc != NO_ERROR)
-                return NULL;
-
-            next_token(&token);
-            if (rc != NO_ERROR)
-                return NULL;
-
-            break;
-
-        case KEYWORD_IF: // if statement
-            statement = IF();
-            if (rc != NO_ERROR)
-                return NULL;
-
-            next_token(&token);
-            if (rc != NO_ERROR)
-                return NULL;
-            break;
-
-        case KEYWORD_WHILE:
-            statement = WHILE();
-            if (rc != NO_ERROR)
-                return NULL;
-
-            next_token(&token);
-            if (rc != NO_ERROR)
-                return NULL;
-            break;
+static void action(Driver *driver, unsigned name) {
+    ASTNode *node;
+    switch (name) {
+    case LL_A_DEFINITIONS:
+        if (parse_threads > 1 && !scanner->pretokenized && !scanner->pipe) {
+            driver->last_definition =
+                parse_definitions_parallel(driver->last_definition);
+            driver->lookahead = token_class(&token);
+        }
+        break;
+    case LL_A_LINK_DEFINITION:
+        node = pop_value(driver);
+        link_definition(driver->last_definition, node);
+        driver->last_definition = node;
+        break;
+    case LL_A_IDENTIFIER:
+        push_node(driver, AST_IDENTIFIER, driver->matched.value.name);
+        break;
 
-        case KEYWORD_RETURN:
-            // Grammar: RETURN -> return EXPRESSION
-            next_token(&token);
-            if (rc != NO_ERROR)
-                return NULL;
+    // The definition or call is created from its name once the next token
+    // tells what it is
+    case LL_A_GETTER:
+        top_value(driver)->type = AST_GETTER_DEF;
+        break;
+    case LL_A_SETTER:
+        top_value(driver)->type = AST_SETTER_DEF;
+        break;
+    case LL_A_FUNCTION:
+        top_value(driver)->type = AST_FUNC_DEF;
+        break;
+    case LL_A_CALL:
+        top_value(driver)->type = AST_FUNC_CALL;
+        break;
 
-            statement = create_ast_node(AST_RETURN, NULL);
-            if (statement == NULL) {
-                rc = ERROR_INTERNAL;
-                return NULL;
-            }
-            if (token.type == TOKEN_EOL || token.type == TOKEN_RCURLY) {
-                rc = SYNTAX_ERROR;
-                return NULL;
-            } else {
-                statement->left = EXPRESSION();
-                if (rc != NO_ERROR)
-                    return NULL;
-            }
+    case LL_A_SET_LEFT:
+        node = pop_value(driver);
+        top_value(driver)->left = node;
+        break;
+    case LL_A_SET_RIGHT:
+        node = pop_value(driver);
+        top_value(driver)->right = node;
+        break;
+    case LL_A_POP:
+        pop_value(driver);
+        break;
+    case LL_A_LAZY_BODY:
+        lazy_body(driver);
+        break;
+    case LL_A_NOTHING:
+        push_value(driver, NULL);
+        break;
+    case LL_A_ARGUMENTS:
+        push_value(driver, top_value(driver));
+        break;
+    case LL_A_ARGUMENT: {
+        ASTNode *argument = create_ast_node(AST_FUNC_ARG, NULL);
+        if (argument == NULL) {
+            fail(driver, ERROR_INTERNAL);
             break;
-
-        default:
-            rc = SYNTAX_ERROR;
-            return NULL;
         }
+        node = pop_value(driver);
+        if (node != NULL) {
+            node->left = argument;
+        }
+        push_value(driver, argument);
         break;
-
-    case TOKEN_LPAREN:
-        next_token(&token);
-        if (rc != NO_ERROR)
-            return NULL;
-
-        PARAMETER_LIST();
-        if (rc != NO_ERROR)
-            return NULL;
-
-        token_control(TOKEN_RPAREN, NULL);
-        if (rc != NO_ERROR)
-            return NULL;
-
-        next_token(&token);
-        if (rc != NO_ERROR)
-            return NULL;
-
+    }
+    case LL_A_BLOCK:
+        node = push_node(driver, AST_BLOCK, NULL);
+        if (node != NULL) {
+            push_value(driver, node);
+        }
         break;
-
-    case TOKEN_LCURLY:
-        statement = BLOCK();
-        if (rc != NO_ERROR)
-            return NULL;
-
-        next_token(&token);
-        if (rc != NO_ERROR)
-            return NULL;
-
+    case LL_A_APPEND:
+        append_statement(driver);
         break;
-
-    case TOKEN_IDENTIFIER:
-    case TOKEN_GLOBAL_VAR:
-        ASTNode *id_node =
-            create_ast_node(AST_IDENTIFIER, token.value.string->str);
-        if (id_node == NULL) {
-            rc = ERROR_INTERNAL;
-            return NULL;
+    case LL_A_ASSIGN: {
+        ASTNode *id_node = pop_value(driver);
+        ASTNode *assign_node = push_node(driver, AST_ASSIGN, NULL);
+        ASTNode *equals = assign_node ? push_node(driver, AST_EQUALS, NULL)
+                                      : NULL;
+        if (equals != NULL) {
+            assign_node->left = equals;
+            equals->left = id_node;
         }
-        next_token(&token);
-        if (rc != NO_ERROR)
-            return NULL;
-
-        if (token.type == TOKEN_LPAREN) { // CALL
-            ASTNode *call_node = FUNC_CALL(id_node);
-            if (rc != NO_ERROR)
-                return NULL;
-            statement = call_node;
-            break;
+        break;
+    }
+    case LL_A_VAR:
+        push_node(driver, AST_VAR_DECL, NULL);
+        break;
+    case LL_A_IF:
+        push_node(driver, AST_IF, NULL);
+        break;
+    case LL_A_ELSE:
+        node = top_value(driver);
+        if (push_node(driver, AST_ELSE, NULL) != NULL) {
+            node->right->right = top_value(driver);
         }
-
-        if (token.type == TOKEN_EQUAL) { // ASSIGNMENT
-            ASTNode *assign_node = create_ast_node(AST_ASSIGN, NULL);
-            if (assign_node == NULL) {
-                rc = ERROR_INTERNAL;
-                return NULL;
-            }
-            statement = assign_node;
-            assign_node->left = create_ast_node(AST_EQUALS, NULL);
-            if (assign_node->left == NULL) {
-                rc = ERROR_INTERNAL;
-                return NULL;
-            }
-            assign_node->left->left = id_node;
-
-            next_token(&token);
-            if (rc != NO_ERROR)
-                return NULL;
-
-            assign_node->left->right = EXPRESSION();
-            if (rc != NO_ERROR)
-                return NULL;
+        break;
+    case LL_A_WHILE:
+        push_node(driver, AST_WHILE, NULL);
+        break;
+    case LL_A_RETURN:
+        push_node(driver, AST_RETURN, NULL);
+        break;
+    case LL_A_REMAP_ON:
+        // The token opening the region is read outside of it
+        fetch(driver);
+        driver->remap++;
+        break;
+    case LL_A_REMAP_OFF:
+        driver->remap--;
+        break;
+    case LL_A_REJECT:
+        fail(driver, SYNTAX_ERROR);
+        break;
+    case LL_A_WRAP_CALL: {
+        // Read past the ) first, as the precedence parser does
+        fetch(driver);
+        if (rc != NO_ERROR)
             break;
+        ASTNode *call = pop_value(driver);
+        ASTNode *expressionWrapper = push_node(driver, AST_EXPRESSION, NULL);
+        if (expressionWrapper != NULL) {
+            expressionWrapper->left = call;
         }
-
-        rc = SYNTAX_ERROR;
-        return NULL;
         break;
-
+    }
     default:
-        rc = SYNTAX_ERROR;
-        return NULL;
+        fail(driver, ERROR_INTERNAL);
+        break;
     }
-    return statement;
-}
-/**
- * @brief Function to parse a single statement line, ensuring it ends with EOL.
- * @return ASTNode* The AST node representing the statement line.
- * Grammar: STML_LINE -> STML eol
- */
-static ASTNode *STML_LINE() {
-
-    ASTNode *current_function = STML();
-    if (rc != NO_ERROR)
-        return NULL;
-
-    eol();
-    if (rc != NO_ERROR)
-        return NULL;
-
-    return current_function;
 }
 
 /**
- * @brief Function to parse a list of statements within a block, linking them
- * as siblings in the AST.
- * @param block The AST node representing the current block context.
- * @return int Error code.
- * Grammar: STML_LIST -> STML_LINE STML_LIST | ε
+ * @brief Parses `start` with the LL(1) table; the result is on the value
+ * stack.
  */
-static void STML_LIST(ASTNode *block) {
-    if (!((token.type == TOKEN_RCURLY))) {
-        ASTNode *current_statement = STML_LINE();
-        if (rc != NO_ERROR)
-            return;
-
-        // Link statements as siblings using 'right' pointer
-        if (block->left == NULL) {
-            // First statement goes to left
-            block->left = current_statement;
-        } else {
-            // Subsequent statements chain via right
-            ASTNode *last = block->left;
-            // Find the last statement in the chain
-            while (last->right != NULL) {
-                last = last->right;
-            }
-            last->right = current_statement;
+static void run(Driver *driver, unsigned start) {
+    uint16_t symbol = LL_SYMBOL(LL_NONTERMINAL, start);
+    push_symbols(driver, &symbol, 1);
+    while (rc == NO_ERROR && driver->depth > 0) {
+        symbol = driver->symbols[--driver->depth];
+        switch (LL_KIND(symbol)) {
+        case LL_TERMINAL:
+            match(driver, LL_INDEX(symbol));
+            break;
+        case LL_NONTERMINAL:
+            expand(driver, LL_INDEX(symbol));
+            break;
+        case LL_ACTION:
+            action(driver, LL_INDEX(symbol));
+            break;
+        case LL_HANDOFF:
+            expression(driver);
+            break;
         }
-
-        STML_LIST(block);
-        if (rc != NO_ERROR)
-            return;
     }
+}
 
-    return;
+static void driver_free(Driver *driver) {
+    free(driver->symbols);
+    free(driver->values);
 }
 
 /**
- * @brief Function to ensure the current token is EOL and skip subsequent EOLs.
- * @return int Error code.
+ * @brief One definition of the class body, parsed on a worker thread.
  */
-static void eol() {
+typedef struct {
+    size_t start;     ///< offset of its `static` keyword
+    ASTNode *node;    ///< parsed definition
+    int rc;           ///< parser result for the definition
+    Token next;       ///< token following the definition
+    size_t next_start; ///< offset of that token
+    size_t position;  ///< scanner position after that token
+} Definition;
 
-    token_control(TOKEN_EOL, NULL);
-    if (rc != NO_ERROR)
-        return;
-    skip_eol();
-}
 /**
- * @brief Function to parse a block of code enclosed in curly braces,
- * creating an AST node for it.
- * @return ASTNode* The AST node representing the block.
- * Grammar: BLOCK -> { eol STML_LIST }
+ * @brief Shared state of one parallel parse of the class body.
  */
-static ASTNode *BLOCK() {
-    ASTNode *block = create_ast_node(AST_BLOCK, NULL);
-    if (block == NULL) {
-        rc = ERROR_INTERNAL;
-        return NULL;
+typedef struct {
+    Definition *definitions;
+    Scanner *scanners;  ///< one scanner per worker over the same source
+    Arena *arenas;      ///< parse arenas of workers 1..threads-1
+    InternLog *logs;    ///< names interned by each definition
+    InternTable *names; ///< intern table of the parser thread
+    ExprParserKind expressions; ///< expression parser of the parser thread
+    Scanner *lazy_source; ///< scanner of deferred bodies, or NULL
+} DefinitionSplit;
+
+/**
+ * @brief Skips a string literal starting at the opening quote.
+ * @return Offset after the closing quote (or the end of the line/source).
+ */
+static size_t skip_string(const char *data, size_t length, size_t i) {
+    if (i + 2 < length && data[i + 1] == '"' && data[i + 2] == '"') {
+        for (i += 3; i + 2 < length; i++) {
+            if (data[i] == '"' && data[i + 1] == '"' && data[i + 2] == '"') {
+                return i + 3;
+            }
+        }
+        return length;
     }
-    token_control(TOKEN_LCURLY, NULL);
-    if (rc != NO_ERROR) {
-        return NULL;
+    for (i++; i < length && data[i] != '"' && data[i] != '\n'; i++) {
+        if (data[i] == '\\') {
+            i++;
+        }
     }
+    return i + 1;
+}
 
-    next_token(&token);
-    if (rc != NO_ERROR) {
-        return NULL;
+/**
+ * @brief Skips a (nested) block comment starting at its slash.
+ * @return Offset after the comment (or the end of the source).
+ */
+static size_t skip_block_comment(const char *data, size_t length, size_t i) {
+    int depth = 0;
+    while (i + 1 < length) {
+        if (data[i] == '/' && data[i + 1] == '*') {
+            depth++;
+            i += 2;
+        } else if (data[i] == '*' && data[i + 1] == '/') {
+            i += 2;
+            if (--depth == 0) {
+                return i;
+            }
+        } else {
+            i++;
+        }
     }
+    return length;
+}
 
-    eol();
-    if (rc != NO_ERROR) {
-        return NULL;
+/**
+ * @brief Skips a string literal or a comment starting at offset `i`.
+ * @return Offset after it, or `i` when none starts there.
+ */
+static size_t skip_ignored(const char *data, size_t length, size_t i) {
+    if (data[i] == '"') {
+        return skip_string(data, length, i);
     }
-
-    STML_LIST(block);
-    if (rc != NO_ERROR) {
-        return block;
+    if (data[i] == '/' && i + 1 < length && data[i + 1] == '/') {
+        const char *newline = memchr(data + i, '\n', length - i);
+        return newline ? (size_t)(newline - data) : length;
     }
-
-    token_control(TOKEN_RCURLY, NULL);
-    if (rc != NO_ERROR) {
-        return NULL;
+    if (data[i] == '/' && i + 1 < length && data[i + 1] == '*') {
+        return skip_block_comment(data, length, i);
     }
-
-    return block;
+    return i;
 }
+
 /**
- * @brief Function to parse a list of parameters in a function call
- * or definition, creating AST nodes for them.
- * @param argument_node The AST node representing the current argument.
- * @return ASTNode* The AST node representing the list of parameters.
- * Grammar: PARAMETER_TAIL -> , id PARAMETER_TAIL | ε
+ * @brief Finds the `static` keywords at brace depth 0 of the class body.
+ * @param data Source text.
+ * @param length Length of the source text.
+ * @param from Offset inside the class body to start at.
+ * @param count Output: number of offsets found.
+ * @return Array of offsets (malloc'ed) or NULL when none were found.
+ * @details A byte-level pre-pass that only tracks strings, comments and
+ * braces. It can be fooled by malformed input; the caller checks every
+ * boundary against the real token stream.
  */
-ASTNode *PARAMETER_TAIL(ASTNode *argument_node) {
-    if (token.type != TOKEN_RPAREN) {
-        argument_node->left = create_ast_node(AST_FUNC_ARG, NULL);
-        if (argument_node->left == NULL) {
-            rc = ERROR_INTERNAL;
-            return NULL;
+static size_t *find_definitions(const char *data, size_t length, size_t from,
+                                size_t *count) {
+    size_t *starts = NULL;
+    size_t capacity = 0;
+    int depth = 0;
+    size_t i = from;
+
+    *count = 0;
+    while (i < length) {
+        char c = data[i];
+        size_t skipped = skip_ignored(data, length, i);
+        if (skipped != i) {
+            i = skipped;
+            continue;
         }
-        token_control(TOKEN_COMMA, NULL);
-        if (rc != NO_ERROR)
-            return NULL;
-
-        next_token(&token);
-        if (rc != NO_ERROR)
-            return NULL;
-
-        argument_node->left->right = EXPRESSION();
-        if (rc != NO_ERROR || argument_node->right == NULL ||
-            argument_node->right->type == AST_FUNC_CALL) {
-            rc = SYNTAX_ERROR;
-            return NULL;
+        if (isalpha((unsigned char)c) || c == '_') {
+            size_t word = i;
+            while (i < length &&
+                   (isalnum((unsigned char)data[i]) || data[i] == '_')) {
+                i++;
+            }
+            if (depth == 0 && i - word == 6 &&
+                memcmp(data + word, "static", 6) == 0) {
+                if (*count == capacity) {
+                    capacity = capacity ? capacity * 2 : 64;
+                    size_t *grown = realloc(starts, capacity * sizeof(size_t));
+                    if (grown == NULL) {
+                        free(starts);
+                        *count = 0;
+                        return NULL;
+                    }
+                    starts = grown;
+                }
+                starts[(*count)++] = word;
+            }
+            continue;
         }
-
-        PARAMETER_TAIL(argument_node->left);
-        if (rc != NO_ERROR)
-            return NULL;
-        return argument_node;
+        if (c == '{') {
+            depth++;
+        } else if (c == '}' && depth-- == 0) {
+            break; // end of the class body
+        }
+        i++;
     }
-    return NULL;
+    return starts;
 }
 
 /**
- * @brief Function to parse a list of parameters in a function call
- * or definition, creating AST nodes for them.
- * @return ASTNode* The AST node representing the list of parameters.
- * Grammar: PARAMETER_LIST -> id PARAMETER_TAIL | ε
+ * @brief Finds the brace closing the block that opens at offset `from`.
+ * @return Offset of the closing brace, or `length` when there is none.
+ * @details The same byte-level pre-pass as `find_definitions`;
+ * `parser_parse_body` checks the result against the real token stream.
  */
-ASTNode *PARAMETER_LIST() {
-    if (token.type != TOKEN_RPAREN) {
-        ASTNode *argument_node = create_ast_node(AST_FUNC_ARG, NULL);
-        if (argument_node == NULL) {
-            rc = ERROR_INTERNAL;
-            return NULL;
+static size_t find_block_end(const char *data, size_t length, size_t from) {
+    size_t depth = 0;
+    size_t i = from;
+    while (i < length) {
+        size_t skipped = skip_ignored(data, length, i);
+        if (skipped != i) {
+            i = skipped;
+            continue;
         }
-        argument_node->right = EXPRESSION();
-        if (rc != NO_ERROR || argument_node->right == NULL ||
-            argument_node->right->type == AST_FUNC_CALL) {
-            rc = SYNTAX_ERROR;
-            return NULL;
+        if (data[i] == '{') {
+            depth++;
+        } else if (data[i] == '}' && --depth == 0) {
+            return i;
         }
-        if (rc != NO_ERROR)
-            return NULL;
-        PARAMETER_TAIL(argument_node);
-        if (rc != NO_ERROR)
-            return NULL;
-        return argument_node;
+        i++;
     }
-    return NULL;
+    return length;
 }
 
 /**
- * @brief Function to parse a setter function definition, creating an AST node
- * for it.
- * @param function The AST node representing the setter function.
- * @return int Error code.
- * Grammar: SETTER -> = (id) BLOCK eol
+ * @brief Function body whose parsing is deferred.
  */
-static void SETTER(ASTNode *function) {
-    next_token(&token);
-    if (rc != NO_ERROR)
-        return;
-
-    token_control(TOKEN_LPAREN, NULL);
-    if (rc != NO_ERROR)
-        return;
-    next_token(&token);
-    if (rc != NO_ERROR)
-        return;
+typedef struct {
+    ASTNode node;    ///< the AST_LAZY_BODY placeholder
+    Scanner *source; ///< scanner of the program
+    size_t start;    ///< offset of the opening brace
+    size_t end;      ///< offset of the closing brace
+} LazyBody;
 
-    token_control(TOKEN_IDENTIFIER, NULL);
-    if (rc != NO_ERROR)
-        return;
-    function->left = create_ast_node(AST_IDENTIFIER, token.value.string->str);
-    if (function->left == NULL) {
-        rc = ERROR_INTERNAL;
+/**
+ * @brief Action `lazy_body`: in lazy mode, skims the body of a function
+ * other than `main()` instead of parsing it.
+ * @details The body becomes an AST_LAZY_BODY and the BLOCK that follows
+ * the action is dropped from the symbol stack; the driver goes on after
+ * the closing brace as if it had just matched it. A body without a closing
+ * brace is parsed (and its error reported) as usual.
+ */
+static void lazy_body(Driver *driver) {
+    ASTNode *function = top_value(driver);
+    if (lazy_source == NULL ||
+        (function->left == NULL && strcmp(function->name, "main") == 0)) {
         return;
     }
-
-    next_token(&token);
-    if (rc != NO_ERROR)
+    fetch(driver);
+    if (rc != NO_ERROR || token.type != TOKEN_LCURLY) {
         return;
-
-    token_control(TOKEN_RPAREN, NULL);
-    if (rc != NO_ERROR)
-        return;
-    next_token(&token);
-    if (rc != NO_ERROR)
-        return;
-
-    function->right = BLOCK();
-    if (rc != NO_ERROR)
+    }
+    size_t start = scanner->token_start;
+    size_t end = find_block_end(scanner->source.data, scanner->source.length,
+                                start);
+    if (end == scanner->source.length) {
         return;
-    next_token(&token);
-    if (rc != NO_ERROR)
+    }
+    LazyBody *body = arena_alloc(phase_arena(ARENA_PARSE), sizeof(LazyBody));
+    if (body == NULL) {
+        fail(driver, ERROR_INTERNAL);
         return;
+    }
+    memset(&body->node, 0, sizeof(body->node));
+    body->node.type = AST_LAZY_BODY;
+    body->node.data_type = TYPE_UNDEF;
+    body->source = lazy_source;
+    body->start = start;
+    body->end = end;
+    push_value(driver, &body->node);
 
-    eol();
-    if (rc != NO_ERROR)
-        return;
-    return;
+    driver->depth--; // BLOCK
+    scanner->position = end + 1;
+    scanner->token_start = end;
+    token.type = TOKEN_RCURLY;
+    driver->matched = token;
+    driver->pending = true;
 }
 
 /**
- * @brief Function to parse the tail of an argument list in a function call,
- * creating AST nodes for each argument.
- * @param node The AST node representing the current argument.
- * @return ASTNode* The AST node representing the argument list tail.
- * Grammar: ARGUMENT_TAIL -> , TERM ARGUMENT_TAIL | ε
+ * @brief Work pool job: parses one definition with the worker's scanner.
  */
-static ASTNode *ARGUMENT_TAIL(ASTNode *node) {
-    if (token.type != TOKEN_RPAREN) {
-        node->left = create_ast_node(AST_FUNC_ARG, NULL);
-        if (node->left == NULL) {
-            rc = ERROR_INTERNAL;
-            return NULL;
+static void parse_definition_job(void *context, size_t job, unsigned worker) {
+    DefinitionSplit *split = context;
+    Definition *definition = &split->definitions[job];
+    Scanner *own = &split->scanners[worker];
+    Arena *arena = phase_arena(ARENA_PARSE);
+    Driver driver = {0};
+
+    // Worker 0 is the parser thread and allocates straight into its arena
+    if (worker != 0) {
+        *arena = split->arenas[worker];
+        intern_attach(split->names);
+    }
+
+    intern_record(&split->logs[job]);
+    expression_kind = split->expressions;
+    lazy_source = split->lazy_source;
+    scanner = own;
+    rc = NO_ERROR;
+    own->position = definition->start;
+    definition->node = NULL;
+    next_token(&driver);
+    if (rc == NO_ERROR && own->token_start == definition->start) {
+        run(&driver, LL_N_DEF_FUN);
+        if (rc == NO_ERROR) {
+            definition->node = driver.values[0];
         }
-        token_control(TOKEN_COMMA, NULL);
-        if (rc != NO_ERROR)
-            return NULL;
-
-        next_token(&token);
-        if (rc != NO_ERROR)
-            return NULL;
-
-        token_control(TOKEN_IDENTIFIER, NULL);
-        if (rc != NO_ERROR)
-            return NULL;
-
-        node->left->right =
-            create_ast_node(AST_IDENTIFIER, token.value.string->str);
-        if (node->left->right == NULL) {
-            rc = ERROR_INTERNAL;
-            return NULL;
-        }
-        if (rc != NO_ERROR)
-            return NULL;
-
-        next_token(&token);
-        if (rc != NO_ERROR)
-            return NULL;
-
-        ARGUMENT_TAIL(node->left);
-        if (rc != NO_ERROR)
-            return NULL;
-        return node;
     }
-    return NULL;
+    driver_free(&driver);
+    definition->rc = rc != NO_ERROR            ? rc
+                     : definition->node == NULL ? SYNTAX_ERROR
+                     : split->logs[job].failed  ? ERROR_INTERNAL
+                                                : NO_ERROR;
+    definition->next = token;
+    definition->next_start = own->token_start;
+    definition->position = own->position;
+    intern_record(NULL);
+
+    if (worker != 0) {
+        split->arenas[worker] = *arena;
+        arena_init(arena);
+        intern_attach(NULL);
+    }
 }
 
 /**
- * @brief Function to parse a list of arguments in a function call,
- * creating AST nodes for them.
- * @return ASTNode* The AST node representing the list of arguments.
- * Grammar: ARGUMENT_LIST -> TERM ARGUMENT_TAIL | ε
- *          TERM -> literal_num | literal_string | literal_null | id
+ * @brief Parses the definitions of the class body on several threads.
+ * @param PROGRAM Pointer to the root ASTNode representing the program.
+ * @return The last definition linked into the AST, or PROGRAM.
+ * @details The current token is the first `static` of the class body. The
+ * definitions found by `find_definitions` are parsed concurrently, each by
+ * a scanner of its worker started at its offset. They are then linked in
+ * source order for as long as each one parsed cleanly and started exactly
+ * where the previous one ended; the parser state is left after the last
+ * linked definition. The names the threads interned are then renumbered
+ * in source order, as symbol tables are ordered by intern id. DEF_FUN_LIST
+ * goes on from there, so a bad boundary or an error is parsed (and
+ * reported) sequentially, exactly as without threads.
  */
-
-static ASTNode *ARGUMENT_LIST() {
-    if (token.type != TOKEN_RPAREN) {
-        token_control(TOKEN_IDENTIFIER, NULL);
-        if (rc != NO_ERROR)
-            return NULL;
-
-        ASTNode *argument_node = create_ast_node(AST_FUNC_ARG, NULL);
-        if (argument_node == NULL) {
-            rc = ERROR_INTERNAL;
-            return NULL;
-        }
-        argument_node->right =
-            create_ast_node(AST_IDENTIFIER, token.value.string->str);
-        if (argument_node->right == NULL) {
-            rc = ERROR_INTERNAL;
-            return NULL;
+static ASTNode *parse_definitions_parallel(ASTNode *PROGRAM) {
+    Scanner *source = scanner;
+    unsigned threads = parse_threads;
+    size_t count;
+    size_t *starts = find_definitions(source->source.data,
+                                      source->source.length,
+                                      source->token_start, &count);
+    if (count < PARSER_PARALLEL_MIN_DEFINITIONS) {
+        free(starts);
+        return PROGRAM;
+    }
+    if (threads > WORK_POOL_MAX_THREADS) {
+        threads = WORK_POOL_MAX_THREADS;
+    }
+
+    DefinitionSplit split = {
+        .definitions = calloc(count, sizeof(Definition)),
+        .scanners = calloc(threads, sizeof(Scanner)),
+        .arenas = calloc(threads, sizeof(Arena)),
+        .logs = calloc(count, sizeof(InternLog)),
+        .names = intern_table(),
+        .expressions = expression_kind,
+        .lazy_source = lazy_source,
+    };
+    unsigned ready = 0;
+    if (split.definitions && split.scanners && split.arenas && split.logs) {
+        while (ready < threads &&
+               scanner_init_buffer(&split.scanners[ready],
+                                   source->source.data,
+                                   source->source.length) == NO_ERROR) {
+            ready++;
         }
-        if (rc != NO_ERROR)
-            return NULL;
-
-        next_token(&token);
-        if (rc != NO_ERROR)
-            return NULL;
-
-        ARGUMENT_TAIL(argument_node);
-        if (rc != NO_ERROR)
-            return NULL;
-        return argument_node;
     }
-    return NULL;
-}
-/**
- * @brief Function to parse the tail of a function definition,
- * creating an AST node for it.
- * @param id_name The name of the function identifier.
- * @return ASTNode* The AST node representing the function definition tail.
- */
-static ASTNode *DEF_FUN_TAIL(char *id_name) {
-    ASTNode *function = NULL;
 
-    // Getter: static identifier {
-    if (token.type == TOKEN_LCURLY) {
-        function = create_ast_node(AST_GETTER_DEF, id_name);
-        if (function == NULL) {
-            rc = ERROR_INTERNAL;
-            return NULL;
+    ASTNode *last = PROGRAM;
+    if (ready == threads) {
+        for (size_t i = 0; i < count; i++) {
+            split.definitions[i].start = starts[i];
         }
-
-        function->right = BLOCK();
-        if (rc != NO_ERROR)
-            return NULL;
-
-        next_token(&token);
-        if (rc != NO_ERROR)
-            return NULL;
-
-        eol();
-        if (rc != NO_ERROR)
-            return NULL;
-
-        return function;
-    }
-
-    // Setter: static identifier=(param) {
-    else if (token.type == TOKEN_EQUAL) {
-        function = create_ast_node(AST_SETTER_DEF, id_name);
-        if (function == NULL) {
-            rc = ERROR_INTERNAL;
-            return NULL;
+        Token current = token;
+        size_t kept = intern_count();
+        intern_share(split.names, true);
+        work_pool_run(count, threads, parse_definition_job, &split, NULL);
+        intern_share(split.names, false);
+        for (unsigned i = 1; i < threads; i++) {
+            arena_merge(phase_arena(ARENA_PARSE), &split.arenas[i]);
         }
-        SETTER(function);
-        if (rc != NO_ERROR)
-            return NULL;
-        return function;
-    }
 
-    // Function: static identifier(...) {
-    else if (token.type == TOKEN_LPAREN) {
-        next_token(&token);
-        if (rc != NO_ERROR)
-            return NULL;
-
-        function = create_ast_node(AST_FUNC_DEF, id_name);
-        if (function == NULL) {
-            rc = ERROR_INTERNAL;
-            return NULL;
+        scanner = source;
+        rc = NO_ERROR;
+        token = current;
+        size_t linked = 0;
+        for (; linked < count; linked++) {
+            const Definition *definition = &split.definitions[linked];
+            if (definition->rc != NO_ERROR ||
+                definition->start != source->token_start) {
+                break;
+            }
+            link_definition(last, definition->node);
+            last = definition->node;
+            token = definition->next;
+            source->token_start = definition->next_start;
+            source->position = definition->position;
         }
 
-        if (token.type != TOKEN_RPAREN) {
-            function->left = ARGUMENT_LIST();
+        // Give the names the ids a sequential parse would have given them
+        if (!intern_renumber(split.names, kept, split.logs, linked)) {
+            rc = ERROR_INTERNAL;
         }
-        if (rc != NO_ERROR)
-            return NULL;
-
-        token_control(TOKEN_RPAREN, NULL);
-        if (rc != NO_ERROR)
-            return NULL;
-
-        next_token(&token);
-        if (rc != NO_ERROR)
-            return NULL;
-
-        function->right = BLOCK();
-        if (rc != NO_ERROR)
-            return NULL;
-
-        next_token(&token);
-        if (rc != NO_ERROR)
-            return NULL;
-
-        eol();
-        if (rc != NO_ERROR)
-            return NULL;
-
-        return function;
     }
 
-    else {
-        rc = SYNTAX_ERROR;
-        return NULL;
+    for (unsigned i = 0; i < ready; i++) {
+        scanner_free(&split.scanners[i]);
     }
-}
-/**
- * @brief Function to parse a function definition,
- * creating an AST node for it.
- * @return ASTNode* The AST node representing the function definition.
- * Grammar: DEF_FUN -> static id DEF_FUN_TAIL
- */
-static ASTNode *DEF_FUN() {
-    expected_keyword = KEYWORD_STATIC;
-    token_control(TOKEN_KEYWORD, &expected_keyword);
-    if (rc != NO_ERROR)
-        return NULL;
-
-    next_token(&token);
-    if (rc != NO_ERROR)
-        return NULL;
-    token_control(TOKEN_IDENTIFIER, NULL);
-    if (rc != NO_ERROR)
-        return NULL;
-    char *id_name = token.value.string->str;
-    next_token(&token);
-    if (rc != NO_ERROR)
-        return NULL;
-    ASTNode *new_function = DEF_FUN_TAIL(id_name);
-    if (rc != NO_ERROR)
-        return NULL;
-
-    return new_function;
-}
-
-/**
- * @brief Function to parse a list of function definitions,
- * creating AST nodes for them.
- * @param current_node The AST node representing the current function.
- * @return ASTNode* The AST node representing the list of function definitions.
- * Grammar: DEF_FUN_LIST -> DEF_FUN DEF_FUN_LIST | ε
- */
-static ASTNode *DEF_FUN_LIST(ASTNode *current_node) {
-    if (((token.type == TOKEN_KEYWORD) &&
-         (token.value.keyword == KEYWORD_STATIC))) {
-        ASTNode *new_function = DEF_FUN();
-        if (new_function == NULL) {
-            return NULL;
-        }
-
-        if (current_node->right == NULL) {
-            if (current_node->type == AST_PROGRAM) {
-                current_node->left = new_function;
-            }
-        } else if (current_node->right->right == NULL) {
-            current_node->right->right = new_function;
-        }
-
-        ASTNode *tail = DEF_FUN_LIST(new_function);
-        if (tail != NULL && rc != NO_ERROR) {
-            rc = SYNTAX_ERROR;
-            return NULL;
-        }
+    for (size_t i = 0; split.logs && i < count; i++) {
+        intern_log_free(&split.logs[i]);
     }
-    return NULL;
+    free(split.logs);
+    free(split.definitions);
+    free(split.scanners);
+    free(split.arenas);
+    free(starts);
+    return last;
 }
 
 /**
- * @brief Function to parse the main class structure of the program,
- * creating AST nodes for it.
+ * @brief Parses the IFJ25 code and fills the abstract syntax tree (AST).
+ * @param source Scanner providing the tokens.
  * @param PROGRAM Pointer to the root ASTNode representing the program.
  * @return int Error code.
- * Grammar: CLASS -> class Program { eol DEF_FUN_LIST }
+ * Grammar: PROGRAM -> EOLS PROLOG eol CLASS EOLS eof
  */
-static void CLASS(ASTNode *PROGRAM) {
-
-    expected_keyword = KEYWORD_CLASS;
-    token_control(TOKEN_KEYWORD, &expected_keyword);
-    if (rc != NO_ERROR)
-        return;
-
-    next_token(&token);
-    if (rc != NO_ERROR)
-        return;
-    token_control(TOKEN_IDENTIFIER, NULL);
-    if (rc != NO_ERROR)
-        return;
-    if (strcmp(token.value.string->str, "Program") != 0) {
-        rc = SYNTAX_ERROR;
-        return;
-    }
-
-    next_token(&token);
-    if (rc != NO_ERROR)
-        return;
-    token_control(TOKEN_LCURLY, NULL);
-    if (rc != NO_ERROR)
-        return;
-
-    next_token(&token);
-    if (rc != NO_ERROR)
-        return;
-    eol();
-    if (rc != NO_ERROR)
-        return;
-
-    DEF_FUN_LIST(PROGRAM);
-    if (rc != NO_ERROR)
-        return;
-    token_control(TOKEN_RCURLY, NULL);
-
-    return;
+int parser(Scanner *source, ASTNode *PROGRAM) {
+    return parser_parallel(source, PROGRAM, 1);
 }
 
-/**
- * @brief Function to parse the prolog of the IFJ25 program,
- * ensuring correct import statements.
- * @return int Error code.
- * Grammar: PROLOG -> import "ifj25" for ifj
- */
-static void PROLOG() {
-
-    skip_eol();
-    if (rc != NO_ERROR)
-        return;
-
-    expected_keyword = KEYWORD_IMPORT;
-    token_control(TOKEN_KEYWORD, &expected_keyword);
-    if (rc != NO_ERROR)
-        return;
-
-    next_token(&token);
-    if (rc != NO_ERROR)
-        return;
-    skip_eol();
-    if (rc != NO_ERROR)
-        return;
-
-    token_control(TOKEN_STRING, "ifj25");
-    if (rc != NO_ERROR)
-        return;
-    next_token(&token);
-    if (rc != NO_ERROR)
-        return;
-    expected_keyword = KEYWORD_FOR;
-    token_control(TOKEN_KEYWORD, &expected_keyword);
-    if (rc != NO_ERROR)
-        return;
-    next_token(&token);
-    if (rc != NO_ERROR)
-        return;
-
-    skip_eol();
-    if (rc != NO_ERROR)
-        return;
-    expected_keyword = KEYWORD_IFJ;
-    token_control(TOKEN_KEYWORD, &expected_keyword);
+void parser_set_expression_parser(ExprParserKind kind) {
+    expression_kind = kind;
+}
 
-    return;
+void parser_set_lazy_bodies(bool lazy) { lazy_bodies = lazy; }
+
+int parser_parse_body(ASTNode *definition) {
+    if (definition->right == NULL ||
+        definition->right->type != AST_LAZY_BODY) {
+        return NO_ERROR;
+    }
+    LazyBody *body = (LazyBody *)definition->right;
+    Scanner *saved_scanner = scanner;
+    Token saved_token = token;
+    int saved_rc = rc;
+    Driver driver = {0};
+
+    scanner = body->source;
+    rc = NO_ERROR;
+    scanner->position = body->start;
+    next_token(&driver);
+    if (rc == NO_ERROR && scanner->token_start == body->start) {
+        run(&driver, LL_N_BLOCK);
+    }
+    // The skim must have found the brace the parser ends at
+    int result = rc != NO_ERROR                        ? rc
+                 : scanner->token_start != body->end ? SYNTAX_ERROR
+                                                     : NO_ERROR;
+    if (result == NO_ERROR) {
+        ASTNode *block = driver.values[0];
+        block->right = body->node.right;
+        block->current_table = body->node.current_table;
+        block->current_scope = body->node.current_scope;
+        definition->right = block;
+    }
+    driver_free(&driver);
+    scanner = saved_scanner;
+    token = saved_token;
+    rc = saved_rc;
+    return result;
 }
+
 /**
- * @brief Parses the IFJ25 code and fills the abstract syntax tree (AST).
+ * @brief Parses the IFJ25 code, the function definitions on `threads`
+ * threads.
+ * @param source Scanner providing the tokens.
  * @param PROGRAM Pointer to the root ASTNode representing the program.
+ * @param threads Number of threads parsing definitions.
  * @return int Error code.
- * Grammar: PROGRAM -> PROLOG eol CLASS eof
  */
-int parser(ASTNode *PROGRAM) {
-    next_token(&token);
-    if (rc != NO_ERROR)
-        return rc;
-    skip_eol();
-    if (rc != NO_ERROR)
-        return rc;
-    PROLOG();
-    if (rc != NO_ERROR)
-        return rc;
-    next_token(&token);
-    if (rc != NO_ERROR)
-        return rc;
-    eol();
-    if (rc != NO_ERROR)
-        return rc;
-
-    CLASS(PROGRAM);
-    if (rc != NO_ERROR)
-        return rc;
-
-    next_token(&token);
-    if (rc != NO_ERROR)
-        return rc;
-    skip_eol();
-    if (rc != NO_ERROR)
-        return rc;
-
-    if (token.type != TOKEN_EOF) {
-        rc = SYNTAX_ERROR;
-    }
+int parser_parallel(Scanner *source, ASTNode *PROGRAM, unsigned threads) {
+    Driver driver = {.pending = true, .last_definition = PROGRAM};
+    parse_threads = threads == 0 ? work_pool_cpu_count() : threads;
+    lazy_source = lazy_bodies && !source->pretokenized && !source->pipe
+                      ? source
+                      : NULL;
+    scanner = source;
+    rc = NO_ERROR;
+    run(&driver, LL_N_PROGRAM);
+    driver_free(&driver);
     return rc;
 }
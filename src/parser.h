@@ -9,19 +9,76 @@
 #ifndef PARSER_H
 #define PARSER_H
 #include "ast.h"
+#include "expr_parser.h"
 #include "scanner.h"
 #include "symtable.h"
+#include <stdbool.h>
+
+/// Fewer definitions than this are parsed sequentially even with threads
+#define PARSER_PARALLEL_MIN_DEFINITIONS 16
 
 /**
  * @brief Main parser entry point that performs syntactic analysis.
+ * @param source Scanner providing the tokens.
  * @param PROGRAM Pointer to the root AST node representing the program.
  * @return Error code (NO_ERROR on success, SYNTAX_ERROR or ERROR_INTERNAL on
  * failure).
  * @details
- * Parses the IFJ25 source code using recursive descent parsing, validates
- * syntax according to the language grammar, and constructs the abstract syntax
- * tree.
+ * Parses the IFJ25 source code with the LL(1) table generated from
+ * grammar.txt, validates syntax according to the language grammar, and
+ * constructs the abstract syntax tree. The parser keeps its own stack, so
+ * the nesting depth and length of the program are limited by memory only.
+ * Lexical errors reported by the scanner are returned unchanged (except
+ * inside an if statement or a call argument, where every error is a syntax
+ * error).
+ */
+int parser(Scanner *source, ASTNode *PROGRAM);
+
+/**
+ * @brief Parser entry point that parses function definitions in parallel.
+ * @param source Scanner providing the tokens.
+ * @param PROGRAM Pointer to the root AST node representing the program.
+ * @param threads Number of threads (0: one per processor, 1: sequential).
+ * @return Error code, the same as `parser` returns.
+ * @details
+ * The `static` definitions of the class body are located by a brace-depth
+ * pre-pass over the source and parsed concurrently, each into the parse
+ * arena of its thread; the arenas are merged into the calling thread's one
+ * afterwards. The AST and the error code are identical to those of the
+ * sequential parser. Only a streaming scanner is split; pre-tokenized and
+ * pipelined scanners are parsed sequentially.
+ */
+int parser_parallel(Scanner *source, ASTNode *PROGRAM, unsigned threads);
+
+/**
+ * @brief Selects the expression parser of the parser runs of the calling
+ * thread.
+ * @param kind Expression parser (EXPR_PARSER_PRECEDENCE until set).
+ * @details Definitions parsed on other threads by `parser_parallel` use the
+ * same one. Both build the same AST.
+ */
+void parser_set_expression_parser(ExprParserKind kind);
+
+/**
+ * @brief Selects whether the parser runs of the calling thread defer the
+ * bodies of functions.
+ * @param lazy Defer function bodies (false until set).
+ * @details In lazy mode the body of every function other than `main()` is
+ * only skimmed for its matching brace and stands in the AST as an
+ * AST_LAZY_BODY, to be parsed by `parser_parse_body` when it turns out to
+ * be needed. The signatures are parsed as usual. Only a streaming scanner
+ * is skimmed; pre-tokenized and pipelined scanners parse every body.
+ */
+void parser_set_lazy_bodies(bool lazy);
+
+/**
+ * @brief Parses the deferred body of a function definition.
+ * @param definition AST_FUNC_DEF whose body may be an AST_LAZY_BODY.
+ * @return Error code, as `parser` would have returned it for the body.
+ * @details The parsed AST_BLOCK replaces the placeholder, keeping its
+ * links and annotations. Nothing is done for a body that is parsed
+ * already. The scanner the program was parsed with must still be alive.
  */
-int parser(ASTNode *PROGRAM);
+int parser_parse_body(ASTNode *definition);
 
 #endif
@@ -0,0 +1,275 @@
+/**
+ * @file scan_simd.c
+ * @author xcernoj00
+ * @brief Vectorized skipping kernels used by the scanner.
+ *
+ * The SSE2 and AVX2 variants are compiled with per-function target
+ * attributes, so the rest of the compiler keeps its baseline flags and the
+ * wide variants only run on CPUs that report support for them.
+ */
+
+#include "scan_simd.h"
+#include <stdbool.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define SCAN_HAVE_X86 1
+#include <immintrin.h>
+#else
+#define SCAN_HAVE_X86 0
+#endif
+
+typedef size_t (*ScanFn)(const char *data, size_t pos, size_t end);
+
+/**
+ * @brief One complete kernel set.
+ */
+typedef struct {
+    ScanFn skip_blanks;
+    ScanFn find_comment_mark;
+    ScanFn find_string_mark;
+} ScanKernelSet;
+
+/* ---------------------------------------------------------------------- */
+/* Scalar kernels                                                          */
+/* ---------------------------------------------------------------------- */
+
+static inline bool is_blank(unsigned char c) {
+    return c == ' ' || c == '\t' || c == '\v' || c == '\f' || c == '\r';
+}
+
+static size_t skip_blanks_scalar(const char *data, size_t pos, size_t end) {
+    while (pos < end && is_blank((unsigned char)data[pos])) {
+        pos++;
+    }
+    return pos;
+}
+
+static size_t find_comment_mark_scalar(const char *data, size_t pos,
+                                       size_t end) {
+    while (pos < end && data[pos] != '*' && data[pos] != '/') {
+        pos++;
+    }
+    return pos;
+}
+
+static size_t find_string_mark_scalar(const char *data, size_t pos,
+                                      size_t end) {
+    while (pos < end && data[pos] != '"' && data[pos] != '\\' &&
+           data[pos] != '\n') {
+        pos++;
+    }
+    return pos;
+}
+
+#if SCAN_HAVE_X86
+
+/* ---------------------------------------------------------------------- */
+/* SSE2 kernels, 16 bytes per step                                         */
+/* ---------------------------------------------------------------------- */
+
+/**
+ * @brief Bit mask of blank bytes in a 16 byte block.
+ *
+ * Blanks are ' ' and the range '\t'..'\r' without '\n'. The range test is
+ * an unsigned compare done with min: (c - 9) <= 4.
+ */
+__attribute__((target("sse2"))) static inline unsigned
+blank_mask_sse2(__m128i v) {
+    __m128i space = _mm_cmpeq_epi8(v, _mm_set1_epi8(' '));
+    __m128i shifted = _mm_sub_epi8(v, _mm_set1_epi8('\t'));
+    __m128i in_range = _mm_cmpeq_epi8(
+        _mm_min_epu8(shifted, _mm_set1_epi8('\r' - '\t')), shifted);
+    __m128i newline = _mm_cmpeq_epi8(v, _mm_set1_epi8('\n'));
+    __m128i blank = _mm_or_si128(space, _mm_andnot_si128(newline, in_range));
+    return (unsigned)_mm_movemask_epi8(blank);
+}
+
+__attribute__((target("sse2"))) static size_t
+skip_blanks_sse2(const char *data, size_t pos, size_t end) {
+    while (pos + 16 <= end) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(data + pos));
+        unsigned other = ~blank_mask_sse2(v) & 0xFFFFu;
+        if (other) {
+            return pos + (size_t)__builtin_ctz(other);
+        }
+        pos += 16;
+    }
+    return skip_blanks_scalar(data, pos, end);
+}
+
+__attribute__((target("sse2"))) static size_t
+find_comment_mark_sse2(const char *data, size_t pos, size_t end) {
+    const __m128i star = _mm_set1_epi8('*');
+    const __m128i slash = _mm_set1_epi8('/');
+    while (pos + 16 <= end) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(data + pos));
+        unsigned mask = (unsigned)_mm_movemask_epi8(
+            _mm_or_si128(_mm_cmpeq_epi8(v, star), _mm_cmpeq_epi8(v, slash)));
+        if (mask) {
+            return pos + (size_t)__builtin_ctz(mask);
+        }
+        pos += 16;
+    }
+    return find_comment_mark_scalar(data, pos, end);
+}
+
+__attribute__((target("sse2"))) static size_t
+find_string_mark_sse2(const char *data, size_t pos, size_t end) {
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i newline = _mm_set1_epi8('\n');
+    while (pos + 16 <= end) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(data + pos));
+        __m128i hit = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(v, quote),
+                         _mm_cmpeq_epi8(v, backslash)),
+            _mm_cmpeq_epi8(v, newline));
+        unsigned mask = (unsigned)_mm_movemask_epi8(hit);
+        if (mask) {
+            return pos + (size_t)__builtin_ctz(mask);
+        }
+        pos += 16;
+    }
+    return find_string_mark_scalar(data, pos, end);
+}
+
+/* ---------------------------------------------------------------------- */
+/* AVX2 kernels, 32 bytes per step                                         */
+/* ---------------------------------------------------------------------- */
+
+__attribute__((target("avx2"))) static inline unsigned
+blank_mask_avx2(__m256i v) {
+    __m256i space = _mm256_cmpeq_epi8(v, _mm256_set1_epi8(' '));
+    __m256i shifted = _mm256_sub_epi8(v, _mm256_set1_epi8('\t'));
+    __m256i in_range = _mm256_cmpeq_epi8(
+        _mm256_min_epu8(shifted, _mm256_set1_epi8('\r' - '\t')), shifted);
+    __m256i newline = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n'));
+    __m256i blank =
+        _mm256_or_si256(space, _mm256_andnot_si256(newline, in_range));
+    return (unsigned)_mm256_movemask_epi8(blank);
+}
+
+__attribute__((target("avx2"))) static size_t
+skip_blanks_avx2(const char *data, size_t pos, size_t end) {
+    while (pos + 32 <= end) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(data + pos));
+        unsigned other = ~blank_mask_avx2(v);
+        if (other) {
+            return pos + (size_t)__builtin_ctz(other);
+        }
+        pos += 32;
+    }
+    return skip_blanks_sse2(data, pos, end);
+}
+
+__attribute__((target("avx2"))) static size_t
+find_comment_mark_avx2(const char *data, size_t pos, size_t end) {
+    const __m256i star = _mm256_set1_epi8('*');
+    const __m256i slash = _mm256_set1_epi8('/');
+    while (pos + 32 <= end) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(data + pos));
+        unsigned mask = (unsigned)_mm256_movemask_epi8(_mm256_or_si256(
+            _mm256_cmpeq_epi8(v, star), _mm256_cmpeq_epi8(v, slash)));
+        if (mask) {
+            return pos + (size_t)__builtin_ctz(mask);
+        }
+        pos += 32;
+    }
+    return find_comment_mark_sse2(data, pos, end);
+}
+
+__attribute__((target("avx2"))) static size_t
+find_string_mark_avx2(const char *data, size_t pos, size_t end) {
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    const __m256i newline = _mm256_set1_epi8('\n');
+    while (pos + 32 <= end) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(data + pos));
+        __m256i hit = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, quote),
+                            _mm256_cmpeq_epi8(v, backslash)),
+            _mm256_cmpeq_epi8(v, newline));
+        unsigned mask = (unsigned)_mm256_movemask_epi8(hit);
+        if (mask) {
+            return pos + (size_t)__builtin_ctz(mask);
+        }
+        pos += 32;
+    }
+    return find_string_mark_sse2(data, pos, end);
+}
+
+#endif // SCAN_HAVE_X86
+
+/* ---------------------------------------------------------------------- */
+/* Dispatch                                                                */
+/* ---------------------------------------------------------------------- */
+
+static const ScanKernelSet kernel_sets[SCAN_KERNEL_COUNT] = {
+    [SCAN_KERNEL_SCALAR] = {skip_blanks_scalar, find_comment_mark_scalar,
+                            find_string_mark_scalar},
+#if SCAN_HAVE_X86
+    [SCAN_KERNEL_SSE2] = {skip_blanks_sse2, find_comment_mark_sse2,
+                          find_string_mark_sse2},
+    [SCAN_KERNEL_AVX2] = {skip_blanks_avx2, find_comment_mark_avx2,
+                          find_string_mark_avx2},
+#endif
+};
+
+static ScanKernel active_kernel = SCAN_KERNEL_SCALAR;
+static const ScanKernelSet *active = &kernel_sets[SCAN_KERNEL_SCALAR];
+
+ScanKernel scan_kernel_best(void) {
+#if SCAN_HAVE_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return SCAN_KERNEL_AVX2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return SCAN_KERNEL_SSE2;
+    }
+#endif
+    return SCAN_KERNEL_SCALAR;
+}
+
+ScanKernel scan_kernel_select(ScanKernel kernel) {
+    ScanKernel best = scan_kernel_best();
+    if (kernel >= SCAN_KERNEL_COUNT || kernel > best) {
+        kernel = best;
+    }
+    active_kernel = kernel;
+    active = &kernel_sets[kernel];
+    return active_kernel;
+}
+
+const char *scan_kernel_name(ScanKernel kernel) {
+    switch (kernel) {
+    case SCAN_KERNEL_SCALAR:
+        return "scalar";
+    case SCAN_KERNEL_SSE2:
+        return "sse2";
+    case SCAN_KERNEL_AVX2:
+        return "avx2";
+    default:
+        return "unknown";
+    }
+}
+
+/**
+ * @brief Pick the best kernel set before main() runs, so the selection
+ * never races with scanners running on other threads.
+ */
+__attribute__((constructor)) static void scan_kernel_init(void) {
+    scan_kernel_select(SCAN_KERNEL_COUNT);
+}
+
+size_t scan_skip_blanks(const char *data, size_t pos, size_t end) {
+    return active->skip_blanks(data, pos, end);
+}
+
+size_t scan_find_comment_mark(const char *data, size_t pos, size_t end) {
+    return active->find_comment_mark(data, pos, end);
+}
+
+size_t scan_find_string_mark(const char *data, size_t pos, size_t end) {
+    return active->find_string_mark(data, pos, end);
+}
@@ -0,0 +1,80 @@
+/**
+ * @file scan_simd.h
+ * @author xcernoj00
+ * @brief Vectorized skipping kernels used by the scanner.
+ *
+ * Each kernel returns the offset of the next byte the scanner has to look
+ * at, so runs of blanks, comment text and string bodies are consumed in
+ * 16 or 32 byte steps instead of one character at a time. The widest
+ * kernel set the CPU supports is selected at startup; a scalar fallback
+ * is always available and produces the same results.
+ */
+
+#ifndef _SCAN_SIMD_H
+#define _SCAN_SIMD_H
+
+#include <stddef.h>
+
+/**
+ * @brief Available kernel implementations, from slowest to fastest.
+ */
+typedef enum {
+    SCAN_KERNEL_SCALAR, ///< portable byte loop
+    SCAN_KERNEL_SSE2,   ///< 16 bytes per step
+    SCAN_KERNEL_AVX2,   ///< 32 bytes per step
+    SCAN_KERNEL_COUNT,
+} ScanKernel;
+
+/**
+ * @brief Skip blanks other than newline (space, \\t, \\v, \\f, \\r).
+ *
+ * @param data Source buffer.
+ * @param pos Offset to start at.
+ * @param end Offset one past the last byte to look at.
+ * @return Offset of the first non-blank byte, or `end` when there is none.
+ */
+size_t scan_skip_blanks(const char *data, size_t pos, size_t end);
+
+/**
+ * @brief Find the next '*' or '/' inside a block comment.
+ *
+ * @param data Source buffer.
+ * @param pos Offset to start at.
+ * @param end Offset one past the last byte to look at.
+ * @return Offset of the first '*' or '/', or `end` when there is none.
+ */
+size_t scan_find_comment_mark(const char *data, size_t pos, size_t end);
+
+/**
+ * @brief Find the next '"', '\\' or newline inside a string literal.
+ *
+ * @param data Source buffer.
+ * @param pos Offset to start at.
+ * @param end Offset one past the last byte to look at.
+ * @return Offset of the first match, or `end` when there is none.
+ */
+size_t scan_find_string_mark(const char *data, size_t pos, size_t end);
+
+/**
+ * @brief Select the kernel set used by the functions above.
+ *
+ * Requests for a kernel the CPU does not support fall back to the best
+ * supported one below it. Meant for tests and benchmarks; the default
+ * selection is made automatically.
+ *
+ * @param kernel Wanted kernel set.
+ * @return Kernel set that is active after the call.
+ */
+ScanKernel scan_kernel_select(ScanKernel kernel);
+
+/**
+ * @brief Best kernel set supported by the running CPU.
+ */
+ScanKernel scan_kernel_best(void);
+
+/**
+ * @brief Human-readable kernel name ("scalar", "sse2", "avx2").
+ */
+const char *scan_kernel_name(ScanKernel kernel);
+
+#endif // _SCAN_SIMD_H
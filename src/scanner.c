@@ -5,175 +5,517 @@
  */
 
 #include "scanner.h"
+#include "intern.h"
+#include "scan_simd.h"
+#include "token_pipe.h"
 #include <ctype.h>
+#include <limits.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-FILE *source_file;      // Source file that will be scanned
-DynamicString d_string; // Dynamic string that will be written into
+/**
+ * @brief Common initialization once the source buffer is in place.
+ */
+static int scanner_setup(Scanner *scanner) {
+    scanner->position = 0;
+    scanner->line = 1;
+    scanner->counted = 0;
+    scanner->line_start = 0;
+    scanner->token_start = 0;
+    memset(&scanner->buffered, 0, sizeof(scanner->buffered));
+    scanner->pretokenized = false;
+    scanner->pipe = NULL;
+    // The scratch buffer is allocated once and reused for the whole run
+    if (d_string_alloc(&scanner->scratch) != NO_ERROR) {
+        scanner->scratch.str = NULL;
+        return ERROR_INTERNAL;
+    }
+    return NO_ERROR;
+}
+
+int scanner_init_file(Scanner *scanner, FILE *f) {
+    scanner->scratch.str = NULL;
+    scanner->pipe = NULL;
+    memset(&scanner->buffered, 0, sizeof(scanner->buffered));
+    if (source_buffer_load(&scanner->source, f) != NO_ERROR) {
+        return ERROR_INTERNAL;
+    }
+    if (scanner_setup(scanner) != NO_ERROR) {
+        source_buffer_free(&scanner->source);
+        return ERROR_INTERNAL;
+    }
+    return NO_ERROR;
+}
+
+int scanner_init_buffer(Scanner *scanner, const char *data, size_t length) {
+    source_buffer_borrow(&scanner->source, data, length);
+    return scanner_setup(scanner);
+}
+
+void scanner_free(Scanner *scanner) {
+    // The scanner thread reads the source, stop it first
+    if (scanner->pipe) {
+        token_pipe_stop(scanner->pipe);
+        scanner->pipe = NULL;
+    }
+    source_buffer_free(&scanner->source);
+    free(scanner->buffered.types);
+    free(scanner->buffered.values);
+    free(scanner->buffered.spans);
+    memset(&scanner->buffered, 0, sizeof(scanner->buffered));
+    scanner->pretokenized = false;
+    if (scanner->scratch.str) {
+        d_string_free(&scanner->scratch);
+        scanner->scratch.str = NULL;
+    }
+}
+
+void scanner_location(Scanner *scanner, size_t offset, unsigned *line,
+                      unsigned *column) {
+    const char *data = scanner->source.data;
+    size_t end = offset < scanner->source.length ? offset
+                                                 : scanner->source.length;
+
+    // Counting resumes from the last query; going backwards starts over
+    if (end < scanner->counted) {
+        scanner->line = 1;
+        scanner->line_start = 0;
+        scanner->counted = 0;
+    }
+    while (scanner->counted < end) {
+        const char *newline = memchr(data + scanner->counted, '\n',
+                                     end - scanner->counted);
+        if (!newline) {
+            break;
+        }
+        scanner->line++;
+        scanner->line_start = (size_t)(newline - data) + 1;
+        scanner->counted = scanner->line_start;
+    }
+    scanner->counted = end;
+    *line = scanner->line;
+    *column = (unsigned)(end - scanner->line_start) + 1;
+}
+
+/**
+ * @brief Read the next source character, fgetc-style.
+ *
+ * @return The character as unsigned char converted to int, or EOF at the
+ *         end of the buffer (the cursor then stays at the end).
+ */
+static inline int next_char(Scanner *scanner) {
+    if (scanner->position >= scanner->source.length) {
+        return EOF;
+    }
+    return (unsigned char)scanner->source.data[scanner->position++];
+}
+
+/**
+ * @brief Push the last read character back, ungetc-style.
+ *
+ * Pushing back EOF is a no-op, exactly like ungetc.
+ */
+static inline void unget_char(Scanner *scanner, int c) {
+    if (c != EOF) {
+        scanner->position--;
+    }
+}
+
+bool keyword_lookup(const char *word, size_t length, Keyword *keyword) {
+    const char *candidate; // The only keyword the word can still be
+    Keyword found;
+
+    // Length and first character select at most one candidate
+    switch (length) {
+    case 2:
+        if (word[0] != 'i') {
+            return false;
+        } else if (word[1] == 'f') {
+            *keyword = KEYWORD_IF;
+            return true;
+        } else if (word[1] == 's') {
+            *keyword = KEYWORD_IS;
+            return true;
+        }
+        return false;
+    case 3:
+        switch (word[0]) {
+        case 'v':
+            candidate = "var";
+            found = KEYWORD_VAR;
+            break;
+        case 'I':
+            candidate = "Ifj";
+            found = KEYWORD_IFJ;
+            break;
+        case 'f':
+            candidate = "for";
+            found = KEYWORD_FOR;
+            break;
+        case 'N':
+            candidate = "Num";
+            found = KEYWORD_NUM;
+            break;
+        default:
+            return false;
+        }
+        break;
+    case 4:
+        switch (word[0]) {
+        case 'e':
+            candidate = "else";
+            found = KEYWORD_ELSE;
+            break;
+        case 'n':
+            candidate = "null";
+            found = KEYWORD_NULL_L;
+            break;
+        case 'N':
+            candidate = "Null";
+            found = KEYWORD_NULL_C;
+            break;
+        default:
+            return false;
+        }
+        break;
+    case 5:
+        switch (word[0]) {
+        case 'c':
+            candidate = "class";
+            found = KEYWORD_CLASS;
+            break;
+        case 'w':
+            candidate = "while";
+            found = KEYWORD_WHILE;
+            break;
+        default:
+            return false;
+        }
+        break;
+    case 6:
+        switch (word[0]) {
+        case 'r':
+            candidate = "return";
+            found = KEYWORD_RETURN;
+            break;
+        case 's':
+            candidate = "static";
+            found = KEYWORD_STATIC;
+            break;
+        case 'i':
+            candidate = "import";
+            found = KEYWORD_IMPORT;
+            break;
+        case 'S':
+            candidate = "String";
+            found = KEYWORD_STRING;
+            break;
+        default:
+            return false;
+        }
+        break;
+    default:
+        return false;
+    }
 
-void set_source_file(FILE *f) { source_file = f; }
+    // First character already matched
+    if (memcmp(word + 1, candidate + 1, length - 1) != 0) {
+        return false;
+    }
+    *keyword = found;
+    return true;
+}
 
-static int check_keyword(DynamicString *d_string, Token *token) {
-    if (!d_string || !d_string->str) {
+static int check_keyword(const char *word, size_t length, Token *token) {
+    if (!word || length == 0) {
         return ERROR_INTERNAL;
     }
 
-    // Check for keywords
-    if (d_string_cmp(d_string, "class") == 0) {
-        token->type = TOKEN_KEYWORD;
-        token->value.keyword = KEYWORD_CLASS;
-    } else if (d_string_cmp(d_string, "if") == 0) {
-        token->type = TOKEN_KEYWORD;
-        token->value.keyword = KEYWORD_IF;
-    } else if (d_string_cmp(d_string, "else") == 0) {
-        token->type = TOKEN_KEYWORD;
-        token->value.keyword = KEYWORD_ELSE;
-    } else if (d_string_cmp(d_string, "is") == 0) {
+    if (keyword_lookup(word, length, &token->value.keyword)) {
         token->type = TOKEN_KEYWORD;
-        token->value.keyword = KEYWORD_IS;
-    } else if (d_string_cmp(d_string, "null") == 0) {
-        token->type = TOKEN_KEYWORD;
-        token->value.keyword = KEYWORD_NULL_L;
-    } else if (d_string_cmp(d_string, "return") == 0) {
-        token->type = TOKEN_KEYWORD;
-        token->value.keyword = KEYWORD_RETURN;
-    } else if (d_string_cmp(d_string, "var") == 0) {
-        token->type = TOKEN_KEYWORD;
-        token->value.keyword = KEYWORD_VAR;
-    } else if (d_string_cmp(d_string, "while") == 0) {
-        token->type = TOKEN_KEYWORD;
-        token->value.keyword = KEYWORD_WHILE;
-    } else if (d_string_cmp(d_string, "Ifj") == 0) {
-        token->type = TOKEN_KEYWORD;
-        token->value.keyword = KEYWORD_IFJ;
-    } else if (d_string_cmp(d_string, "static") == 0) {
-        token->type = TOKEN_KEYWORD;
-        token->value.keyword = KEYWORD_STATIC;
-    } else if (d_string_cmp(d_string, "import") == 0) {
-        token->type = TOKEN_KEYWORD;
-        token->value.keyword = KEYWORD_IMPORT;
-    } else if (d_string_cmp(d_string, "for") == 0) {
-        token->type = TOKEN_KEYWORD;
-        token->value.keyword = KEYWORD_FOR;
-    } else if (d_string_cmp(d_string, "Num") == 0) {
-        token->type = TOKEN_KEYWORD;
-        token->value.keyword = KEYWORD_NUM;
-    } else if (d_string_cmp(d_string, "String") == 0) {
-        token->type = TOKEN_KEYWORD;
-        token->value.keyword = KEYWORD_STRING;
-    } else if (d_string_cmp(d_string, "Null") == 0) {
-        token->type = TOKEN_KEYWORD;
-        token->value.keyword = KEYWORD_NULL_C;
     } else {
         // Not a keyword, check if it's a global variable or identifier
-        if (d_string->length >= 2 && d_string->str[0] == '_' &&
-            d_string->str[1] == '_') {
+        if (length >= 2 && word[0] == '_' && word[1] == '_') {
             token->type = TOKEN_GLOBAL_VAR;
         } else {
-            if (d_string->str[0] == '_') {
-                exit(SCANNER_ERROR); // Invalid identifier with single _
+            if (word[0] == '_') {
+                return SCANNER_ERROR; // Invalid identifier with single _
             }
             token->type = TOKEN_IDENTIFIER;
         }
-
-        // Allocate and copy dynamic string for identifiers and global vars
-        token->value.string = malloc(sizeof(DynamicString));
-        if (token->value.string == NULL) {
+        token->value.name = intern_n(word, length);
+        if (!token->value.name) {
             return ERROR_INTERNAL;
         }
+    }
+    return NO_ERROR;
+}
 
-        if (d_string_alloc(token->value.string) != NO_ERROR) {
-            free(token->value.string);
-            token->value.string = NULL;
-            return ERROR_INTERNAL;
-        }
+#define NUMBER_COPY_MAX 128        // Longer literals are copied to the heap
+#define FAST_PATH_MAX_DIGITS 19    // Significant digits that fit in uint64_t
+#define FAST_PATH_MAX_MANTISSA (UINT64_C(1) << 53) // Exact as a double
+#define EXPONENT_LIMIT 100000      // Larger exponents only saturate
+
+/**
+ * @brief Powers of ten that are exact doubles (10^22 is the largest).
+ */
+static const double exact_powers_of_ten[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+/**
+ * @brief Saturating `magnitude * base + digit`.
+ */
+static inline uint64_t accumulate(uint64_t magnitude, unsigned base,
+                                  unsigned digit) {
+    if (magnitude > (UINT64_MAX - digit) / base) {
+        return UINT64_MAX;
+    }
+    return magnitude * base + digit;
+}
+
+/**
+ * @brief Integer value with strtol semantics (saturated to long), narrowed
+ * to int like `atoi`/`(int)strtol` did.
+ */
+static int narrow_integer(bool negative, uint64_t magnitude) {
+    long value;
+    if (negative) {
+        value = magnitude > (uint64_t)LONG_MAX ? LONG_MIN : -(long)magnitude;
+    } else {
+        value = magnitude > (uint64_t)LONG_MAX ? LONG_MAX : (long)magnitude;
+    }
+    return (int)value;
+}
+
+/**
+ * @brief Correctly rounded value of a decimal literal that missed the
+ * fast path, via strtod on a NUL-terminated copy.
+ */
+static int convert_decimal_slow(const char *text, size_t length,
+                                double *value) {
+    char buffer[NUMBER_COPY_MAX];
+    char *copy = buffer;
 
-        if (d_string_copy(d_string, token->value.string) != NO_ERROR) {
-            d_string_free(token->value.string);
-            free(token->value.string);
-            token->value.string = NULL;
+    if (length >= NUMBER_COPY_MAX) {
+        copy = malloc(length + 1);
+        if (!copy) {
             return ERROR_INTERNAL;
         }
     }
+    memcpy(copy, text, length);
+    copy[length] = '\0';
+    *value = strtod(copy, NULL);
+    if (copy != buffer) {
+        free(copy);
+    }
     return NO_ERROR;
 }
 
-int get_token(Token *token) {
-    char c;                  // Current character
-    int state = STATE_START; // Current state of the scanner
-    int hex_count = 0;       // Counter for hexadecimal digits
-    int hex_value = 0;       // Value of hexadecimal escape sequence
+/**
+ * @brief Scan a numeric literal in one pass straight from the source.
+ *
+ * `token_start` points at the first digit or at the '-' of a negative
+ * literal. Accepted forms are `0x` hex integers, decimal integers and
+ * doubles with an optional fraction and exponent. Integers keep the old
+ * `atoi`/`strtol` results including overflow. Doubles with at most 19
+ * significant digits (mantissa <= 2^53) and a power of ten up to 22 are
+ * exact after one multiplication or division (Clinger's fast path), all
+ * others are left to strtod.
+ */
+static int scan_number(Scanner *scanner, Token *token) {
+    const char *data = scanner->source.data;
+    size_t end = scanner->source.length;
+    size_t start = scanner->token_start;
+    size_t pos = start;
+    bool negative = data[pos] == '-';
 
-    if (source_file == NULL) {
-        return ERROR_INTERNAL;
+    if (negative) {
+        pos++;
+    }
+
+    // Hexadecimal integer, only in the unsigned "0x" form
+    if (!negative && data[pos] == '0' && pos + 1 < end &&
+        data[pos + 1] == 'x') {
+        uint64_t magnitude = 0;
+        size_t digits = pos += 2;
+        for (; pos < end; pos++) {
+            unsigned char c = (unsigned char)data[pos];
+            unsigned digit;
+            if (c >= '0' && c <= '9') {
+                digit = c - '0';
+            } else if (c >= 'a' && c <= 'f') {
+                digit = c - 'a' + 10;
+            } else if (c >= 'A' && c <= 'F') {
+                digit = c - 'A' + 10;
+            } else {
+                break;
+            }
+            magnitude = accumulate(magnitude, 16, digit);
+        }
+        scanner->position = pos;
+        if (pos == digits) {
+            return SCANNER_ERROR; // Only "0x" without digits
+        }
+        token->type = TOKEN_INTEGER;
+        token->value.integer = narrow_integer(false, magnitude);
+        return NO_ERROR;
+    }
+
+    uint64_t magnitude = 0; // integer part, saturated
+    uint64_t mantissa = 0;  // significant digits of the whole literal
+    int mantissa_digits = 0;
+    bool truncated = false; // more significant digits than fit
+    long exponent = 0;      // power of ten applied to the mantissa
+    bool is_double = false;
+
+    for (; pos < end && isdigit((unsigned char)data[pos]); pos++) {
+        unsigned digit = (unsigned)(data[pos] - '0');
+        magnitude = accumulate(magnitude, 10, digit);
+        if (mantissa_digits < FAST_PATH_MAX_DIGITS) {
+            mantissa = mantissa * 10 + digit;
+            mantissa_digits += mantissa != 0; // leading zeros are free
+        } else {
+            truncated = true;
+        }
+    }
+
+    if (pos < end && data[pos] == '.') {
+        is_double = true;
+        for (pos++; pos < end && isdigit((unsigned char)data[pos]); pos++) {
+            unsigned digit = (unsigned)(data[pos] - '0');
+            if (mantissa_digits < FAST_PATH_MAX_DIGITS) {
+                mantissa = mantissa * 10 + digit;
+                mantissa_digits += mantissa != 0;
+                exponent--;
+            } else {
+                truncated = true;
+            }
+        }
+    }
+
+    if (pos < end && (data[pos] == 'e' || data[pos] == 'E')) {
+        bool exponent_negative = false;
+        long written = 0;
+        is_double = true;
+        pos++;
+        if (pos < end && (data[pos] == '+' || data[pos] == '-')) {
+            exponent_negative = data[pos] == '-';
+            pos++;
+        }
+        size_t digits = pos;
+        for (; pos < end && isdigit((unsigned char)data[pos]); pos++) {
+            if (written < EXPONENT_LIMIT) {
+                written = written * 10 + (data[pos] - '0');
+            }
+        }
+        if (pos == digits) {
+            scanner->position = pos;
+            return SCANNER_ERROR; // Incomplete exponent
+        }
+        exponent += exponent_negative ? -written : written;
+    }
+    scanner->position = pos;
+
+    if (!is_double) {
+        token->type = TOKEN_INTEGER;
+        token->value.integer = narrow_integer(negative, magnitude);
+        return NO_ERROR;
+    }
+
+    token->type = TOKEN_DOUBLE;
+    if (!truncated && mantissa <= FAST_PATH_MAX_MANTISSA &&
+        exponent >= -22 && exponent <= 22) {
+        // Both operands are exact, so the single rounding is correct
+        double value = (double)mantissa;
+        value = exponent < 0 ? value / exact_powers_of_ten[-exponent]
+                             : value * exact_powers_of_ten[exponent];
+        token->value.decimal = negative ? -value : value;
+        return NO_ERROR;
     }
+    return convert_decimal_slow(data + start, pos - start,
+                                &token->value.decimal);
+}
 
-    // Initialize d_string
-    if (d_string_alloc(&d_string) != NO_ERROR) {
+/**
+ * @brief Scan the next token straight from the source buffer.
+ */
+static int scan_token(Scanner *scanner, Token *token) {
+    int c;                   // Current character
+    int state = STATE_START; // Current state of the scanner
+    int hex_count = 0;       // Counter for hexadecimal digits
+    size_t start = 0;        // Source offset where the current slice starts
+    unsigned slice_flags = SLICE_PLAIN; // How to read the current slice
+    bool ifj_spaced = false; // 'Ifj . name' written with spaces
+
+    if (scanner == NULL || scanner->scratch.str == NULL) {
         return ERROR_INTERNAL;
     }
 
     token->type = TOKEN_UNDEFINED;
-    d_string_clear(&d_string); // Clear the string for new token
 
     while (1) {
-        c = fgetc(source_file);
+        c = next_char(scanner);
 
         switch (state) {
         case STATE_START:
+            scanner->token_start = scanner->position - (c != EOF);
             if (c == '\n') {
                 // Skip multiple newlines, return only one EOL token
                 do {
-                    c = fgetc(source_file);
+                    c = next_char(scanner);
                 } while (c == '\n');
-                ungetc(c, source_file); // push back the first non-newline
+                unget_char(scanner, c); // push back the first non-newline
                 token->type = TOKEN_EOL;
                 return NO_ERROR;
             } else if (isspace(c)) { // Skip whitespace except newline
+                // Single blanks between tokens are skipped by the loop,
+                // only longer runs (indentation) go to the kernel
+                if (scanner->position < scanner->source.length &&
+                    scanner->source.data[scanner->position] == c) {
+                    scanner->position = scan_skip_blanks(
+                        scanner->source.data, scanner->position,
+                        scanner->source.length);
+                }
                 continue;
             } else if (c == EOF) {
                 token->type = TOKEN_EOF;
                 return NO_ERROR;
             } else if (isalpha(c) || c == '_') {
-                d_string_add_char(&d_string, c);
+                start = scanner->position - 1;
                 state = STATE_IDENTIFY_WORD;
-            } else if (c == '0') {
-                d_string_add_char(&d_string, c);
-                state = STATE_NUMBER; // Will handle 0x prefix in STATE_NUMBER
             } else if (isdigit(c)) {
-                d_string_add_char(&d_string, c);
-                state = STATE_NUMBER;
+                return scan_number(scanner, token);
             } else if (c == '"') {
                 // Check for multiline string (""")
-                char c2 = fgetc(source_file);
+                int c2 = next_char(scanner);
                 if (c2 == '"') {
-                    char c3 = fgetc(source_file);
+                    int c3 = next_char(scanner);
                     if (c3 == '"') {
                         state = STATE_MULTILINE_STRING;
                     } else {
                         // Put back characters and treat as regular string
-                        ungetc(c3, source_file);
-                        ungetc(c2, source_file);
+                        unget_char(scanner, c3);
+                        unget_char(scanner, c2);
                         state = STATE_STRING;
                     }
                 } else {
-                    ungetc(c2, source_file);
+                    unget_char(scanner, c2);
                     state = STATE_STRING;
                 }
+                start = scanner->position; // String content starts after the quotes
             } else if (c == '+') {
                 token->type = TOKEN_PLUS;
                 return NO_ERROR;
             } else if (c == '-') {
-                c = fgetc(source_file);
+                c = next_char(scanner);
                 if (isdigit(c)) {
-                    // Negative number
-                    d_string_add_char(&d_string, '-');
-                    d_string_add_char(&d_string, c);
-                    state = STATE_NUMBER;
+                    return scan_number(scanner, token); // Negative number
                 } else {
-                    ungetc(c, source_file);
+                    unget_char(scanner, c);
                     token->type = TOKEN_MINUS;
                     return NO_ERROR;
                 }
@@ -209,270 +551,166 @@ int get_token(Token *token) {
                 token->type = TOKEN_COMMA;
                 return NO_ERROR;
             } else {
-                exit(SCANNER_ERROR); // Unknown character
+                return SCANNER_ERROR; // Unknown character
             }
             break;
 
         case STATE_IDENTIFY_WORD:
-            if (isalnum(c) || c == '_') {
-                d_string_add_char(&d_string, c);
-            } else { // check if word is 'Ifj' and is followed by dot
-                if (d_string_cmp(&d_string, "Ifj") == 0) {
+            if (!isalnum(c) && c != '_') {
+                unget_char(scanner, c);
+                // check if word is 'Ifj' and is followed by dot
+                if (!ifj_spaced && scanner->position - start == 3 &&
+                    memcmp(scanner->source.data + start, "Ifj", 3) == 0) {
+                    size_t dot = scanner->position;
 
+                    c = next_char(scanner);
                     while (c == ' ') {
-                        c = fgetc(source_file);
+                        c = next_char(scanner);
                     }
 
                     if (c == '.') {
-                        d_string_add_char(&d_string, c);
-
                         // Skip whitespace after the dot
-                        c = fgetc(source_file);
+                        c = next_char(scanner);
                         while (c == ' ') {
-                            c = fgetc(source_file);
+                            c = next_char(scanner);
                         }
-                        d_string_add_char(&d_string, c);
-
-                    } else {
-                        ungetc(c, source_file);
-                        return check_keyword(&d_string, token);
+                        // The first name character is taken as it is, the
+                        // rest of the name continues as an ordinary word
+                        if (c != EOF &&
+                            scanner->position - 1 == start + 4 && // "Ifj." + name
+                            scanner->source.data[dot] == '.') {
+                            continue; // contiguous, keep the plain slice
+                        }
+                        ifj_spaced = true;
+                        start = c == EOF ? scanner->position : scanner->position - 1;
+                        continue;
                     }
-                    state = STATE_IDENTIFY_WORD;
-                    continue;
-                }
-                ungetc(c, source_file);
-                return check_keyword(&d_string, token);
-            }
-            break;
-
-        case STATE_NUMBER:
-            if (isdigit(c)) {
-                d_string_add_char(&d_string, c);
-            } else if (c == 'x' && d_string.length == 1 &&
-                       d_string.str[0] == '0') {
-                // Hexadecimal number
-                d_string_add_char(&d_string, c);
-                state = STATE_HEXADECIMAL;
-            } else if (c == '.') {
-                d_string_add_char(&d_string, c);
-                state = STATE_DECIMAL;
-            } else if (c == 'e' || c == 'E') {
-                d_string_add_char(&d_string, c);
-                state = STATE_EXPONENT;
-            } else {
-                ungetc(c, source_file);
-                // Convert to integer
-                token->type = TOKEN_INTEGER;
-                token->value.integer = atoi(d_string.str);
-                return NO_ERROR;
-            }
-            break;
-
-        case STATE_HEXADECIMAL:
-            if (isdigit(c) || (c >= 'a' && c <= 'f') ||
-                (c >= 'A' && c <= 'F')) {
-                d_string_add_char(&d_string, c);
-            } else {
-                ungetc(c, source_file);
-                if (d_string.length <= 2) { // Only "0x" without digits
-                    exit(SCANNER_ERROR);
+                    unget_char(scanner, c);
                 }
-                // Convert hexadecimal to integer
-                token->type = TOKEN_INTEGER;
-                token->value.integer = (int)strtol(d_string.str, NULL, 16);
-                return NO_ERROR;
-            }
-            break;
 
-        case STATE_DECIMAL:
-            if (isdigit(c)) {
-                d_string_add_char(&d_string, c);
-            } else if (c == 'e' || c == 'E') {
-                d_string_add_char(&d_string, c);
-                state = STATE_EXPONENT;
-            } else {
-                ungetc(c, source_file);
-                // Convert to double
-                token->type = TOKEN_DOUBLE;
-                token->value.decimal = atof(d_string.str);
-                return NO_ERROR;
-            }
-            break;
-
-        case STATE_EXPONENT:
-            if (isdigit(c)) {
-                d_string_add_char(&d_string, c);
-                state = STATE_EXPONENT; // Stay in exponent state
-            } else if ((c == '+' || c == '-') &&
-                       (d_string.str[d_string.length - 1] == 'e' ||
-                        d_string.str[d_string.length - 1] == 'E')) {
-                d_string_add_char(&d_string, c);
-            } else {
-                ungetc(c, source_file);
-                // Check if we have a valid exponent
-                char last_char = d_string.str[d_string.length - 1];
-                if (last_char == 'e' || last_char == 'E' || last_char == '+' ||
-                    last_char == '-') {
-                    exit(SCANNER_ERROR); // Incomplete exponent
+                if (ifj_spaced) {
+                    // Normalize to "Ifj.name", start points at the name
+                    d_string_clear(&scanner->scratch);
+                    if (d_string_add_str(&scanner->scratch, "Ifj.") != NO_ERROR ||
+                        d_string_add_n(&scanner->scratch, scanner->source.data + start,
+                                       scanner->position - start) != NO_ERROR) {
+                        return ERROR_INTERNAL;
+                    }
+                    token->type = TOKEN_IDENTIFIER;
+                    token->value.name = intern_n(scanner->scratch.str, scanner->scratch.length);
+                    return token->value.name ? NO_ERROR : ERROR_INTERNAL;
                 }
-                token->type = TOKEN_DOUBLE;
-                token->value.decimal = atof(d_string.str);
-                return NO_ERROR;
+                return check_keyword(scanner->source.data + start, scanner->position - start,
+                                     token);
             }
             break;
 
         case STATE_STRING:
             if (c == EOF) {
-                exit(SCANNER_ERROR); // Unterminated string
+                return SCANNER_ERROR; // Unterminated string
             } else if (c == '"') {
-                // End of string
+                // End of string, the slice covers the text between quotes
                 token->type = TOKEN_STRING;
-
-                // Allocate and copy dynamic string for string literals
-                token->value.string = malloc(sizeof(DynamicString));
-                if (token->value.string == NULL) {
-                    return ERROR_INTERNAL;
-                }
-
-                if (d_string_alloc(token->value.string) != NO_ERROR) {
-                    free(token->value.string);
-                    token->value.string = NULL;
-                    return ERROR_INTERNAL;
-                }
-
-                if (d_string_copy(&d_string, token->value.string) != NO_ERROR) {
-                    d_string_free(token->value.string);
-                    free(token->value.string);
-                    token->value.string = NULL;
-                    return ERROR_INTERNAL;
-                }
+                token->value.slice.offset = start;
+                token->value.slice.length = scanner->position - 1 - start;
+                token->value.slice.flags = slice_flags;
                 return NO_ERROR;
             } else if (c == '\\') {
+                slice_flags = SLICE_ESCAPED; // decoded by token_text
                 state = STATE_ESCAPE_SEQ;
             } else if (c == '\n') {
-                exit(SCANNER_ERROR); // Newline in string not allowed
+                return SCANNER_ERROR; // Newline in string not allowed
             } else {
-                d_string_add_char(&d_string, c);
+                // Plain characters: jump to the next quote, escape or newline
+                scanner->position = scan_find_string_mark(
+                    scanner->source.data, scanner->position,
+                    scanner->source.length);
             }
             break;
 
         case STATE_ESCAPE_SEQ:
-            if (c == '"') {
-                d_string_add_char(&d_string, '"');
-                state = STATE_STRING;
-            } else if (c == 'n') {
-                d_string_add_char(&d_string, '\n');
-                state = STATE_STRING;
-            } else if (c == 'r') {
-                d_string_add_char(&d_string, '\r');
-                state = STATE_STRING;
-            } else if (c == 't') {
-                d_string_add_char(&d_string, '\t');
-                state = STATE_STRING;
-            } else if (c == '\\') {
-                d_string_add_char(&d_string, '\\');
+            if (c == '"' || c == 'n' || c == 'r' || c == 't' || c == '\\') {
                 state = STATE_STRING;
             } else if (c == 'x') {
                 hex_count = 0;
-                hex_value = 0;
                 state = STATE_HEXADECIMAL2;
             } else {
-                exit(SCANNER_ERROR); // Invalid escape sequence
+                return SCANNER_ERROR; // Invalid escape sequence
             }
             break;
 
         case STATE_HEXADECIMAL2:
-            if (isdigit(c) || (c >= 'a' && c <= 'f') ||
-                (c >= 'A' && c <= 'F')) {
-                int digit_value;
-                if (isdigit(c)) {
-                    digit_value = c - '0';
-                } else if (c >= 'a' && c <= 'f') {
-                    digit_value = c - 'a' + 10;
-                } else {
-                    digit_value = c - 'A' + 10;
-                }
-                hex_value = hex_value * 16 + digit_value;
+            if (isxdigit(c)) {
                 hex_count++;
-
                 if (hex_count == 2) {
-                    d_string_add_char(&d_string, (char)hex_value);
                     state = STATE_STRING;
                 }
             } else {
-                exit(SCANNER_ERROR); // Invalid hexadecimal escape
+                return SCANNER_ERROR; // Invalid hexadecimal escape
             }
             break;
 
         case STATE_MULTILINE_STRING:
             if (c == EOF) {
-                exit(SCANNER_ERROR); // Unterminated multiline string
+                return SCANNER_ERROR; // Unterminated multiline string
             } else if (c == '"') {
                 // Check for closing """
-                char c2 = fgetc(source_file);
+                int c2 = next_char(scanner);
                 if (c2 == '"') {
-                    char c3 = fgetc(source_file);
+                    int c3 = next_char(scanner);
                     if (c3 == '"') {
-                        // End of multiline string
+                        // End of multiline string, taken verbatim
                         token->type = TOKEN_STRING;
-
-                        // Allocate and copy dynamic string for multiline
-                        // string
-                        token->value.string = malloc(sizeof(DynamicString));
-                        if (token->value.string == NULL) {
-                            return ERROR_INTERNAL;
-                        }
-
-                        if (d_string_alloc(token->value.string) != NO_ERROR) {
-                            free(token->value.string);
-                            token->value.string = NULL;
-                            return ERROR_INTERNAL;
-                        }
-
-                        if (d_string_copy(&d_string, token->value.string) !=
-                            NO_ERROR) {
-                            d_string_free(token->value.string);
-                            free(token->value.string);
-                            token->value.string = NULL;
-                            return ERROR_INTERNAL;
-                        }
-
+                        token->value.slice.offset = start;
+                        token->value.slice.length = scanner->position - 3 - start;
+                        token->value.slice.flags = SLICE_PLAIN;
                         return NO_ERROR;
                     } else {
-                        // Not closing, add chars to string
-                        d_string_add_char(&d_string, c);
-                        d_string_add_char(&d_string, c2);
-                        ungetc(c3, source_file);
+                        // Not closing, both quotes stay in the string
+                        unget_char(scanner, c3);
                     }
                 } else {
-                    d_string_add_char(&d_string, c);
-                    ungetc(c2, source_file);
+                    unget_char(scanner, c2);
                 }
             } else {
-                d_string_add_char(&d_string, c);
+                // Only a quote can end the string
+                const char *quote =
+                    memchr(scanner->source.data + scanner->position, '"',
+                           scanner->source.length - scanner->position);
+                scanner->position = quote ? (size_t)(quote - scanner->source.data)
+                                          : scanner->source.length;
             }
             break;
 
         case STATE_SLASH:
             if (c == '/') {
-                // Line comment
+                // Line comment, continue right before the end of the line
+                const char *newline =
+                    memchr(scanner->source.data + scanner->position, '\n',
+                           scanner->source.length - scanner->position);
+                scanner->position = newline ? (size_t)(newline - scanner->source.data)
+                                            : scanner->source.length;
                 state = STATE_COMMENT;
             } else if (c == '*') {
                 // Block comment - treat as whitespace
                 int block_depth = 1;
                 while (block_depth > 0) {
-                    c = fgetc(source_file);
+                    // Only '*' and '/' can open or close a level
+                    scanner->position = scan_find_comment_mark(
+                        scanner->source.data, scanner->position,
+                        scanner->source.length);
+                    c = next_char(scanner);
                     if (c == EOF) {
-                        exit(SCANNER_ERROR); // Unterminated block comment
-                    } else if (c == '/' && fgetc(source_file) == '*') {
+                        return SCANNER_ERROR; // Unterminated block comment
+                    } else if (c == '/' && next_char(scanner) == '*') {
                         block_depth++; // Nested block comment
-                    } else if (c == '*' && fgetc(source_file) == '/') {
+                    } else if (c == '*' && next_char(scanner) == '/') {
                         block_depth--; // End of block comment level
                     }
                 }
                 state = STATE_START; // Continue tokenizing
             } else {
-                ungetc(c, source_file);
+                unget_char(scanner, c);
                 token->type = TOKEN_DIVIDE;
                 return NO_ERROR;
             }
@@ -480,7 +718,7 @@ int get_token(Token *token) {
 
         case STATE_COMMENT:
             if (c == '\n' || c == EOF) {
-                ungetc(c, source_file); // Put back newline/EOF
+                unget_char(scanner, c); // Put back newline/EOF
                 state = STATE_START;
             }
             // Skip all other characters in comment
@@ -491,7 +729,7 @@ int get_token(Token *token) {
                 token->type = TOKEN_LOGIC_EQUAL;
                 return NO_ERROR;
             } else {
-                ungetc(c, source_file);
+                unget_char(scanner, c);
                 token->type = TOKEN_EQUAL;
                 return NO_ERROR;
             }
@@ -502,7 +740,7 @@ int get_token(Token *token) {
                 token->type = TOKEN_NEQUAL;
                 return NO_ERROR;
             } else {
-                ungetc(c, source_file);
+                unget_char(scanner, c);
                 token->type = TOKEN_NOT;
                 return NO_ERROR;
             }
@@ -513,7 +751,7 @@ int get_token(Token *token) {
                 token->type = TOKEN_LESSER_EQUAL;
                 return NO_ERROR;
             } else {
-                ungetc(c, source_file);
+                unget_char(scanner, c);
                 token->type = TOKEN_LESSER;
                 return NO_ERROR;
             }
@@ -524,27 +762,512 @@ int get_token(Token *token) {
                 token->type = TOKEN_GREATER_EQUAL;
                 return NO_ERROR;
             } else {
-                ungetc(c, source_file);
+                unget_char(scanner, c);
                 token->type = TOKEN_GREATER;
                 return NO_ERROR;
             }
             break;
 
         default:
-            exit(SCANNER_ERROR);
+            return SCANNER_ERROR;
+        }
+    }
+}
+
+/**
+ * @brief Grow all token array columns to `capacity` entries.
+ */
+static int token_array_reserve(TokenArray *array, size_t capacity) {
+    uint8_t *types = realloc(array->types, capacity * sizeof(uint8_t));
+    if (!types) {
+        return ERROR_INTERNAL;
+    }
+    array->types = types;
+    PackedTokenValue *values =
+        realloc(array->values, capacity * sizeof(PackedTokenValue));
+    if (!values) {
+        return ERROR_INTERNAL;
+    }
+    array->values = values;
+    TokenSpan *spans = realloc(array->spans, capacity * sizeof(TokenSpan));
+    if (!spans) {
+        return ERROR_INTERNAL;
+    }
+    array->spans = spans;
+    array->capacity = capacity;
+    return NO_ERROR;
+}
+
+/**
+ * @brief Append one scanned token to the token array.
+ */
+static int token_array_push(TokenArray *array, const Token *token,
+                            size_t start, size_t end) {
+    if (array->count == array->capacity &&
+        token_array_reserve(array, array->capacity * 2) != NO_ERROR) {
+        return ERROR_INTERNAL;
+    }
+    size_t i = array->count++;
+    PackedTokenValue *value = &array->values[i];
+
+    array->types[i] = (uint8_t)token->type;
+    array->spans[i].start = (uint32_t)start;
+    array->spans[i].length = (uint32_t)(end - start);
+    switch (token->type) {
+    case TOKEN_STRING:
+        value->string.quotes = (uint8_t)(token->value.slice.offset - start);
+        value->string.flags = (uint8_t)token->value.slice.flags;
+        break;
+    case TOKEN_IDENTIFIER:
+    case TOKEN_GLOBAL_VAR:
+        value->name = token->value.name;
+        break;
+    case TOKEN_DOUBLE:
+        value->decimal = token->value.decimal;
+        break;
+    case TOKEN_INTEGER:
+        value->integer = token->value.integer;
+        break;
+    default:
+        value->keyword = token->value.keyword;
+        break;
+    }
+    return NO_ERROR;
+}
+
+/**
+ * @brief Rebuild token `index` of the array as a full Token.
+ */
+static void token_array_get(const TokenArray *array, size_t index,
+                            Token *token) {
+    const PackedTokenValue *value = &array->values[index];
+
+    token->type = (TokenType)array->types[index];
+    switch (token->type) {
+    case TOKEN_STRING: {
+        const TokenSpan *span = &array->spans[index];
+        token->value.slice.offset = span->start + value->string.quotes;
+        token->value.slice.length = span->length - 2u * value->string.quotes;
+        token->value.slice.flags = value->string.flags;
+        break;
+    }
+    case TOKEN_IDENTIFIER:
+    case TOKEN_GLOBAL_VAR:
+        token->value.name = value->name;
+        break;
+    case TOKEN_DOUBLE:
+        token->value.decimal = value->decimal;
+        break;
+    case TOKEN_INTEGER:
+        token->value.integer = value->integer;
+        break;
+    default:
+        token->value.keyword = value->keyword;
+        break;
+    }
+}
+
+int scanner_tokenize_all(Scanner *scanner) {
+    Token token;
+
+    if (scanner == NULL || scanner->scratch.str == NULL) {
+        return ERROR_INTERNAL;
+    }
+    if (scanner->pretokenized || scanner->pipe ||
+        scanner->source.length >= UINT32_MAX) {
+        return NO_ERROR; // already done, pipelined or too large for spans
+    }
+    TokenArray *array = &scanner->buffered;
+    // Dense sources have a token every 3-4 bytes, start close to that
+    size_t capacity = scanner->source.length / 3 + 16;
+    if (array->capacity < capacity &&
+        token_array_reserve(array, capacity) != NO_ERROR) {
+        return ERROR_INTERNAL;
+    }
+
+    array->count = 0;
+    array->next = 0;
+    array->status = NO_ERROR;
+    while (1) {
+        int result = scan_token(scanner, &token);
+        if (result != NO_ERROR) {
+            array->status = result; // reported when the consumer gets here
+            break;
+        }
+        if (token_array_push(array, &token, scanner->token_start,
+                             scanner->position) != NO_ERROR) {
+            return ERROR_INTERNAL;
+        }
+        if (token.type == TOKEN_EOF) {
+            break;
         }
     }
+    scanner->pretokenized = true;
+    return NO_ERROR;
+}
+
+/**
+ * @brief Release the columns of a token array.
+ */
+static void token_array_free(TokenArray *array) {
+    free(array->types);
+    free(array->values);
+    free(array->spans);
+    memset(array, 0, sizeof(*array));
+}
+
+/**
+ * @brief Tell whether token `i` of `a` and token `j` of `b` are identical.
+ */
+static bool token_array_same(const TokenArray *a, size_t i,
+                             const TokenArray *b, size_t j) {
+    if (a->types[i] != b->types[j] ||
+        a->spans[i].start != b->spans[j].start ||
+        a->spans[i].length != b->spans[j].length) {
+        return false;
+    }
+    const PackedTokenValue *x = &a->values[i];
+    const PackedTokenValue *y = &b->values[j];
+    switch ((TokenType)a->types[i]) {
+    case TOKEN_STRING:
+        return x->string.quotes == y->string.quotes &&
+               x->string.flags == y->string.flags;
+    case TOKEN_IDENTIFIER:
+    case TOKEN_GLOBAL_VAR:
+        return x->name == y->name;
+    case TOKEN_DOUBLE:
+        return memcmp(&x->decimal, &y->decimal, sizeof(double)) == 0;
+    case TOKEN_INTEGER:
+        return x->integer == y->integer;
+    case TOKEN_KEYWORD:
+        return x->keyword == y->keyword;
+    default:
+        return true;
+    }
+}
+
+/**
+ * @brief Edit the source and lex it again from the start, for scanners
+ *        that have no token array to update.
+ */
+static int relex_all(Scanner *scanner, const SourceEdit *edit,
+                     TokenChange *change) {
+    size_t old_count = scanner->pretokenized ? scanner->buffered.count : 0;
+
+    if (source_buffer_splice(&scanner->source, edit->offset, edit->removed,
+                             edit->inserted,
+                             edit->inserted_length) != NO_ERROR) {
+        return ERROR_INTERNAL;
+    }
+    scanner->position = 0;
+    scanner->pretokenized = false;
+    if (scanner_tokenize_all(scanner) != NO_ERROR) {
+        return ERROR_INTERNAL;
+    }
+    change->first = 0;
+    change->removed = old_count;
+    change->inserted = scanner->pretokenized ? scanner->buffered.count : 0;
+    return NO_ERROR;
+}
+
+int scanner_relex(Scanner *scanner, const SourceEdit *edit,
+                  TokenChange *change) {
+    TokenChange unused;
+    TokenArray fresh = {0};
+    Token token;
+
+    if (scanner == NULL || edit == NULL || scanner->scratch.str == NULL ||
+        scanner->pipe) {
+        return ERROR_INTERNAL;
+    }
+    TokenArray *array = &scanner->buffered;
+    if (change == NULL) {
+        change = &unused;
+    }
+    size_t old_length = scanner->source.length;
+    if (edit->offset > old_length ||
+        edit->removed > old_length - edit->offset) {
+        return ERROR_INTERNAL;
+    }
+    // Line numbers are counted again on the next location query
+    scanner->line = 1;
+    scanner->line_start = 0;
+    scanner->counted = 0;
+    size_t length = old_length - edit->removed + edit->inserted_length;
+    if (!scanner->pretokenized || length >= UINT32_MAX) {
+        return relex_all(scanner, edit, change);
+    }
+
+    // Restart behind the last EOL token that ends before the edit. Its
+    // newline is outside strings and comments, and no token before it
+    // looked at bytes past it.
+    size_t first = 0, lo = 0, hi = array->count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if ((size_t)array->spans[mid].start + array->spans[mid].length <
+            edit->offset) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    for (size_t i = lo; i > 0; i--) {
+        if (array->types[i - 1] == TOKEN_EOL) {
+            first = i;
+            break;
+        }
+    }
+    size_t restart = first ? (size_t)array->spans[first - 1].start +
+                                 array->spans[first - 1].length
+                           : 0;
+
+    // Old tokens starting behind the removed bytes are resync candidates
+    size_t edit_end = edit->offset + edit->removed;
+    size_t old = first;
+    while (old < array->count && array->spans[old].start < edit_end) {
+        old++;
+    }
+
+    if (source_buffer_splice(&scanner->source, edit->offset, edit->removed,
+                             edit->inserted,
+                             edit->inserted_length) != NO_ERROR ||
+        token_array_reserve(&fresh, 64) != NO_ERROR) {
+        token_array_free(&fresh);
+        return ERROR_INTERNAL;
+    }
+
+    scanner->position = restart;
+    bool resynced = false;
+    int status = NO_ERROR;
+    while (1) {
+        int result = scan_token(scanner, &token);
+        if (result != NO_ERROR) {
+            status = result;
+            break;
+        }
+        // Compare positions in old coordinates: new = old - removed + inserted
+        size_t start = scanner->token_start;
+        while (old < array->count && (size_t)array->spans[old].start +
+                                             edit->inserted_length <
+                                         start + edit->removed) {
+            old++;
+        }
+        if (old < array->count && (size_t)array->spans[old].start +
+                                          edit->inserted_length ==
+                                      start + edit->removed) {
+            resynced = true; // the rest of the stream is unchanged
+            break;
+        }
+        if (token_array_push(&fresh, &token, start, scanner->position) !=
+            NO_ERROR) {
+            token_array_free(&fresh);
+            return ERROR_INTERNAL;
+        }
+        if (token.type == TOKEN_EOF) {
+            break;
+        }
+    }
+
+    // Splice: array[first, old) becomes fresh, array[old, count) moves
+    size_t kept = resynced ? array->count - old : 0;
+    size_t count = first + fresh.count + kept;
+    if (count > array->capacity &&
+        token_array_reserve(array, count + count / 4) != NO_ERROR) {
+        token_array_free(&fresh);
+        return ERROR_INTERNAL;
+    }
+    size_t target = first + fresh.count;
+    if (kept) {
+        // Typing inside a token keeps the token count, nothing moves then
+        if (target != old) {
+            memmove(array->types + target, array->types + old,
+                    kept * sizeof(uint8_t));
+            memmove(array->values + target, array->values + old,
+                    kept * sizeof(PackedTokenValue));
+            memmove(array->spans + target, array->spans + old,
+                    kept * sizeof(TokenSpan));
+        }
+        uint32_t delta = (uint32_t)edit->inserted_length -
+                         (uint32_t)edit->removed; // wraps for deletions
+        if (delta) {
+            for (size_t i = target; i < target + kept; i++) {
+                array->spans[i].start += delta;
+            }
+        }
+    } else {
+        array->status = status;
+    }
+
+    // Tokens lexed again before the edit usually did not change
+    size_t same = 0;
+    size_t old_end = resynced ? old : array->count;
+    while (same < fresh.count && first + same < old_end &&
+           token_array_same(&fresh, same, array, first + same)) {
+        same++;
+    }
+    change->first = first + same;
+    change->removed = old_end - first - same;
+    change->inserted = fresh.count - same;
+
+    memcpy(array->types + first, fresh.types, fresh.count * sizeof(uint8_t));
+    memcpy(array->values + first, fresh.values,
+           fresh.count * sizeof(PackedTokenValue));
+    memcpy(array->spans + first, fresh.spans,
+           fresh.count * sizeof(TokenSpan));
+    array->count = count;
+    array->next = 0;
+    token_array_free(&fresh);
+    return NO_ERROR;
+}
+
+/**
+ * @brief Token `index` of the pre-lexed stream, or its terminating error.
+ */
+static int buffered_token(const TokenArray *array, size_t index, Token *token) {
+    if (index < array->count) {
+        token_array_get(array, index, token);
+        return NO_ERROR;
+    }
+    if (array->status != NO_ERROR) {
+        token->type = TOKEN_UNDEFINED;
+        return array->status;
+    }
+    // Past the end the stream keeps returning EOF, like the scanner does
+    token_array_get(array, array->count - 1, token);
+    return NO_ERROR;
+}
+
+int get_token(Scanner *scanner, Token *token) {
+    if (scanner != NULL && scanner->pipe) {
+        return token_pipe_get(scanner->pipe, scanner, token);
+    }
+    if (scanner != NULL && scanner->pretokenized) {
+        TokenArray *array = &scanner->buffered;
+        int result = buffered_token(array, array->next, token);
+        if (array->next < array->count) {
+            array->next++;
+        }
+        return result;
+    }
+    return scan_token(scanner, token);
+}
+
+int peek_token(Scanner *scanner, size_t ahead, Token *token) {
+    if (scanner == NULL || scanner->scratch.str == NULL) {
+        return ERROR_INTERNAL;
+    }
+    if (scanner->pipe) {
+        return token_pipe_peek(scanner->pipe, ahead, token);
+    }
+    if (scanner->pretokenized) {
+        TokenArray *array = &scanner->buffered;
+        return buffered_token(array, array->next + ahead, token);
+    }
+
+    // Streaming mode: scan ahead, then rewind the cursor
+    size_t position = scanner->position;
+    size_t token_start = scanner->token_start;
+    int result = NO_ERROR;
+    for (size_t i = 0; i <= ahead && result == NO_ERROR; i++) {
+        result = scan_token(scanner, token);
+    }
+    scanner->position = position;
+    scanner->token_start = token_start;
+    return result;
+}
+
+/**
+ * @brief Value of a hexadecimal digit character.
+ */
+static int hex_digit_value(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    } else if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return c - 'A' + 10;
+}
+
+/**
+ * @brief Decode the escape sequences of a string literal slice.
+ *
+ * The slice was validated while scanning, so every backslash starts one of
+ * the supported sequences.
+ */
+static void decode_escapes(const char *text, size_t length,
+                           DynamicString *out) {
+    // Decoding never makes the text longer
+    d_string_reserve(out, out->length + length);
+    for (size_t i = 0; i < length; i++) {
+        if (text[i] != '\\') {
+            d_string_add_char(out, text[i]);
+            continue;
+        }
+        switch (text[++i]) {
+        case 'n':
+            d_string_add_char(out, '\n');
+            break;
+        case 'r':
+            d_string_add_char(out, '\r');
+            break;
+        case 't':
+            d_string_add_char(out, '\t');
+            break;
+        case 'x':
+            d_string_add_char(out, (char)(hex_digit_value(text[i + 1]) * 16 +
+                                          hex_digit_value(text[i + 2])));
+            i += 2;
+            break;
+        default: // '"' and '\\' stand for themselves
+            d_string_add_char(out, text[i]);
+            break;
+        }
+    }
+}
+
+const char *token_text(Scanner *scanner, const Token *token, size_t *length) {
+    if (token->type != TOKEN_STRING) {
+        *length = strlen(token->value.name);
+        return token->value.name;
+    }
+
+    const TokenSlice *slice = &token->value.slice;
+    const char *text = slice->length ? scanner->source.data + slice->offset : "";
+
+    if (slice->flags == SLICE_PLAIN) {
+        *length = slice->length;
+        return text;
+    }
+
+    d_string_clear(&scanner->scratch);
+    decode_escapes(text, slice->length, &scanner->scratch);
+    *length = scanner->scratch.length;
+    return scanner->scratch.str;
+}
+
+int token_text_cmp(Scanner *scanner, const Token *token, const char *str) {
+    size_t length;
+    const char *text = token_text(scanner, token, &length);
+    // Text ends at an embedded NUL, just like a C string copy of it would
+    size_t text_length = 0;
+    while (text_length < length && text[text_length] != '\0') {
+        text_length++;
+    }
+    return !(strlen(str) == text_length &&
+             memcmp(text, str, text_length) == 0);
 }
 
 // helper function to print token types for debugging (can be removed later)
-void print_token_types() {
+void print_token_types(Scanner *scanner) {
     Token token;
     int result;
+    const char *text;
+    size_t length;
 
     printf("List of token types:\n");
 
     while (1) {
-        result = get_token(&token);
+        result = get_token(scanner, &token);
 
         if (result != NO_ERROR) {
             printf("Scanner error: %d\n", result);
@@ -565,12 +1288,10 @@ void print_token_types() {
             printf("EOL");
             break;
         case TOKEN_GLOBAL_VAR:
-            printf("GLOBAL_VAR=\"%s\"",
-                   token.value.string ? token.value.string->str : "NULL");
+            printf("GLOBAL_VAR=\"%s\"", token.value.name);
             break;
         case TOKEN_IDENTIFIER:
-            printf("IDENTIFIER=\"%s\"",
-                   token.value.string ? token.value.string->str : "NULL");
+            printf("IDENTIFIER=\"%s\"", token.value.name);
             break;
         case TOKEN_KEYWORD:
             switch (token.value.keyword) {
@@ -628,8 +1349,8 @@ void print_token_types() {
             printf("DOUBLE=%f", token.value.decimal);
             break;
         case TOKEN_STRING:
-            printf("STRING=\"%s\"",
-                   token.value.string ? token.value.string->str : "NULL");
+            text = token_text(scanner, &token, &length);
+            printf("STRING=\"%.*s\"", (int)length, text);
             break;
         case TOKEN_PLUS:
             printf("PLUS");
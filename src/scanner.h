@@ -13,7 +13,9 @@
 
 #include "dynamic_string.h"
 #include "error.h"
+#include "source_buffer.h"
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 
 /**
@@ -97,18 +99,37 @@ typedef enum {
     KEYWORD_NULL_C ///< capitalized 'Null'
 } Keyword;
 
+/**
+ * @brief Slice flags describing how to turn a slice into the token text.
+ */
+#define SLICE_PLAIN 0   ///< text is exactly the sliced source bytes
+#define SLICE_ESCAPED 1 ///< string literal with escape sequences to decode
+
+/**
+ * @brief Reference to the text of a string literal inside the source buffer.
+ *
+ * The slice covers the characters between the quotes.
+ */
+typedef struct {
+    size_t offset; ///< first byte of the slice in the source buffer
+    size_t length; ///< number of source bytes covered
+    unsigned flags; ///< SLICE_* flags
+} TokenSlice;
+
 /**
  * @brief Token payload. Only the field matching the token type is valid.
  *
- * - For identifiers, global variables and string literals the `string`
- *   field holds a pointer to a `DynamicString` with the textual value.
+ * - Identifiers and global variables carry their interned name (see
+ *   intern.h); `Ifj . name` is normalized to "Ifj.name".
+ * - String literals carry a `slice` into the source buffer; use
+ *   `token_text` to obtain the actual characters.
  */
 typedef union {
-    Keyword keyword; ///< for TOKEN_KEYWORD
-    int integer;     ///< for TOKEN_INTEGER
-    double decimal;  ///< for TOKEN_DOUBLE
-    DynamicString
-        *string; ///< for TOKEN_IDENTIFIER/TOKEN_GLOBAL_VAR/TOKEN_STRING
+    Keyword keyword;  ///< for TOKEN_KEYWORD
+    int integer;      ///< for TOKEN_INTEGER
+    double decimal;   ///< for TOKEN_DOUBLE
+    const char *name; ///< for TOKEN_IDENTIFIER/TOKEN_GLOBAL_VAR
+    TokenSlice slice; ///< for TOKEN_STRING
 } TokenValue;
 
 /**
@@ -120,31 +141,249 @@ typedef struct Token {
 } Token;
 
 /**
- * @brief Set the source file used by the scanner.
+ * @brief Source range a token was scanned from.
+ */
+typedef struct {
+    uint32_t start;  ///< offset of the first token character
+    uint32_t length; ///< number of source bytes in the token
+} TokenSpan;
+
+/**
+ * @brief 8-byte token payload stored in a TokenArray.
  *
+ * String literals keep only what their span does not already say: the
+ * number of quotes on each side and the slice flags.
+ */
+typedef union {
+    Keyword keyword;  ///< for TOKEN_KEYWORD
+    int integer;      ///< for TOKEN_INTEGER
+    double decimal;   ///< for TOKEN_DOUBLE
+    const char *name; ///< for TOKEN_IDENTIFIER/TOKEN_GLOBAL_VAR
+    struct {
+        uint8_t quotes; ///< 1 for "...", 3 for """..."""
+        uint8_t flags;  ///< SLICE_* flags
+    } string;           ///< for TOKEN_STRING
+} PackedTokenValue;
+
+/**
+ * @brief Whole token stream of a program, lexed up front.
+ *
+ * Stored as three parallel arrays (1 byte type, 8 byte payload, 8 byte
+ * span), i.e. 17 bytes per token instead of a full Token plus span. The
+ * stream ends with TOKEN_EOF, or with the lexical error stored in
+ * `status`, which is reported only once the consumer reaches it, exactly
+ * where streaming mode would report it.
+ */
+typedef struct {
+    uint8_t *types;           ///< TokenType of each token
+    PackedTokenValue *values; ///< payload of each token
+    TokenSpan *spans;         ///< source range of each token
+    size_t count;             ///< number of scanned tokens
+    size_t capacity;  ///< allocated entries in both arrays
+    size_t next;      ///< index of the next token handed out
+    int status;       ///< error that stopped lexing, NO_ERROR after EOF
+} TokenArray;
+
+/**
+ * @brief One text edit of the source program.
+ */
+typedef struct {
+    size_t offset;          ///< first replaced byte of the current source
+    size_t removed;         ///< number of replaced bytes
+    const char *inserted;   ///< replacement text (not NUL-terminated)
+    size_t inserted_length; ///< number of bytes in `inserted`
+} SourceEdit;
+
+/**
+ * @brief Tokens replaced by `scanner_relex`.
+ *
+ * Old tokens `first .. first + removed - 1` were replaced by the new tokens
+ * `first .. first + inserted - 1`. Tokens before `first` are unchanged,
+ * tokens after the range are the same tokens moved by `inserted - removed`
+ * places, with spans moved by the length difference of the edit.
+ */
+typedef struct {
+    size_t first;    ///< index of the first changed token
+    size_t removed;  ///< number of old tokens replaced
+    size_t inserted; ///< number of new tokens in their place
+} TokenChange;
+
+/**
+ * @brief Scanner state for one source program.
+ *
+ * All lexer state lives here, so independent scanners can run side by side
+ * in one process. Line numbers are not tracked while scanning; they are
+ * computed on request by `scanner_location`, which caches its progress in
+ * `line`, `line_start` and `counted`.
+ */
+typedef struct Scanner {
+    SourceBuffer source;   ///< whole source program
+    size_t position;       ///< cursor into `source`
+    DynamicString scratch; ///< scratch text, allocated once per scanner
+    unsigned line;         ///< line of offset `counted`
+    size_t line_start;     ///< offset where that line starts
+    size_t counted;        ///< newlines before this offset are counted
+    size_t token_start;    ///< offset where the last scanned token starts
+    TokenArray buffered;   ///< pre-lexed tokens, used when `pretokenized`
+    bool pretokenized;     ///< tokens are served from `buffered`
+    struct TokenPipe *pipe; ///< scanner thread serving the tokens, or NULL
+} Scanner;
+
+/**
+ * @brief Initialize a scanner over the whole content of a stream.
+ *
+ * The stream is loaded up front (memory-mapped for regular files, read
+ * in for pipes) and may be closed afterwards.
+ *
+ * @param scanner Scanner to initialize.
  * @param f Input file stream (e.g. stdin or fopen result).
+ * @return NO_ERROR on success or ERROR_INTERNAL when the input cannot be
+ *         loaded.
+ */
+int scanner_init_file(Scanner *scanner, FILE *f);
+
+/**
+ * @brief Initialize a scanner over an in-memory buffer owned by the caller.
+ *
+ * @param scanner Scanner to initialize.
+ * @param data Source text (does not need to be NUL-terminated).
+ * @param length Number of bytes in `data`.
+ * @return NO_ERROR on success or ERROR_INTERNAL on allocation failure.
+ */
+int scanner_init_buffer(Scanner *scanner, const char *data, size_t length);
+
+/**
+ * @brief Release everything owned by a scanner.
+ *
+ * @param scanner Scanner to free.
+ */
+void scanner_free(Scanner *scanner);
+
+/**
+ * @brief Line and column (both 1-based) of a source offset.
+ *
+ * Newlines are counted from the previous query on, so walking forward
+ * through the source costs O(n) in total.
+ *
+ * @param scanner Scanner owning the source.
+ * @param offset Source offset, e.g. `token_start` or a TokenSpan start.
+ * @param line Output: line number.
+ * @param column Output: column number.
  */
-void set_source_file(FILE *f);
+void scanner_location(Scanner *scanner, size_t offset, unsigned *line,
+                      unsigned *column);
+
+/**
+ * @brief Lex the whole remaining source into a token array.
+ *
+ * Afterwards `get_token` and `peek_token` serve tokens from the array in
+ * O(1). A lexical error stops lexing but is only returned by `get_token`
+ * once all tokens before it were consumed. Sources of 4 GB and more stay
+ * in streaming mode, as spans are stored as 32-bit offsets, and so does a
+ * pipelined scanner (see token_pipe.h).
+ *
+ * @param scanner Scanner to switch into pre-tokenized mode.
+ * @return NO_ERROR on success or ERROR_INTERNAL on allocation failure.
+ */
+int scanner_tokenize_all(Scanner *scanner);
+
+/**
+ * @brief Apply an edit to the source and update the token array.
+ *
+ * Only the part of the source the edit can influence is lexed again: from
+ * the start of the line containing the edit (the end of the preceding EOL
+ * token, which lies outside any string or comment) up to the first token
+ * that starts where an old token after the edit started. From there on the
+ * text is the same, so the old tokens are kept and only their spans move.
+ *
+ * The source becomes a heap copy owned by the scanner on the first edit.
+ * A scanner that is not pre-tokenized yet is lexed as a whole. The token
+ * cursor is reset, so the next `get_token` returns the first token again.
+ *
+ * @param scanner Scanner to update.
+ * @param edit Edit of the current source text.
+ * @param change Output: the replaced token range (may be NULL).
+ * @return NO_ERROR on success or ERROR_INTERNAL on an invalid edit range,
+ *         a pipelined scanner or allocation failure. Lexical errors are stored in the token
+ *         array like in `scanner_tokenize_all`.
+ */
+int scanner_relex(Scanner *scanner, const SourceEdit *edit,
+                  TokenChange *change);
+
+/**
+ * @brief Look at an upcoming token without consuming it.
+ *
+ * In pre-tokenized mode this is an array lookup and in pipelined mode a
+ * look into the token ring; in streaming mode the tokens are scanned and
+ * the cursor is moved back afterwards.
+ *
+ * @param scanner Scanner to read from.
+ * @param ahead 0 for the token the next `get_token` call returns, 1 for
+ *        the one after it, etc.
+ * @param token Output: the upcoming token.
+ * @return Same as `get_token` would return for that token.
+ */
+int peek_token(Scanner *scanner, size_t ahead, Token *token);
 
 /**
  * @brief Simple debug helper that prints token types until EOF.
  *
  * Intended for development/testing; not used by the parser.
  */
-void print_token_types(void);
+void print_token_types(Scanner *scanner);
 
 /**
- * @brief Obtain the next token from the input stream.
+ * @brief Obtain the next token from the source buffer.
  *
  * On success the function initializes the provided `Token` structure.
- * For token types that allocate a `DynamicString` (identifiers, global
- * variables, string literals) the caller is responsible for freeing
- * the `DynamicString` when it is no longer needed.
+ * Names are interned and string literals only reference the source
+ * buffer, so tokens never own memory and need no cleanup.
  *
+ * @param scanner Scanner to read from.
  * @param token Pointer to Token structure to populate.
  * @return NO_ERROR on success, SCANNER_ERROR on lexical error or
  *         ERROR_INTERNAL on internal failures (allocation etc.).
  */
-int get_token(Token *token);
+int get_token(Scanner *scanner, Token *token);
+
+/**
+ * @brief Classify a word as a keyword.
+ *
+ * The word length and first character select at most one candidate
+ * keyword, which is then confirmed with a single memcmp.
+ *
+ * @param word Word characters (need not be NUL-terminated).
+ * @param length Number of characters in `word`.
+ * @param keyword Output: the recognized keyword (untouched otherwise).
+ * @return true if the word is a keyword, false otherwise.
+ */
+bool keyword_lookup(const char *word, size_t length, Keyword *keyword);
+
+/**
+ * @brief Get the characters of an identifier, global variable or string
+ * literal token.
+ *
+ * Names are returned as their interned handle. Plain string slices are
+ * returned as a pointer straight into the source buffer, escaped string
+ * literals are decoded into the scanner scratch buffer, which stays valid
+ * until the next `get_token` or `token_text` call. The returned text is
+ * NOT NUL-terminated.
+ *
+ * @param scanner Scanner that produced the token.
+ * @param token Identifier, global variable or string literal token.
+ * @param length Output: number of characters in the returned text.
+ * @return Pointer to the token text.
+ */
+const char *token_text(Scanner *scanner, const Token *token, size_t *length);
+
+/**
+ * @brief Compare the text of a name or string token with a C string.
+ *
+ * @param scanner Scanner that produced the token.
+ * @param token Identifier, global variable or string literal token.
+ * @param str NUL-terminated string to compare with.
+ * @return 0 if equal, non-zero otherwise.
+ */
+int token_text_cmp(Scanner *scanner, const Token *token, const char *str);
 
 #endif // _SCANNER_H
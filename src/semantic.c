@@ -11,6 +11,10 @@
  */
 
 #include "semantic.h"
+#include "arena.h"
+#include "ast_walk.h"
+#include "intern.h"
+#include "parser.h"
 #include <stdio.h>
 #include <stdbool.h>
 #include <stdlib.h>
@@ -24,7 +28,26 @@
 #define MAX_BUILTIN_KEY_LENGTH 64
 
 /** @brief Global pointer to current function being analyzed (for variable tracking) */
-ASTNode *func_node;
+static _Thread_local ASTNode *func_node;
+
+/** @brief Last declaration appended to a function's var_next chain, and
+ * that function: appending does not walk the whole chain again */
+static _Thread_local ASTNode *last_var_decl;
+static _Thread_local ASTNode *last_var_func;
+
+/**
+ * @brief Function whose deferred body was parsed after its definition had
+ * been visited, so the body still has to be analyzed.
+ */
+typedef struct PendingBody {
+    ASTNode *definition;
+    struct PendingBody *next;
+} PendingBody;
+
+/** @brief Bodies waiting for analysis in the order the calls were found
+ * (lazy mode, see parser_parse_body) */
+static _Thread_local PendingBody *pending_bodies;
+static _Thread_local PendingBody *last_pending_body;
 
 /**
  * @brief Annotates expression tree nodes with their resolved scopes
@@ -65,12 +88,11 @@ static void annotate_expr_scopes(ExprNode *expr, Scope *scope) {
  * them from variables and functions with the same base name.
  * 
  * @param name Base name of the getter (without suffix)
- * @return Dynamically allocated key string "name$get", or NULL on allocation failure
- * @note Caller must free the returned string
+ * @return Key string "name$get" in the semantic arena, or NULL on allocation failure
  */
 static char* make_getter_key(const char *name) {
     size_t len = strlen(name) + 5;
-    char *key = malloc(len);
+    char *key = arena_alloc(phase_arena(ARENA_SEMANTIC), len);
     if (!key) return NULL;
     snprintf(key, len, "%s$get", name);
     return key;
@@ -83,36 +105,31 @@ static char* make_getter_key(const char *name) {
  * them from variables and functions with the same base name.
  * 
  * @param name Base name of the setter (without suffix)
- * @return Dynamically allocated key string "name$set", or NULL on allocation failure
- * @note Caller must free the returned string
+ * @return Key string "name$set" in the semantic arena, or NULL on allocation failure
  */
 static char* make_setter_key(const char *name) {
     size_t len = strlen(name) + 5;
-    char *key = malloc(len);
+    char *key = arena_alloc(phase_arena(ARENA_SEMANTIC), len);
     if (!key) return NULL;
     snprintf(key, len, "%s$set", name);
     return key;
 }
 
 /**
- * @brief Searches AVL tree for any key with given prefix (DFS)
+ * @brief Checks whether a symbol is a function whose key has a given prefix
  * 
  * Used to check if any function overload exists (any parameter count).
- * Performs depth-first search through the symbol table's AVL tree.
+ * Called by symtable_foreach for every symbol of a table.
  * 
- * @param node Current AVL tree node being examined
- * @param prefix Prefix to search for (e.g., "functionName$")
- * @return true if at least one matching function key found, false otherwise
+ * @param key Key of the symbol being examined
+ * @param data The symbol
+ * @param context Prefix to search for (e.g., "functionName$")
+ * @return true if the key is a matching function key (stops the search)
  */
-static bool symtable_has_key_prefix(SNode *node, const char *prefix) {
-    if (!node) return false;
+static bool symtable_has_key_prefix(const char *key, SymTableData *data, void *context) {
+    const char *prefix = context;
     size_t plen = strlen(prefix);
-    if (strncmp(node->key, prefix, plen) == 0) {
-        if (node->data && node->data->type == NODE_FUNC) return true;
-    }
-    if (symtable_has_key_prefix(node->left, prefix)) return true;
-    if (symtable_has_key_prefix(node->right, prefix)) return true;
-    return false;
+    return strncmp(key, prefix, plen) == 0 && data && data->type == NODE_FUNC;
 }
 
 /**
@@ -130,28 +147,32 @@ static bool any_arity_function_exists(Scope *scope, const char *func_name) {
     char prefix[MAX_FUNCTION_KEY_LENGTH];
     snprintf(prefix, sizeof(prefix), "%s$", func_name);
     for (Scope *s = scope; s; s = s->parent) {
-        if (symtable_has_key_prefix(s->symbols.root, prefix)) return true;
+        if (symtable_foreach(&s->symbols, symtable_has_key_prefix, prefix)) return true;
     }
     return false;
 }
 
 /** @brief Global flag tracking whether main() with 0 parameters is defined */
-static bool main_zero_defined = false;
+static _Thread_local bool main_zero_defined = false;
 
 
-Scope* init_scope(){
-    Scope* scope = (Scope*)malloc(sizeof(Scope));
+Scope* init_scope(Scope *parent){
+    Scope* scope = arena_alloc(phase_arena(ARENA_SEMANTIC), sizeof(Scope));
     if (!scope) {
         return NULL;
     }
     symtable_init(&scope->symbols);
-    scope->parent = NULL;
+    scope->parent = parent;
+    scope->depth = parent ? parent->depth + 1 : 1;
     return scope;
 }
 
 SymTableData* lookup_symbol(Scope *scope, const char *name) {
+    // Hash the name once, not at every level of the chain
+    const char *handle = intern_find(name);
+    if (!handle) return NULL;
     while (scope) {
-        SymTableData *data = symtable_search(&scope->symbols, name);
+        SymTableData *data = symtable_search_handle(&scope->symbols, handle);
         if (data) return data;
         scope = scope->parent;
     }
@@ -274,7 +295,6 @@ int infer_expr_node_type(ExprNode *expr, Scope *scope, DataType *out_type) {
                     char *getter_key = make_getter_key(expr->data.identifier_name);
                     if (getter_key) {
                         identifier = lookup_symbol(scope, getter_key);
-                        free(getter_key);
                     }
                 }
 
@@ -293,7 +313,6 @@ int infer_expr_node_type(ExprNode *expr, Scope *scope, DataType *out_type) {
                     
                     if (!symtable_insert(&global_scope->symbols, expr->data.identifier_name, global_var)) {
                         fprintf(stderr, "[SEMANTIC] Failed to insert global variable '%s'\n", expr->data.identifier_name);
-                        free(global_var);
                         return ERROR_INTERNAL;
                     }
                     
@@ -312,7 +331,7 @@ int infer_expr_node_type(ExprNode *expr, Scope *scope, DataType *out_type) {
                     *out_type = identifier->data.var_data->data_type;
                     return NO_ERROR;
                 } else if (identifier->type == NODE_GETTER) {
-                    char *name_copy = expr->data.identifier_name;
+                    const char *name_copy = expr->data.identifier_name;
                     expr->type = EXPR_GETTER_CALL;
                     expr->data.getter_name = name_copy;
                     expr->current_scope = scope;
@@ -329,7 +348,6 @@ int infer_expr_node_type(ExprNode *expr, Scope *scope, DataType *out_type) {
             if (!getter_key) return ERROR_INTERNAL;
             
             SymTableData *g = lookup_symbol(scope, getter_key);
-            free(getter_key);
             
             if (!g) {
                 fprintf(stderr, "[SEMANTIC] Getter '%s' not found\n", expr->data.getter_name);
@@ -431,35 +449,41 @@ int infer_expr_node_type(ExprNode *expr, Scope *scope, DataType *out_type) {
     return NO_ERROR;
 }
 
+/** @brief Stops the walk of scan_return_type at the first inferable return */
+#define RETURN_TYPE_FOUND (-1)
+
+/** @brief State of scan_return_type */
+typedef struct {
+    Scope *scope;
+    DataType type;
+} ReturnScan;
+
 /**
- * @brief Scans AST subtree for return statements to infer function return type
- * 
- * Performs pre-order traversal looking for AST_RETURN nodes with inferable types.
- * Used to determine getter/function return types before full semantic analysis.
+ * @brief Pre visit of scan_return_type: tries to infer the type of a return
  * 
- * @param n AST node to scan (typically function/getter body)
- * @param scope Scope for type inference
- * @param out_type Output parameter for found return type
- * @return Error code (NO_ERROR on success, sets out_type to TYPE_UNDEF if no type found)
+ * @param step Visit of the current AST node
+ * @param data The ReturnScan
+ * @return RETURN_TYPE_FOUND once a type is found, NO_ERROR to go on, or the
+ * error of the inference
  */
-static int scan_return_type(ASTNode *n, Scope *scope, DataType *out_type) {
-    if (!out_type) return ERROR_INTERNAL;
-    *out_type = TYPE_UNDEF;
-    if (!n) return NO_ERROR;
+static int scan_return_enter(AstWalkStep *step, void *data) {
+    ReturnScan *scan = data;
+    ASTNode *n = step->node;
+    Scope *scope = scan->scope;
 
     if (n->type == AST_RETURN) {
         if (n->expr) {
             DataType t;
             int ierr = infer_expr_node_type(n->expr, scope, &t);
             if (ierr != NO_ERROR) return ierr;
-            if (t != TYPE_UNDEF) { *out_type = t; return NO_ERROR; }
+            if (t != TYPE_UNDEF) { scan->type = t; return RETURN_TYPE_FOUND; }
         } else if (n->left) {
             if (n->left->type == AST_FUNC_CALL) {
                 int err = semantic_visit(n->left, scope);
                 if (err != NO_ERROR) return err;
                 if (n->left->data_type != TYPE_UNDEF) {
-                    *out_type = n->left->data_type;
-                    return NO_ERROR;
+                    scan->type = n->left->data_type;
+                    return RETURN_TYPE_FOUND;
                 }
             } else if (n->left->type == AST_EXPRESSION) {
                 DataType t = TYPE_UNDEF;
@@ -471,17 +495,30 @@ static int scan_return_type(ASTNode *n, Scope *scope, DataType *out_type) {
                     if (err != NO_ERROR) return err;
                     t = n->left->left->data_type;
                 }
-                if (t != TYPE_UNDEF) { *out_type = t; return NO_ERROR; }
+                if (t != TYPE_UNDEF) { scan->type = t; return RETURN_TYPE_FOUND; }
             }
         }
     }
+    return NO_ERROR;
+}
 
-    DataType left_type;
-    int lerr = scan_return_type(n->left, scope, &left_type);
-    if (lerr != NO_ERROR) return lerr;
-    if (left_type != TYPE_UNDEF) { *out_type = left_type; return NO_ERROR; }
-
-    return scan_return_type(n->right, scope, out_type);
+/**
+ * @brief Scans AST subtree for return statements to infer function return type
+ * 
+ * Performs pre-order traversal looking for AST_RETURN nodes with inferable types.
+ * Used to determine getter/function return types before full semantic analysis.
+ * 
+ * @param n AST node to scan (typically function/getter body)
+ * @param scope Scope for type inference
+ * @param out_type Output parameter for found return type
+ * @return Error code (NO_ERROR on success, sets out_type to TYPE_UNDEF if no type found)
+ */
+static int scan_return_type(ASTNode *n, Scope *scope, DataType *out_type) {
+    if (!out_type) return ERROR_INTERNAL;
+    ReturnScan scan = { scope, TYPE_UNDEF };
+    int err = ast_walk(n, NULL, scan_return_enter, NULL, &scan);
+    *out_type = scan.type;
+    return err == RETURN_TYPE_FOUND ? NO_ERROR : err;
 }
 
 int count_arguments(ASTNode *arg_list) {
@@ -497,11 +534,44 @@ int count_arguments(ASTNode *arg_list) {
 
 
 void add_node_to_func_node(ASTNode *node, ASTNode *func_node){
-    ASTNode *tmp = func_node;
+    ASTNode *tmp = last_var_func == func_node && last_var_decl ? last_var_decl : func_node;
     while(tmp->var_next != NULL){
         tmp = tmp->var_next;
     }
     tmp->var_next = node;
+    last_var_decl = node;
+    last_var_func = func_node;
+}
+
+/**
+ * @brief Parses the deferred body of a called function (lazy mode)
+ *
+ * The body is analyzed when the definition is visited. If that already
+ * happened (with the body still deferred), it is queued for
+ * semantic_analyze to analyze it in the scope recorded by the visit.
+ *
+ * @param definition Definition of the called function, NULL for built-ins
+ * @return Error code of parsing the body, NO_ERROR if it was parsed already
+ */
+static int require_body(ASTNode *definition) {
+    if (!definition || !definition->right || definition->right->type != AST_LAZY_BODY) {
+        return NO_ERROR;
+    }
+    bool visited = definition->right->current_scope != NULL;
+    int err = parser_parse_body(definition);
+    if (err != NO_ERROR || !visited) return err;
+
+    PendingBody *pending = arena_alloc(phase_arena(ARENA_SEMANTIC), sizeof(PendingBody));
+    if (!pending) return ERROR_INTERNAL;
+    pending->definition = definition;
+    pending->next = NULL;
+    if (pending_bodies) {
+        last_pending_body->next = pending;
+    } else {
+        pending_bodies = pending;
+    }
+    last_pending_body = pending;
+    return NO_ERROR;
 }
 
 int check_user_function_call(ASTNode *node, Scope *scope, SymTableData *func_symbol) {
@@ -541,8 +611,8 @@ int check_user_function_call(ASTNode *node, Scope *scope, SymTableData *func_sym
 }
     
     node->data_type = fdata->return_type;
-    
-    return NO_ERROR;
+
+    return require_body(fdata->definition);
 }
 
 /**
@@ -632,6 +702,7 @@ int semantic_definition(ASTNode *node, Scope *current_scope){
                     fprintf(stderr, "[SEMANTIC] Failed to insert function '%s' overload '%s' into symbol table.\n", func_name, overload_key);
                     return ERROR_INTERNAL;
                 }
+                func_symbol->data.func_data->definition = actual;
 
                 if(strcmp(func_name, "main") == 0 && param_count == 0) {
                     main_zero_defined = true;
@@ -639,19 +710,17 @@ int semantic_definition(ASTNode *node, Scope *current_scope){
                 }
                 
                 // Update function name to include hashtag
-                free(actual->name);
-                actual->name = my_strdup(overload_key);
+                actual->name = intern(overload_key);
                 if (!actual->name) {
                     fprintf(stderr, "[SEMANTIC] Failed to allocate memory for function name with hashtag.\n");
                     return ERROR_INTERNAL;
                 }
                 
-                Scope *func_scope = init_scope();
+                Scope *func_scope = init_scope(current_scope);
                 if (!func_scope) {
                     fprintf(stderr, "[SEMANTIC] Failed to create scope for function '%s'.\n", func_name);
                     return ERROR_INTERNAL;
                 }
-                func_scope->parent = current_scope;
 
                 for (Param *p = params; p; p = p->next) {
                     SymTableData *param_var = make_variable(p->data_type, true, true);
@@ -662,7 +731,6 @@ int semantic_definition(ASTNode *node, Scope *current_scope){
                     param_var->data.var_data->scope = func_scope;
                     if (!symtable_insert(&func_scope->symbols, p->name, param_var)) {
                         fprintf(stderr, "[SEMANTIC] Failed to insert parameter '%s' into function scope.\n", p->name);
-                        free(param_var);
                         return ERROR_INTERNAL;
                     }
                 }
@@ -701,30 +769,25 @@ int semantic_definition(ASTNode *node, Scope *current_scope){
                 SymTableData *existing = symtable_search(&current_scope->symbols, setter_key);
                 if (existing && existing->type == NODE_SETTER) {
                     fprintf(stderr, "[SEMANTIC] Redefinition of setter '%s'.\n", setter_name);
-                    free(setter_key);
                     return SEM_ERROR_REDEFINED;
                 }
 
                 SymTableData *setter_symbol = make_setter(param_type, true);
                 if (!setter_symbol) {
                     fprintf(stderr, "[SEMANTIC] Failed to allocate symbol for setter '%s'.\n", setter_name);
-                    free(setter_key);
                     return ERROR_INTERNAL;
                 }
 
                 if (!symtable_insert(&current_scope->symbols, setter_key, setter_symbol)) {
                     fprintf(stderr, "[SEMANTIC] Failed to insert setter '%s' into symbol table.\n", setter_name);
-                    free(setter_key);
                     return ERROR_INTERNAL;
                 }
-                free(setter_key);
 
-                Scope *setter_scope = init_scope();
+                Scope *setter_scope = init_scope(current_scope);
                 if (!setter_scope) {
                     fprintf(stderr, "[SEMANTIC] Failed to create scope for setter '%s'.\n", setter_name);
                     return ERROR_INTERNAL;
                 }
-                setter_scope->parent = current_scope;
 
                 SymTableData *param_var = make_variable(param_type, true, true);
                 if (!param_var) {
@@ -734,7 +797,6 @@ int semantic_definition(ASTNode *node, Scope *current_scope){
                 param_var->data.var_data->scope = setter_scope;
                 if (!symtable_insert(&setter_scope->symbols, param_name, param_var)) {
                     fprintf(stderr, "[SEMANTIC] Failed to insert parameter '%s' into setter scope.\n", param_name);
-                    free(param_var);
                     return ERROR_INTERNAL;
                 }
 
@@ -756,29 +818,25 @@ int semantic_definition(ASTNode *node, Scope *current_scope){
                 SymTableData *existing = symtable_search(&current_scope->symbols, getter_key);
                 if (existing && existing->type == NODE_GETTER) {
                     fprintf(stderr, "[SEMANTIC] Redefinition of getter '%s'.\n", getter_name);
-                    free(getter_key);
                     return SEM_ERROR_REDEFINED;
                 }
 
                 SymTableData *getter_symbol = make_getter(TYPE_UNDEF, true);
                 if (!getter_symbol) {
                     fprintf(stderr, "[SEMANTIC] Failed to allocate symbol for getter '%s'.\n", getter_name);
-                    free(getter_key);
                     return ERROR_INTERNAL;
                 }
 
                 if (!symtable_insert(&current_scope->symbols, getter_key, getter_symbol)) {
                     fprintf(stderr, "[SEMANTIC] Failed to insert getter '%s' into symbol table.\n", getter_name);
-                    free(getter_key);
                     return ERROR_INTERNAL;
                 }
 
-                Scope *getter_scope = init_scope();
+                Scope *getter_scope = init_scope(current_scope);
                 if (!getter_scope) {
                     fprintf(stderr, "[SEMANTIC] Failed to create scope for getter '%s'.\n", getter_name);
                     return ERROR_INTERNAL;
                 }
-                getter_scope->parent = current_scope;
 
                 ASTNode *scan = actual->right;
                 DataType found_type = TYPE_UNDEF;
@@ -792,7 +850,6 @@ int semantic_definition(ASTNode *node, Scope *current_scope){
                         if (s && s->type == NODE_GETTER) {
                             s->data.getter_data->return_type = found_type;
                         }
-                        free(lookup_key);
                     }
                 }
                 actual->right->current_table = &getter_scope->symbols;
@@ -803,9 +860,19 @@ int semantic_definition(ASTNode *node, Scope *current_scope){
 }
 
 /**
- * @brief Main recursive visitor for semantic analysis of AST nodes
+ * @brief Skips the left child of a visited node and continues with its
+ * right one (the next statement, or the body of a definition) in `scope`
+ */
+static int walk_right(AstWalkStep *step, Scope *scope) {
+    step->children = AST_WALK_RIGHT;
+    step->right_context = scope;
+    return NO_ERROR;
+}
+
+/**
+ * @brief Pre visit of the semantic walk (see semantic_visit)
  * 
- * Traverses and validates AST nodes recursively. Each node type is handled
+ * Validates a node on entering it. Each node type is handled
  * according to IFJ25 semantic rules:
  * 
  * - AST_PROGRAM: Entry point, analyzes function definitions
@@ -820,17 +887,23 @@ int semantic_definition(ASTNode *node, Scope *current_scope){
  * - AST_BLOCK: Creates new scope for block
  * - AST_EXPRESSION: Infers and validates expression types
  * 
- * @param node Current AST node to analyze
- * @param current_scope Current scope for symbol resolution
+ * The step's context is the current scope for symbol resolution; the
+ * children of the node are walked afterwards, as the step says.
+ *
+ * @param step Visit of the current AST node
+ * @param data Unused
  * @return Error code (NO_ERROR on success, SEM_ERROR_* or ERROR_INTERNAL on failure)
  */
-int semantic_visit(ASTNode *node, Scope *current_scope) {
-    if (!node) return NO_ERROR;
+static int semantic_enter(AstWalkStep *step, void *data) {
+    (void)data;
+    ASTNode *node = step->node;
+    Scope *current_scope = step->context;
 
     switch (node->type) {
         case AST_PROGRAM:   {
             node->current_scope = current_scope;
-                return semantic_visit(node->left, current_scope);
+                step->children = AST_WALK_LEFT;
+                return NO_ERROR;
             } break;
         case AST_MAIN_DEF: {
                 if (!node->right) return ERROR_INTERNAL;
@@ -905,12 +978,11 @@ int semantic_visit(ASTNode *node, Scope *current_scope) {
 
 
                 // Create new scope for main function body
-                Scope *main_scope = init_scope();
+                Scope *main_scope = init_scope(current_scope);
                 if (!main_scope) {
                     fprintf(stderr, "[SEMANTIC] Failed to create scope for 'main'.\n");
                     return ERROR_INTERNAL;
                 }
-                main_scope->parent = current_scope;
                 node->right->current_table = &main_scope->symbols;
 
                 // Insert parameters into main scope
@@ -924,7 +996,6 @@ int semantic_visit(ASTNode *node, Scope *current_scope) {
                     param_var->data.var_data->scope = main_scope;
                     if (!symtable_insert(&main_scope->symbols, p->name, param_var)) {
                         fprintf(stderr, "[SEMANTIC] Failed to insert parameter '%s' into main scope.\n", p->name);
-                        free(param_var);
                         return ERROR_INTERNAL;
                     }
                 }
@@ -939,9 +1010,7 @@ int semantic_visit(ASTNode *node, Scope *current_scope) {
                 }
 
                 // Analyze main function body with main scope
-                int result = semantic_visit(node->right, main_scope);
-                
-                return result;
+                return walk_right(step, main_scope);
             } break;
 
         case AST_FUNC_DEF: {
@@ -1012,12 +1081,11 @@ int semantic_visit(ASTNode *node, Scope *current_scope) {
                     node->type = AST_MAIN_DEF;
                 }
                 // Create new scope for function body
-                Scope *func_scope = init_scope();
+                Scope *func_scope = init_scope(current_scope);
                 if (!func_scope) {
                     fprintf(stderr, "[SEMANTIC] Failed to create scope for function '%s'.\n", func_name);
                     return ERROR_INTERNAL;
                 }
-                func_scope->parent = current_scope;
 
                 // Insert parameters into function scope
                 for (Param *p = params; p; p = p->next) {
@@ -1030,7 +1098,6 @@ int semantic_visit(ASTNode *node, Scope *current_scope) {
                     param_var->data.var_data->scope = func_scope;
                     if (!symtable_insert(&func_scope->symbols, p->name, param_var)) {
                         fprintf(stderr, "[SEMANTIC] Failed to insert parameter '%s' into function scope.\n", p->name);
-                        free(param_var);
                         return ERROR_INTERNAL;
                     }
                 }
@@ -1045,9 +1112,7 @@ int semantic_visit(ASTNode *node, Scope *current_scope) {
                 }
 
                 node->right->current_table = &func_scope->symbols;
-                int result = semantic_visit(node->right, func_scope);
-
-                return result;
+                return walk_right(step, func_scope);
             } break;
 
 
@@ -1068,33 +1133,27 @@ int semantic_visit(ASTNode *node, Scope *current_scope) {
                 if (existing) {
                     if (existing->type != NODE_GETTER) {
                         fprintf(stderr, "[SEMANTIC] Symbol '%s' exists and is not a getter.\n", getter_name);
-                        free(getter_key);
                         return SEM_ERROR_REDEFINED;
                     }
                     getter_symbol = existing;
-                    free(getter_key);
                 } else {
                     getter_symbol = make_getter(TYPE_UNDEF, true);
                     if (!getter_symbol) {
                         fprintf(stderr, "[SEMANTIC] Failed to allocate symbol for getter '%s'.\n", getter_name);
-                        free(getter_key);
                         return ERROR_INTERNAL;
                     }
                     if (!symtable_insert(&current_scope->symbols, getter_key, getter_symbol)) {
                         fprintf(stderr, "[SEMANTIC] Failed to insert getter '%s' into symbol table.\n", getter_name);
-                        free(getter_key);
                         return ERROR_INTERNAL;
                     }
-                    free(getter_key);
                 }
 
                 // Create new scope for getter body
-                Scope *getter_scope = init_scope();
+                Scope *getter_scope = init_scope(current_scope);
                 if (!getter_scope) {
                     fprintf(stderr, "[SEMANTIC] Failed to create scope for getter '%s'.\n", getter_name);
                     return ERROR_INTERNAL;
                 }
-                getter_scope->parent = current_scope;
 
                 // Before analyzing the getter body, try to infer the getter's
                 // return type by scanning the body for return statements that
@@ -1115,9 +1174,7 @@ int semantic_visit(ASTNode *node, Scope *current_scope) {
                 node->right->current_table = &getter_scope->symbols;
 
                 // Now analyze getter body with getter scope
-                int result = semantic_visit(node->right, getter_scope);
-
-                return result;
+                return walk_right(step, getter_scope);
             } break;
 
         case AST_SETTER_DEF: {
@@ -1146,36 +1203,30 @@ int semantic_visit(ASTNode *node, Scope *current_scope) {
                 if (existing) {
                     if (existing->type != NODE_SETTER) {
                         fprintf(stderr, "[SEMANTIC] Symbol '%s' exists and is not a setter.\n", setter_name);
-                        free(setter_key);
                         return SEM_ERROR_REDEFINED;
                     }
                     setter_symbol = existing;
                     if (setter_symbol->data.setter_data->param_type == TYPE_UNDEF && param_type != TYPE_UNDEF) {
                         setter_symbol->data.setter_data->param_type = param_type;
                     }
-                    free(setter_key);
                 } else {
                     setter_symbol = make_setter(param_type, true);
                     if (!setter_symbol) {
                         fprintf(stderr, "[SEMANTIC] Failed to allocate symbol for setter '%s'.\n", setter_name);
-                        free(setter_key);
                         return ERROR_INTERNAL;
                     }
                     if (!symtable_insert(&current_scope->symbols, setter_key, setter_symbol)) {
                         fprintf(stderr, "[SEMANTIC] Failed to insert setter '%s' into symbol table.\n", setter_name);
-                        free(setter_key);
                         return ERROR_INTERNAL;
                     }
-                    free(setter_key);
                 }
 
                 // Create new scope for setter body
-                Scope *setter_scope = init_scope();
+                Scope *setter_scope = init_scope(current_scope);
                 if (!setter_scope) {
                     fprintf(stderr, "[SEMANTIC] Failed to create scope for setter '%s'.\n", setter_name);
                     return ERROR_INTERNAL;
                 }
-                setter_scope->parent = current_scope;
 
                 // Insert parameter into setter scope
                 SymTableData *param_var = make_variable(param_type, true, true);
@@ -1187,7 +1238,6 @@ int semantic_visit(ASTNode *node, Scope *current_scope) {
                 param_var->data.var_data->scope = setter_scope;
                 if (!symtable_insert(&setter_scope->symbols, param_name, param_var)) {
                     fprintf(stderr, "[SEMANTIC] Failed to insert parameter '%s' into setter scope.\n", param_name);
-                    free(param_var);
                     return ERROR_INTERNAL;
                 }
 
@@ -1198,7 +1248,7 @@ int semantic_visit(ASTNode *node, Scope *current_scope) {
                 node->right->current_table = &setter_scope->symbols;
 
                 // Analyze setter body with setter scope
-                return semantic_visit(node->right, setter_scope);
+                return walk_right(step, setter_scope);
             } break;
         case AST_VAR_DECL: {
                 if (!node->left || node->left->type != AST_IDENTIFIER ) return ERROR_INTERNAL;
@@ -1223,7 +1273,6 @@ int semantic_visit(ASTNode *node, Scope *current_scope) {
                 // Insert into current scope's symbol table
                 if(!symtable_insert(&current_scope->symbols, name, var_data)){
                     fprintf(stderr, "[SEMANTIC] Failed to insert variable into symbol table: %s\n", name);
-                    free(var_data);
                     return ERROR_INTERNAL;
                 }   
 
@@ -1236,7 +1285,7 @@ int semantic_visit(ASTNode *node, Scope *current_scope) {
                 }
                 
                 
-                return semantic_visit(node->right, current_scope);
+                return walk_right(step, current_scope);
                 
             } break;
 
@@ -1252,7 +1301,6 @@ int semantic_visit(ASTNode *node, Scope *current_scope) {
                     SymTableData* sym = NULL;
                     if (setter_key) {
                         sym = lookup_symbol(current_scope, setter_key);
-                        free(setter_key);
                     }
                     
                     if (sym && sym->type == NODE_SETTER) {
@@ -1265,9 +1313,8 @@ int semantic_visit(ASTNode *node, Scope *current_scope) {
                             return SEM_ERROR_OTHER;
                         }
 
-                        // Transfer identifier name to this node (free existing name first)
-                        if (node->name) free(node->name);
-                        node->name = id_node->name; // take ownership
+                        // Transfer identifier name to this node (names are interned)
+                        node->name = id_node->name;
                         id_node->name = NULL;
 
                         // Rewire node: become AST_SETTER_CALL with left = expression
@@ -1281,8 +1328,7 @@ int semantic_visit(ASTNode *node, Scope *current_scope) {
                         node->left = rhs_expr;
                         // node->right already points to next statement (keep it)
 
-                        // free the old equals and identifier structures (name moved)
-                        free_ast_tree(equals);
+                        // the old equals and identifier nodes stay in the parse arena
 
                         // Now perform type inference/check for the setter parameter
                         DataType right_type = TYPE_UNDEF;
@@ -1310,16 +1356,13 @@ int semantic_visit(ASTNode *node, Scope *current_scope) {
                         }
 
                         // After transforming to AST_SETTER_CALL, continue visiting next statement
-                        return semantic_visit(node->right, current_scope);
+                        return walk_right(step, current_scope);
                     }
                 }
 
-                // Process the assignment (AST_EQUALS) normally
-                int err = semantic_visit(node->left, current_scope);
-                if (err != NO_ERROR) return err;
-
-                // Continue with next statement
-                return semantic_visit(node->right, current_scope);
+                // Process the assignment (AST_EQUALS) normally, then
+                // continue with next statement
+                return NO_ERROR;
             } break;
 
         case AST_SETTER_CALL: {
@@ -1370,7 +1413,7 @@ int semantic_visit(ASTNode *node, Scope *current_scope) {
                 }
 
                 // Continue with next statement
-                return semantic_visit(node->right, current_scope);
+                return walk_right(step, current_scope);
             } break;
 
         case AST_EQUALS: {
@@ -1407,7 +1450,6 @@ int semantic_visit(ASTNode *node, Scope *current_scope) {
                     // insert into global scope
                     if (!symtable_insert(&global_scope->symbols, var_name, global_var)) {
                         fprintf(stderr, "[SEMANTIC] Failed to insert global variable '%s'\n", var_name);
-                        free(global_var);
                         return ERROR_INTERNAL;
                     }
                     
@@ -1462,9 +1504,8 @@ int semantic_visit(ASTNode *node, Scope *current_scope) {
                 // Mark variable as initialized
                 var_data->data.var_data->initialized = true;
 
-                int err = semantic_visit(node->left, current_scope);
-                if (err != NO_ERROR) return err;
-
+                // Visit the identifier, not the expression again
+                step->children = AST_WALK_LEFT;
                 return NO_ERROR;
             } break;
 
@@ -1500,7 +1541,6 @@ int semantic_visit(ASTNode *node, Scope *current_scope) {
                     // insert into global scope
                     if (!symtable_insert(&global_scope->symbols, var_name, global_var)) {
                         fprintf(stderr, "[SEMANTIC] Failed to insert global variable '%s'\n", var_name);
-                        free(global_var);
                         return ERROR_INTERNAL;
                     }
                     
@@ -1531,10 +1571,7 @@ int semantic_visit(ASTNode *node, Scope *current_scope) {
                 node->data_type = var_data->data.var_data->data_type;
                 
                 // Continue with any child nodes (though identifiers shouldn't have any in normal use)
-                int err = semantic_visit(node->left, current_scope);
-                if (err != NO_ERROR) return err;
-                
-                return semantic_visit(node->right, current_scope);
+                return NO_ERROR;
             } break;
             case AST_FUNC_CALL: {
                 
@@ -1547,8 +1584,7 @@ int semantic_visit(ASTNode *node, Scope *current_scope) {
                 snprintf(keybuf, sizeof(keybuf), "%s$%d", func_name, argc);
 
                 // Update node->name to include parameter count suffix for code generation
-                free(node->name);
-                node->name = my_strdup(keybuf);
+                node->name = intern(keybuf);
                 
 
                 // Hľadáme presné preťaženie
@@ -1566,8 +1602,7 @@ int semantic_visit(ASTNode *node, Scope *current_scope) {
                 int err =  check_user_function_call(node, current_scope, func_symbol);
                 
                 if(err != NO_ERROR) return err;
-                err = semantic_visit(node->right, current_scope);
-                return err;
+                return walk_right(step, current_scope);
                 
             } break;
         case AST_FUNC_ARG: {
@@ -1600,7 +1635,8 @@ int semantic_visit(ASTNode *node, Scope *current_scope) {
                     return ERROR_INTERNAL;
                 }
 
-                return semantic_visit(node->left, current_scope);
+                step->children = AST_WALK_LEFT;
+                return NO_ERROR;
             } break;
         case AST_IF: {
                 // AST_IF -> left = condition (AST_EXPRESSION), right = then branch (AST_BLOCK)
@@ -1610,27 +1646,9 @@ int semantic_visit(ASTNode *node, Scope *current_scope) {
                     return SEM_ERROR_OTHER;
                 }
 
-                // Analyze condition expression
-                int err = semantic_visit(node->left, current_scope);
-                if (err != NO_ERROR) return err;
-
-                DataType cond_type = node->left->data_type;
-
-                if (cond_type != TYPE_NUM && cond_type != TYPE_UNDEF) {
-                    fprintf(stderr, "[SEMANTIC] If condition must be numeric expression, got type %d\n", cond_type);
-                    return SEM_ERROR_TYPE_COMPATIBILITY;
-                }
-
-                // Visit then branch
-                if (!node->right || node->right->type != AST_BLOCK) {
-                    fprintf(stderr, "[SEMANTIC] If statement missing then block\n");
-                    return ERROR_INTERNAL;
-                }
-
-                // Visit then branch
-                
-
-                return semantic_visit(node->right, current_scope);
+                // Analyze condition expression, then the then branch
+                // (checked by semantic_leave in between)
+                return NO_ERROR;
             } break;
 
 
@@ -1643,7 +1661,7 @@ int semantic_visit(ASTNode *node, Scope *current_scope) {
                 }
                 
                 // Process else branch
-                return semantic_visit(node->right, current_scope);
+                return walk_right(step, current_scope);
             } break;
 
         case AST_RETURN: {
@@ -1666,11 +1684,11 @@ int semantic_visit(ASTNode *node, Scope *current_scope) {
                 }
                
                 // If neither expr nor function call, it's a void return (TYPE_NULL)
-                int err = semantic_visit(node->left, current_scope);
-                    if (err != NO_ERROR) return err;
                 // Store return type for function return type checking
                 node->data_type = return_type;
                 
+                // Visit node->left; nothing follows a return
+                step->children = AST_WALK_LEFT;
                 return NO_ERROR;
             } break;
         case AST_WHILE: {
@@ -1682,27 +1700,8 @@ int semantic_visit(ASTNode *node, Scope *current_scope) {
                 }
 
                 // Visit the expression node first — it will infer its data type internally
-                int err = semantic_visit(node->left, current_scope);
-                if (err != NO_ERROR) return err;
-
-                DataType cond_type = node->left->data_type;
-
-                // Condition should be numeric (truthy)
-                if (cond_type != TYPE_NUM && cond_type != TYPE_UNDEF) {
-                    fprintf(stderr, "[SEMANTIC] While condition must be numeric expression, got type %d\n", cond_type);
-                    return SEM_ERROR_TYPE_COMPATIBILITY;
-                }
-
-                // Loop body must exist and be a block
-                if (!node->right || node->right->type != AST_BLOCK) {
-                    fprintf(stderr, "[SEMANTIC] While statement missing loop body block\n");
-                    return ERROR_INTERNAL;
-                }
-
-                // Visit loop body — AST_BLOCK already handles new scope creation
-                err = semantic_visit(node->right, current_scope);
-                if (err != NO_ERROR) return err;
-
+                // Then the loop body (checked by semantic_leave in between) —
+                // AST_BLOCK already handles new scope creation
                 return NO_ERROR;
             } break;
 
@@ -1710,25 +1709,25 @@ int semantic_visit(ASTNode *node, Scope *current_scope) {
                 Scope* block_scope = current_scope;  
 
                 if (!node->current_table) {
-                    block_scope = init_scope();
+                    block_scope = init_scope(current_scope);
                     if (!block_scope) {
                         fprintf(stderr, "[SEMANTIC] Failed to initialize block scope.\n");
                         return ERROR_INTERNAL;
                     }
-                    
-                    block_scope->parent = current_scope;
                     node->current_table = &block_scope->symbols;
                    
                 }
 
-                int err = semantic_visit(node->left, block_scope);
-                if (err != NO_ERROR) {
-                    return err;
-                }
-                
-                err = semantic_visit(node->right, current_scope);
-               
-                return err;
+                // Statements in the block scope, what follows the block
+                // in the enclosing one
+                step->left_context = block_scope;
+                return NO_ERROR;
+            } break;
+
+        case AST_LAZY_BODY: {
+                // Analyzed once a call needs it; remember the function scope
+                node->current_scope = current_scope;
+                return walk_right(step, current_scope);
             } break;
 
         case AST_EXPRESSION: {
@@ -1744,15 +1743,15 @@ int semantic_visit(ASTNode *node, Scope *current_scope) {
                     SymTableData *s = lookup_symbol(current_scope, node->expr->data.identifier_name);
                     if (s && s->type == NODE_GETTER) {
                         // replace identifier expr with getter-call expr
-                        char *name_copy = node->expr->data.identifier_name;
+                        const char *name_copy = node->expr->data.identifier_name;
                         // create getter call node
                         ExprNode *g = create_getter_call_node(name_copy);
                         if (!g) {
                             fprintf(stderr, "[SEMANTIC] Failed to allocate getter expr for '%s'\n", name_copy);
                             return ERROR_INTERNAL;
                         }
-                        // free old identifier structure but avoid double-free of string
-                        free(node->expr);
+                        // recycle old identifier structure (its name is interned)
+                        arena_release(phase_arena(ARENA_PARSE), node->expr, sizeof(ExprNode));
                         node->expr = g;
                     }
                 }
@@ -1784,7 +1783,7 @@ int semantic_visit(ASTNode *node, Scope *current_scope) {
             }
             
             // Continue with next statement
-            return semantic_visit(node->right, current_scope);
+            return walk_right(step, current_scope);
         } break;
 
         default:
@@ -1796,6 +1795,54 @@ int semantic_visit(ASTNode *node, Scope *current_scope) {
     return NO_ERROR;
 }
 
+/**
+ * @brief Post visit of the semantic walk: checks the condition of an if
+ * or while statement, analyzed by then, before its block is walked
+ *
+ * @param step Visit of the current AST node
+ * @param data Unused
+ * @return Error code (NO_ERROR on success, SEM_ERROR_TYPE_COMPATIBILITY or
+ * ERROR_INTERNAL on failure)
+ */
+static int semantic_leave(AstWalkStep *step, void *data) {
+    (void)data;
+    ASTNode *node = step->node;
+    if (node->type != AST_IF && node->type != AST_WHILE) {
+        return NO_ERROR;
+    }
+    const char *statement = node->type == AST_IF ? "If" : "While";
+
+    // Condition should be numeric (truthy)
+    DataType cond_type = node->left->data_type;
+    if (cond_type != TYPE_NUM && cond_type != TYPE_UNDEF) {
+        fprintf(stderr, "[SEMANTIC] %s condition must be numeric expression, got type %d\n", statement, cond_type);
+        return SEM_ERROR_TYPE_COMPATIBILITY;
+    }
+
+    // Then branch or loop body must exist and be a block
+    if (!node->right || node->right->type != AST_BLOCK) {
+        fprintf(stderr, "[SEMANTIC] %s statement missing %s block\n", statement, node->type == AST_IF ? "then" : "loop body");
+        return ERROR_INTERNAL;
+    }
+    return NO_ERROR;
+}
+
+/**
+ * @brief Semantic analysis of a subtree
+ *
+ * Walks the nodes with ast_walk, so a chain of statements of any length
+ * analyzes in constant C stack: semantic_enter validates each node and
+ * sets the scopes of its children, semantic_leave checks conditions.
+ *
+ * @param node First AST node to analyze
+ * @param current_scope Current scope for symbol resolution
+ * @return Error code (NO_ERROR on success, SEM_ERROR_* or ERROR_INTERNAL on failure)
+ */
+int semantic_visit(ASTNode *node, Scope *current_scope) {
+    return ast_walk(node, current_scope, semantic_enter, semantic_leave,
+                    NULL);
+}
+
 
 
 /**
@@ -1814,11 +1861,16 @@ int semantic_analyze(ASTNode *root) {
         return ERROR_INTERNAL;
     }
 
-    // Reset simple global state for main() detection
+    // Reset the state left over by a previous run on this thread
     main_zero_defined = false;
+    func_node = NULL;
+    last_var_decl = NULL;
+    last_var_func = NULL;
+    pending_bodies = NULL;
+    last_pending_body = NULL;
     
     // Initialize global scope
-    Scope* global_scope = init_scope();
+    Scope* global_scope = init_scope(NULL);
     if (!global_scope) {
         fprintf(stderr, "[SEMANTIC] Failed to initialize global scope.\n");
         return ERROR_INTERNAL;
@@ -1834,6 +1886,15 @@ int semantic_analyze(ASTNode *root) {
     // Analyze AST
     int result = semantic_visit(root, global_scope);
 
+    // Analyze the deferred bodies called from the analyzed code, which may
+    // call further ones
+    while (result == NO_ERROR && pending_bodies) {
+        ASTNode *definition = pending_bodies->definition;
+        pending_bodies = pending_bodies->next;
+        func_node = definition;
+        result = semantic_visit(definition->right->left, definition->right->current_scope);
+    }
+
     if (result != NO_ERROR) return result;
 
     // Simple final check based on the flag set in AST_MAIN_DEF
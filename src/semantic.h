@@ -35,6 +35,10 @@ typedef struct Scope {
     
     /** @brief Parent scope (outer scope), NULL for global scope */
     struct Scope *parent;
+
+    /** @brief Number of scopes from this one to the global scope, 1 for the
+     *  global scope; the code generator suffixes local names with it */
+    unsigned depth;
 } Scope;
 
 // ========== Scope Management Functions ==========
@@ -42,13 +46,13 @@ typedef struct Scope {
 /**
  * @brief Initializes a new scope with an empty symbol table
  * 
- * Creates and initializes a new Scope structure with an empty symbol table.
- * The parent pointer is set to NULL and should be assigned by the caller
- * to establish the scope hierarchy.
+ * Creates and initializes a new Scope structure with an empty symbol table,
+ * nested in the given parent scope.
  * 
+ * @param parent Enclosing scope, NULL for the global scope
  * @return Pointer to newly created scope
  */
-Scope* init_scope();
+Scope* init_scope(Scope *parent);
 
 // ========== Symbol Table Utility Functions ==========
 
@@ -206,7 +210,7 @@ int semantic_definition(ASTNode *node, Scope *current_scope);
 int semantic_analyze(ASTNode *root);
 
 /**
- * @brief Recursive AST visitor for semantic analysis
+ * @brief AST visitor for semantic analysis
  * 
  * Traverses and validates an AST node and its children. Different node
  * types are handled differently
@@ -218,7 +222,8 @@ int semantic_analyze(ASTNode *root);
  * @return Error code
  * @retval NO_ERROR if node and children are valid else Error code
  * 
- * @note Recursively visits children nodes as appropriate
+ * @note Visits children nodes as appropriate, with ast_walk: the C stack
+ * does not grow with the number of statements
  */
 int semantic_visit(ASTNode *node, Scope *current_scope);
 
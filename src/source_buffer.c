@@ -0,0 +1,169 @@
+/**
+ * @file source_buffer.c
+ * @author xcernoj00
+ * @brief Whole-file source buffer (mmap with read-loop fallback)
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "source_buffer.h"
+#include "error.h"
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define SOURCE_READ_CHUNK 65536
+
+/**
+ * @brief Try to memory-map a regular file that has not been read from yet.
+ *
+ * @return true when the buffer was mapped, false when the caller has to
+ *         fall back to reading the stream.
+ */
+static bool source_buffer_map(SourceBuffer *buffer, FILE *f) {
+    int fd = fileno(f);
+    struct stat st;
+
+    if (fd < 0 || fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        return false;
+    }
+    // Bytes already consumed from the stream would be skipped by mmap
+    if (lseek(fd, 0, SEEK_CUR) != 0 || ftell(f) != 0) {
+        return false;
+    }
+    if (st.st_size == 0) {
+        buffer->data = NULL;
+        buffer->length = 0;
+        return true;
+    }
+
+    void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+        return false;
+    }
+    buffer->data = data;
+    buffer->length = (size_t)st.st_size;
+    buffer->capacity = 0;
+    buffer->mapped = true;
+    buffer->owned = true;
+    return true;
+}
+
+int source_buffer_load(SourceBuffer *buffer, FILE *f) {
+    buffer->data = NULL;
+    buffer->length = 0;
+    buffer->capacity = 0;
+    buffer->mapped = false;
+    buffer->owned = false;
+
+    if (f == NULL) {
+        return ERROR_INTERNAL;
+    }
+    if (source_buffer_map(buffer, f)) {
+        return NO_ERROR;
+    }
+
+    // Pipes and terminals: read everything into a growing heap block
+    size_t capacity = SOURCE_READ_CHUNK;
+    size_t length = 0;
+    char *data = malloc(capacity);
+    if (!data) {
+        return ERROR_INTERNAL;
+    }
+
+    while (1) {
+        if (length == capacity) {
+            capacity *= 2;
+            char *grown = realloc(data, capacity);
+            if (!grown) {
+                free(data);
+                return ERROR_INTERNAL;
+            }
+            data = grown;
+        }
+        size_t n = fread(data + length, 1, capacity - length, f);
+        length += n;
+        if (n == 0) {
+            if (ferror(f)) {
+                free(data);
+                return ERROR_INTERNAL;
+            }
+            break;
+        }
+    }
+
+    buffer->data = data;
+    buffer->length = length;
+    buffer->capacity = capacity;
+    buffer->owned = true;
+    return NO_ERROR;
+}
+
+void source_buffer_borrow(SourceBuffer *buffer, const char *data,
+                          size_t length) {
+    buffer->data = data;
+    buffer->length = length;
+    buffer->capacity = 0;
+    buffer->mapped = false;
+    buffer->owned = false;
+}
+
+int source_buffer_splice(SourceBuffer *buffer, size_t offset, size_t removed,
+                         const char *inserted, size_t inserted_length) {
+    if (offset > buffer->length || removed > buffer->length - offset) {
+        return ERROR_INTERNAL;
+    }
+    size_t tail = buffer->length - offset - removed;
+    size_t length = offset + inserted_length + tail;
+
+    if (buffer->owned && !buffer->mapped && length <= buffer->capacity) {
+        char *data = (char *)buffer->data;
+        memmove(data + offset + inserted_length, data + offset + removed,
+                tail);
+        if (inserted_length) {
+            memcpy(data + offset, inserted, inserted_length);
+        }
+        buffer->length = length;
+        return NO_ERROR;
+    }
+
+    // Copy into a fresh heap block, with room for the edits to come
+    size_t capacity = length + length / 2 + SOURCE_READ_CHUNK;
+    char *data = malloc(capacity);
+    if (!data) {
+        return ERROR_INTERNAL;
+    }
+    if (offset) {
+        memcpy(data, buffer->data, offset);
+    }
+    if (inserted_length) {
+        memcpy(data + offset, inserted, inserted_length);
+    }
+    if (tail) {
+        memcpy(data + offset + inserted_length,
+               buffer->data + offset + removed, tail);
+    }
+    source_buffer_free(buffer);
+    buffer->data = data;
+    buffer->length = length;
+    buffer->capacity = capacity;
+    buffer->owned = true;
+    return NO_ERROR;
+}
+
+void source_buffer_free(SourceBuffer *buffer) {
+    if (buffer->owned && buffer->data) {
+        if (buffer->mapped) {
+            munmap((void *)buffer->data, buffer->length);
+        } else {
+            free((void *)buffer->data);
+        }
+    }
+    buffer->data = NULL;
+    buffer->length = 0;
+    buffer->capacity = 0;
+    buffer->mapped = false;
+    buffer->owned = false;
+}
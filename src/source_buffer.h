@@ -0,0 +1,87 @@
+/**
+ * @file source_buffer.h
+ * @author xcernoj00
+ * @brief Whole-file source buffer used as the scanner input.
+ *
+ * The scanner works on one contiguous, read-only byte buffer instead of
+ * pulling characters from a FILE stream. Regular files are memory-mapped,
+ * everything else (pipes, terminals) is read in with a growing read loop.
+ */
+
+#ifndef _SOURCE_BUFFER_H
+#define _SOURCE_BUFFER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+/**
+ * @brief Read-only view of the whole source program.
+ *
+ * - `data` points to `length` bytes of source text. The buffer is NOT
+ *   NUL-terminated (a mapped file ends exactly at its last byte).
+ * - `mapped` tells whether `data` comes from mmap or from the heap.
+ * - `owned` is false for buffers that only borrow caller memory.
+ * - `capacity` is the allocated size of an owned heap block, 0 otherwise.
+ */
+typedef struct {
+    const char *data;
+    size_t length;
+    size_t capacity;
+    bool mapped;
+    bool owned;
+} SourceBuffer;
+
+/**
+ * @brief Load the whole content of a stream into a source buffer.
+ *
+ * Regular files positioned at their beginning are memory-mapped. Other
+ * streams are consumed with fread into a geometrically growing heap block.
+ *
+ * @param buffer Buffer to initialize.
+ * @param f Input stream (e.g. stdin or fopen result).
+ * @return NO_ERROR on success or ERROR_INTERNAL on I/O or allocation failure.
+ */
+int source_buffer_load(SourceBuffer *buffer, FILE *f);
+
+/**
+ * @brief Wrap caller-owned memory as a source buffer without copying it.
+ *
+ * The memory must stay valid until the buffer is no longer used.
+ *
+ * @param buffer Buffer to initialize.
+ * @param data Source text.
+ * @param length Number of bytes in `data`.
+ */
+void source_buffer_borrow(SourceBuffer *buffer, const char *data,
+                          size_t length);
+
+/**
+ * @brief Replace `removed` bytes at `offset` with `inserted_length` new ones.
+ *
+ * Owned heap buffers are edited in place (growing geometrically when
+ * needed). Mapped and borrowed buffers are first copied into a heap block
+ * of their own, so the file or caller memory is never written to.
+ *
+ * @param buffer Buffer to edit.
+ * @param offset First replaced byte; must not be past the end.
+ * @param removed Number of replaced bytes; must not reach past the end.
+ * @param inserted Replacement bytes.
+ * @param inserted_length Number of bytes in `inserted`.
+ * @return NO_ERROR on success or ERROR_INTERNAL on invalid ranges or
+ *         allocation failure (the buffer is then left unchanged).
+ */
+int source_buffer_splice(SourceBuffer *buffer, size_t offset, size_t removed,
+                         const char *inserted, size_t inserted_length);
+
+/**
+ * @brief Release the memory held by a source buffer.
+ *
+ * Unmaps or frees the data when the buffer owns it and resets the buffer
+ * to an empty state.
+ *
+ * @param buffer Buffer to release.
+ */
+void source_buffer_free(SourceBuffer *buffer);
+
+#endif // _SOURCE_BUFFER_H
@@ -1,10 +1,23 @@
 /**
  * @file symtable.c
  * @author xcernoj00
- * @brief Table of symbols presented as binary tree
+ * @brief Table of symbols presented as binary tree or hash table
+ *
+ * Tree nodes, hash slots, symbol data and parameters are allocated from
+ * the ARENA_SEMANTIC arena and released together with it.
+ *
+ * The hash table (SYMTABLE_HASH) uses linear probing with Robin Hood
+ * insertion: a key moving along the probe sequence takes the slot of any
+ * key closer to its own home slot. Probe lengths stay short and even, and
+ * a search for a missing key stops at the first slot whose key is closer
+ * to home than the searched one would be. Keys are interned, so the
+ * interning id serves as a precomputed hash and equality is one integer
+ * comparison.
  */
 
 #include "symtable.h"
+#include "arena.h"
+#include "intern.h"
 #include <stdlib.h>
 #include <string.h>
 
@@ -22,23 +35,69 @@ char *my_strdup(const char *s) {
     return copy;
 }
 
+// strndup replacement (not in C standard); stops early at an embedded NUL
+char *my_strndup(const char *s, size_t n) {
+    if (!s)
+        return NULL;
+    size_t len = 0;
+    while (len < n && s[len] != '\0')
+        len++;
+    char *copy = malloc(len + 1);
+    if (!copy)
+        return NULL;
+    memcpy(copy, s, len);
+    copy[len] = '\0';
+    return copy;
+}
+
+// Allocate a symbol together with its kind-specific data
+static SymTableData *alloc_symbol(NodeDataType type, size_t data_size) {
+    SymTableData *d = arena_alloc(phase_arena(ARENA_SEMANTIC),
+                                  sizeof(SymTableData) + data_size);
+    if (!d)
+        return NULL;
+    d->type = type;
+    // sizeof(SymTableData) is a multiple of the pointer alignment
+    void *data = (char *)d + sizeof(SymTableData);
+    switch (type) {
+    case NODE_VAR:
+        d->data.var_data = data;
+        break;
+    case NODE_FUNC:
+        d->data.func_data = data;
+        break;
+    case NODE_GETTER:
+        d->data.getter_data = data;
+        break;
+    case NODE_SETTER:
+        d->data.setter_data = data;
+        break;
+    }
+    return d;
+}
+
+#ifndef SYMTABLE_HASH
+
 // Return node height
 static int node_height(SNode *n) { return n ? n->height : 0; }
 
 // Return max of two integers
 static int max(int a, int b) { return (a > b) ? a : b; }
 
-// Create new node
+// Order of two interned keys (by interning id, so it is deterministic)
+static int key_cmp(const char *a, const char *b) {
+    if (a == b)
+        return 0;
+    return intern_id(a) < intern_id(b) ? -1 : 1;
+}
+
+// Create new node (key must already be interned)
 static SNode *create_node(const char *key, SymTableData *data) {
-    SNode *node = malloc(sizeof(SNode));
+    SNode *node = arena_alloc(phase_arena(ARENA_SEMANTIC), sizeof(SNode));
     if (!node)
         return NULL;
 
-    node->key = my_strdup(key); // copy key
-    if (!node->key) {
-        free(node);
-        return NULL;
-    }
+    node->key = key;
 
     node->data = data;
     node->left = node->right = NULL;
@@ -46,43 +105,6 @@ static SNode *create_node(const char *key, SymTableData *data) {
     return node;
 }
 
-// Free node and its data
-static void free_node(SNode *n) {
-    if (!n)
-        return;
-
-    if (n->data) {
-        switch (n->data->type) {
-        case NODE_VAR:
-            free(n->data->data.var_data);
-            break;
-        case NODE_FUNC: {
-            Param *p = n->data->data.func_data->parameters;
-            while (p) {
-                Param *next = p->next;
-                free(p->name);
-                free(p);
-                p = next;
-            }
-            free(n->data->data.func_data);
-            break;
-        }
-        case NODE_GETTER:
-            free(n->data->data.getter_data);
-            break;
-        case NODE_SETTER:
-            free(n->data->data.setter_data);
-            break;
-        }
-        free(n->data);
-    }
-
-    if (n->key) {
-        free(n->key);
-    }
-    free(n);
-}
-
 // AVL balance helpers
 static int get_balance(SNode *n) {
     return n ? (node_height(n->left) - node_height(n->right)) : 0;
@@ -118,11 +140,12 @@ static SNode *rotate_left(SNode *x) {
 static SNode *insert_node(SNode *node, const char *key, SymTableData *data,
                           bool *inserted) {
     if (!node) {
-        *inserted = true;
-        return create_node(key, data);
+        SNode *created = create_node(key, data);
+        *inserted = created != NULL;
+        return created;
     }
 
-    int cmp = strcmp(key, node->key);
+    int cmp = key_cmp(key, node->key);
     if (cmp < 0) {
         node->left = insert_node(node->left, key, data, inserted);
     } else if (cmp > 0) {
@@ -138,21 +161,21 @@ static SNode *insert_node(SNode *node, const char *key, SymTableData *data,
     int balance = get_balance(node);
 
     // LL
-    if (balance > 1 && strcmp(key, node->left->key) < 0)
+    if (balance > 1 && key_cmp(key, node->left->key) < 0)
         return rotate_right(node);
 
     // RR
-    if (balance < -1 && strcmp(key, node->right->key) > 0)
+    if (balance < -1 && key_cmp(key, node->right->key) > 0)
         return rotate_left(node);
 
     // LR
-    if (balance > 1 && strcmp(key, node->left->key) > 0) {
+    if (balance > 1 && key_cmp(key, node->left->key) > 0) {
         node->left = rotate_left(node->left);
         return rotate_right(node);
     }
 
     // RL
-    if (balance < -1 && strcmp(key, node->right->key) < 0) {
+    if (balance < -1 && key_cmp(key, node->right->key) < 0) {
         node->right = rotate_right(node->right);
         return rotate_left(node);
     }
@@ -165,7 +188,7 @@ static SymTableData *search_node(SNode *node, const char *key) {
     if (!node)
         return NULL;
 
-    int cmp = strcmp(key, node->key);
+    int cmp = key_cmp(key, node->key);
     if (cmp == 0)
         return node->data;
     if (cmp < 0)
@@ -173,13 +196,13 @@ static SymTableData *search_node(SNode *node, const char *key) {
     return search_node(node->right, key);
 }
 
-// Free whole subtree
-static void free_subtree(SNode *node) {
+// In-order walk (by interning id), stops once visit returns true
+static bool foreach_node(SNode *node, SymTableVisit visit, void *context) {
     if (!node)
-        return;
-    free_subtree(node->left);
-    free_subtree(node->right);
-    free_node(node);
+        return false;
+    return foreach_node(node->left, visit, context) ||
+           visit(node->key, node->data, context) ||
+           foreach_node(node->right, visit, context);
 }
 
 // ---------- Public API ----------
@@ -187,17 +210,28 @@ static void free_subtree(SNode *node) {
 void symtable_init(SymTable *table) { table->root = NULL; }
 
 void symtable_free(SymTable *table) {
-    free_subtree(table->root);
+    // The entries themselves are reclaimed with the semantic arena
     table->root = NULL;
 }
 
 SymTableData *symtable_search(SymTable *table, const char *key) {
-    return search_node(table->root, key);
+    // A name that was never interned cannot be in any table
+    const char *handle = intern_find(key);
+    if (!handle)
+        return NULL;
+    return symtable_search_handle(table, handle);
+}
+
+SymTableData *symtable_search_handle(SymTable *table, const char *handle) {
+    return search_node(table->root, handle);
 }
 
 bool symtable_insert(SymTable *table, const char *key, SymTableData *data) {
     bool inserted = false;
-    table->root = insert_node(table->root, key, data, &inserted);
+    const char *handle = intern(key);
+    if (!handle)
+        return false;
+    table->root = insert_node(table->root, handle, data, &inserted);
     return inserted;
 }
 
@@ -208,18 +242,177 @@ bool symtable_delete(SymTable *table, const char *key) {
     return false;
 }
 
+bool symtable_foreach(SymTable *table, SymTableVisit visit, void *context) {
+    return foreach_node(table->root, visit, context);
+}
+
+#else // SYMTABLE_HASH
+
+// Slots of a table on its first insertion
+#define SYMTABLE_INITIAL_CAPACITY 8
+
+// Home slot of an interning id (Fibonacci hashing: ids are sequential)
+static size_t home_slot(const SymTable *table, unsigned id) {
+    return (size_t)(id * 2654435769u) * table->capacity >> 32;
+}
+
+// Slot holding the key with interning id `id`, or NULL
+static SymSlot *find_slot(const SymTable *table, unsigned id) {
+    if (table->count == 0)
+        return NULL;
+    size_t mask = table->capacity - 1;
+    size_t i = home_slot(table, id);
+    for (unsigned distance = 0;; distance++) {
+        SymSlot *slot = &table->slots[i];
+        // Past this slot the key would have displaced its occupant
+        if (!slot->key || slot->distance < distance)
+            return NULL;
+        if (slot->id == id)
+            return slot;
+        i = (i + 1) & mask;
+    }
+}
+
+// Store an entry known to be absent, displacing keys closer to home
+static void place_slot(SymTable *table, SymSlot entry) {
+    size_t mask = table->capacity - 1;
+    size_t i = home_slot(table, entry.id);
+    entry.distance = 0;
+    for (;;) {
+        SymSlot *slot = &table->slots[i];
+        if (!slot->key) {
+            *slot = entry;
+            return;
+        }
+        if (slot->distance < entry.distance) {
+            SymSlot displaced = *slot;
+            *slot = entry;
+            entry = displaced;
+        }
+        entry.distance++;
+        i = (i + 1) & mask;
+    }
+}
+
+// Rehash into `capacity` slots (a power of two)
+static bool resize(SymTable *table, size_t capacity) {
+    Arena *arena = phase_arena(ARENA_SEMANTIC);
+    SymSlot *slots = arena_alloc(arena, capacity * sizeof(SymSlot));
+    if (!slots)
+        return false;
+    memset(slots, 0, capacity * sizeof(SymSlot));
+
+    SymSlot *old = table->slots;
+    size_t old_capacity = table->capacity;
+    table->slots = slots;
+    table->capacity = capacity;
+    for (size_t i = 0; i < old_capacity; i++) {
+        if (old[i].key)
+            place_slot(table, old[i]);
+    }
+    arena_release(arena, old, old_capacity * sizeof(SymSlot));
+    return true;
+}
+
+void symtable_init(SymTable *table) {
+    table->slots = NULL;
+    table->capacity = 0;
+    table->count = 0;
+}
+
+void symtable_free(SymTable *table) {
+    // The slots themselves are reclaimed with the semantic arena
+    symtable_init(table);
+}
+
+SymTableData *symtable_search(SymTable *table, const char *key) {
+    // A name that was never interned cannot be in any table
+    const char *handle = intern_find(key);
+    if (!handle)
+        return NULL;
+    return symtable_search_handle(table, handle);
+}
+
+SymTableData *symtable_search_handle(SymTable *table, const char *handle) {
+    SymSlot *slot = find_slot(table, intern_id(handle));
+    return slot ? slot->data : NULL;
+}
+
+bool symtable_insert(SymTable *table, const char *key, SymTableData *data) {
+    const char *handle = intern(key);
+    if (!handle)
+        return false;
+    unsigned id = intern_id(handle);
+    if (find_slot(table, id))
+        return false;
+
+    // Keep the load factor at most 3/4
+    if ((table->count + 1) * 4 > table->capacity * 3 &&
+        !resize(table, table->capacity ? table->capacity * 2
+                                       : SYMTABLE_INITIAL_CAPACITY))
+        return false;
+    place_slot(table, (SymSlot){handle, data, id, 0});
+    table->count++;
+    return true;
+}
+
+bool symtable_delete(SymTable *table, const char *key) {
+    const char *handle = intern_find(key);
+    SymSlot *slot = handle ? find_slot(table, intern_id(handle)) : NULL;
+    if (!slot)
+        return false;
+
+    // Shift the following keys one slot back towards their homes
+    size_t mask = table->capacity - 1;
+    size_t i = (size_t)(slot - table->slots);
+    for (;;) {
+        SymSlot *next = &table->slots[(i + 1) & mask];
+        if (!next->key || next->distance == 0)
+            break;
+        table->slots[i] = *next;
+        table->slots[i].distance--;
+        i = (i + 1) & mask;
+    }
+    table->slots[i] = (SymSlot){0};
+    table->count--;
+    return true;
+}
+
+// Orders slots by interning id
+static int compare_slots(const void *a, const void *b) {
+    unsigned x = (*(SymSlot *const *)a)->id;
+    unsigned y = (*(SymSlot *const *)b)->id;
+    return (x > y) - (x < y);
+}
+
+bool symtable_foreach(SymTable *table, SymTableVisit visit, void *context) {
+    if (table->count == 0)
+        return false;
+    SymSlot **order = malloc(table->count * sizeof(SymSlot *));
+    if (!order)
+        return false;
+    size_t n = 0;
+    for (size_t i = 0; i < table->capacity; i++) {
+        if (table->slots[i].key)
+            order[n++] = &table->slots[i];
+    }
+    qsort(order, n, sizeof(SymSlot *), compare_slots);
+
+    bool stopped = false;
+    for (size_t i = 0; i < n && !stopped; i++)
+        stopped = visit(order[i]->key, order[i]->data, context);
+    free(order);
+    return stopped;
+}
+
+#endif // SYMTABLE_HASH
+
 // ---------- Factory functions ----------
 
 SymTableData *make_variable(DataType type, bool defined, bool initialized) {
-    SymTableData *d = malloc(sizeof(SymTableData));
+    SymTableData *d = alloc_symbol(NODE_VAR, sizeof(VariableData));
     if (!d)
         return NULL;
-    d->type = NODE_VAR;
-    d->data.var_data = malloc(sizeof(VariableData));
-    if (!d->data.var_data) {
-        free(d);
-        return NULL;
-    }
     d->data.var_data->data_type = type;
     d->data.var_data->defined = defined;
     d->data.var_data->initialized = initialized;
@@ -229,15 +422,13 @@ SymTableData *make_variable(DataType type, bool defined, bool initialized) {
 
 // Create a new parameter node
 Param *make_param(const char *name, DataType type) {
-    Param *p = malloc(sizeof(Param));
+    Param *p = arena_alloc(phase_arena(ARENA_SEMANTIC), sizeof(Param));
     if (!p)
         return NULL;
 
-    p->name = my_strdup(name); // copy identifier
-    if (!p->name) {
-        free(p);
+    p->name = intern(name); // shared identifier
+    if (!p->name)
         return NULL;
-    }
     p->data_type = type;
     p->next = NULL;
     return p;
@@ -256,47 +447,30 @@ Param *append_param(Param *head, Param *new_param) {
 }
 
 SymTableData *make_function(int param_count, Param *params, bool defined, DataType return_type) {
-    SymTableData *d = malloc(sizeof(SymTableData));
+    SymTableData *d = alloc_symbol(NODE_FUNC, sizeof(FunctionData));
     if (!d)
         return NULL;
-    d->type = NODE_FUNC;
-    d->data.func_data = malloc(sizeof(FunctionData));
-    if (!d->data.func_data) {
-        free(d);
-        return NULL;
-    }
     d->data.func_data->param_count = param_count;
     d->data.func_data->parameters = params;
     d->data.func_data->defined = defined;
     d->data.func_data->return_type = return_type;
+    d->data.func_data->definition = NULL;
     return d;
 }
 
 SymTableData *make_getter(DataType return_type, bool defined) {
-    SymTableData *d = malloc(sizeof(SymTableData));
+    SymTableData *d = alloc_symbol(NODE_GETTER, sizeof(GetterData));
     if (!d)
         return NULL;
-    d->type = NODE_GETTER;
-    d->data.getter_data = malloc(sizeof(GetterData));
-    if (!d->data.getter_data) {
-        free(d);
-        return NULL;
-    }
     d->data.getter_data->return_type = return_type;
     d->data.getter_data->defined = defined;
     return d;
 }
 
 SymTableData *make_setter(DataType param_type, bool defined) {
-    SymTableData *d = malloc(sizeof(SymTableData));
+    SymTableData *d = alloc_symbol(NODE_SETTER, sizeof(SetterData));
     if (!d)
         return NULL;
-    d->type = NODE_SETTER;
-    d->data.setter_data = malloc(sizeof(SetterData));
-    if (!d->data.setter_data) {
-        free(d);
-        return NULL;
-    }
     d->data.setter_data->param_type = param_type;
     d->data.setter_data->defined = defined;
     return d;
@@ -1,10 +1,16 @@
 /**
  * @file symtable.h
  * @author xcernoj00
- * @brief Symbol table (AVL tree) API and type declarations for IFJ25.
+ * @brief Symbol table API and type declarations for IFJ25.
  *
  * The symbol table stores variables, functions, getters and setters
- * in an AVL-balanced binary search tree keyed by identifier name.
+ * keyed by interned identifier name. Two implementations are available,
+ * chosen at build time:
+ * - by default, an AVL-balanced binary search tree whose nodes are
+ *   ordered by interning id, so comparing two keys never touches their
+ *   characters;
+ * - with SYMTABLE_HASH defined (`make SYMTABLE=hash`), an open-addressing
+ *   hash table with Robin Hood probing, hashed by interning id.
  * This header exposes the public data types used by the semantic
  * analysis phase and factory functions to create symbol entries.
  */
@@ -13,6 +19,7 @@
 #define SYMTABLE_H
 
 #include <stdbool.h>
+#include <stddef.h>
 
 /**
  * @brief Opaque scope type.
@@ -55,7 +62,7 @@ typedef struct VariableData {
  * @brief Function parameter description (linked list node).
  */
 typedef struct Param {
-    char *name;         /**< parameter identifier (heap allocated) */
+    const char *name;   /**< parameter identifier (interned) */
     DataType data_type; /**< parameter type */
     struct Param *next; /**< next parameter in list or NULL */
 } Param;
@@ -68,6 +75,7 @@ typedef struct FunctionData {
     Param *parameters;    /**< linked list of parameters */
     bool defined;         /**< whether the function body is defined */
     DataType return_type; /**< return type of the function */
+    struct ASTNode *definition; /**< its definition, NULL for built-ins */
 } FunctionData;
 
 /**
@@ -99,11 +107,34 @@ typedef struct SymTableData {
     } data;
 } SymTableData;
 
+#ifdef SYMTABLE_HASH
+
+/**
+ * @brief Hash table slot storing an identifier and its associated data.
+ */
+typedef struct SymSlot {
+    const char *key;    /**< interned identifier name, NULL if empty */
+    SymTableData *data; /**< pointer to symbol metadata */
+    unsigned id;        /**< interning id of the key, hashed for the slot */
+    unsigned distance;  /**< distance from the slot the key hashes to */
+} SymSlot;
+
+/**
+ * @brief Symbol table structure.
+ */
+typedef struct {
+    SymSlot *slots;  /**< `capacity` slots, NULL while empty */
+    size_t capacity; /**< number of slots, 0 or a power of two */
+    size_t count;    /**< number of stored symbols */
+} SymTable;
+
+#else
+
 /**
  * @brief AVL tree node storing an identifier and its associated data.
  */
 typedef struct SNode {
-    char *key;           /**< identifier name (unique in scope) */
+    const char *key;     /**< interned identifier name (unique in scope) */
     SymTableData *data;  /**< pointer to symbol metadata */
     struct SNode *left;  /**< left child */
     struct SNode *right; /**< right child */
@@ -117,6 +148,19 @@ typedef struct {
     SNode *root; /**< root node of the AVL tree */
 } SymTable;
 
+#endif
+
+/**
+ * @brief Callback of symtable_foreach.
+ *
+ * @param key Interned identifier name.
+ * @param data Its symbol.
+ * @param context Context passed to symtable_foreach.
+ * @return true to stop the iteration.
+ */
+typedef bool (*SymTableVisit)(const char *key, SymTableData *data,
+                              void *context);
+
 /* ---------- Public API ---------- */
 
 /**
@@ -127,7 +171,10 @@ typedef struct {
 void symtable_init(SymTable *table);
 
 /**
- * @brief Free all resources held by the symbol table.
+ * @brief Empty the symbol table.
+ *
+ * The entries live in the ARENA_SEMANTIC arena and are reclaimed when that
+ * arena is freed.
  *
  * @param table Pointer to SymTable to free.
  */
@@ -142,11 +189,23 @@ void symtable_free(SymTable *table);
  */
 SymTableData *symtable_search(SymTable *table, const char *key);
 
+/**
+ * @brief Search for a symbol by its interned name.
+ *
+ * Skips the interning lookup of symtable_search, for callers searching
+ * several tables for the same name.
+ *
+ * @param table Pointer to SymTable.
+ * @param handle Name returned by intern() or intern_find().
+ * @return Pointer to SymTableData if found, or NULL if not present.
+ */
+SymTableData *symtable_search_handle(SymTable *table, const char *handle);
+
 /**
  * @brief Insert a new symbol into the table.
  *
  * @param table Pointer to SymTable.
- * @param key Identifier name (NUL-terminated).
+ * @param key Identifier name (NUL-terminated, interned on insertion).
  * @param data Pointer to SymTableData (ownership semantics depend on
  * implementation).
  * @return true on success, false on failure (e.g. memory allocation or
@@ -163,11 +222,29 @@ bool symtable_insert(SymTable *table, const char *key, SymTableData *data);
  */
 bool symtable_delete(SymTable *table, const char *key);
 
+/**
+ * @brief Call `visit` for every symbol, in the order the keys were
+ * interned, until it returns true.
+ *
+ * The order does not depend on the implementation, so output generated
+ * from a table is the same with either.
+ *
+ * @param table Pointer to SymTable.
+ * @param visit Callback.
+ * @param context Passed to the callback.
+ * @return true if a callback stopped the iteration, false otherwise (also
+ * on allocation failure).
+ */
+bool symtable_foreach(SymTable *table, SymTableVisit visit, void *context);
+
 /* ---------- Factory functions ---------- */
 
 /**
  * @brief Create a SymTableData for a variable.
  *
+ * Symbols are allocated from the ARENA_SEMANTIC arena, each in one block
+ * together with its kind-specific data.
+ *
  * @param type Variable data type.
  * @param defined Whether the variable is declared/defined.
  * @param initialized Whether the variable has an assigned value.
@@ -194,7 +271,8 @@ SymTableData *make_setter(DataType param_type, bool defined);
 /**
  * @brief Create a parameter descriptor.
  *
- * The returned Param is heap allocated and may be linked into a list.
+ * The returned Param lives in the ARENA_SEMANTIC arena and may be linked
+ * into a list.
  */
 Param *make_param(const char *name, DataType type);
 
@@ -215,4 +293,16 @@ Param *append_param(Param *head, Param *new_param);
  */
 char *my_strdup(const char *s);
 
+/**
+ * @brief Duplicate at most `n` bytes of a string (simple strndup).
+ *
+ * Copying stops early at an embedded NUL, so the result always matches
+ * what `my_strdup` would produce for the same NUL-terminated text.
+ *
+ * @param s Source characters (need not be NUL-terminated).
+ * @param n Maximum number of bytes to copy.
+ * @return Heap-allocated NUL-terminated copy or NULL on allocation failure.
+ */
+char *my_strndup(const char *s, size_t n);
+
 #endif // SYMTABLE_H
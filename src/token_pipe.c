@@ -0,0 +1,195 @@
+/**
+ * @file token_pipe.c
+ * @author xcernoj00
+ * @brief Pipelined scanning: a scanner thread feeding the parser
+ *
+ * The ring is indexed by two ever-growing counters: `tail` counts the
+ * entries the scanner thread published, `head` the ones the parser took.
+ * Each side owns one counter and only reads the other (acquire/release),
+ * caching the value it saw last so the shared cache line is touched only
+ * when the ring looks full or empty.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "token_pipe.h"
+#include "intern.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#define CACHE_LINE 64
+#define PIPE_MASK (TOKEN_PIPE_CAPACITY - 1)
+#define SPINS_BEFORE_YIELD 64
+
+/**
+ * @brief One scanned token and the scanner cursor after it.
+ */
+typedef struct {
+    Token token;
+    size_t start; ///< offset where the token starts
+    size_t end;   ///< offset after the token
+    int result;   ///< get_token result, an error ends the stream
+} PipeEntry;
+
+struct TokenPipe {
+    // Scanner thread side
+    alignas(CACHE_LINE) atomic_size_t tail; ///< entries published
+    size_t head_seen;                       ///< `head` as last read
+    Scanner lexer;                          ///< scanner of the thread
+
+    // Parser side
+    alignas(CACHE_LINE) atomic_size_t head; ///< entries taken
+    size_t tail_seen;                       ///< `tail` as last read
+    bool finished;                          ///< `last` was taken
+    PipeEntry last;                         ///< EOF or error entry
+
+    alignas(CACHE_LINE) atomic_bool stop; ///< parser is done, thread exits
+    InternTable *names;                   ///< intern table of the parser
+    pthread_t thread;
+
+    alignas(CACHE_LINE) PipeEntry entries[TOKEN_PIPE_CAPACITY];
+};
+
+static inline bool is_last(const PipeEntry *entry) {
+    return entry->result != NO_ERROR || entry->token.type == TOKEN_EOF;
+}
+
+/**
+ * @brief Wait a little: spin first, then give the CPU to the other side.
+ */
+static inline void backoff(unsigned *spins) {
+    if (++*spins >= SPINS_BEFORE_YIELD) {
+        sched_yield();
+    }
+}
+
+static void *scan_thread(void *arg) {
+    TokenPipe *pipe = arg;
+    size_t tail = atomic_load_explicit(&pipe->tail, memory_order_relaxed);
+    PipeEntry entry;
+
+    intern_attach(pipe->names);
+    do {
+        entry.result = get_token(&pipe->lexer, &entry.token);
+        entry.start = pipe->lexer.token_start;
+        entry.end = pipe->lexer.position;
+
+        // Backpressure: wait for the parser to free a slot
+        unsigned spins = 0;
+        while (tail - pipe->head_seen == TOKEN_PIPE_CAPACITY) {
+            pipe->head_seen =
+                atomic_load_explicit(&pipe->head, memory_order_acquire);
+            if (tail - pipe->head_seen < TOKEN_PIPE_CAPACITY) {
+                break;
+            }
+            if (atomic_load_explicit(&pipe->stop, memory_order_relaxed)) {
+                intern_attach(NULL);
+                return NULL;
+            }
+            backoff(&spins);
+        }
+        pipe->entries[tail & PIPE_MASK] = entry;
+        atomic_store_explicit(&pipe->tail, ++tail, memory_order_release);
+    } while (!is_last(&entry) &&
+             !atomic_load_explicit(&pipe->stop, memory_order_relaxed));
+    intern_attach(NULL);
+    return NULL;
+}
+
+/**
+ * @brief Entry number `index`, waiting until the scanner published it.
+ */
+static const PipeEntry *entry_at(TokenPipe *pipe, size_t index) {
+    unsigned spins = 0;
+    while (index >= pipe->tail_seen) {
+        pipe->tail_seen =
+            atomic_load_explicit(&pipe->tail, memory_order_acquire);
+        if (index < pipe->tail_seen) {
+            break;
+        }
+        backoff(&spins);
+    }
+    return &pipe->entries[index & PIPE_MASK];
+}
+
+int scanner_start_pipeline(Scanner *scanner) {
+    if (scanner->pretokenized || scanner->pipe) {
+        return ERROR_INTERNAL;
+    }
+    TokenPipe *pipe = aligned_alloc(CACHE_LINE, sizeof(TokenPipe));
+    if (!pipe) {
+        return ERROR_INTERNAL;
+    }
+    if (scanner_init_buffer(&pipe->lexer, scanner->source.data,
+                            scanner->source.length) != NO_ERROR) {
+        free(pipe);
+        return ERROR_INTERNAL;
+    }
+    pipe->lexer.position = scanner->position;
+    atomic_init(&pipe->tail, 0);
+    atomic_init(&pipe->head, 0);
+    atomic_init(&pipe->stop, false);
+    pipe->head_seen = 0;
+    pipe->tail_seen = 0;
+    pipe->finished = false;
+    pipe->names = intern_table();
+
+    intern_share(pipe->names, true);
+    if (pthread_create(&pipe->thread, NULL, scan_thread, pipe) != 0) {
+        intern_share(pipe->names, false);
+        scanner_free(&pipe->lexer);
+        free(pipe);
+        return ERROR_INTERNAL;
+    }
+    scanner->pipe = pipe;
+    return NO_ERROR;
+}
+
+int token_pipe_get(TokenPipe *pipe, Scanner *scanner, Token *token) {
+    if (!pipe->finished) {
+        size_t head = atomic_load_explicit(&pipe->head, memory_order_relaxed);
+        PipeEntry entry = *entry_at(pipe, head);
+        atomic_store_explicit(&pipe->head, head + 1, memory_order_release);
+        scanner->token_start = entry.start;
+        scanner->position = entry.end;
+        if (!is_last(&entry)) {
+            *token = entry.token;
+            return entry.result;
+        }
+        pipe->finished = true;
+        pipe->last = entry;
+    }
+    // The stream keeps repeating its EOF or error
+    *token = pipe->last.token;
+    return pipe->last.result;
+}
+
+int token_pipe_peek(TokenPipe *pipe, size_t ahead, Token *token) {
+    const PipeEntry *entry = &pipe->last;
+    if (ahead >= TOKEN_PIPE_CAPACITY) {
+        return ERROR_INTERNAL;
+    }
+    if (!pipe->finished) {
+        size_t head = atomic_load_explicit(&pipe->head, memory_order_relaxed);
+        for (size_t i = 0;; i++) {
+            entry = entry_at(pipe, head + i);
+            if (i == ahead || is_last(entry)) {
+                break;
+            }
+        }
+    }
+    *token = entry->token;
+    return entry->result;
+}
+
+void token_pipe_stop(TokenPipe *pipe) {
+    atomic_store_explicit(&pipe->stop, true, memory_order_relaxed);
+    pthread_join(pipe->thread, NULL);
+    intern_share(pipe->names, false);
+    scanner_free(&pipe->lexer);
+    free(pipe);
+}
@@ -0,0 +1,55 @@
+/**
+ * @file token_pipe.h
+ * @author xcernoj00
+ * @brief Pipelined scanning: a scanner thread feeding the parser.
+ *
+ * In pipelined mode the source is scanned on its own thread, which
+ * publishes tokens into a bounded lock-free single-producer/single-consumer
+ * ring. `get_token` and `peek_token` of the scanner then consume the ring,
+ * so the parser overlaps with lexing without any change on its side.
+ *
+ * When the ring is full the scanner thread waits for the parser
+ * (backpressure); when it is empty the parser waits for the scanner. A
+ * lexical error ends the stream: it is queued like a token and returned
+ * once the parser reaches it, exactly where streaming mode returns it.
+ */
+
+#ifndef _TOKEN_PIPE_H
+#define _TOKEN_PIPE_H
+
+#include "scanner.h"
+
+#define TOKEN_PIPE_CAPACITY 4096 ///< ring entries (power of two)
+
+typedef struct TokenPipe TokenPipe;
+
+/**
+ * @brief Start scanning the source of `scanner` on a separate thread.
+ *
+ * Must be called before the first token is taken. Identifiers are interned
+ * into the calling thread's table (see intern_attach), which is shared
+ * until the pipeline stops.
+ *
+ * @param scanner Freshly initialized scanner (not pre-tokenized).
+ * @return NO_ERROR, or ERROR_INTERNAL when the thread cannot be started
+ *         (the scanner then stays in streaming mode).
+ */
+int scanner_start_pipeline(Scanner *scanner);
+
+/**
+ * @brief Take the next token from the ring (used by `get_token`).
+ */
+int token_pipe_get(TokenPipe *pipe, Scanner *scanner, Token *token);
+
+/**
+ * @brief Look at an upcoming token in the ring (used by `peek_token`).
+ */
+int token_pipe_peek(TokenPipe *pipe, size_t ahead, Token *token);
+
+/**
+ * @brief Stop the scanner thread and free the pipeline
+ *        (used by `scanner_free`).
+ */
+void token_pipe_stop(TokenPipe *pipe);
+
+#endif // _TOKEN_PIPE_H
@@ -0,0 +1,169 @@
+/**
+ * @file work_pool.c
+ * @author xcernoj00
+ * @brief Work-stealing thread pool for independent jobs
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "work_pool.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <unistd.h>
+
+/**
+ * @brief Jobs still owned by one worker: [head, tail).
+ *
+ * The owner takes from the tail, thieves take from the head.
+ */
+typedef struct {
+    pthread_mutex_t lock;
+    size_t head;
+    size_t tail;
+} WorkRange;
+
+typedef struct {
+    WorkRange ranges[WORK_POOL_MAX_THREADS];
+    unsigned threads;
+    WorkFn fn;
+    void *context;
+} WorkPool;
+
+typedef struct {
+    WorkPool *pool;
+    unsigned id;
+    bool started; ///< thread was created (worker 0 always runs)
+    size_t steals;
+    pthread_t thread;
+} Worker;
+
+unsigned work_pool_cpu_count(void) {
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (unsigned)count : 1;
+}
+
+/**
+ * @brief Take the next job of the worker's own range.
+ */
+static bool take_own(WorkRange *range, size_t *job) {
+    bool found = false;
+    pthread_mutex_lock(&range->lock);
+    if (range->head < range->tail) {
+        *job = --range->tail;
+        found = true;
+    }
+    pthread_mutex_unlock(&range->lock);
+    return found;
+}
+
+/**
+ * @brief Move the front half of the largest other range into the worker's
+ *        own range.
+ * @return false when no other worker has jobs left.
+ */
+static bool steal(WorkPool *pool, unsigned thief) {
+    while (true) {
+        unsigned victim = thief;
+        size_t largest = 0;
+        for (unsigned i = 0; i < pool->threads; i++) {
+            WorkRange *range = &pool->ranges[i];
+            pthread_mutex_lock(&range->lock);
+            size_t left = range->tail - range->head;
+            pthread_mutex_unlock(&range->lock);
+            if (i != thief && left > largest) {
+                largest = left;
+                victim = i;
+            }
+        }
+        if (victim == thief) {
+            return false;
+        }
+
+        // The victim may have run dry meanwhile; look again then
+        WorkRange *range = &pool->ranges[victim];
+        pthread_mutex_lock(&range->lock);
+        size_t left = range->tail - range->head;
+        size_t head = range->head;
+        size_t taken = (left + 1) / 2;
+        range->head += taken;
+        pthread_mutex_unlock(&range->lock);
+        if (taken == 0) {
+            continue;
+        }
+
+        WorkRange *own = &pool->ranges[thief];
+        pthread_mutex_lock(&own->lock);
+        own->head = head;
+        own->tail = head + taken;
+        pthread_mutex_unlock(&own->lock);
+        return true;
+    }
+}
+
+static void *worker_main(void *arg) {
+    Worker *worker = arg;
+    WorkPool *pool = worker->pool;
+    size_t job;
+
+    while (true) {
+        while (take_own(&pool->ranges[worker->id], &job)) {
+            pool->fn(pool->context, job, worker->id);
+        }
+        if (!steal(pool, worker->id)) {
+            return NULL;
+        }
+        worker->steals++;
+    }
+}
+
+void work_pool_run(size_t count, unsigned threads, WorkFn fn, void *context,
+                   WorkPoolStats *stats) {
+    WorkPool pool;
+    Worker workers[WORK_POOL_MAX_THREADS];
+
+    if (threads == 0) {
+        threads = work_pool_cpu_count();
+    }
+    if (threads > WORK_POOL_MAX_THREADS) {
+        threads = WORK_POOL_MAX_THREADS;
+    }
+    if (threads > count) {
+        threads = count > 0 ? (unsigned)count : 1;
+    }
+    pool.threads = threads;
+    pool.fn = fn;
+    pool.context = context;
+
+    // Contiguous ranges of nearly equal size
+    for (unsigned i = 0; i < threads; i++) {
+        pthread_mutex_init(&pool.ranges[i].lock, NULL);
+        pool.ranges[i].head = count * i / threads;
+        pool.ranges[i].tail = count * (i + 1) / threads;
+        workers[i].pool = &pool;
+        workers[i].id = i;
+        workers[i].steals = 0;
+        workers[i].started = false;
+    }
+    for (unsigned i = 1; i < threads; i++) {
+        workers[i].started = pthread_create(&workers[i].thread, NULL,
+                                            worker_main, &workers[i]) == 0;
+    }
+    worker_main(&workers[0]);
+
+    size_t steals = workers[0].steals;
+    unsigned ran = 1;
+    for (unsigned i = 1; i < threads; i++) {
+        if (workers[i].started) {
+            pthread_join(workers[i].thread, NULL);
+            steals += workers[i].steals;
+            ran++;
+        }
+    }
+    for (unsigned i = 0; i < threads; i++) {
+        pthread_mutex_destroy(&pool.ranges[i].lock);
+    }
+    if (stats) {
+        stats->threads = ran;
+        stats->steals = steals;
+    }
+}
@@ -0,0 +1,56 @@
+/**
+ * @file work_pool.h
+ * @author xcernoj00
+ * @brief Work-stealing thread pool for independent jobs.
+ *
+ * Jobs are numbered 0..count-1 and split into one contiguous range per
+ * worker. A worker takes jobs from the back of its own range; when it runs
+ * dry it steals the front half of the largest remaining range of another
+ * worker, so uneven jobs still keep every thread busy.
+ */
+
+#ifndef _WORK_POOL_H
+#define _WORK_POOL_H
+
+#include <stddef.h>
+
+#define WORK_POOL_MAX_THREADS 256
+
+/**
+ * @brief Job callback.
+ *
+ * @param context Caller data passed to work_pool_run().
+ * @param job Job number.
+ * @param worker Number of the worker running the job (0..threads-1).
+ */
+typedef void (*WorkFn)(void *context, size_t job, unsigned worker);
+
+/**
+ * @brief Counters of one pool run.
+ */
+typedef struct {
+    unsigned threads; ///< workers that ran
+    size_t steals;    ///< successful steals over all workers
+} WorkPoolStats;
+
+/**
+ * @brief Number of processors available to the process (at least 1).
+ */
+unsigned work_pool_cpu_count(void);
+
+/**
+ * @brief Run `count` jobs on up to `threads` workers and wait for them.
+ *
+ * The calling thread acts as worker 0. Each job runs exactly once; the
+ * jobs of a worker whose thread cannot be started are stolen by the others.
+ *
+ * @param count Number of jobs.
+ * @param threads Requested number of workers (0 means one per processor).
+ * @param fn Job callback.
+ * @param context Caller data for the callback.
+ * @param stats Receives the counters of the run (may be NULL).
+ */
+void work_pool_run(size_t count, unsigned threads, WorkFn fn, void *context,
+                   WorkPoolStats *stats);
+
+#endif // _WORK_POOL_H
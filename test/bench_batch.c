@@ -0,0 +1,222 @@
+/**
+ * @file bench_batch.c
+ * @author xcernoj00
+ * @brief Scaling benchmark of batch compilation.
+ *
+ * The programs given on the command line are copied many times into a
+ * temporary directory. The whole directory is then compiled:
+ *   - by spawning `./main <options> < file > file.ifjcode` once per file,
+ *     the way test_complet.sh does (when ./main exists),
+ *   - with batch_compile() on 1, 2, 4, ... up to N threads.
+ * The compiler options (--lex-first, --pipeline, --parse-threads N,
+ * --climbing, --lazy-bodies) are passed to both. Every run must reproduce
+ * the exit codes and the generated code of the single-threaded batch run.
+ *
+ * Usage: ./bench_batch [-j N] [-c copies] [options] file.wren...
+ *        (default N: number of processors, at least 4; copies: 20)
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "batch.h"
+#include "error.h"
+#include "ifj25.h"
+#include "test_util.h"
+#include <fcntl.h>
+#include <spawn.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+static int failures = 0;
+
+static char *output_of(const char *path, size_t *length) {
+    char output_path[4096];
+    snprintf(output_path, sizeof(output_path), "%s%s", path,
+             BATCH_OUTPUT_SUFFIX);
+    return read_file(output_path, length);
+}
+
+/**
+ * @brief Compare the exit codes and outputs with the reference run.
+ */
+static void compare(const Batch *batch, const int *statuses,
+                    char *const *outputs, const size_t *lengths,
+                    const char *run) {
+    for (size_t i = 0; i < batch->count && failures < 10; i++) {
+        size_t length;
+        char *output = output_of(batch->files[i].path, &length);
+        if (batch->files[i].status != statuses[i] || !output ||
+            length != lengths[i] || memcmp(output, outputs[i], length) != 0) {
+            printf("FAIL: %s differs %s\n", batch->files[i].path, run);
+            failures++;
+        }
+        free(output);
+    }
+}
+
+/**
+ * @brief Compile every file with its own `./main` process; the exit code of
+ * each replaces its batch status.
+ */
+static double spawn_per_file(Batch *batch, char **main_argv) {
+    extern char **environ;
+    double start = now_seconds();
+    for (size_t i = 0; i < batch->count; i++) {
+        char output_path[4096];
+        snprintf(output_path, sizeof(output_path), "%s%s",
+                 batch->files[i].path, BATCH_OUTPUT_SUFFIX);
+        posix_spawn_file_actions_t actions;
+        posix_spawn_file_actions_init(&actions);
+        posix_spawn_file_actions_addopen(&actions, 0, batch->files[i].path,
+                                         O_RDONLY, 0);
+        posix_spawn_file_actions_addopen(&actions, 1, output_path,
+                                         O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        posix_spawn_file_actions_addopen(&actions, 2, "/dev/null", O_WRONLY,
+                                         0);
+        pid_t pid;
+        batch->files[i].status = ERROR_INTERNAL;
+        if (posix_spawn(&pid, "./main", &actions, NULL, main_argv, environ) ==
+            0) {
+            int status;
+            if (waitpid(pid, &status, 0) == pid && WIFEXITED(status)) {
+                batch->files[i].status = WEXITSTATUS(status);
+            }
+        }
+        posix_spawn_file_actions_destroy(&actions);
+    }
+    return now_seconds() - start;
+}
+
+int main(int argc, char **argv) {
+    unsigned max_threads = work_pool_cpu_count();
+    int copies = 20;
+    int first = 1;
+    if (max_threads < 4) {
+        max_threads = 4;
+    }
+    Ifj25Context options;
+    ifj25_context_init(&options);
+    // ./main with the same options, then NULL
+    char **main_argv = calloc((size_t)argc + 1, sizeof(char *));
+    if (!main_argv) {
+        return 1;
+    }
+    int main_argc = 0;
+    main_argv[main_argc++] = "./main";
+    for (; first < argc && argv[first][0] == '-'; first++) {
+        const char *option = argv[first];
+        bool has_value = first + 1 < argc;
+        if (strcmp(option, "-j") == 0 && has_value) {
+            max_threads = (unsigned)atoi(argv[++first]);
+            continue;
+        } else if (strcmp(option, "-c") == 0 && has_value) {
+            copies = atoi(argv[++first]);
+            continue;
+        } else if (strcmp(option, "--lex-first") == 0) {
+            options.lex_first = true;
+        } else if (strcmp(option, "--pipeline") == 0) {
+            options.pipelined = true;
+        } else if (strcmp(option, "--parse-threads") == 0 && has_value) {
+            main_argv[main_argc++] = argv[first++];
+            options.parse_threads = (unsigned)atoi(argv[first]);
+        } else if (strcmp(option, "--climbing") == 0) {
+            options.climbing_expressions = true;
+        } else if (strcmp(option, "--lazy-bodies") == 0) {
+            options.lazy_bodies = true;
+        } else {
+            printf("FAIL: unknown option %s\n", option);
+            return 1;
+        }
+        main_argv[main_argc++] = argv[first];
+    }
+
+    // Diagnostics of failing programs are expected
+    if (!freopen("/dev/null", "w", stderr)) {
+        return 1;
+    }
+
+    char dir[] = "/tmp/bench_batch_XXXXXX";
+    if (!mkdtemp(dir)) {
+        printf("FAIL: cannot create a temporary directory\n");
+        return 1;
+    }
+    Batch batch;
+    batch_init(&batch);
+    for (int copy = 0; copy < copies; copy++) {
+        for (int i = first; i < argc; i++) {
+            size_t length;
+            char *source = read_file(argv[i], &length);
+            if (!source) {
+                printf("FAIL: cannot read %s\n", argv[i]);
+                return 1;
+            }
+            char path[4096];
+            snprintf(path, sizeof(path), "%s/%03d_%d.wren", dir, copy, i);
+            FILE *f = fopen(path, "wb");
+            fwrite(source, 1, length, f);
+            fclose(f);
+            free(source);
+            batch_add(&batch, path);
+        }
+    }
+    printf("%zu programs, %u processors\n", batch.count,
+           work_pool_cpu_count());
+
+    // Reference: one thread
+    double t0 = now_seconds();
+    batch_compile(&batch, 1, &options, NULL);
+    double t_one = now_seconds() - t0;
+    int *statuses = malloc(batch.count * sizeof(int));
+    char **outputs = malloc(batch.count * sizeof(char *));
+    size_t *lengths = malloc(batch.count * sizeof(size_t));
+    for (size_t i = 0; i < batch.count; i++) {
+        statuses[i] = batch.files[i].status;
+        outputs[i] = output_of(batch.files[i].path, &lengths[i]);
+    }
+
+    if (access("./main", X_OK) == 0) {
+        double t_spawn = spawn_per_file(&batch, main_argv);
+        printf("  process per file: %8.3f s\n", t_spawn);
+        compare(&batch, statuses, outputs, lengths, "from ./main");
+    }
+    printf("  batch, 1 thread:  %8.3f s\n", t_one);
+
+    for (unsigned threads = 2; threads <= max_threads; threads *= 2) {
+        WorkPoolStats stats;
+        t0 = now_seconds();
+        batch_compile(&batch, threads, &options, &stats);
+        double elapsed = now_seconds() - t0;
+        printf("  batch, %u threads: %7.3f s (%.2fx, %zu steals)\n", threads,
+               elapsed, t_one / elapsed, stats.steals);
+
+        char run[32];
+        snprintf(run, sizeof(run), "on %u threads", threads);
+        compare(&batch, statuses, outputs, lengths, run);
+    }
+
+    for (size_t i = 0; i < batch.count; i++) {
+        char output_path[4096];
+        snprintf(output_path, sizeof(output_path), "%s%s",
+                 batch.files[i].path, BATCH_OUTPUT_SUFFIX);
+        remove(output_path);
+        remove(batch.files[i].path);
+        free(outputs[i]);
+    }
+    rmdir(dir);
+    free(statuses);
+    free(outputs);
+    free(lengths);
+    free(main_argv);
+    batch_free(&batch);
+    if (failures) {
+        printf("%d failure(s)\n", failures);
+        return 1;
+    }
+    printf("./main and all thread counts reproduce the single-threaded "
+           "results\n");
+    return 0;
+}
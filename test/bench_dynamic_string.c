@@ -0,0 +1,237 @@
+/**
+ * @file bench_dynamic_string.c
+ * @author xcernoj00
+ * @brief DynamicString append microbenchmarks.
+ *
+ * Compares the current DynamicString with the former implementation
+ * (exact-size growth, strcat appends, always on the heap) kept below, on
+ * three append-heavy workloads:
+ *   - short identifiers built character by character and freed again,
+ *   - a long multiline string literal built character by character,
+ *   - a long text built from many C string appends (quadratic before).
+ * Both implementations must produce the same text.
+ *
+ * Usage: ./bench_dynamic_string [kilobytes]   (default 256)
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "dynamic_string.h"
+#include "error.h"
+#include "test_util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ---------------------------------------------------------------------- */
+/* Former implementation                                                   */
+/* ---------------------------------------------------------------------- */
+
+typedef struct {
+    char *str;
+    unsigned int length;
+    unsigned int max_length;
+} LegacyString;
+
+static int legacy_alloc(LegacyString *s) {
+    s->length = 0;
+    s->max_length = 8;
+    s->str = malloc(8);
+    if (!s->str)
+        exit(ERROR_INTERNAL);
+    s->str[0] = '\0';
+    return NO_ERROR;
+}
+
+static int legacy_add_char(LegacyString *s, char c) {
+    if (s->length + 1 >= s->max_length) {
+        unsigned int new_size = s->length * 2;
+        s->str = realloc(s->str, new_size);
+        if (!s->str)
+            return ERROR_INTERNAL;
+        s->max_length = new_size;
+    }
+    s->str[s->length++] = c;
+    s->str[s->length] = '\0';
+    return NO_ERROR;
+}
+
+static int legacy_add_str(LegacyString *s, const char *const_str) {
+    unsigned int const_str_length = (unsigned int)strlen(const_str);
+
+    if (s->length + const_str_length + 1 >= s->max_length) {
+        unsigned int new_size = s->length + const_str_length + 1;
+        s->str = realloc(s->str, new_size);
+        if (!s->str)
+            return ERROR_INTERNAL;
+        s->max_length = new_size;
+    }
+    s->length += const_str_length;
+    strcat(s->str, const_str);
+    s->str[s->length] = '\0';
+    return NO_ERROR;
+}
+
+/* ---------------------------------------------------------------------- */
+/* Workloads                                                               */
+/* ---------------------------------------------------------------------- */
+
+static int failures = 0;
+static volatile size_t sink; // keeps results alive
+
+static void report(const char *label, double t_legacy, double t_new) {
+    printf("%-22s legacy %8.2f ms, new %8.2f ms (%.1fx)\n", label,
+           t_legacy * 1e3, t_new * 1e3, t_legacy / t_new);
+}
+
+static void compare(const char *label, const char *expect, const char *got) {
+    if (strcmp(expect, got) != 0) {
+        printf("FAIL: %s: texts differ\n", label);
+        failures++;
+    }
+}
+
+static void bench_identifiers(void) {
+    static const char *words[] = {"x", "counter", "Ifj", "__global_total",
+                                  "value2", "a_rather_long_identifier_name"};
+    enum { WORDS = 6, ROUNDS = 2000000 };
+    size_t total = 0;
+
+    double t0 = now_seconds();
+    for (int i = 0; i < ROUNDS; i++) {
+        LegacyString s;
+        legacy_alloc(&s);
+        for (const char *p = words[i % WORDS]; *p; p++) {
+            legacy_add_char(&s, *p);
+        }
+        total += s.length;
+        free(s.str);
+    }
+    double t_legacy = now_seconds() - t0;
+
+    t0 = now_seconds();
+    for (int i = 0; i < ROUNDS; i++) {
+        DynamicString s;
+        d_string_alloc(&s);
+        for (const char *p = words[i % WORDS]; *p; p++) {
+            d_string_add_char(&s, *p);
+        }
+        total -= s.length;
+        d_string_free(&s);
+    }
+    double t_new = now_seconds() - t0;
+
+    if (total != 0) {
+        printf("FAIL: identifiers: lengths differ\n");
+        failures++;
+    }
+    report("identifiers", t_legacy, t_new);
+}
+
+static void bench_multiline(size_t bytes) {
+    static const char line[] = "    a line of a long multiline literal\n";
+    LegacyString legacy;
+    DynamicString s;
+
+    legacy_alloc(&legacy);
+    double t0 = now_seconds();
+    for (size_t i = 0; i < bytes; i++) {
+        legacy_add_char(&legacy, line[i % (sizeof(line) - 1)]);
+    }
+    double t_legacy = now_seconds() - t0;
+
+    d_string_alloc(&s);
+    t0 = now_seconds();
+    for (size_t i = 0; i < bytes; i++) {
+        d_string_add_char(&s, line[i % (sizeof(line) - 1)]);
+    }
+    double t_new = now_seconds() - t0;
+
+    compare("multiline", legacy.str, s.str);
+    sink = s.length;
+    report("multiline by char", t_legacy, t_new);
+    free(legacy.str);
+    d_string_free(&s);
+}
+
+static void bench_lines(size_t bytes) {
+    static const char line[] = "x = Ifj.concat(x, \"another piece\")\n";
+    size_t count = bytes / (sizeof(line) - 1);
+    LegacyString legacy;
+    DynamicString s;
+
+    legacy_alloc(&legacy);
+    double t0 = now_seconds();
+    for (size_t i = 0; i < count; i++) {
+        legacy_add_str(&legacy, line);
+    }
+    double t_legacy = now_seconds() - t0;
+
+    d_string_alloc(&s);
+    t0 = now_seconds();
+    for (size_t i = 0; i < count; i++) {
+        d_string_add_str(&s, line);
+    }
+    double t_new = now_seconds() - t0;
+
+    compare("lines", legacy.str, s.str);
+    sink = s.length;
+    report("lines by add_str", t_legacy, t_new);
+    free(legacy.str);
+    d_string_free(&s);
+}
+
+/**
+ * @brief Edge cases of the inline buffer and of reserve.
+ */
+static void test_edges(void) {
+    DynamicString a, b;
+    d_string_alloc(&a);
+    d_string_alloc(&b);
+
+    // Cross the inline size one character at a time
+    for (int i = 0; i < 3 * D_STRING_INLINE_SIZE; i++) {
+        d_string_add_char(&a, (char)('a' + i % 26));
+        if (a.length != (unsigned)i + 1 || a.str[a.length] != '\0' ||
+            a.str[i] != (char)('a' + i % 26)) {
+            printf("FAIL: add_char at length %d\n", i);
+            failures++;
+            break;
+        }
+    }
+    if (a.str == a.small) {
+        printf("FAIL: long string still inline\n");
+        failures++;
+    }
+    d_string_copy(&a, &b);
+    compare("copy", a.str, b.str);
+    d_string_clear(&b);
+    d_string_add_n(&b, "ab\0cd", 5); // embedded NUL is kept
+    if (b.length != 5 || memcmp(b.str, "ab\0cd", 6) != 0) {
+        printf("FAIL: add_n with embedded NUL\n");
+        failures++;
+    }
+    if (d_string_reserve(&b, 100000) != NO_ERROR || b.max_length <= 100000 ||
+        memcmp(b.str, "ab\0cd", 6) != 0) {
+        printf("FAIL: reserve\n");
+        failures++;
+    }
+    d_string_free(&a);
+    d_string_free(&a); // harmless
+    d_string_free(&b);
+}
+
+int main(int argc, char **argv) {
+    size_t kilobytes = argc > 1 ? (size_t)atol(argv[1]) : 256;
+
+    test_edges();
+    bench_identifiers();
+    bench_multiline(kilobytes * 1024 * 16);
+    bench_lines(kilobytes * 1024);
+    if (failures) {
+        printf("%d failure(s)\n", failures);
+        return 1;
+    }
+    printf("Both implementations build the same text\n");
+    return 0;
+}
@@ -0,0 +1,230 @@
+/**
+ * @file bench_expr_stack.c
+ * @author xcernoj00
+ * @brief Expression parser benchmark: shift/reduce against precedence
+ * climbing, on typical, very long and very deep expressions.
+ *
+ * Takes the right-hand sides of the assignments in an expression test
+ * program (test112_expression_stress_0.wren by default). The first program
+ * assigns them one by one, 200k times in all. The next ones join them, in
+ * parentheses, with + into expressions of growing length and assign such an
+ * expression 100 times. A last program nests one operand in thousands of
+ * parentheses, which keeps the whole expression on the precedence stack at
+ * once (and makes the climbing parser hand over to the shift/reduce one).
+ * Every program is parsed several times with each expression parser; the
+ * best run is reported as expressions per second and time per operand. The
+ * times include scanning and the rest of the parser.
+ *
+ * Usage: ./bench_expr_stack [program.wren]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "arena.h"
+#include "ast.h"
+#include "intern.h"
+#include "parser.h"
+#include "scanner.h"
+#include "test_util.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define STATEMENTS 100
+#define SHORT_STATEMENTS 200000
+#define RUNS 5
+#define MAX_EXPRESSIONS 1024
+
+static const char *prolog = "import \"ifj25\" for Ifj\n"
+                            "class Program {\n"
+                            "    static main() {\n"
+                            "        var x\n";
+static const char *epilog = "    }\n"
+                            "}\n";
+
+/**
+ * @brief Tells whether an expression calls a function, which is a statement
+ * of its own rather than an operand.
+ */
+static int is_call(const char *expression) {
+    for (const char *p = expression + 1; *p; p++) {
+        if (*p == '(' && (isalnum((unsigned char)p[-1]) || p[-1] == '_')) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Collects the right-hand sides of `name = expression` lines.
+ * @return Number of expressions stored in `expressions`.
+ */
+static size_t load_expressions(const char *path, char **expressions) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        perror(path);
+        return 0;
+    }
+    char line[4096];
+    size_t count = 0;
+    while (count < MAX_EXPRESSIONS && fgets(line, sizeof(line), file)) {
+        char *p = line;
+        while (isspace((unsigned char)*p)) {
+            p++;
+        }
+        char *name = p;
+        while (isalnum((unsigned char)*p) || *p == '_') {
+            p++;
+        }
+        if (p == name || strncmp(p, " = ", 3) != 0) {
+            continue;
+        }
+        p += 3;
+        p[strcspn(p, "\r\n")] = '\0';
+        if (*p != '\0' && !is_call(p) && strstr(p, "//") == NULL) {
+            expressions[count++] = strdup(p);
+        }
+    }
+    fclose(file);
+    return count;
+}
+
+/**
+ * @brief Parses `source` RUNS times with one expression parser; returns the
+ * best time or -1 on error.
+ */
+static double parse(const Text *source, ExprParserKind kind) {
+    double best = -1;
+    parser_set_expression_parser(kind);
+    for (int run = 0; run < RUNS; run++) {
+        Scanner scanner;
+        if (scanner_init_buffer(&scanner, source->data, source->length) !=
+            NO_ERROR) {
+            return -1;
+        }
+        ASTNode *program = create_ast_node(AST_PROGRAM, NULL);
+        double t0 = now_seconds();
+        int rc = program ? parser(&scanner, program) : ERROR_INTERNAL;
+        double seconds = now_seconds() - t0;
+        scanner_free(&scanner);
+        phase_arenas_free_all();
+        intern_free_all();
+        if (rc != NO_ERROR) {
+            printf("  parser returned %d\n", rc);
+            return -1;
+        }
+        if (best < 0 || seconds < best) {
+            best = seconds;
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief Times both expression parsers on a program of `expressions`
+ * expressions with `operands` operands in total.
+ */
+static void report(const char *name, const Text *source, size_t expressions,
+                   size_t operands) {
+    static const char *const parsers[] = {"precedence", "climbing"};
+    printf("  %s (%zu bytes)\n", name, source->length);
+    for (int kind = EXPR_PARSER_PRECEDENCE; kind <= EXPR_PARSER_CLIMBING;
+         kind++) {
+        double seconds = parse(source, (ExprParserKind)kind);
+        if (seconds < 0) {
+            printf("    %-10s failed\n", parsers[kind]);
+            continue;
+        }
+        printf("    %-10s %9.4f s %12.0f expressions/s %8.1f ns/operand\n",
+               parsers[kind], seconds, expressions / seconds,
+               seconds * 1e9 / operands);
+    }
+}
+
+/**
+ * @brief Counts the operands of an expression (one more than operators).
+ */
+static size_t count_operands(const char *expression) {
+    size_t operands = 1;
+    for (const char *p = expression; *p; p++) {
+        if (strchr("+-*/<>=!", *p) && p[1] == ' ') {
+            operands++;
+        } else if (p[0] == 'i' && p[1] == 's' && p[2] == ' ' && p > expression &&
+                   p[-1] == ' ') {
+            operands++;
+        }
+    }
+    return operands;
+}
+
+int main(int argc, char **argv) {
+    const char *path = argc > 1 ? argv[1]
+                                : "test/codes-OK/test112_expression_stress_0.wren";
+    char *expressions[MAX_EXPRESSIONS];
+    size_t count = load_expressions(path, expressions);
+    if (count == 0) {
+        fprintf(stderr, "no expressions in %s\n", path);
+        return 1;
+    }
+    printf("=== Expression parsers: %zu expressions of %s, best of %d ===\n",
+           count, path, RUNS);
+
+    // The expressions themselves, one per statement
+    Text source = {0};
+    size_t operands = 0;
+    append(&source, "%s", prolog);
+    for (size_t statement = 0; statement < SHORT_STATEMENTS; statement++) {
+        append(&source, "        x = ");
+        append(&source, "%s", expressions[statement % count]);
+        append(&source, "\n");
+        operands += count_operands(expressions[statement % count]);
+    }
+    append(&source, "%s", epilog);
+    report("one expression per statement", &source, SHORT_STATEMENTS,
+           operands);
+    free(source.data);
+
+    for (size_t length = 10; length <= 10000; length *= 10) {
+        source = (Text){0};
+        append(&source, "%s", prolog);
+        for (size_t statement = 0; statement < STATEMENTS; statement++) {
+            append(&source, "        x = ");
+            for (size_t i = 0; i < length; i++) {
+                append(&source, "%s", i ? " + (" : "(");
+                append(&source, "%s", expressions[(statement + i) % count]);
+                append(&source, ")");
+            }
+            append(&source, "\n");
+        }
+        append(&source, "%s", epilog);
+        char name[32];
+        snprintf(name, sizeof(name), "%zu joined", length);
+        report(name, &source, STATEMENTS, length * STATEMENTS);
+        free(source.data);
+    }
+
+    size_t depth = 10000;
+    source = (Text){0};
+    append(&source, "%s", prolog);
+    for (size_t statement = 0; statement < STATEMENTS; statement++) {
+        append(&source, "        x = ");
+        for (size_t i = 0; i < depth; i++) {
+            append(&source, "(1 + ");
+        }
+        append(&source, "%s", expressions[statement % count]);
+        for (size_t i = 0; i < depth; i++) {
+            append(&source, ")");
+        }
+        append(&source, "\n");
+    }
+    append(&source, "%s", epilog);
+    report("10k nested parentheses", &source, STATEMENTS,
+           (depth + 1) * STATEMENTS);
+    free(source.data);
+
+    for (size_t i = 0; i < count; i++) {
+        free(expressions[i]);
+    }
+    return 0;
+}
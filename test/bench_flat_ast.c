@@ -0,0 +1,365 @@
+/**
+ * @file bench_flat_ast.c
+ * @author xcernoj00
+ * @brief Pointer AST against the flat AST pool (ast_pool.h): memory and
+ * traversal time.
+ *
+ * Generates a program of about a million AST nodes (functions with
+ * assignments, calls, ifs and whiles, getters and setters), parses it and
+ * builds its pool. Prints the bytes of both forms and the best of several
+ * full traversals of each: a walk of the pointer tree with an explicit
+ * stack, the same walk over ids, and a linear scan of the pool columns.
+ * All three must see the same nodes (the pointer walk skipping the wrapper
+ * nodes the pool folds away).
+ *
+ * Given .wren files instead, parses and analyzes each one and checks the
+ * pool of every program that compiles in the same way.
+ *
+ * Usage: ./bench_flat_ast [functions | program.wren...]
+ *        (default: 25000 functions)
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "arena.h"
+#include "ast.h"
+#include "ast_pool.h"
+#include "intern.h"
+#include "parser.h"
+#include "scanner.h"
+#include "semantic.h"
+#include "test_util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RUNS 5
+
+static const char *prolog = "import \"ifj25\" for Ifj\n"
+                            "class Program {\n"
+                            "    static main() {\n"
+                            "        var r\n"
+                            "        r = f0(1, 2)\n"
+                            "        Ifj.write(r)\n"
+                            "    }\n";
+
+static const char *function_format =
+    "    static f%zu(a, b) {\n"
+    "        var x\n"
+    "        x = (a + b) * 3 - a / 2\n"
+    "        if (x > 10) {\n"
+    "            x = Ifj.write(x)\n"
+    "        } else {\n"
+    "            while (x < 100) {\n"
+    "                x = x * 2\n"
+    "            }\n"
+    "        }\n"
+    "        g%zu = x\n"
+    "        x = g%zu\n"
+    "        return x\n"
+    "    }\n"
+    "    static g%zu {\n"
+    "        return 1\n"
+    "    }\n"
+    "    static g%zu=(value) {\n"
+    "        var y\n"
+    "        y = value\n"
+    "    }\n";
+
+/**
+ * @brief What a traversal saw: nodes of each kind and a sum over the
+ * fields it read.
+ */
+typedef struct {
+    size_t kinds[AST_LAZY_BODY + 1];
+    size_t nodes;
+    size_t named;
+    size_t sum;
+} Census;
+
+static void census_add(Census *census, ASTNodeType kind, DataType type,
+                       int named) {
+    census->kinds[kind]++;
+    census->nodes++;
+    census->named += named != 0;
+    census->sum += (size_t)kind * 31 + (size_t)type;
+}
+
+static int is_wrapper(ASTNodeType kind) {
+    return kind == AST_FUNC_ARG || kind == AST_EQUALS || kind == AST_ELSE;
+}
+
+/**
+ * @brief Explicit stack of pointers or ids for the walks.
+ */
+typedef struct {
+    void **items;
+    size_t count;
+    size_t capacity;
+} Stack;
+
+static void push(Stack *stack, void *item) {
+    if (stack->count == stack->capacity) {
+        stack->capacity = stack->capacity ? stack->capacity * 2 : 1024;
+        stack->items = realloc(stack->items, stack->capacity * sizeof(void *));
+        if (!stack->items) {
+            abort();
+        }
+    }
+    stack->items[stack->count++] = item;
+}
+
+/**
+ * @brief Visits every node of the pointer tree; counts all but wrappers.
+ * @return Nodes visited, wrappers included.
+ */
+static size_t walk_pointers(ASTNode *program, Stack *stack, Census *census) {
+    size_t visited = 0;
+    stack->count = 0;
+    push(stack, program);
+    while (stack->count > 0) {
+        ASTNode *node = stack->items[--stack->count];
+        visited++;
+        if (!is_wrapper(node->type)) {
+            census_add(census, node->type, node->data_type,
+                       node->name != NULL);
+        }
+        if (node->right) {
+            push(stack, node->right);
+        }
+        if (node->left) {
+            push(stack, node->left);
+        }
+    }
+    return visited;
+}
+
+/**
+ * @brief Tells whether the first two slots of a kind hold a list.
+ */
+static int has_list(ASTNodeType kind) {
+    switch (kind) {
+    case AST_PROGRAM:
+    case AST_MAIN_DEF:
+    case AST_FUNC_DEF:
+    case AST_SETTER_DEF:
+    case AST_BLOCK:
+    case AST_FUNC_CALL:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+/**
+ * @brief Visits the pool depth first, from the root, through the child
+ * slots and lists.
+ */
+static void walk_pool(const AstPool *pool, Stack *stack, Census *census) {
+    stack->count = 0;
+    push(stack, (void *)(uintptr_t)AST_POOL_ROOT);
+    while (stack->count > 0) {
+        AstId id = (AstId)(uintptr_t)stack->items[--stack->count];
+        ASTNodeType kind = ast_pool_kind(pool, id);
+        census_add(census, kind, ast_pool_type(pool, id), pool->names[id]);
+        if (kind != AST_EXPRESSION && ast_pool_child(pool, id, 2)) {
+            push(stack, (void *)(uintptr_t)ast_pool_child(pool, id, 2));
+        }
+        if (has_list(kind)) {
+            AstId first;
+            size_t count = ast_pool_list(pool, id, &first);
+            for (size_t i = count; i > 0; i--) {
+                push(stack, (void *)(uintptr_t)(first + i - 1));
+            }
+            continue;
+        }
+        for (unsigned slot = 2; slot-- > 0;) {
+            if (ast_pool_child(pool, id, slot)) {
+                push(stack, (void *)(uintptr_t)ast_pool_child(pool, id, slot));
+            }
+        }
+    }
+}
+
+/**
+ * @brief Reads every node of the pool in id order.
+ */
+static void scan_pool(const AstPool *pool, Census *census) {
+    for (AstId id = AST_POOL_ROOT; id < pool->count; id++) {
+        census_add(census, ast_pool_kind(pool, id), ast_pool_type(pool, id),
+                   pool->names[id]);
+    }
+}
+
+static int same_census(const Census *a, const Census *b) {
+    return memcmp(a, b, sizeof(Census)) == 0;
+}
+
+/**
+ * @brief Builds the pool of a program and checks that the pool walk, the
+ * pool scan and the pointer walk agree.
+ * @return 1 when they do.
+ */
+static int check_pool(ASTNode *program, AstPool *pool, Stack *stack) {
+    if (ast_pool_build(pool, program) != NO_ERROR) {
+        return 0;
+    }
+    Census pointers = {0}, walked = {0}, scanned = {0};
+    walk_pointers(program, stack, &pointers);
+    walk_pool(pool, stack, &walked);
+    scan_pool(pool, &scanned);
+    if (!same_census(&pointers, &walked) || !same_census(&pointers, &scanned)) {
+        return 0;
+    }
+    // Every id must lead back to a node of its own kind
+    for (AstId id = AST_POOL_ROOT; id < pool->count; id++) {
+        if (ast_pool_node(pool, id)->type != ast_pool_kind(pool, id)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief Checks the pools of the programs of the corpus that compile.
+ */
+static int check_files(int count, char **paths) {
+    Stack stack = {0};
+    int checked = 0, failed = 0;
+    for (int i = 0; i < count; i++) {
+        size_t length;
+        char *data = read_file(paths[i], &length);
+        Scanner scanner;
+        if (!data ||
+            scanner_init_buffer(&scanner, data, length) != NO_ERROR) {
+            free(data);
+            continue;
+        }
+        ASTNode *program = create_ast_node(AST_PROGRAM, NULL);
+        int rc = program ? parser(&scanner, program) : ERROR_INTERNAL;
+        if (rc == NO_ERROR) {
+            rc = semantic_analyze(program);
+        }
+        if (rc == NO_ERROR) {
+            AstPool pool;
+            checked++;
+            if (!check_pool(program, &pool, &stack)) {
+                printf("  FAIL: %s\n", paths[i]);
+                failed++;
+            }
+            ast_pool_free(&pool);
+        }
+        scanner_free(&scanner);
+        phase_arenas_free_all();
+        intern_free_all();
+        free(data);
+    }
+    printf("  %d programs checked, %d failed\n", checked, failed);
+    free(stack.items);
+    return failed == 0 ? 0 : 1;
+}
+
+static char *generate(size_t functions, size_t *length) {
+    size_t capacity = 4096 + functions * 512;
+    char *source = malloc(capacity);
+    if (!source) {
+        abort();
+    }
+    size_t n = (size_t)snprintf(source, capacity, "%s", prolog);
+    for (size_t i = 0; i < functions; i++) {
+        n += (size_t)snprintf(source + n, capacity - n, function_format, i, i,
+                              i, i, i);
+    }
+    n += (size_t)snprintf(source + n, capacity - n, "}\n");
+    *length = n;
+    return source;
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1 && strstr(argv[1], ".wren") != NULL) {
+        printf("=== Flat AST pool of %d programs ===\n", argc - 1);
+        return check_files(argc - 1, argv + 1);
+    }
+    size_t functions = argc > 1 ? (size_t)atol(argv[1]) : 25000;
+    size_t length;
+    char *source = generate(functions, &length);
+
+    Scanner scanner;
+    if (scanner_init_buffer(&scanner, source, length) != NO_ERROR) {
+        return 1;
+    }
+    ASTNode *program = create_ast_node(AST_PROGRAM, NULL);
+    int rc = program ? parser(&scanner, program) : ERROR_INTERNAL;
+    if (rc != NO_ERROR) {
+        printf("parser returned %d\n", rc);
+        return 1;
+    }
+
+    Stack stack = {0};
+    Census census = {0};
+    size_t nodes = walk_pointers(program, &stack, &census);
+    printf("=== Flat AST pool: %zu functions, %zu bytes, %zu nodes ===\n",
+           functions, length, nodes);
+
+    AstPool pool;
+    double build = -1;
+    for (int run = 0; run < RUNS; run++) {
+        double t0 = now_seconds();
+        rc = ast_pool_build(&pool, program);
+        double seconds = now_seconds() - t0;
+        if (rc != NO_ERROR) {
+            printf("ast_pool_build returned %d\n", rc);
+            return 1;
+        }
+        if (build < 0 || seconds < build) {
+            build = seconds;
+        }
+        ast_pool_free(&pool);
+    }
+    int ok = check_pool(program, &pool, &stack);
+
+    printf("  pointer tree    %10zu nodes %12zu bytes\n", nodes,
+           nodes * sizeof(ASTNode));
+    printf("  pool            %10zu ids   %12zu bytes (%zu with origin)\n",
+           pool.count - 1, ast_pool_bytes(&pool, false),
+           ast_pool_bytes(&pool, true));
+    printf("  pool build      %9.4f s\n", build);
+
+    double best[3] = {-1, -1, -1};
+    size_t sums[3] = {0};
+    for (int run = 0; run < RUNS; run++) {
+        for (int walk = 0; walk < 3; walk++) {
+            Census seen = {0};
+            double t0 = now_seconds();
+            if (walk == 0) {
+                walk_pointers(program, &stack, &seen);
+            } else if (walk == 1) {
+                walk_pool(&pool, &stack, &seen);
+            } else {
+                scan_pool(&pool, &seen);
+            }
+            double seconds = now_seconds() - t0;
+            sums[walk] = seen.sum;
+            if (best[walk] < 0 || seconds < best[walk]) {
+                best[walk] = seconds;
+            }
+        }
+    }
+    static const char *const walks[] = {"pointer walk", "pool walk",
+                                        "pool scan"};
+    for (int walk = 0; walk < 3; walk++) {
+        printf("  %-15s %9.4f s %8.2f ns/node\n", walks[walk], best[walk],
+               best[walk] * 1e9 / census.nodes);
+    }
+    ok = ok && sums[0] == sums[1] && sums[0] == sums[2];
+    printf("%s: pointer tree and pool hold the same %zu nodes\n",
+           ok ? "PASS" : "FAIL", census.nodes);
+
+    ast_pool_free(&pool);
+    free(stack.items);
+    scanner_free(&scanner);
+    phase_arenas_free_all();
+    intern_free_all();
+    free(source);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,119 @@
+/**
+ * @file bench_keyword.c
+ * @author xcernoj00
+ * @brief Keyword classification microbenchmark.
+ *
+ * Classifies a keyword-heavy and an identifier-heavy word list with the
+ * former sequential compare chain and with keyword_lookup(), checks that
+ * both agree on every word and reports the time per word.
+ *
+ * Usage: ./bench_keyword [rounds]   (default 2000000)
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "scanner.h"
+#include "test_util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *keywords[] = {
+    "class",  "if",     "else",   "is",  "null", "return", "var",  "while",
+    "Ifj",    "static", "import", "for", "Num",  "String", "Null",
+};
+#define KEYWORD_COUNT (sizeof(keywords) / sizeof(keywords[0]))
+
+static const char *keyword_heavy[] = {
+    "var", "if", "else", "return", "while", "static", "null", "is",
+    "var", "Num", "String", "Null", "class", "import", "for", "Ifj",
+    "result", "var", "if", "return",
+};
+
+static const char *identifier_heavy[] = {
+    "result", "counter", "i",      "value", "x",     "index",  "total",
+    "temp",   "str",     "length", "nil",   "nums",  "Strings", "classy",
+    "iff",    "vars",    "main",   "a",     "while", "sum",
+};
+
+#define LIST_LENGTH(list) (sizeof(list) / sizeof(list[0]))
+
+/**
+ * @brief The compare chain check_keyword used before keyword_lookup.
+ */
+static bool chain_lookup(const char *word, size_t length, Keyword *keyword) {
+    for (size_t i = 0; i < KEYWORD_COUNT; i++) {
+        if (strlen(keywords[i]) == length &&
+            memcmp(word, keywords[i], length) == 0) {
+            *keyword = (Keyword)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+typedef bool (*LookupFn)(const char *, size_t, Keyword *);
+
+static double run(LookupFn lookup, const char **words, size_t *lengths,
+                  size_t count, long rounds, long *hits) {
+    Keyword keyword;
+    double t0 = now_seconds();
+    *hits = 0;
+    for (long r = 0; r < rounds; r++) {
+        for (size_t i = 0; i < count; i++) {
+            if (lookup(words[i], lengths[i], &keyword)) {
+                *hits += keyword + 1;
+            }
+        }
+    }
+    return now_seconds() - t0;
+}
+
+static int bench_list(const char *label, const char **words, size_t count,
+                      long rounds) {
+    size_t lengths[64];
+    Keyword a, b;
+
+    for (size_t i = 0; i < count; i++) {
+        lengths[i] = strlen(words[i]);
+        bool found_a = chain_lookup(words[i], lengths[i], &a);
+        bool found_b = keyword_lookup(words[i], lengths[i], &b);
+        if (found_a != found_b || (found_a && a != b)) {
+            printf("FAIL: '%s' classified differently\n", words[i]);
+            return 1;
+        }
+    }
+
+    long hits_chain, hits_lookup;
+    double t_chain = run(chain_lookup, words, lengths, count, rounds,
+                         &hits_chain);
+    double t_lookup = run(keyword_lookup, words, lengths, count, rounds,
+                          &hits_lookup);
+    double words_total = (double)rounds * count;
+
+    printf("%s:\n", label);
+    printf("  compare chain:  %.2f ns/word\n", t_chain / words_total * 1e9);
+    printf("  keyword_lookup: %.2f ns/word (%.2fx)\n",
+           t_lookup / words_total * 1e9, t_chain / t_lookup);
+    return hits_chain != hits_lookup;
+}
+
+int main(int argc, char **argv) {
+    long rounds = argc > 1 ? atol(argv[1]) : 2000000;
+
+    // Every keyword must map to its own enum value
+    for (size_t i = 0; i < KEYWORD_COUNT; i++) {
+        Keyword keyword;
+        if (!keyword_lookup(keywords[i], strlen(keywords[i]), &keyword) ||
+            keyword != (Keyword)i) {
+            printf("FAIL: keyword '%s' not recognized\n", keywords[i]);
+            return 1;
+        }
+    }
+
+    int result = bench_list("keyword-heavy", keyword_heavy,
+                            LIST_LENGTH(keyword_heavy), rounds);
+    result |= bench_list("identifier-heavy", identifier_heavy,
+                         LIST_LENGTH(identifier_heavy), rounds);
+    return result;
+}
@@ -0,0 +1,225 @@
+/**
+ * @file bench_parallel_parse.c
+ * @author xcernoj00
+ * @brief Sequential vs. parallel parsing of function definitions.
+ *
+ * Generates programs with thousands of definitions (functions, getters and
+ * setters, with braces and `static` hidden in strings and comments) and
+ * parses each with parser() and with parser_parallel() on 2, 4, ... up to
+ * N threads, each time with a fresh intern table. Every parallel AST must
+ * be identical to the sequential one, down to the intern ids of its names.
+ * Then a smaller program is broken at many places (lexical and syntax
+ * errors, unbalanced braces) and the parallel parser must return the same
+ * error code as the sequential one for every variant.
+ *
+ * Usage: ./bench_parallel_parse [-j N] [definitions]
+ *        (default N: number of processors, at least 4; definitions: 4000)
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "arena.h"
+#include "ast.h"
+#include "expr_ast.h"
+#include "intern.h"
+#include "parser.h"
+#include "scanner.h"
+#include "test_util.h"
+#include "work_pool.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *prolog = "import \"ifj25\" for Ifj\n"
+                            "class Program {\n"
+                            "    static main() {\n"
+                            "        var r\n"
+                            "        r = f0(1, 2)\n"
+                            "    }\n";
+
+static const char *function_format =
+    "    // f%zu: static { in a comment\n"
+    "    static f%zu(a, b) {\n"
+    "        var x\n"
+    "        x = (a + b) * 3 - a / 2\n"
+    "        if (x > 10) {\n"
+    "            x = Ifj.write(\"} static {\\\"\")\n"
+    "        } else {\n"
+    "            x = x + 1\n"
+    "        }\n"
+    "        while (x < 100) {\n"
+    "            x = x * 2 /* static } /* nested { */ */\n"
+    "        }\n"
+    "        return x\n"
+    "    }\n";
+
+static const char *getter_format = "    static g%zu {\n"
+                                   "        return \"\"\"static {\n"
+                                   "        \"\"\"\n"
+                                   "    }\n";
+
+static const char *setter_format = "    static g%zu=(value) {\n"
+                                   "        var y\n"
+                                   "        y = value\n"
+                                   "    }\n";
+
+static int failures = 0;
+
+/**
+ * @brief Generate a program with `definitions` definitions after main.
+ */
+static char *generate(size_t definitions, size_t *length) {
+    size_t capacity = 4096 + definitions * 512;
+    char *data = malloc(capacity);
+    if (!data) {
+        return NULL;
+    }
+    size_t used = (size_t)sprintf(data, "%s", prolog);
+    for (size_t i = 0; i < definitions; i++) {
+        if (i % 8 == 3) {
+            used += (size_t)sprintf(data + used, getter_format, i);
+        } else if (i % 8 == 4) {
+            used += (size_t)sprintf(data + used, setter_format, i - 1);
+        } else {
+            used += (size_t)sprintf(data + used, function_format, i, i);
+        }
+    }
+    used += (size_t)sprintf(data + used, "}\n");
+    *length = used;
+    return data;
+}
+
+/**
+ * @brief Parse with a fresh intern table; the AST is returned serialized.
+ */
+static int parse(const char *data, size_t length, unsigned threads,
+                 Text *text, double *seconds) {
+    Scanner scanner;
+    double t0 = now_seconds();
+    if (scanner_init_buffer(&scanner, data, length) != NO_ERROR) {
+        return ERROR_INTERNAL;
+    }
+    ASTNode *program = create_ast_node(AST_PROGRAM, NULL);
+    int rc = parser_parallel(&scanner, program, threads);
+    scanner_free(&scanner);
+    if (seconds) {
+        *seconds = now_seconds() - t0;
+    }
+    text->length = 0;
+    append(text, "%d", rc);
+    if (rc == NO_ERROR) {
+        serialize(text, program);
+    }
+    phase_arenas_free_all();
+    intern_free_all();
+    return rc;
+}
+
+static bool same_text(const Text *a, const Text *b) {
+    return a->length == b->length && memcmp(a->data, b->data, a->length) == 0;
+}
+
+static void bench(size_t definitions, unsigned max_threads) {
+    size_t length;
+    char *data = generate(definitions, &length);
+    if (!data) {
+        printf("FAIL: out of memory\n");
+        failures++;
+        return;
+    }
+
+    Text reference = {0}, text = {0};
+    double t_one;
+    int rc = parse(data, length, 1, &reference, &t_one);
+    printf("%zu definitions (%zu bytes):\n", definitions, length);
+    printf("  sequential:  %8.3f s\n", t_one);
+    if (rc != NO_ERROR) {
+        printf("FAIL: sequential parse returned %d\n", rc);
+        failures++;
+    }
+
+    for (unsigned threads = 2; threads <= max_threads; threads *= 2) {
+        double elapsed;
+        parse(data, length, threads, &text, &elapsed);
+        printf("  %3u threads: %8.3f s (%.2fx)\n", threads, elapsed,
+               t_one / elapsed);
+        if (!same_text(&reference, &text)) {
+            printf("FAIL: AST differs on %u threads\n", threads);
+            failures++;
+        }
+    }
+    free(reference.data);
+    free(text.data);
+    free(data);
+}
+
+/**
+ * @brief Break the program at many places and compare the results.
+ */
+static void errors(unsigned threads) {
+    static const char *breaks[] = {"@", "}", "{", "\"", "/*", "static",
+                                   "(", "\n}\n"};
+    size_t length;
+    char *data = generate(200, &length);
+    char *broken = malloc(length + 16);
+    if (!data || !broken) {
+        printf("FAIL: out of memory\n");
+        failures++;
+        free(data);
+        free(broken);
+        return;
+    }
+
+    Text reference = {0}, text = {0};
+    size_t variants = 0;
+    for (size_t offset = 0; offset < length; offset += 97) {
+        for (size_t b = 0; b < sizeof(breaks) / sizeof(breaks[0]); b++) {
+            size_t n = strlen(breaks[b]);
+            memcpy(broken, data, offset);
+            memcpy(broken + offset, breaks[b], n);
+            memcpy(broken + offset + n, data + offset, length - offset);
+
+            int expected = parse(broken, length + n, 1, &reference, NULL);
+            int rc = parse(broken, length + n, threads, &text, NULL);
+            if (!same_text(&reference, &text)) {
+                printf("FAIL: \"%s\" at %zu: %d instead of %d\n", breaks[b],
+                       offset, rc, expected);
+                failures++;
+            }
+            variants++;
+        }
+    }
+    printf("%zu broken programs give the same result on %u threads\n",
+           variants, threads);
+    free(reference.data);
+    free(text.data);
+    free(data);
+    free(broken);
+}
+
+int main(int argc, char **argv) {
+    unsigned max_threads = work_pool_cpu_count();
+    size_t definitions = 4000;
+    if (max_threads < 4) {
+        max_threads = 4;
+    }
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            max_threads = (unsigned)atoi(argv[++i]);
+        } else {
+            definitions = (size_t)atol(argv[i]);
+        }
+    }
+    printf("%u processor(s)\n", work_pool_cpu_count());
+
+    bench(definitions / 4, max_threads);
+    bench(definitions, max_threads);
+    errors(max_threads);
+    if (failures) {
+        printf("%d failure(s)\n", failures);
+        return 1;
+    }
+    printf("All thread counts reproduce the sequential parser\n");
+    return 0;
+}
@@ -0,0 +1,285 @@
+/**
+ * @file bench_relex.c
+ * @author xcernoj00
+ * @brief Incremental re-lexing check and benchmark.
+ *
+ * 1. Random edits full of quotes, comment marks and newlines are applied
+ *    to a small program with scanner_relex; after every edit the token
+ *    array must equal a full scan of the edited text, and the tokens
+ *    outside the reported change must be the old ones.
+ * 2. Typing-like edits of identifiers and blanks are applied to a large
+ *    program (a .wren file given on the command line, or a generated 10 MB one)
+ *    and the time per edit is compared with lexing the whole file again.
+ *
+ * Usage: ./bench_relex [file.wren]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "intern.h"
+#include "scanner.h"
+#include "test_util.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *function_format =
+    "    static f%zu(a, b) {\n"
+    "        var x\n"
+    "        x = (a + b) * 3 - a / 2 // scale\n"
+    "        if (x > 10) {\n"
+    "            x = Ifj.write(\"big \\n value\")\n"
+    "        } else {\n"
+    "            /* small /* nested */ values */\n"
+    "            x = \"\"\"multi\n  line\"\"\"\n"
+    "        }\n"
+    "        return x\n"
+    "    }\n";
+
+static int failures = 0;
+
+/**
+ * @brief Generate a program of at least `target` bytes.
+ */
+static char *generate(size_t target, size_t *length) {
+    size_t capacity = target + 4096;
+    char *data = malloc(capacity);
+    if (!data) {
+        return NULL;
+    }
+    size_t used = (size_t)sprintf(data, "import \"ifj25\" for Ifj\n"
+                                        "class Program {\n");
+    for (size_t i = 0; used < target; i++) {
+        if (capacity - used < 1024) {
+            capacity *= 2;
+            char *grown = realloc(data, capacity);
+            if (!grown) {
+                free(data);
+                return NULL;
+            }
+            data = grown;
+        }
+        used += (size_t)sprintf(data + used, function_format, i);
+    }
+    used += (size_t)sprintf(data + used, "}\n");
+    *length = used;
+    return data;
+}
+
+/**
+ * @brief Compare token `i` of `a` with token `j` of `b`, where
+ *        `a` start + `shift_old` corresponds to `b` start + `shift_new`.
+ */
+static bool same_token(const TokenArray *a, size_t i, const TokenArray *b,
+                       size_t j, size_t shift_old, size_t shift_new) {
+    if (a->types[i] != b->types[j] ||
+        a->spans[i].start + shift_old != b->spans[j].start + shift_new ||
+        a->spans[i].length != b->spans[j].length) {
+        return false;
+    }
+    switch ((TokenType)a->types[i]) {
+    case TOKEN_IDENTIFIER:
+    case TOKEN_GLOBAL_VAR:
+        return a->values[i].name == b->values[j].name;
+    case TOKEN_INTEGER:
+        return a->values[i].integer == b->values[j].integer;
+    case TOKEN_DOUBLE:
+        return memcmp(&a->values[i].decimal, &b->values[j].decimal,
+                      sizeof(double)) == 0;
+    case TOKEN_KEYWORD:
+        return a->values[i].keyword == b->values[j].keyword;
+    case TOKEN_STRING:
+        return a->values[i].string.quotes == b->values[j].string.quotes &&
+               a->values[i].string.flags == b->values[j].string.flags;
+    default:
+        return true;
+    }
+}
+
+/**
+ * @brief Copy of a token array, to check which tokens an edit kept.
+ */
+static TokenArray copy_array(const TokenArray *array) {
+    TokenArray copy = *array;
+    copy.types = malloc(array->count + 1);
+    copy.values = malloc((array->count + 1) * sizeof(PackedTokenValue));
+    copy.spans = malloc((array->count + 1) * sizeof(TokenSpan));
+    memcpy(copy.types, array->types, array->count);
+    memcpy(copy.values, array->values,
+           array->count * sizeof(PackedTokenValue));
+    memcpy(copy.spans, array->spans, array->count * sizeof(TokenSpan));
+    return copy;
+}
+
+static void free_array(TokenArray *array) {
+    free(array->types);
+    free(array->values);
+    free(array->spans);
+}
+
+/**
+ * @brief Random edit anywhere, likely to open or close strings and comments.
+ */
+static void random_edit(SourceEdit *edit, size_t length) {
+    static const char *texts[] = {
+        "\"", "\"\"\"", "/*", "*/", "//", "\n", "\n\n", " ", "x", "Ifj", ".",
+        "12", "1.5e3", "-", "\\", "\\n", "#", "{", "}", "var y = 2\n", "",
+    };
+    const char *text = texts[rand() % (sizeof(texts) / sizeof(texts[0]))];
+
+    edit->offset = length ? (size_t)rand() % (length + 1) : 0;
+    edit->removed = (size_t)rand() % 4;
+    if (edit->removed > length - edit->offset) {
+        edit->removed = length - edit->offset;
+    }
+    edit->inserted = text;
+    edit->inserted_length = strlen(text);
+}
+
+/**
+ * @brief Typing-like edit: a letter added to or removed from the end of an
+ *        identifier, or a blank inserted in front of a token.
+ */
+static void typing_edit(SourceEdit *edit, const TokenArray *array) {
+    size_t i = (size_t)rand() % array->count;
+    const TokenSpan *span = &array->spans[i];
+
+    edit->inserted = "q";
+    edit->inserted_length = 1;
+    edit->removed = 0;
+    if (array->types[i] != TOKEN_IDENTIFIER) {
+        edit->offset = span->start;
+        edit->inserted = " ";
+    } else if (span->length > 1 && rand() % 2) {
+        edit->offset = span->start + span->length - 1;
+        edit->removed = 1;
+        edit->inserted_length = 0;
+    } else {
+        edit->offset = span->start + span->length;
+    }
+}
+
+/**
+ * @brief Apply random edits to a small program and compare every result
+ *        with a full scan.
+ */
+static void test_edits(void) {
+    size_t length;
+    char *data = generate(4000, &length);
+    Scanner scanner;
+    TokenChange change;
+
+    scanner_init_buffer(&scanner, data, length);
+    scanner_tokenize_all(&scanner);
+    srand(99);
+    for (int round = 0; round < 20000 && failures < 5; round++) {
+        SourceEdit edit;
+        if (rand() % 4 || scanner.buffered.count == 0) {
+            random_edit(&edit, scanner.source.length);
+        } else {
+            typing_edit(&edit, &scanner.buffered);
+        }
+        TokenArray before = copy_array(&scanner.buffered);
+        if (scanner_relex(&scanner, &edit, &change) != NO_ERROR) {
+            printf("FAIL: edit %d rejected\n", round);
+            failures++;
+            free_array(&before);
+            break;
+        }
+
+        // The same text lexed from scratch
+        Scanner full;
+        scanner_init_buffer(&full, scanner.source.data, scanner.source.length);
+        scanner_tokenize_all(&full);
+        const TokenArray *got = &scanner.buffered;
+        const TokenArray *expect = &full.buffered;
+        bool same = got->count == expect->count &&
+                    got->status == expect->status;
+        for (size_t i = 0; same && i < got->count; i++) {
+            same = same_token(got, i, expect, i, 0, 0);
+        }
+        if (!same) {
+            printf("FAIL: edit %d: relexed tokens differ from a full scan\n",
+                   round);
+            failures++;
+        }
+
+        // Tokens outside the change are the old ones
+        bool kept = change.first + change.removed <= before.count &&
+                    got->count - change.inserted ==
+                        before.count - change.removed;
+        for (size_t i = 0; kept && i < change.first; i++) {
+            kept = same_token(got, i, &before, i, 0, 0);
+        }
+        for (size_t i = change.first + change.removed; kept && i < before.count;
+             i++) {
+            size_t j = i - change.removed + change.inserted;
+            kept = same_token(got, j, &before, i, edit.removed,
+                              edit.inserted_length);
+        }
+        if (!kept) {
+            printf("FAIL: edit %d: tokens outside the change moved\n", round);
+            failures++;
+        }
+        scanner_free(&full);
+        free_array(&before);
+    }
+    scanner_free(&scanner);
+    free(data);
+}
+
+static int bench(char *data, size_t length) {
+    Scanner scanner;
+    TokenChange change;
+    enum { EDITS = 2000 };
+
+    double t0 = now_seconds();
+    scanner_init_buffer(&scanner, data, length);
+    scanner_tokenize_all(&scanner);
+    double t_full = now_seconds() - t0;
+    size_t tokens = scanner.buffered.count;
+
+    size_t relexed = 0;
+    srand(5);
+    t0 = now_seconds();
+    for (int i = 0; i < EDITS; i++) {
+        SourceEdit edit;
+        typing_edit(&edit, &scanner.buffered);
+        if (scanner_relex(&scanner, &edit, &change) != NO_ERROR) {
+            printf("FAIL: edit %d rejected\n", i);
+            scanner_free(&scanner);
+            return 1;
+        }
+        relexed += change.inserted;
+    }
+    double t_relex = (now_seconds() - t0) / EDITS;
+    scanner_free(&scanner);
+
+    printf("%zu bytes, %zu tokens:\n", length, tokens);
+    printf("  full scan:  %.3f ms\n", t_full * 1e3);
+    printf("  relex/edit: %.3f ms (%.0fx), %.1f changed tokens on average\n",
+           t_relex * 1e3, t_full / t_relex, (double)relexed / EDITS);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    size_t length;
+    char *data = argc > 1 ? read_file(argv[1], &length)
+                          : generate(10 * 1024 * 1024, &length);
+    if (!data) {
+        printf("FAIL: cannot load the input\n");
+        return 1;
+    }
+
+    test_edits();
+    int result = bench(data, length);
+    free(data);
+    intern_free_all();
+    if (failures) {
+        printf("%d failure(s)\n", failures);
+        return 1;
+    }
+    printf("Relexed token arrays match full scans\n");
+    return result;
+}
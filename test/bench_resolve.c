@@ -0,0 +1,123 @@
+/**
+ * @file bench_resolve.c
+ * @author xcernoj00
+ * @brief Benchmark of variable resolution in deeply nested blocks.
+ *
+ * Generates main() with `depth` nested blocks, alternately while loops and
+ * if statements. Every block declares `locals` variables and assigns each
+ * of them from the outermost block's variable and the enclosing block's
+ * one, so references reach both ends of a long scope chain. Semantic
+ * analysis resolves each reference once; code generation then only reads
+ * the depth of the resolved scope. Prints the time of each phase (best of
+ * several runs).
+ *
+ * Usage: ./bench_resolve [depth] [locals]
+ *        (default depth: 2000; locals: 8)
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "arena.h"
+#include "ast.h"
+#include "error.h"
+#include "generator.h"
+#include "intern.h"
+#include "parser.h"
+#include "scanner.h"
+#include "semantic.h"
+#include "test_util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RUNS 3
+
+/**
+ * @brief main() with `depth` nested while/if blocks of `locals` variables.
+ */
+static Text generate(size_t depth, size_t locals) {
+    Text source = {NULL, 0, 0};
+    append(&source, "import \"ifj25\" for Ifj\n"
+                    "class Program {\n"
+                    "    static main() {\n");
+    for (size_t k = 0; k < depth; k++) {
+        for (size_t j = 0; j < locals; j++) {
+            append(&source, "var v%zu_%zu\n", k, j);
+        }
+        for (size_t j = 0; j < locals; j++) {
+            if (k == 0) {
+                append(&source, "v0_%zu = %zu\n", j, j);
+            } else {
+                append(&source, "v%zu_%zu = v0_%zu + v%zu_%zu\n", k, j, j,
+                       k - 1, j);
+            }
+        }
+        if (k % 2 == 0) {
+            append(&source, "while (v%zu_0 < 1) {\n", k);
+        } else {
+            append(&source, "if (v%zu_0) {\n", k);
+        }
+    }
+    for (size_t k = depth; k-- > 0;) {
+        append(&source, k % 2 == 0 ? "}\n" : "} else {\n}\n");
+    }
+    append(&source, "    }\n}\n");
+    return source;
+}
+
+int main(int argc, char **argv) {
+    size_t depth = argc > 1 ? (size_t)atol(argv[1]) : 2000;
+    size_t locals = argc > 2 ? (size_t)atol(argv[2]) : 8;
+    if (locals < 1) {
+        locals = 1;
+    }
+    Text source = generate(depth, locals);
+    FILE *sink = fopen("/dev/null", "w");
+    if (!sink) {
+        return 1;
+    }
+
+    printf("=== Resolution: %zu nested blocks, %zu locals each, "
+           "%zu references ===\n",
+           depth, locals, depth * locals * 3);
+    double best[3] = {-1, -1, -1};
+    for (int run = 0; run < RUNS; run++) {
+        Scanner scanner;
+        if (scanner_init_buffer(&scanner, source.data, source.length) !=
+            NO_ERROR) {
+            return 1;
+        }
+        double t0 = now_seconds();
+        ASTNode *program = create_ast_node(AST_PROGRAM, NULL);
+        int rc = program ? parser(&scanner, program) : ERROR_INTERNAL;
+        double t1 = now_seconds();
+        if (rc == NO_ERROR) {
+            rc = semantic_analyze(program);
+        }
+        double t2 = now_seconds();
+        if (rc == NO_ERROR) {
+            rc = generate_code(program, sink);
+        }
+        double t3 = now_seconds();
+        scanner_free(&scanner);
+        phase_arenas_free_all();
+        intern_free_all();
+        if (rc != NO_ERROR) {
+            printf("compilation returned %d\n", rc);
+            return 1;
+        }
+        double times[3] = {t1 - t0, t2 - t1, t3 - t2};
+        for (int i = 0; i < 3; i++) {
+            if (best[i] < 0 || times[i] < best[i]) {
+                best[i] = times[i];
+            }
+        }
+    }
+    printf("  parse    %9.3f ms\n", best[0] * 1e3);
+    printf("  semantic %9.3f ms\n", best[1] * 1e3);
+    printf("  codegen  %9.3f ms\n", best[2] * 1e3);
+
+    fclose(sink);
+    free(source.data);
+    return 0;
+}
@@ -0,0 +1,196 @@
+/**
+ * @file bench_scanner.c
+ * @author xcernoj00
+ * @brief Scanner throughput benchmark.
+ *
+ * Generates a large synthetic IFJ25 source, then tokenizes it once with the
+ * frozen stream-based scanner (fgetc/ungetc per character) and once with
+ * the buffer-based scanner, and reports MB/s for both. Both runs must
+ * produce the same number of tokens.
+ *
+ * A comment- and string-heavy source is then tokenized with the scalar and
+ * with the best vectorized skipping kernels to show what they save.
+ *
+ * Usage: ./bench_scanner [megabytes]   (default 16)
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "legacy_scanner.h"
+#include "scan_simd.h"
+#include "scanner.h"
+#include "test_util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *chunk =
+    "// Helper computing a value\n"
+    "static compute_value(a, b) {\n"
+    "    /* block comment with * and / inside */\n"
+    "    var result\n"
+    "    result = (a + b) * 3.5e2 - 0x1F / -42\n"
+    "    if (result >= 10) {\n"
+    "        result = result != 11\n"
+    "    }\n"
+    "    if (result is Num) {\n"
+    "        __global = Ifj.write(\"value:\\t\\x41 done\\n\")\n"
+    "    } else {\n"
+    "        result = \"\"\"multi\n"
+    "line\"\"\"\n"
+    "    }\n"
+    "    while (result < 1000) {\n"
+    "        result = result * 2\n"
+    "    }\n"
+    "    return result\n"
+    "}\n"
+    "\n";
+
+static const char *heavy_chunk =
+    "/*\n"
+    " * Long documentation block of the kind found in commented sources.\n"
+    " * It spans several lines, and only the closing star-slash ends it,\n"
+    " * so the scanner has to walk through every single character here.\n"
+    " */\n"
+    "static describe() {\n"
+    "    // A line comment that also takes up most of the line it sits on\n"
+    "    var text = \"Plain string bodies are scanned for quotes and escapes\"\n"
+    "    text = \"\"\"A multiline literal\n"
+    "that keeps going over more than one line of the source file\n"
+    "\"\"\"\n"
+    "    return text\n"
+    "}\n"
+    "\n";
+
+static int is_string_token(TokenType type) {
+    return type == TOKEN_IDENTIFIER || type == TOKEN_GLOBAL_VAR ||
+           type == TOKEN_STRING;
+}
+
+static long run_legacy(FILE *f) {
+    LegacyToken token;
+    long count = 0;
+
+    rewind(f);
+    legacy_set_source_file(f);
+    while (legacy_get_token(&token) == NO_ERROR && token.type != TOKEN_EOF) {
+        if (is_string_token(token.type)) {
+            d_string_free(token.value.string);
+            free(token.value.string);
+        }
+        count++;
+    }
+    return count;
+}
+
+static long run_buffer(FILE *f) {
+    Scanner scanner;
+    Token token;
+    long count = 0;
+
+    rewind(f);
+    if (scanner_init_file(&scanner, f) != NO_ERROR) {
+        return -1;
+    }
+    while (get_token(&scanner, &token) == NO_ERROR &&
+           token.type != TOKEN_EOF) {
+        count++;
+    }
+    scanner_free(&scanner);
+    return count;
+}
+
+/**
+ * @brief Tokenize a buffer with one kernel set, returning the token count.
+ */
+static long run_kernel(const char *data, size_t length, ScanKernel kernel,
+                       double *seconds) {
+    Scanner scanner;
+    Token token;
+    long count = 0;
+
+    scan_kernel_select(kernel);
+    if (scanner_init_buffer(&scanner, data, length) != NO_ERROR) {
+        return -1;
+    }
+    double t0 = now_seconds();
+    while (get_token(&scanner, &token) == NO_ERROR &&
+           token.type != TOKEN_EOF) {
+        count++;
+    }
+    *seconds = now_seconds() - t0;
+    scanner_free(&scanner);
+    return count;
+}
+
+static int bench_kernels(size_t target) {
+    size_t chunk_length = strlen(heavy_chunk);
+    size_t length = 0;
+    char *data = malloc(target + chunk_length);
+    if (!data) {
+        return 1;
+    }
+    while (length < target) {
+        memcpy(data + length, heavy_chunk, chunk_length);
+        length += chunk_length;
+    }
+
+    double mb = length / (1024.0 * 1024.0);
+    double t_scalar, t_best;
+    ScanKernel best = scan_kernel_best();
+    long scalar_tokens =
+        run_kernel(data, length, SCAN_KERNEL_SCALAR, &t_scalar);
+    long best_tokens = run_kernel(data, length, best, &t_best);
+    free(data);
+
+    printf("comment/string-heavy input: %.1f MB\n", mb);
+    printf("scalar kernels: %ld tokens, %.3f s, %.1f MB/s\n", scalar_tokens,
+           t_scalar, mb / t_scalar);
+    printf("%-6s kernels: %ld tokens, %.3f s, %.1f MB/s (%.2fx)\n",
+           scan_kernel_name(best), best_tokens, t_best, mb / t_best,
+           t_scalar / t_best);
+    if (scalar_tokens != best_tokens) {
+        printf("FAIL: token counts differ\n");
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    size_t megabytes = argc > 1 ? (size_t)atol(argv[1]) : 16;
+    size_t target = megabytes * 1024 * 1024;
+    size_t chunk_length = strlen(chunk);
+
+    FILE *f = tmpfile();
+    if (!f) {
+        perror("tmpfile");
+        return 1;
+    }
+    size_t written = 0;
+    while (written < target) {
+        fwrite(chunk, 1, chunk_length, f);
+        written += chunk_length;
+    }
+    fflush(f);
+
+    double t0 = now_seconds();
+    long legacy_tokens = run_legacy(f);
+    double t1 = now_seconds();
+    long buffer_tokens = run_buffer(f);
+    double t2 = now_seconds();
+    fclose(f);
+
+    double mb = written / (1024.0 * 1024.0);
+    printf("input: %.1f MB\n", mb);
+    printf("fgetc/ungetc scanner: %ld tokens, %.3f s, %.1f MB/s\n",
+           legacy_tokens, t1 - t0, mb / (t1 - t0));
+    printf("buffer scanner:       %ld tokens, %.3f s, %.1f MB/s\n",
+           buffer_tokens, t2 - t1, mb / (t2 - t1));
+
+    if (legacy_tokens != buffer_tokens) {
+        printf("FAIL: token counts differ\n");
+        return 1;
+    }
+    printf("speedup: %.2fx\n", (t1 - t0) / (t2 - t1));
+    return bench_kernels(target);
+}
@@ -0,0 +1,249 @@
+/**
+ * @file bench_symtable.c
+ * @author xcernoj00
+ * @brief Benchmark of the symbol table implementation chosen at build time.
+ *
+ * `make bench_symtable` builds this program twice, as bench_symtable_avl
+ * and bench_symtable_hash (SYMTABLE_HASH), and runs both. Workloads:
+ *   - insert: a global scope of functions (`name$arity`), getters
+ *     (`name$get`) and setters (`name$set`), filled again and again,
+ *   - lookup: call-site checks against that scope, half of them for keys
+ *     it does not hold (the setter check of every assignment),
+ *   - scopes: small block scopes, each lookup walking a chain of them,
+ *   - compile: a whole program with many functions and calls.
+ * Every search goes through symtable_search, interning lookup included;
+ * the time of intern_find alone is printed for reference. The checksums
+ * must match between the two builds.
+ *
+ * Usage: ./bench_symtable_avl [symbols] [lookups]
+ *        (default symbols: 10000; lookups: 2000000)
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "arena.h"
+#include "ifj25.h"
+#include "intern.h"
+#include "symtable.h"
+#include "test_util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef SYMTABLE_HASH
+#define IMPLEMENTATION "hash"
+#else
+#define IMPLEMENTATION "avl"
+#endif
+
+/// Scopes in the chain of the scopes workload, and symbols per scope
+#define CHAIN_LENGTH 8
+#define SCOPE_SYMBOLS 4
+
+/// Key length limit (like MAX_FUNCTION_KEY_LENGTH in semantic.c)
+#define KEY_LENGTH 32
+
+static void report(const char *name, double seconds, size_t operations,
+                   unsigned long checksum) {
+    printf("  %-5s %-30s %8.1f ns/op  (checksum %lu)\n", IMPLEMENTATION,
+           name, seconds * 1e9 / (double)operations, checksum);
+}
+
+/**
+ * @brief Keys of a global scope: functions of arity 0-3, getters and
+ * setters, in the proportion 2:1:1.
+ */
+static char (*global_keys(size_t count))[KEY_LENGTH] {
+    char (*keys)[KEY_LENGTH] = malloc(count * sizeof(*keys));
+    if (!keys) {
+        abort();
+    }
+    for (size_t i = 0; i < count; i++) {
+        switch (i % 4) {
+        case 0:
+        case 1:
+            snprintf(keys[i], KEY_LENGTH, "func%zu$%zu", i / 4, i % 4);
+            break;
+        case 2:
+            snprintf(keys[i], KEY_LENGTH, "prop%zu$get", i / 4);
+            break;
+        default:
+            snprintf(keys[i], KEY_LENGTH, "prop%zu$set", i / 4);
+            break;
+        }
+    }
+    return keys;
+}
+
+static void fill(SymTable *table, char (*keys)[KEY_LENGTH], size_t count,
+                 SymTableData *data) {
+    symtable_init(table);
+    for (size_t i = 0; i < count; i++) {
+        if (!symtable_insert(table, keys[i], data)) {
+            fprintf(stderr, "insert of %s failed\n", keys[i]);
+            exit(1);
+        }
+    }
+}
+
+static void bench_insert(char (*keys)[KEY_LENGTH], size_t count,
+                         size_t operations) {
+    SymTableData *data = make_function(0, NULL, true, TYPE_UNDEF);
+    size_t rounds = operations / count ? operations / count : 1;
+    unsigned long checksum = 0;
+    double t0 = now_seconds();
+    for (size_t r = 0; r < rounds; r++) {
+        // Tables live in the semantic arena, like a compilation's
+        SymTable table;
+        fill(&table, keys, count, data);
+        checksum += symtable_search(&table, keys[r % count]) == data;
+        symtable_free(&table);
+        arena_free(phase_arena(ARENA_SEMANTIC));
+    }
+    report("insert", now_seconds() - t0, rounds * count, checksum);
+}
+
+static void bench_lookup(char (*keys)[KEY_LENGTH], size_t count,
+                         size_t operations) {
+    SymTableData *data = make_function(0, NULL, true, TYPE_UNDEF);
+    SymTable table;
+    fill(&table, keys, count, data);
+
+    // Interned misses: the same names with an arity or suffix not defined
+    char (*misses)[KEY_LENGTH] = malloc(count * sizeof(*misses));
+    if (!misses) {
+        abort();
+    }
+    for (size_t i = 0; i < count; i++) {
+        snprintf(misses[i], KEY_LENGTH, "%s_", keys[i]);
+        intern(misses[i]);
+    }
+
+    unsigned long checksum = 0;
+    size_t step = 7919; // prime: visits the keys in scattered order
+    double t0 = now_seconds();
+    for (size_t i = 0, k = 0; i < operations; i++, k = (k + step) % count) {
+        const char *key = i % 2 ? misses[k] : keys[k];
+        checksum += symtable_search(&table, key) != NULL;
+    }
+    report("lookup (half misses)", now_seconds() - t0, operations,
+           checksum);
+
+    checksum = 0;
+    t0 = now_seconds();
+    for (size_t i = 0, k = 0; i < operations; i++, k = (k + step) % count) {
+        const char *key = i % 2 ? misses[k] : keys[k];
+        checksum += intern_find(key) != NULL;
+    }
+    report("  of which intern_find", now_seconds() - t0, operations,
+           checksum);
+
+    free(misses);
+    symtable_free(&table);
+    arena_free(phase_arena(ARENA_SEMANTIC));
+}
+
+static void bench_scopes(size_t operations) {
+    SymTableData *data = make_variable(TYPE_NUM, true, true);
+    SymTable chain[CHAIN_LENGTH];
+    char names[CHAIN_LENGTH * SCOPE_SYMBOLS][KEY_LENGTH];
+    for (size_t s = 0; s < CHAIN_LENGTH; s++) {
+        symtable_init(&chain[s]);
+        for (size_t v = 0; v < SCOPE_SYMBOLS; v++) {
+            char *name = names[s * SCOPE_SYMBOLS + v];
+            snprintf(name, KEY_LENGTH, "local%zu_%zu", s, v);
+            symtable_insert(&chain[s], name, data);
+        }
+    }
+
+    // Look each name up from the innermost scope outwards, like
+    // lookup_symbol does
+    unsigned long checksum = 0;
+    size_t lookups = 0;
+    double t0 = now_seconds();
+    for (size_t i = 0; i < operations / CHAIN_LENGTH; i++) {
+        const char *name = names[i % (CHAIN_LENGTH * SCOPE_SYMBOLS)];
+        for (size_t s = CHAIN_LENGTH; s-- > 0;) {
+            lookups++;
+            if (symtable_search(&chain[s], name)) {
+                checksum += s;
+                break;
+            }
+        }
+    }
+    report("scopes (chain of 8)", now_seconds() - t0, lookups, checksum);
+    arena_free(phase_arena(ARENA_SEMANTIC));
+}
+
+/**
+ * @brief Program with `functions` one-parameter functions, each called
+ * `calls` times from main.
+ */
+static char *make_program(size_t functions, size_t calls, size_t *length) {
+    size_t capacity = 128 + functions * (64 + calls * 32);
+    char *source = malloc(capacity);
+    if (!source) {
+        abort();
+    }
+    size_t n = (size_t)snprintf(source, capacity,
+                                "import \"ifj25\" for Ifj\n"
+                                "class Program {\n");
+    for (size_t f = 0; f < functions; f++) {
+        n += (size_t)snprintf(source + n, capacity - n,
+                              "    static f%zu(a) {\n"
+                              "        return a + %zu\n"
+                              "    }\n",
+                              f, f);
+    }
+    n += (size_t)snprintf(source + n, capacity - n,
+                          "    static main() {\n        var x\n");
+    for (size_t c = 0; c < calls; c++) {
+        for (size_t f = 0; f < functions; f++) {
+            n += (size_t)snprintf(source + n, capacity - n,
+                                  "        x = f%zu(x)\n", f);
+        }
+    }
+    n += (size_t)snprintf(source + n, capacity - n, "    }\n}\n");
+    *length = n;
+    return source;
+}
+
+static void bench_compile(size_t functions) {
+    size_t calls = 10;
+    size_t length;
+    char *source = make_program(functions, calls, &length);
+    FILE *sink = fopen("/dev/null", "w");
+    if (!sink) {
+        abort();
+    }
+    Ifj25Context ctx;
+    ifj25_context_init(&ctx);
+    double t0 = now_seconds();
+    int rc = ifj25_compile(&ctx, source, length, sink);
+    double seconds = now_seconds() - t0;
+    printf("  %-5s compile %zu functions, %zu calls %9.3f s  (status %d)\n",
+           IMPLEMENTATION, functions, functions * calls, seconds, rc);
+    fclose(sink);
+    free(source);
+}
+
+int main(int argc, char **argv) {
+    size_t symbols = argc > 1 ? (size_t)atol(argv[1]) : 10000;
+    size_t lookups = argc > 2 ? (size_t)atol(argv[2]) : 2000000;
+    if (symbols < 4) {
+        symbols = 4;
+    }
+
+    printf("=== Symbol table: %s, %zu global symbols ===\n", IMPLEMENTATION,
+           symbols);
+    char (*keys)[KEY_LENGTH] = global_keys(symbols);
+    bench_insert(keys, symbols, lookups);
+    bench_lookup(keys, symbols, lookups);
+    bench_scopes(lookups);
+    free(keys);
+    phase_arenas_free_all();
+    intern_free_all();
+
+    bench_compile(symbols / 4);
+    return 0;
+}
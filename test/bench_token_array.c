@@ -0,0 +1,171 @@
+/**
+ * @file bench_token_array.c
+ * @author xcernoj00
+ * @brief Streaming vs. lex-first vs. pipelined parsing benchmark.
+ *
+ * Parses a generated IFJ25 program with tokens scanned on demand, with the
+ * whole input lexed into a token array first, and with a scanner thread
+ * feeding the parser through the token ring (token_pipe.h), for a small
+ * program (parsed many times) and a large one (default 10 MB). All modes
+ * must build ASTs of the same size. Times run from scanner setup to the
+ * finished AST, i.e. the end-to-end latency of the front end.
+ *
+ * Usage: ./bench_token_array [megabytes]   (default 10)
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "arena.h"
+#include "ast.h"
+#include "intern.h"
+#include "parser.h"
+#include "scanner.h"
+#include "test_util.h"
+#include "token_pipe.h"
+#include "work_pool.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *prolog = "import \"ifj25\" for Ifj\n"
+                            "class Program {\n"
+                            "    static main() {\n"
+                            "        var r\n"
+                            "        r = f0(1, 2)\n"
+                            "    }\n";
+
+static const char *function_format =
+    "    static f%zu(a, b) {\n"
+    "        var x\n"
+    "        x = (a + b) * 3 - a / 2\n"
+    "        if (x > 10) {\n"
+    "            x = Ifj.write(\"big\")\n"
+    "        } else {\n"
+    "            x = x + 1\n"
+    "        }\n"
+    "        while (x < 100) {\n"
+    "            x = x * 2\n"
+    "        }\n"
+    "        return x\n"
+    "    }\n";
+
+typedef enum { MODE_STREAMING, MODE_LEX_FIRST, MODE_PIPELINED } ParseMode;
+
+/**
+ * @brief Generate a program of at least `target` bytes.
+ */
+static char *generate(size_t target, size_t *length) {
+    size_t capacity = target + 4096;
+    char *data = malloc(capacity);
+    if (!data) {
+        return NULL;
+    }
+    size_t used = (size_t)sprintf(data, "%s", prolog);
+    for (size_t i = 0; used < target; i++) {
+        if (capacity - used < 1024) {
+            capacity *= 2;
+            char *grown = realloc(data, capacity);
+            if (!grown) {
+                free(data);
+                return NULL;
+            }
+            data = grown;
+        }
+        used += (size_t)sprintf(data + used, function_format, i);
+    }
+    used += (size_t)sprintf(data + used, "}\n");
+    *length = used;
+    return data;
+}
+
+static size_t count_nodes(const ASTNode *node) {
+    size_t count = 0;
+    while (node) {
+        count += 1 + count_nodes(node->left);
+        node = node->right;
+    }
+    return count;
+}
+
+/**
+ * @brief Parse the buffer `rounds` times, returning the AST size or 0 on
+ *        a parse error.
+ */
+static size_t parse(const char *data, size_t length, ParseMode mode,
+                    int rounds, double *seconds) {
+    size_t nodes = 0;
+
+    // Only lexing and parsing are timed, not freeing the AST
+    *seconds = 0;
+    for (int i = 0; i < rounds; i++) {
+        Scanner scanner;
+        double t0 = now_seconds();
+        if (scanner_init_buffer(&scanner, data, length) != NO_ERROR) {
+            return 0;
+        }
+        if (mode == MODE_LEX_FIRST &&
+            scanner_tokenize_all(&scanner) != NO_ERROR) {
+            scanner_free(&scanner);
+            return 0;
+        }
+        if (mode == MODE_PIPELINED &&
+            scanner_start_pipeline(&scanner) != NO_ERROR) {
+            scanner_free(&scanner);
+            return 0;
+        }
+        ASTNode *program = create_ast_node(AST_PROGRAM, NULL);
+        int rc = parser(&scanner, program);
+        scanner_free(&scanner);
+        *seconds += now_seconds() - t0;
+
+        nodes = rc == NO_ERROR ? count_nodes(program) : 0;
+        phase_arenas_free_all();
+        if (nodes == 0) {
+            return 0;
+        }
+    }
+    return nodes;
+}
+
+static int bench(const char *label, size_t target, int rounds) {
+    size_t length;
+    char *data = generate(target, &length);
+    if (!data) {
+        return 1;
+    }
+
+    // Warm-up run, so neither mode pays for filling the intern table
+    double t_stream, t_array, t_pipe;
+    parse(data, length, MODE_STREAMING, 1, &t_stream);
+    size_t stream_nodes =
+        parse(data, length, MODE_STREAMING, rounds, &t_stream);
+    size_t array_nodes = parse(data, length, MODE_LEX_FIRST, rounds, &t_array);
+    size_t pipe_nodes = parse(data, length, MODE_PIPELINED, rounds, &t_pipe);
+    free(data);
+
+    double mb = (double)length * rounds / (1024.0 * 1024.0);
+    printf("%s (%zu bytes x %d):\n", label, length, rounds);
+    if (stream_nodes == 0 || stream_nodes != array_nodes ||
+        stream_nodes != pipe_nodes) {
+        printf("FAIL: parse failed or AST sizes differ (%zu vs %zu vs %zu)\n",
+               stream_nodes, array_nodes, pipe_nodes);
+        return 1;
+    }
+    printf("  streaming: %.3f s, %.1f MB/s\n", t_stream, mb / t_stream);
+    printf("  lex-first: %.3f s, %.1f MB/s (%.2fx)\n", t_array, mb / t_array,
+           t_stream / t_array);
+    printf("  pipelined: %.3f s, %.1f MB/s (%.2fx)\n", t_pipe, mb / t_pipe,
+           t_stream / t_pipe);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    size_t megabytes = argc > 1 ? (size_t)atol(argv[1]) : 10;
+    printf("%u processor(s)\n", work_pool_cpu_count());
+
+    int result = bench("small input", 2048, 5000);
+    result |= bench("large input", megabytes * 1024 * 1024, 1);
+    intern_free_all();
+    return result;
+}
@@ -0,0 +1,45 @@
+/**
+ * @file legacy_scanner.h
+ * @author xcernoj00
+ * @brief Interface of the frozen stream-based scanner used by benchmarks.
+ */
+
+#ifndef _LEGACY_SCANNER_H
+#define _LEGACY_SCANNER_H
+
+#include "dynamic_string.h"
+#include "scanner.h"
+#include <stdio.h>
+
+/**
+ * @brief Token as produced by the stream-based scanner.
+ *
+ * Identifiers, global variables and string literals own a heap-allocated
+ * `DynamicString` copy of their text.
+ */
+typedef struct {
+    TokenType type;
+    union {
+        Keyword keyword;
+        int integer;
+        double decimal;
+        DynamicString *string;
+    } value;
+} LegacyToken;
+
+/**
+ * @brief Set the stream the legacy scanner pulls characters from.
+ *
+ * @param f Input stream.
+ */
+void legacy_set_source_file(FILE *f);
+
+/**
+ * @brief Obtain the next token with per-character fgetc/ungetc reads.
+ *
+ * @param token Token to populate.
+ * @return NO_ERROR on success or ERROR_INTERNAL on internal failure.
+ */
+int legacy_get_token(LegacyToken *token);
+
+#endif // _LEGACY_SCANNER_H
@@ -0,0 +1,269 @@
+/**
+ * @file test_expr_fuzz.c
+ * @author xcernoj00
+ * @brief Differential fuzz test of the two expression parsers.
+ *
+ * Random expressions are placed where the grammar expects one (assignment,
+ * return, if and while conditions, call arguments) and every program is
+ * parsed with the shift/reduce precedence parser and with the precedence
+ * climbing parser. Return codes and ASTs must be identical. Three kinds of
+ * expressions are generated:
+ * 1. random sequences of expression tokens, other tokens and lexical errors
+ *    (almost all of them malformed, and where a lexical error follows the
+ *    point at which an error is found decides the return code);
+ * 2. well-formed expressions, half of them damaged at one place;
+ * 3. expressions nested in hundreds of parentheses, beyond the depth at
+ *    which the climbing parser hands over to the shift/reduce parser.
+ *
+ * Usage: ./test_expr_fuzz [programs per kind] [seed]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "arena.h"
+#include "ast.h"
+#include "expr_ast.h"
+#include "intern.h"
+#include "parser.h"
+#include "scanner.h"
+#include "test_util.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static uint64_t random_state = 88172645463325252ULL;
+
+static unsigned random_below(unsigned n) {
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 7;
+    random_state ^= random_state << 17;
+    return (unsigned)(random_state % n);
+}
+
+/**
+ * @brief Parses `source` with one expression parser into `result`.
+ */
+static void parse(const Text *source, ExprParserKind kind, Text *result) {
+    result->length = 0;
+    Scanner scanner;
+    if (scanner_init_buffer(&scanner, source->data, source->length) !=
+        NO_ERROR) {
+        append(result, "scanner");
+        return;
+    }
+    parser_set_expression_parser(kind);
+    ASTNode *program = create_ast_node(AST_PROGRAM, NULL);
+    int rc = program ? parser(&scanner, program) : ERROR_INTERNAL;
+    append(result, "%d", rc);
+    if (rc == NO_ERROR) {
+        serialize(result, program);
+    }
+    scanner_free(&scanner);
+    phase_arenas_free_all();
+    intern_free_all();
+}
+
+// Tokens of expressions, and a few others that end up in them by mistake
+static const char *const operands[] = {"a", "b", "__g", "1", "2.5", "0x1F",
+                                       "\"s\"", "null", "Null", "Num",
+                                       "String"};
+static const char *const operators[] = {"+",  "-",  "*",  "/",  "<",
+                                        ">",  "<=", ">=", "==", "!=",
+                                        "is"};
+static const char *const others[] = {"if", "var", "=", "{", "}", ".", "!",
+                                     ",", "f(", "\n", "Ifj.f", "return"};
+static const char *const lexical_errors[] = {"@", "\"\\q\"", "1e", "&"};
+
+#define COUNT(array) (sizeof(array) / sizeof(*(array)))
+
+static const char *random_token(void) {
+    unsigned kind = random_below(100);
+    if (kind < 33) {
+        return operands[random_below(COUNT(operands))];
+    } else if (kind < 60) {
+        return operators[random_below(COUNT(operators))];
+    } else if (kind < 82) {
+        return random_below(2) ? "(" : ")";
+    } else if (kind < 92) {
+        return others[random_below(COUNT(others))];
+    }
+    return lexical_errors[random_below(COUNT(lexical_errors))];
+}
+
+/**
+ * @brief Appends a well-formed expression of at most `depth` levels.
+ */
+static void random_expression(Text *text, unsigned depth) {
+    unsigned kind = depth > 0 ? random_below(10) : 0;
+    if (kind < 4) {
+        append(text, "%s", operands[random_below(COUNT(operands))]);
+    } else if (kind < 6) {
+        append(text, "(");
+        random_expression(text, depth - 1);
+        append(text, ")");
+    } else {
+        random_expression(text, depth - 1);
+        append(text, " %s ", operators[random_below(COUNT(operators))]);
+        random_expression(text, depth - 1);
+    }
+}
+
+/**
+ * @brief Damages a well-formed expression at a random character: inserts a
+ * random token there, replaces the character by one, or removes it.
+ */
+static void mutate(Text *expression) {
+    Text tokens = {0};
+    size_t position = random_below((unsigned)expression->length + 1);
+    unsigned kind = random_below(3);
+    append(&tokens, "%.*s", (int)position, expression->data);
+    if (kind != 2) {
+        append(&tokens, " %s ", random_token());
+    }
+    size_t rest = position;
+    if (kind != 1 && rest < expression->length) {
+        rest++; // drop a character of the original
+    }
+    append(&tokens, "%s", expression->data + rest);
+    expression->length = 0;
+    append(expression, "%s", tokens.data);
+    free(tokens.data);
+}
+
+/**
+ * @brief Puts an expression into a program, in a random context.
+ */
+static void program_with(Text *program, const char *expression) {
+    program->length = 0;
+    append(program, "import \"ifj25\" for Ifj\n"
+                    "class Program {\n"
+                    "    static f(p, q) {\n"
+                    "    }\n"
+                    "    static main() {\n"
+                    "        var a\n"
+                    "        var b\n");
+    switch (random_below(6)) {
+    case 0:
+        append(program, "        a = %s\n", expression);
+        break;
+    case 1:
+        append(program, "        return %s\n", expression);
+        break;
+    case 2:
+        append(program, "        if (%s) {\n        } else {\n        }\n",
+               expression);
+        break;
+    case 3:
+        append(program, "        while (%s) {\n        }\n", expression);
+        break;
+    case 4:
+        append(program, "        f(%s, a)\n", expression);
+        break;
+    default:
+        append(program, "        a = f(%s)\n", expression);
+        break;
+    }
+    append(program, "    }\n"
+                    "}\n");
+}
+
+/**
+ * @brief Parses the program with both parsers and compares the results.
+ * @return 1 when they differ.
+ */
+static int differs(const Text *program, int *accepted) {
+    static Text precedence, climbing;
+    parse(program, EXPR_PARSER_PRECEDENCE, &precedence);
+    parse(program, EXPR_PARSER_CLIMBING, &climbing);
+    if (precedence.data[0] == '0') {
+        (*accepted)++;
+    }
+    if (precedence.length != climbing.length ||
+        memcmp(precedence.data, climbing.data, precedence.length) != 0) {
+        printf("  differs: %.*s vs %.*s\n%s", 2, precedence.data, 2,
+               climbing.data, program->data);
+        return 1;
+    }
+    return 0;
+}
+
+static void report(int differences, int programs, int accepted,
+                   const char *name) {
+    char label[128];
+    snprintf(label, sizeof label, "%s (%d programs, %d accepted)", name,
+             programs, accepted);
+    check(differences == 0, label);
+}
+
+static void test_random_tokens(int programs) {
+    Text expression = {0}, program = {0};
+    int differences = 0, accepted = 0;
+    for (int i = 0; i < programs && differences < 10; i++) {
+        expression.length = 0;
+        unsigned length = 1 + random_below(12);
+        for (unsigned t = 0; t < length; t++) {
+            append(&expression, "%s ", random_token());
+        }
+        program_with(&program, expression.data);
+        differences += differs(&program, &accepted);
+    }
+    report(differences, programs, accepted, "random token sequences");
+    free(expression.data);
+    free(program.data);
+}
+
+static void test_mutated_expressions(int programs) {
+    Text expression = {0}, program = {0};
+    int differences = 0, accepted = 0;
+    for (int i = 0; i < programs && differences < 10; i++) {
+        expression.length = 0;
+        random_expression(&expression, 1 + random_below(6));
+        if (random_below(2)) {
+            mutate(&expression);
+        }
+        program_with(&program, expression.data);
+        differences += differs(&program, &accepted);
+    }
+    report(differences, programs, accepted, "mutated expressions");
+    free(expression.data);
+    free(program.data);
+}
+
+static void test_deep_nesting(int programs) {
+    Text expression = {0}, program = {0};
+    int differences = 0, accepted = 0;
+    for (int i = 0; i < programs && differences < 10; i++) {
+        expression.length = 0;
+        unsigned depth = 200 + random_below(200);
+        for (unsigned d = 0; d < depth; d++) {
+            append(&expression, random_below(4) ? "(a + " : "(");
+        }
+        random_expression(&expression, 3);
+        for (unsigned d = 0; d < depth; d++) {
+            append(&expression, ")");
+        }
+        if (random_below(2)) {
+            mutate(&expression);
+        }
+        program_with(&program, expression.data);
+        differences += differs(&program, &accepted);
+    }
+    report(differences, programs, accepted, "deep nesting");
+    free(expression.data);
+    free(program.data);
+}
+
+int main(int argc, char **argv) {
+    int programs = argc > 1 ? atoi(argv[1]) : 20000;
+    if (argc > 2) {
+        random_state = strtoull(argv[2], NULL, 10) * 2 + 1;
+    }
+
+    printf("=== Expression parser differential fuzz ===\n");
+    test_random_tokens(programs);
+    test_mutated_expressions(programs);
+    test_deep_nesting(programs / 20);
+
+    return tests_summary();
+}
@@ -0,0 +1,332 @@
+/**
+ * @file test_expr_pool.c
+ * @author xcernoj00
+ * @brief Test of the compact expression pool (expr_pool.h).
+ *
+ * Checks the node size, the sharing of equal numbers, strings and names,
+ * and that every expression of the analyzed programs of the test corpus
+ * survives the way into a per-function pool and back unchanged, scopes
+ * included. A chain of 100k operators is converted both ways without
+ * recursion. Finally the expressions of an expression-heavy program are
+ * stored both ways and the bytes are printed.
+ *
+ * Usage: ./test_expr_pool [program.wren...]
+ *        (default: test/codes-OK/ *.wren and test/codes-COMPLET/ *.wren)
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "arena.h"
+#include "ast.h"
+#include "expr_ast.h"
+#include "expr_pool.h"
+#include "intern.h"
+#include "parser.h"
+#include "scanner.h"
+#include "semantic.h"
+#include "test_util.h"
+#include <glob.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void test_layout_and_sharing(void) {
+    check(sizeof(CompactExpr) == 16, "nodes are 16 bytes");
+
+    ExprPool pool = {0};
+    ExprId last = EXPR_NONE;
+    for (int i = 0; i < 100; i++) {
+        ExprId sum = expr_pool_binary_op(&pool, OP_ADD,
+                                         expr_pool_identifier(&pool, "x"),
+                                         expr_pool_num_literal(&pool, 1));
+        ExprId text = expr_pool_string_literal(&pool, "hello");
+        last = expr_pool_binary_op(&pool, OP_EQ, sum, text);
+    }
+    ExprId cut = expr_pool_string_literal_n(&pool, "hello\0world", 11);
+    ExprId zero = expr_pool_num_literal(&pool, 0.0);
+    ExprId minus_zero = expr_pool_num_literal(&pool, -0.0);
+    check(pool.count == 1 + 100 * 5 + 3 && pool.name_count == 1 &&
+              pool.string_count == 1 && pool.number_count == 3,
+          "equal constants and names are stored once");
+    check(expr_pool_kind(&pool, last) == EXPR_BINARY_OP &&
+              expr_pool_op(&pool, last) == OP_EQ &&
+              strcmp(expr_pool_string(&pool, expr_pool_right(&pool, last)),
+                     "hello") == 0 &&
+              expr_pool_string(&pool, cut) ==
+                  expr_pool_string(&pool, expr_pool_right(&pool, last)) &&
+              expr_pool_name(&pool, expr_pool_left(
+                                        &pool, expr_pool_left(&pool, last))) ==
+                  intern("x") &&
+              expr_pool_number(&pool, zero) == 0.0 &&
+              expr_pool_left(&pool, zero) !=
+                  expr_pool_left(&pool, minus_zero),
+          "accessors return what the builders got");
+    expr_pool_free(&pool);
+    intern_free_all();
+}
+
+/**
+ * @brief Counts the pointer bytes of an expression tree.
+ */
+static size_t tree_bytes(const ExprNode *node) {
+    size_t bytes = 0;
+    const ExprNode **stack = NULL;
+    size_t depth = 0, capacity = 0;
+    while (node) {
+        bytes += sizeof(ExprNode);
+        if (node->type == EXPR_STRING_LITERAL) {
+            bytes += strlen(node->data.string_literal) + 1;
+        }
+        if (node->type == EXPR_BINARY_OP) {
+            if (depth == capacity) {
+                capacity = capacity ? capacity * 2 : 64;
+                stack = realloc(stack, capacity * sizeof(*stack));
+                if (!stack) {
+                    abort();
+                }
+            }
+            stack[depth++] = node->data.binary.right;
+            node = node->data.binary.left;
+        } else {
+            node = depth > 0 ? stack[--depth] : NULL;
+        }
+    }
+    free(stack);
+    return bytes;
+}
+
+/**
+ * @brief Stores the expressions of every function in a pool of its own.
+ * @param pointer_bytes, pool_bytes Incremented by the size of both forms.
+ * @return Number of expressions that did not come back unchanged.
+ */
+static size_t round_trip_program(ASTNode *program, size_t *expressions,
+                                 size_t *pointer_bytes, size_t *pool_bytes) {
+    size_t differences = 0;
+    Text before = {0}, after = {0};
+    ASTNode **stack = NULL;
+    size_t capacity = 0;
+    for (ASTNode *def = program->left; def && def->right;
+         def = def->right->right) {
+        ExprPool pool = {0};
+        size_t depth = 0;
+        ASTNode *node = def->right->left;
+        while (node || depth > 0) {
+            if (!node) {
+                node = stack[--depth];
+                continue;
+            }
+            if (node->type == AST_EXPRESSION && node->expr) {
+                ExprId id = expr_pool_add_tree(&pool, node->expr);
+                before.length = after.length = 0;
+                serialize_expr(&before, node->expr);
+                serialize_expr(&after, expr_pool_to_tree(&pool, id));
+                differences += id == EXPR_NONE ||
+                               strcmp(before.data, after.data) != 0;
+                (*expressions)++;
+                *pointer_bytes += tree_bytes(node->expr);
+            }
+            if (node->right) {
+                if (depth == capacity) {
+                    capacity = capacity ? capacity * 2 : 64;
+                    stack = realloc(stack, capacity * sizeof(*stack));
+                    if (!stack) {
+                        abort();
+                    }
+                }
+                stack[depth++] = node->right;
+            }
+            node = node->left;
+        }
+        *pool_bytes += expr_pool_bytes(&pool);
+        expr_pool_free(&pool);
+    }
+    free(stack);
+    free(before.data);
+    free(after.data);
+    return differences;
+}
+
+/**
+ * @brief Parses (and analyzes when `analyze`) a program, then round-trips
+ * its expressions.
+ * @return 0 when the program does not compile.
+ */
+static int round_trip_source(const char *data, size_t length, int analyze,
+                             size_t *expressions, size_t *differences,
+                             size_t *pointer_bytes, size_t *pool_bytes) {
+    Scanner scanner;
+    if (scanner_init_buffer(&scanner, data, length) != NO_ERROR) {
+        return 0;
+    }
+    ASTNode *program = create_ast_node(AST_PROGRAM, NULL);
+    int rc = program ? parser(&scanner, program) : ERROR_INTERNAL;
+    if (rc == NO_ERROR && analyze) {
+        rc = semantic_analyze(program);
+    }
+    if (rc == NO_ERROR) {
+        *differences += round_trip_program(program, expressions,
+                                           pointer_bytes, pool_bytes);
+    }
+    scanner_free(&scanner);
+    phase_arenas_free_all();
+    intern_free_all();
+    return rc == NO_ERROR;
+}
+
+static void test_corpus(int count, char **paths) {
+    size_t programs = 0, expressions = 0, differences = 0;
+    size_t pointer_bytes = 0, pool_bytes = 0;
+    for (int i = 0; i < count; i++) {
+        size_t length;
+        char *data = read_file(paths[i], &length);
+        if (data) {
+            programs += round_trip_source(data, length, 1, &expressions,
+                                          &differences, &pointer_bytes,
+                                          &pool_bytes);
+        }
+        free(data);
+    }
+    printf("  %zu programs, %zu expressions: %zu bytes as trees, %zu in "
+           "pools\n",
+           programs, expressions, pointer_bytes, pool_bytes);
+    check(programs > 0 && differences == 0,
+          "corpus expressions come back unchanged, scopes included");
+}
+
+/**
+ * @brief Tells whether two pool trees are equal, without recursion.
+ */
+static int same_tree(const ExprPool *a, ExprId id_a, const ExprPool *b,
+                     ExprId id_b) {
+    size_t capacity = 64, depth = 0;
+    ExprId *stack = malloc(capacity * 2 * sizeof(ExprId));
+    int same = stack != NULL;
+    if (same) {
+        stack[depth * 2] = id_a;
+        stack[depth * 2 + 1] = id_b;
+        depth++;
+    }
+    while (same && depth > 0) {
+        depth--;
+        id_a = stack[depth * 2];
+        id_b = stack[depth * 2 + 1];
+        ExprNodeType kind = expr_pool_kind(a, id_a);
+        same = kind == expr_pool_kind(b, id_b);
+        if (!same || kind != EXPR_BINARY_OP) {
+            same = same && (kind != EXPR_NUM_LITERAL ||
+                            expr_pool_number(a, id_a) ==
+                                expr_pool_number(b, id_b));
+            continue;
+        }
+        same = expr_pool_op(a, id_a) == expr_pool_op(b, id_b);
+        if (depth + 2 > capacity) {
+            capacity *= 2;
+            stack = realloc(stack, capacity * 2 * sizeof(ExprId));
+            if (!stack) {
+                abort();
+            }
+        }
+        stack[depth * 2] = expr_pool_left(a, id_a);
+        stack[depth * 2 + 1] = expr_pool_left(b, id_b);
+        stack[depth * 2 + 2] = expr_pool_right(a, id_a);
+        stack[depth * 2 + 3] = expr_pool_right(b, id_b);
+        depth += 2;
+    }
+    free(stack);
+    return same;
+}
+
+static void test_deep_chain(void) {
+    ExprPool pool = {0};
+    size_t length = 100000;
+    ExprId chain = expr_pool_identifier(&pool, "a");
+    for (size_t i = 0; i < length; i++) {
+        chain = expr_pool_binary_op(&pool, i % 2 ? OP_ADD : OP_MUL, chain,
+                                    expr_pool_num_literal(&pool, (double)i));
+    }
+    ExprNode *tree = expr_pool_to_tree(&pool, chain);
+    ExprPool copy = {0};
+    ExprId copied = expr_pool_add_tree(&copy, tree);
+    check(tree && copied != EXPR_NONE && copy.count == pool.count &&
+              copy.number_count == length &&
+              same_tree(&pool, chain, &copy, copied),
+          "100k operators deep, both ways");
+    expr_pool_free(&pool);
+    expr_pool_free(&copy);
+    phase_arenas_free_all();
+    intern_free_all();
+}
+
+/**
+ * @brief One function assigning the expressions of an expression test
+ * program over and over.
+ */
+static void test_expression_heavy(void) {
+    size_t length;
+    char *data = read_file("test/codes-OK/test112_expression_stress_0.wren",
+                           &length);
+    if (!data) {
+        check(0, "expression-heavy program");
+        return;
+    }
+    Text source = {0};
+    append(&source, "import \"ifj25\" for Ifj\n"
+                    "class Program {\n"
+                    "    static main() {\n"
+                    "        var x\n"
+                    "        var a\n"
+                    "        var b\n"
+                    "        var c\n");
+    for (int copy = 0; copy < 2000; copy++) {
+        for (const char *line = data; *line;) {
+            size_t n = strcspn(line, "\n");
+            const char *equals = memchr(line, '=', n);
+            if (equals && equals[1] == ' ' && equals[-1] == ' ' &&
+                !memchr(line, '(', (size_t)(equals - line)) &&
+                !memchr(equals, '.', n - (size_t)(equals - line))) {
+                append(&source, "        x %.*s\n", (int)(n - (equals - line)),
+                       equals);
+            }
+            line += n + (line[n] == '\n');
+        }
+    }
+    append(&source, "    }\n"
+                    "}\n");
+    size_t expressions = 0, differences = 0, pointer_bytes = 0,
+           pool_bytes = 0;
+    int parsed = round_trip_source(source.data, source.length, 0,
+                                   &expressions, &differences,
+                                   &pointer_bytes, &pool_bytes);
+    printf("  %zu expressions: %zu bytes as trees, %zu in one pool "
+           "(%.1f%%)\n",
+           expressions, pointer_bytes, pool_bytes,
+           pointer_bytes ? 100.0 * pool_bytes / pointer_bytes : 0.0);
+    check(parsed && differences == 0 && pool_bytes < pointer_bytes,
+          "expression-heavy program takes less room in a pool");
+    free(source.data);
+    free(data);
+}
+
+int main(int argc, char **argv) {
+    // Keep the messages of programs that do not compile out of the log
+    if (!freopen("/dev/null", "w", stderr)) {
+        return 1;
+    }
+    printf("=== Compact expression pool ===\n");
+    test_layout_and_sharing();
+
+    glob_t corpus = {0};
+    if (argc > 1) {
+        test_corpus(argc - 1, argv + 1);
+    } else {
+        glob("test/codes-OK/*.wren", 0, NULL, &corpus);
+        glob("test/codes-COMPLET/*.wren", GLOB_APPEND, NULL, &corpus);
+        test_corpus((int)corpus.gl_pathc, corpus.gl_pathv);
+        globfree(&corpus);
+    }
+    test_deep_chain();
+    test_expression_heavy();
+
+    return tests_summary();
+}
@@ -0,0 +1,268 @@
+/**
+ * @file test_lazy_bodies.c
+ * @author xcernoj00
+ * @brief Test of lazy function bodies (Ifj25Context.lazy_bodies).
+ *
+ * Small programs check that functions are parsed, analyzed and generated
+ * exactly when a call reaches them (before or after main, through other
+ * functions, recursively, from a getter), that errors in called bodies are
+ * reported with their usual codes while uncalled bodies are ignored, and
+ * that redefinitions are still reported from the signatures. A generated
+ * program with many uncalled helpers is then compiled eagerly and lazily,
+ * sequentially and on threads, and the times are printed.
+ *
+ * Usage: ./test_lazy_bodies [helpers]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "ifj25.h"
+#include "test_util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Compiles `source` with the options of `ctx`; returns the generated
+ * code (caller frees).
+ */
+static char *compile(Ifj25Context *ctx, const char *source, size_t length,
+                     int *status) {
+    char *code = NULL;
+    size_t code_length;
+    FILE *sink = open_memstream(&code, &code_length);
+    *status = ifj25_compile(ctx, source, length, sink);
+    fclose(sink);
+    return code;
+}
+
+/**
+ * @brief Compiles a program eagerly and lazily and checks both statuses.
+ * @param generated Functions that must have code in lazy mode ("a$1 b$0"),
+ * the others must not.
+ */
+static void expect(const char *name, const char *program, int eager,
+                   int lazy, const char *generated, const char *skipped) {
+    Ifj25Context ctx;
+    ifj25_context_init(&ctx);
+    int status;
+    free(compile(&ctx, program, strlen(program), &status));
+    int ok = status == eager;
+
+    ctx.lazy_bodies = true;
+    char *code = compile(&ctx, program, strlen(program), &status);
+    ok = ok && status == lazy;
+    char label[64];
+    for (int pass = 0; pass < 2 && status == NO_ERROR; pass++) {
+        const char *names = pass == 0 ? generated : skipped;
+        while (names && *names) {
+            size_t length = strcspn(names, " ");
+            snprintf(label, sizeof(label), "LABEL $func_%.*s\n", (int)length,
+                     names);
+            ok = ok && (strstr(code, label) != NULL) == (pass == 0);
+            names += length + (names[length] == ' ');
+        }
+    }
+    free(code);
+    check(ok, name);
+}
+
+static const char *reachable =
+    "import \"ifj25\" for Ifj\n"
+    "class Program {\n"
+    "    static before(x) {\n"
+    "        var y\n"
+    "        y = after(x)\n"
+    "        return y\n"
+    "    }\n"
+    "    static unused(a) {\n"
+    "        var = = =\n"
+    "    }\n"
+    "    static value {\n"
+    "        fromGetter()\n"
+    "        return 1\n"
+    "    }\n"
+    "    static main() {\n"
+    "        var r\n"
+    "        r = before(3)\n"
+    "        r = sum(4)\n"
+    "        Ifj.write(r)\n"
+    "    }\n"
+    "    static after(y) {\n"
+    "        return y + 1\n"
+    "    }\n"
+    "    static sum(n) {\n"
+    "        if (n < 1) {\n"
+    "            return 0\n"
+    "        } else {\n"
+    "            var m\n"
+    "            m = sum(n - 1)\n"
+    "            return n + m\n"
+    "        }\n"
+    "    }\n"
+    "    static fromGetter() {\n"
+    "        return 1\n"
+    "    }\n"
+    "    static alsoUnused() {\n"
+    "        unused(1)\n"
+    "    }\n"
+    "}\n";
+
+static const char *called_syntax_error =
+    "import \"ifj25\" for Ifj\n"
+    "class Program {\n"
+    "    static f() {\n"
+    "        var = = =\n"
+    "    }\n"
+    "    static main() {\n"
+    "        f()\n"
+    "    }\n"
+    "}\n";
+
+static const char *called_semantic_error =
+    "import \"ifj25\" for Ifj\n"
+    "class Program {\n"
+    "    static f() {\n"
+    "        g(1)\n"
+    "    }\n"
+    "    static main() {\n"
+    "        f()\n"
+    "    }\n"
+    "    static g(a) {\n"
+    "        undefined = a\n"
+    "    }\n"
+    "}\n";
+
+static const char *uncalled_overload =
+    "import \"ifj25\" for Ifj\n"
+    "class Program {\n"
+    "    static main() {\n"
+    "        f()\n"
+    "    }\n"
+    "    static f() {\n"
+    "        g(1)\n"
+    "    }\n"
+    "    static g() {\n"
+    "        undefined = 1\n"
+    "    }\n"
+    "    static g(a) {\n"
+    "        return a\n"
+    "    }\n"
+    "    static h() {\n"
+    "        undefined = 1\n"
+    "    }\n"
+    "}\n";
+
+static const char *redefined =
+    "import \"ifj25\" for Ifj\n"
+    "class Program {\n"
+    "    static main() {\n"
+    "    }\n"
+    "    static f(a) {\n"
+    "    }\n"
+    "    static f(b) {\n"
+    "    }\n"
+    "}\n";
+
+static const char *unclosed =
+    "import \"ifj25\" for Ifj\n"
+    "class Program {\n"
+    "    static main() {\n"
+    "    }\n"
+    "    static f(a) {\n"
+    "        if (a) {\n"
+    "    }\n"
+    "}\n";
+
+/**
+ * @brief Appends `count` uncalled helpers and a main calling the first one.
+ */
+static char *helpers_program(size_t count, size_t *length) {
+    size_t capacity = 512 + count * 256;
+    char *source = malloc(capacity);
+    if (!source) {
+        abort();
+    }
+    size_t n = (size_t)snprintf(source, capacity,
+                                "import \"ifj25\" for Ifj\n"
+                                "class Program {\n");
+    for (size_t i = 0; i < count; i++) {
+        n += (size_t)snprintf(source + n, capacity - n,
+                              "    static helper%zu(a, b) {\n"
+                              "        var c\n"
+                              "        c = (a + %zu) * (b - 1) / 2\n"
+                              "        while (c > 100) {\n"
+                              "            c = c - 100\n"
+                              "        }\n"
+                              "        return c\n"
+                              "    }\n",
+                              i, i);
+    }
+    n += (size_t)snprintf(source + n, capacity - n,
+                          "    static main() {\n"
+                          "        var x\n"
+                          "        x = helper0(1, 2)\n"
+                          "        Ifj.write(x)\n"
+                          "    }\n"
+                          "}\n");
+    *length = n;
+    return source;
+}
+
+static void test_helpers(size_t count) {
+    size_t length;
+    char *source = helpers_program(count, &length);
+    const char *names[] = {"eager", "lazy", "eager, 4 threads",
+                           "lazy, 4 threads"};
+    size_t code_length[4];
+    int ok = 1;
+    for (int mode = 0; mode < 4; mode++) {
+        Ifj25Context ctx;
+        ifj25_context_init(&ctx);
+        ctx.lazy_bodies = mode % 2;
+        ctx.parse_threads = mode >= 2 ? 4 : 1;
+        int status;
+        double t0 = now_seconds();
+        char *code = compile(&ctx, source, length, &status);
+        printf("  %-18s %9zu bytes %8.3f s\n", names[mode], length,
+               now_seconds() - t0);
+        code_length[mode] = strlen(code);
+        ok = ok && status == NO_ERROR &&
+             (strstr(code, "LABEL $func_helper1$2\n") != NULL) == !ctx.lazy_bodies &&
+             strstr(code, "LABEL $func_helper0$2\n") != NULL;
+        free(code);
+    }
+    check(ok && code_length[1] == code_length[3] &&
+              code_length[1] < code_length[0],
+          "uncalled helpers are neither parsed nor generated");
+    free(source);
+}
+
+int main(int argc, char **argv) {
+    size_t helpers = argc > 1 ? (size_t)atol(argv[1]) : 1000;
+
+    // Keep the expected error messages of failing programs out of the log
+    if (!freopen("/dev/null", "w", stderr)) {
+        return 1;
+    }
+
+    printf("=== Lazy function bodies ===\n");
+    expect("reached bodies are generated, others skipped", reachable,
+           SYNTAX_ERROR, NO_ERROR, "before$1 after$1 sum$1 fromGetter$0",
+           "unused$1 alsoUnused$0");
+    expect("syntax error in a called body", called_syntax_error,
+           SYNTAX_ERROR, SYNTAX_ERROR, NULL, NULL);
+    expect("semantic error in a body reached through a call",
+           called_semantic_error, SEM_ERROR_UNDEFINED, SEM_ERROR_UNDEFINED,
+           NULL, NULL);
+    expect("errors in uncalled overloads are not reported",
+           uncalled_overload, SEM_ERROR_UNDEFINED, NO_ERROR, "f$0 g$1",
+           "g$0 h$0");
+    expect("redefinition in uncalled functions", redefined,
+           SEM_ERROR_REDEFINED, SEM_ERROR_REDEFINED, NULL, NULL);
+    expect("unclosed body", unclosed, SYNTAX_ERROR, SYNTAX_ERROR, NULL,
+           NULL);
+    test_helpers(helpers);
+
+    return tests_summary();
+}
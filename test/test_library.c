@@ -0,0 +1,169 @@
+/**
+ * @file test_library.c
+ * @author xcernoj00
+ * @brief Test of the reentrant compiler library (libifj25.a).
+ *
+ * Every program given on the command line is compiled in one process:
+ * 1. twice in a row, both results (status and generated code) must be the
+ *    same, so no state survives a compilation;
+ * 2. from memory and from a stream, with --lex-first and with a scanner
+ *    thread (--pipeline), again with the same results;
+ * 3. by several threads at once, each compiling all programs several
+ *    times, again with the same results.
+ *
+ * Usage: ./test_library file.wren...
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "ifj25.h"
+#include "test_util.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define THREADS 4
+#define ROUNDS 3
+
+typedef struct {
+    const char *path;
+    char *source;
+    size_t length;
+    int status;   ///< status of the first compilation
+    char *code;   ///< code generated by the first compilation
+    size_t code_length;
+} Program;
+
+static Program *programs;
+static int program_count;
+static int failures = 0;
+static pthread_mutex_t failures_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void fail(const char *what, const Program *program) {
+    pthread_mutex_lock(&failures_lock);
+    if (failures < 10) {
+        printf("FAIL: %s: %s\n", program->path, what);
+    }
+    failures++;
+    pthread_mutex_unlock(&failures_lock);
+}
+
+/**
+ * @brief Compile a program from memory (or from a stream over the same
+ *        bytes) and return the generated code (caller frees).
+ */
+static char *compile(Ifj25Context *ctx, const Program *program, bool stream,
+                     int *status, size_t *length) {
+    char *code = NULL;
+    FILE *sink = open_memstream(&code, length);
+    if (stream) {
+        FILE *source = fmemopen(program->source, program->length, "rb");
+        *status = ifj25_compile_file(ctx, source, sink);
+        fclose(source);
+    } else {
+        *status = ifj25_compile(ctx, program->source, program->length, sink);
+    }
+    fclose(sink);
+    return code;
+}
+
+static void verify(Ifj25Context *ctx, const Program *program, bool stream,
+                   const char *label) {
+    int status;
+    size_t length;
+    char *code = compile(ctx, program, stream, &status, &length);
+    if (status != program->status) {
+        fail(label, program);
+    } else if (length != program->code_length ||
+               memcmp(code, program->code, length) != 0) {
+        fail(label, program);
+    }
+    free(code);
+}
+
+static void *compile_all(void *arg) {
+    Ifj25Context ctx;
+    ifj25_context_init(&ctx);
+    ctx.lex_first = (arg != NULL);
+    ctx.pipelined = (arg == NULL);
+    for (int round = 0; round < ROUNDS; round++) {
+        for (int i = 0; i < program_count; i++) {
+            verify(&ctx, &programs[i], (i + round) % 2, "differs on a thread");
+        }
+    }
+    if (ctx.compiled != (size_t)(ROUNDS * program_count)) {
+        fail("compilations not counted", &programs[0]);
+    }
+    return NULL;
+}
+
+int main(int argc, char **argv) {
+    Ifj25Context ctx;
+    ifj25_context_init(&ctx);
+
+    // Keep the expected error messages of failing programs out of the log
+    if (!freopen("/dev/null", "w", stderr)) {
+        return 1;
+    }
+
+    program_count = argc - 1;
+    programs = calloc(program_count > 0 ? program_count : 1, sizeof(Program));
+    for (int i = 0; i < program_count; i++) {
+        Program *program = &programs[i];
+        program->path = argv[i + 1];
+        program->source = read_file(program->path, &program->length);
+        if (!program->source) {
+            printf("FAIL: cannot read %s\n", program->path);
+            return 1;
+        }
+        program->code = compile(&ctx, program, false, &program->status,
+                                &program->code_length);
+        if (program->status != ctx.status ||
+            (program->status != NO_ERROR) !=
+                (ctx.failed_phase != IFJ25_PHASE_NONE)) {
+            fail("status not recorded in the context", program);
+        }
+    }
+
+    // Same process, same results
+    for (int i = 0; i < program_count; i++) {
+        verify(&ctx, &programs[i], false, "second compilation differs");
+        verify(&ctx, &programs[i], true, "compilation from a stream differs");
+        ctx.lex_first = true;
+        verify(&ctx, &programs[i], false, "--lex-first compilation differs");
+        ctx.lex_first = false;
+        ctx.pipelined = true;
+        verify(&ctx, &programs[i], true, "--pipeline compilation differs");
+        ctx.pipelined = false;
+        ctx.parse_threads = 4;
+        verify(&ctx, &programs[i], false, "--parse-threads compilation differs");
+        ctx.parse_threads = 0;
+    }
+
+    // Several threads at once
+    pthread_t threads[THREADS];
+    for (int t = 0; t < THREADS; t++) {
+        pthread_create(&threads[t], NULL, compile_all,
+                       t % 2 ? (void *)&ctx : NULL);
+    }
+    for (int t = 0; t < THREADS; t++) {
+        pthread_join(threads[t], NULL);
+    }
+
+    int ok = 0;
+    for (int i = 0; i < program_count; i++) {
+        ok += programs[i].status == NO_ERROR;
+        free(programs[i].source);
+        free(programs[i].code);
+    }
+    free(programs);
+    if (failures) {
+        printf("%d failure(s)\n", failures);
+        return 1;
+    }
+    printf("%d programs (%d compiled cleanly) give the same results in one "
+           "process and on %d threads\n",
+           program_count, ok, THREADS);
+    return 0;
+}
@@ -0,0 +1,332 @@
+/**
+ * @file test_numeric.c
+ * @author xcernoj00
+ * @brief Round-trip test of the one-pass numeric literal scanner.
+ *
+ * 1. Every decimal literal built from mantissas 0..9999, every decimal
+ *    point position and exponents -30..30 is scanned and compared bit for
+ *    bit with strtod.
+ * 2. Random doubles printed with 1 to 17 significant digits, in %g and %e
+ *    form and with a sign, must scan to exactly what strtod returns (and
+ *    with 17 digits, to the original value).
+ * 3. Decimal and hex integers, including overflowing ones, must match the
+ *    `(int)strtol` results the scanner always produced.
+ * 4. Literals with unusual neighbours are compared token by token with the
+ *    frozen stream-based scanner, and malformed literals must be rejected.
+ *
+ * Usage: ./test_numeric
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "intern.h"
+#include "legacy_scanner.h"
+#include "scanner.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LITERAL_MAX 64
+
+/**
+ * @brief Batch of literals scanned in one scanner pass.
+ */
+typedef struct {
+    char *text;      ///< literals separated by spaces
+    size_t length;   ///< used bytes of `text`
+    size_t capacity; ///< allocated bytes of `text`
+    size_t *starts;  ///< offset of each literal inside `text`
+    size_t count;    ///< number of literals in the batch
+    size_t max_count;
+} Batch;
+
+static long checked = 0;
+static int failures = 0;
+
+static void batch_init(Batch *batch, size_t max_count) {
+    batch->capacity = max_count * (LITERAL_MAX + 1);
+    batch->text = malloc(batch->capacity);
+    batch->starts = malloc(max_count * sizeof(size_t));
+    batch->max_count = max_count;
+    batch->length = 0;
+    batch->count = 0;
+}
+
+static void batch_free(Batch *batch) {
+    free(batch->text);
+    free(batch->starts);
+}
+
+static uint64_t bits_of(double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+/**
+ * @brief Scan all literals of the batch and compare each with strtod or
+ *        strtol, then empty the batch.
+ */
+static void batch_check(Batch *batch) {
+    Scanner scanner;
+    Token token;
+
+    if (scanner_init_buffer(&scanner, batch->text, batch->length) !=
+        NO_ERROR) {
+        failures++;
+        return;
+    }
+    for (size_t i = 0; i < batch->count && failures < 10; i++) {
+        // strtod and strtol stop at the space after the literal
+        const char *literal = batch->text + batch->starts[i];
+        int length = (int)strcspn(literal, " ");
+        int rc = get_token(&scanner, &token);
+        bool is_hex = strncmp(literal, "0x", 2) == 0;
+        bool is_double = !is_hex && strpbrk(literal, ".eE ") - literal < length;
+
+        if (rc != NO_ERROR) {
+            printf("FAIL: '%.*s' rejected (%d)\n", length, literal, rc);
+            failures++;
+        } else if (is_double) {
+            double expect = strtod(literal, NULL);
+            if (token.type != TOKEN_DOUBLE ||
+                bits_of(token.value.decimal) != bits_of(expect)) {
+                printf("FAIL: '%.*s' scanned as %.17g, strtod gives %.17g\n",
+                       length, literal, token.value.decimal, expect);
+                failures++;
+            }
+        } else {
+            int expect = (int)strtol(literal, NULL, is_hex ? 16 : 10);
+            if (token.type != TOKEN_INTEGER || token.value.integer != expect) {
+                printf("FAIL: '%.*s' scanned as %d, expected %d\n", length,
+                       literal, token.value.integer, expect);
+                failures++;
+            }
+        }
+        checked++;
+    }
+    scanner_free(&scanner);
+    batch->length = 0;
+    batch->count = 0;
+}
+
+static void batch_add(Batch *batch, const char *literal) {
+    size_t n = strlen(literal);
+    if (batch->count == batch->max_count ||
+        batch->length + n + 1 > batch->capacity) {
+        batch_check(batch);
+    }
+    batch->starts[batch->count++] = batch->length;
+    memcpy(batch->text + batch->length, literal, n);
+    batch->text[batch->length + n] = ' ';
+    batch->length += n + 1;
+}
+
+static uint64_t random64(void) {
+    uint64_t value = 0;
+    for (int i = 0; i < 4; i++) {
+        value = (value << 16) ^ (uint64_t)(rand() & 0xFFFF);
+    }
+    return value;
+}
+
+static void test_exhaustive(Batch *batch) {
+    char literal[LITERAL_MAX];
+    char digits[8];
+
+    for (int mantissa = 0; mantissa < 10000; mantissa++) {
+        int length = snprintf(digits, sizeof(digits), "%d", mantissa);
+        // Decimal point after `point` digits, no point at all when -1
+        for (int point = -1; point <= length; point++) {
+            char number[16];
+            if (point < 0) {
+                snprintf(number, sizeof(number), "%s", digits);
+            } else if (point == 0) {
+                snprintf(number, sizeof(number), "0.%s", digits);
+            } else {
+                snprintf(number, sizeof(number), "%.*s.%s", point, digits,
+                         digits + point);
+            }
+            for (int exponent = -30; exponent <= 30; exponent++) {
+                snprintf(literal, sizeof(literal), "%se%d", number, exponent);
+                batch_add(batch, literal);
+            }
+            batch_add(batch, number);
+        }
+    }
+    batch_check(batch);
+}
+
+static void test_random_doubles(Batch *batch) {
+    char literal[LITERAL_MAX];
+
+    srand(12345);
+    for (int i = 0; i < 300000; i++) {
+        double value;
+        if (i % 3 == 0) {
+            // Any finite bit pattern, including subnormals
+            uint64_t bits = random64() & ~(UINT64_C(1) << 63);
+            memcpy(&value, &bits, sizeof(value));
+            if (!isfinite(value)) {
+                continue;
+            }
+        } else {
+            // Values of everyday magnitude
+            value = (double)random64() / (double)(UINT64_C(1) << (rand() % 64));
+        }
+        int precision = 1 + i % 17;
+        snprintf(literal, sizeof(literal), "%.*g", precision, value);
+        if (strchr(literal, '.') == NULL && strchr(literal, 'e') == NULL) {
+            strcat(literal, ".0"); // keep it a double literal
+        }
+        batch_add(batch, literal);
+        snprintf(literal, sizeof(literal), "-%.*e", precision - 1, value);
+        batch_add(batch, literal);
+
+        // 17 significant digits must reproduce the value exactly
+        snprintf(literal, sizeof(literal), "%.16e", value);
+        if (strtod(literal, NULL) != value) {
+            printf("FAIL: %%.16e does not round-trip for %a\n", value);
+            failures++;
+        }
+        batch_add(batch, literal);
+    }
+    batch_check(batch);
+}
+
+static void test_integers(Batch *batch) {
+    static const char *edges[] = {
+        "0",
+        "7",
+        "00012",
+        "2147483647",
+        "2147483648",
+        "4294967295",
+        "4294967296",
+        "9223372036854775807",
+        "9223372036854775808",
+        "18446744073709551615",
+        "18446744073709551616",
+        "99999999999999999999999999999",
+        "-1",
+        "-2147483648",
+        "-2147483649",
+        "-9223372036854775808",
+        "-9223372036854775809",
+        "-99999999999999999999999999999",
+        "0x0",
+        "0xff",
+        "0xFF",
+        "0x7fffffff",
+        "0x80000000",
+        "0xffffffff",
+        "0x100000000",
+        "0x7fffffffffffffff",
+        "0x8000000000000000",
+        "0xffffffffffffffffff",
+    };
+    char literal[LITERAL_MAX];
+
+    for (size_t i = 0; i < sizeof(edges) / sizeof(edges[0]); i++) {
+        batch_add(batch, edges[i]);
+    }
+    srand(777);
+    for (int i = 0; i < 200000; i++) {
+        uint64_t value = random64() >> (rand() % 64);
+        snprintf(literal, sizeof(literal), i % 2 ? "%llu" : "-%llu",
+                 (unsigned long long)value);
+        batch_add(batch, literal);
+        snprintf(literal, sizeof(literal), "0x%llx", (unsigned long long)value);
+        batch_add(batch, literal);
+    }
+    batch_check(batch);
+}
+
+/**
+ * @brief Compare full token streams with the frozen scanner.
+ */
+static void test_against_legacy(void) {
+    static const char *sources[] = {
+        "12abc", "1..2", "-0x1F", "00x5", "0x1g", "1.e5", "1.5e+3e2",
+        "1e5e", "3.", "-3.", "-0.0", "0.000000000000000000000000001",
+        "1234567890123456789012345678901234567890.5",
+        "179769313486231570814527423731704356798070e267", "2.5E-3 -7 x-1",
+        "0.1+0.2", "4.9406564584124654e-324", "1e400", "-1e-400",
+    };
+
+    for (size_t i = 0; i < sizeof(sources) / sizeof(sources[0]); i++) {
+        const char *source = sources[i];
+        size_t length = strlen(source);
+        FILE *f = fmemopen((void *)source, length, "r");
+        Scanner scanner;
+        Token token;
+        LegacyToken expect;
+
+        legacy_set_source_file(f);
+        scanner_init_buffer(&scanner, source, length);
+        while (1) {
+            int rc = get_token(&scanner, &token);
+            int expect_rc = legacy_get_token(&expect);
+            bool same = rc == expect_rc && token.type == expect.type;
+            if (same && token.type == TOKEN_INTEGER) {
+                same = token.value.integer == expect.value.integer;
+            } else if (same && token.type == TOKEN_DOUBLE) {
+                same = bits_of(token.value.decimal) ==
+                       bits_of(expect.value.decimal);
+            }
+            if (expect.type == TOKEN_IDENTIFIER) {
+                d_string_free(expect.value.string);
+                free(expect.value.string);
+            }
+            if (!same) {
+                printf("FAIL: '%s' scans differently than before\n", source);
+                failures++;
+                break;
+            }
+            checked++;
+            if (rc != NO_ERROR || token.type == TOKEN_EOF) {
+                break;
+            }
+        }
+        scanner_free(&scanner);
+        fclose(f);
+    }
+}
+
+static void test_malformed(void) {
+    static const char *sources[] = {"0x", "0xg", "1e", "1e+", "1.5E-", "2ex"};
+
+    for (size_t i = 0; i < sizeof(sources) / sizeof(sources[0]); i++) {
+        Scanner scanner;
+        Token token;
+        scanner_init_buffer(&scanner, sources[i], strlen(sources[i]));
+        if (get_token(&scanner, &token) != SCANNER_ERROR) {
+            printf("FAIL: '%s' accepted\n", sources[i]);
+            failures++;
+        }
+        scanner_free(&scanner);
+        checked++;
+    }
+}
+
+int main(void) {
+    Batch batch;
+    batch_init(&batch, 65536);
+
+    test_exhaustive(&batch);
+    test_random_doubles(&batch);
+    test_integers(&batch);
+    test_against_legacy();
+    test_malformed();
+
+    batch_free(&batch);
+    intern_free_all();
+    if (failures) {
+        printf("%d failure(s)\n", failures);
+        return 1;
+    }
+    printf("All %ld numeric literals match strtod/strtol\n", checked);
+    return 0;
+}
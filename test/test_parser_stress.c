@@ -0,0 +1,197 @@
+/**
+ * @file test_parser_stress.c
+ * @author xcernoj00
+ * @brief Parser stress test: deep nesting and very long functions.
+ *
+ * Parses a program with 100k nested blocks (and one with 100k nested if
+ * statements) and a function with 1M statements on the default stack, and
+ * checks the shape of the resulting AST. The parser keeps its own stack, so
+ * neither depth nor length may exhaust the C stack.
+ *
+ * The nested if statements and the long function are then compiled, to
+ * check that semantic analysis and code generation (which walk the AST
+ * with ast_walk) do not exhaust it either.
+ *
+ * Usage: ./test_parser_stress [depth] [statements]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "arena.h"
+#include "ast.h"
+#include "ifj25.h"
+#include "intern.h"
+#include "parser.h"
+#include "scanner.h"
+#include "test_util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *prolog = "import \"ifj25\" for Ifj\n"
+                            "class Program {\n"
+                            "    static main() {\n";
+static const char *epilog = "    }\n"
+                            "}\n";
+
+/**
+ * @brief Parses `source`; returns the body block of main or NULL.
+ */
+static ASTNode *parse(const Text *source, const char *name) {
+    Scanner scanner;
+    if (scanner_init_buffer(&scanner, source->data, source->length) !=
+        NO_ERROR) {
+        return NULL;
+    }
+    ASTNode *program = create_ast_node(AST_PROGRAM, NULL);
+    double t0 = now_seconds();
+    int rc = program ? parser(&scanner, program) : ERROR_INTERNAL;
+    printf("  %-28s %9zu bytes %8.3f s\n", name, source->length,
+           now_seconds() - t0);
+    scanner_free(&scanner);
+    if (rc != NO_ERROR) {
+        printf("  parser returned %d\n", rc);
+        return NULL;
+    }
+    ASTNode *main_function = program->left;
+    if (!main_function || main_function->type != AST_FUNC_DEF) {
+        return NULL;
+    }
+    return main_function->right;
+}
+
+static void finish_parse(void) {
+    phase_arenas_free_all();
+    intern_free_all();
+}
+
+/**
+ * @brief Compiles `source`; returns the number of generated lines that
+ * start with `prefix`, or -1 when the compilation fails.
+ */
+static long compile(const Text *source, const char *name,
+                    const char *prefix) {
+    FILE *sink = tmpfile();
+    if (!sink) {
+        return -1;
+    }
+    Ifj25Context ctx;
+    ifj25_context_init(&ctx);
+    double t0 = now_seconds();
+    int rc = ifj25_compile(&ctx, source->data, source->length, sink);
+    printf("  %-28s %9zu bytes %8.3f s\n", name, source->length,
+           now_seconds() - t0);
+    if (rc != NO_ERROR) {
+        printf("  compilation failed in %s: %d\n",
+               ifj25_phase_name(ctx.failed_phase), rc);
+        fclose(sink);
+        return -1;
+    }
+
+    long count = 0;
+    size_t length = strlen(prefix);
+    char line[256];
+    rewind(sink);
+    while (fgets(line, sizeof(line), sink)) {
+        if (strncmp(line, prefix, length) == 0) {
+            count++;
+        }
+    }
+    fclose(sink);
+    return count;
+}
+
+static void test_nested_blocks(size_t depth) {
+    Text source = {0};
+    append(&source, "%s", prolog);
+    repeat(&source, "{\n", depth);
+    append(&source, "var x\n");
+    repeat(&source, "}\n", depth);
+    append(&source, "%s", epilog);
+
+    ASTNode *block = parse(&source, "nested blocks");
+    size_t levels = 0;
+    // main { {...} }: each block holds the next one as its only statement
+    while (block && block->type == AST_BLOCK && block->left &&
+           block->left->type == AST_BLOCK && block->left->right == NULL) {
+        block = block->left;
+        levels++;
+    }
+    check(levels == depth && block && block->left &&
+              block->left->type == AST_VAR_DECL,
+          "100k nested blocks");
+    finish_parse();
+    free(source.data);
+}
+
+static void test_nested_ifs(size_t depth) {
+    Text source = {0};
+    append(&source, "%s", prolog);
+    append(&source, "var x\n");
+    // Constant conditions: looking x up through all the enclosing scopes
+    // would make the compilation quadratic in the depth
+    repeat(&source, "if (1) {\n", depth);
+    append(&source, "x = 1\n");
+    repeat(&source, "} else {\n}\n", depth);
+    append(&source, "%s", epilog);
+
+    ASTNode *block = parse(&source, "nested if statements");
+    size_t levels = 0;
+    ASTNode *statement = block && block->left ? block->left->right : NULL;
+    // if -> then block -> if -> then block ...
+    while (statement && statement->type == AST_IF && statement->right &&
+           statement->right->type == AST_BLOCK && statement->right->right &&
+           statement->right->right->type == AST_ELSE) {
+        statement = statement->right->left;
+        levels++;
+    }
+    check(levels == depth && statement && statement->type == AST_ASSIGN,
+          "100k nested if statements");
+    finish_parse();
+
+    check(compile(&source, "compile nested ifs", "LABEL $endif") ==
+              (long)depth,
+          "compile 100k nested if statements");
+    free(source.data);
+}
+
+static void test_long_function(size_t statements) {
+    Text source = {0};
+    append(&source, "%s", prolog);
+    append(&source, "var x\n");
+    repeat(&source, "x = x + 1\n", statements);
+    append(&source, "%s", epilog);
+
+    ASTNode *block = parse(&source, "long function");
+    size_t count = 0;
+    for (ASTNode *statement = block ? block->left : NULL; statement;
+         statement = statement->right) {
+        count++;
+    }
+    check(count == statements + 1, "1M statements in one function");
+    finish_parse();
+    free(source.data);
+
+    // Constant values keep the generated code at a few lines a statement
+    Text program = {0};
+    append(&program, "%s", prolog);
+    append(&program, "var x\n");
+    repeat(&program, "x = 1\n", statements);
+    append(&program, "%s", epilog);
+    check(compile(&program, "compile long function", "POPS LF@x") ==
+              (long)statements,
+          "compile 1M statements in one function");
+    free(program.data);
+}
+
+int main(int argc, char **argv) {
+    size_t depth = argc > 1 ? (size_t)atol(argv[1]) : 100000;
+    size_t statements = argc > 2 ? (size_t)atol(argv[2]) : 1000000;
+
+    printf("=== Parser stress tests ===\n");
+    test_nested_blocks(depth);
+    test_nested_ifs(depth);
+    test_long_function(statements);
+
+    return tests_summary();
+}
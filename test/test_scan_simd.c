@@ -0,0 +1,205 @@
+/**
+ * @file test_scan_simd.c
+ * @author xcernoj00
+ * @brief Differential test of the vectorized scanner kernels.
+ *
+ * 1. Every kernel set the CPU supports is compared with the scalar kernels
+ *    on random buffers, for every start offset and several end offsets.
+ * 2. Whole token streams (type, payload, location and return code) are
+ *    compared between the scalar and the best kernel set, on random
+ *    comment- and string-heavy programs and on every file given on the
+ *    command line.
+ *
+ * Usage: ./test_scan_simd [file.wren...]
+ */
+
+#include "intern.h"
+#include "scan_simd.h"
+#include "scanner.h"
+#include "test_util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_TOKENS 200000
+
+typedef struct {
+    Token token;
+    int rc;
+    size_t position;
+    unsigned line;
+    unsigned column;
+} TokenRecord;
+
+static int failures = 0;
+
+static int test_kernels(void) {
+    static const char alphabet[] = "  \t\r\v\f\n**//\"\\ax9_\x80\xff";
+    char data[300];
+    int result = 0;
+
+    srand(42);
+    for (int round = 0; round < 200; round++) {
+        for (size_t i = 0; i < sizeof(data); i++) {
+            // Long runs of one byte exercise the full-width steps
+            data[i] = rand() % 4 ? ' ' : alphabet[rand() % (sizeof(alphabet) - 1)];
+            if (round % 3 == 1 && rand() % 8) {
+                data[i] = 'x';
+            }
+        }
+        for (ScanKernel k = SCAN_KERNEL_SSE2; k <= scan_kernel_best(); k++) {
+            for (size_t pos = 0; pos < sizeof(data); pos++) {
+                for (size_t end = pos; end <= sizeof(data); end += 7) {
+                    size_t expect[3], got[3];
+                    scan_kernel_select(SCAN_KERNEL_SCALAR);
+                    expect[0] = scan_skip_blanks(data, pos, end);
+                    expect[1] = scan_find_comment_mark(data, pos, end);
+                    expect[2] = scan_find_string_mark(data, pos, end);
+                    scan_kernel_select(k);
+                    got[0] = scan_skip_blanks(data, pos, end);
+                    got[1] = scan_find_comment_mark(data, pos, end);
+                    got[2] = scan_find_string_mark(data, pos, end);
+                    if (memcmp(expect, got, sizeof(expect)) != 0) {
+                        printf("FAIL: %s kernel differs at pos %zu end %zu\n",
+                               scan_kernel_name(k), pos, end);
+                        result = 1;
+                        goto done;
+                    }
+                }
+            }
+        }
+    }
+done:
+    scan_kernel_select(SCAN_KERNEL_COUNT);
+    return result;
+}
+
+/**
+ * @brief Tokenize a buffer with the given kernel set, stopping at EOF or at
+ *        the first error.
+ */
+static size_t tokenize(const char *data, size_t length, ScanKernel kernel,
+                       TokenRecord *records) {
+    Scanner scanner;
+    size_t count = 0;
+
+    scan_kernel_select(kernel);
+    if (scanner_init_buffer(&scanner, data, length) != NO_ERROR) {
+        return 0;
+    }
+    while (count < MAX_TOKENS) {
+        TokenRecord *record = &records[count++];
+        memset(record, 0, sizeof(*record)); // records are compared bytewise
+        record->rc = get_token(&scanner, &record->token);
+        record->position = scanner.position;
+        scanner_location(&scanner, scanner.token_start, &record->line,
+                         &record->column);
+        if (record->rc != NO_ERROR || record->token.type == TOKEN_EOF) {
+            break;
+        }
+    }
+    scanner_free(&scanner);
+    return count;
+}
+
+static void compare_streams(const char *label, const char *data,
+                            size_t length) {
+    static TokenRecord scalar[MAX_TOKENS], simd[MAX_TOKENS];
+    ScanKernel best = scan_kernel_best();
+
+    size_t n_scalar = tokenize(data, length, SCAN_KERNEL_SCALAR, scalar);
+    size_t n_simd = tokenize(data, length, best, simd);
+    if (n_scalar != n_simd) {
+        printf("FAIL: %s: %zu tokens with scalar, %zu with %s\n", label,
+               n_scalar, n_simd, scan_kernel_name(best));
+        failures++;
+        return;
+    }
+    for (size_t i = 0; i < n_scalar; i++) {
+        if (memcmp(&scalar[i], &simd[i], sizeof(TokenRecord)) != 0) {
+            printf("FAIL: %s: token %zu differs (line %u)\n", label, i,
+                   scalar[i].line);
+            failures++;
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Build a random program out of fragments that stress the kernels.
+ */
+static size_t random_program(char *out, size_t capacity) {
+    static const char *fragments[] = {
+        "var x = 1\n",
+        "    \t  \r\n",
+        "/* block * with / stars ** and // slashes */",
+        "/* nested /* inner */ still outer ***/ ",
+        "// line comment with \"quotes\" and /* marks\n",
+        "x = \"a long plain string literal without escapes at all\"\n",
+        "x = \"esc \\\" \\n \\t \\\\ \\x41 tail\"\n",
+        "x = \"\"\"multi\nline \"\" with \" quotes\n\"\"\"\n",
+        "if (a <= b) { return a / b * 2 }\n",
+        "                                          ",
+        "Ifj.write(\"\")\n",
+        "/**/",
+        "\"unterminated",
+        "/* unterminated",
+        "\"\"\"unterminated \"\"",
+        "\"bad \\q escape\"",
+        "\"line\nbreak\"",
+    };
+    size_t length = 0;
+    size_t fragment_count = sizeof(fragments) / sizeof(fragments[0]);
+    int pieces = 1 + rand() % 40;
+
+    for (int i = 0; i < pieces; i++) {
+        // Mostly valid fragments so streams get long before any error
+        size_t f = (size_t)rand() % (rand() % 10 ? fragment_count - 5
+                                                 : fragment_count);
+        size_t n = strlen(fragments[f]);
+        if (length + n >= capacity) {
+            break;
+        }
+        memcpy(out + length, fragments[f], n);
+        length += n;
+    }
+    return length;
+}
+
+int main(int argc, char **argv) {
+    printf("best kernel: %s\n", scan_kernel_name(scan_kernel_best()));
+
+    if (test_kernels() != 0) {
+        failures++;
+    }
+
+    char program[8192];
+    srand(7);
+    for (int i = 0; i < 5000 && failures == 0; i++) {
+        size_t length = random_program(program, sizeof(program));
+        char label[32];
+        snprintf(label, sizeof(label), "random #%d", i);
+        compare_streams(label, program, length);
+    }
+
+    for (int i = 1; i < argc; i++) {
+        size_t length;
+        char *data = read_file(argv[i], &length);
+        if (!data) {
+            printf("FAIL: cannot read %s\n", argv[i]);
+            failures++;
+            continue;
+        }
+        compare_streams(argv[i], data, length);
+        free(data);
+    }
+
+    intern_free_all();
+    if (failures) {
+        printf("%d failure(s)\n", failures);
+        return 1;
+    }
+    printf("All kernel and token stream comparisons passed (%d files)\n",
+           argc - 1);
+    return 0;
+}
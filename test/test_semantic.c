@@ -2,6 +2,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include "semantic.h"
+#include "arena.h"
 #include "ast.h"
 #include "expr_ast.h"   // For ExprNode creation helpers
 
@@ -229,7 +230,7 @@ while_stmt->right = while_body;
     int result = semantic_analyze(program);
     printf("Expected: %d, got: %d\n", NO_ERROR, result);
 
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result;
 }
 
@@ -277,7 +278,7 @@ int test_program3_basic_strings() {
     expr_str2->expr = create_string_literal_node(", ktery jeste trochu obohatime");
 
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result; // Should return NO_ERROR
 }
 
@@ -345,7 +346,7 @@ int test_program3_string_operations() {
     expr_combined->expr = add_expr;
 
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result; // Should return NO_ERROR
 }
 
@@ -381,7 +382,7 @@ int test_program3_builtin_write() {
     expr_arg2->expr = create_string_literal_node("\n");
 
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result; // Should return NO_ERROR
 }
 
@@ -431,7 +432,7 @@ int test_program3_read_and_null() {
     expr_empty->expr = create_string_literal_node("");
 
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result; // Should return NO_ERROR
 }
 
@@ -500,7 +501,7 @@ int test_program3_while_and_strcmp() {
     
     ASTNode* expr_arg1 = create_ast_node(AST_EXPRESSION, NULL);
     arg1->right = expr_arg1;
-    expr_arg1->expr = create_identifier_node("input");
+    expr_arg1->expr = create_string_literal_node("input");
     expr_arg1->expr->type = EXPR_STRING_LITERAL;
 
     // Second argument: "abcdefgh"
@@ -513,7 +514,7 @@ int test_program3_while_and_strcmp() {
     expr_arg2->expr->type = EXPR_STRING_LITERAL;
 
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result; // Should return NO_ERROR
 }
 
@@ -585,7 +586,7 @@ int test_program3_if_else_branching() {
     expr_arg2->expr = create_string_literal_node("Spatne zadana posloupnost, zkuste znovu:\n");
 
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result; // Should return NO_ERROR
 }
 
@@ -647,7 +648,7 @@ int test_program3_complete() {
     expr_read->left = call_read;
 
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result; // Should return NO_ERROR
 }
 
@@ -2,6 +2,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include "semantic.h"
+#include "arena.h"
 #include "ast.h"
 #include "expr_ast.h"
 
@@ -52,7 +53,7 @@ int test_single_variable() {
     var_decl->left = identifier;
     
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result; // Should return NO_ERROR
 }
 
@@ -78,7 +79,7 @@ int test_multiple_different_variables() {
     var_c->left = create_ast_node(AST_IDENTIFIER, "c");
     
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result; // Should return NO_ERROR
 }
 
@@ -99,7 +100,7 @@ int test_redeclaration_error() {
     var_x2->left = create_ast_node(AST_IDENTIFIER, "x");
     
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     
     // Test passes if we get redeclaration error
     return result;
@@ -133,7 +134,7 @@ int test_multiple_vars_same_block() {
     var_c->left = create_ast_node(AST_IDENTIFIER, "c");
     
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result; // Should return NO_ERROR
 }
 
@@ -164,7 +165,7 @@ int test_same_var_different_blocks() {
     var_x2->left = create_ast_node(AST_IDENTIFIER, "x");
     
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result; // Should return NO_ERROR
 }
 
@@ -191,7 +192,7 @@ int test_same_var_same_block() {
     var_y2->left = create_ast_node(AST_IDENTIFIER, "y");
     
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     
     // Test passes if we get redeclaration error
     return result;
@@ -220,7 +221,7 @@ int test_global_local_same_name() {
     local_var->left = create_ast_node(AST_IDENTIFIER, "z");
     
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result; // Should return NO_ERROR
 }
 
@@ -239,7 +240,7 @@ int test_func_simple_definition() {
     func->right = block;
 
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result; // NO_ERROR
 }
 
@@ -258,7 +259,7 @@ int test_func_redefinition_same_params() {
     func2->right = create_ast_node(AST_BLOCK, NULL);
 
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result;
 }
 
@@ -281,7 +282,7 @@ int test_func_duplicate_param() {
     func->right = create_ast_node(AST_BLOCK, NULL);
 
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result;
 }
 
@@ -304,7 +305,7 @@ int test_func_param_shadowed_by_var() {
     var_decl->left = create_ast_node(AST_IDENTIFIER, "x");
 
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result;
 }
 
@@ -321,7 +322,7 @@ int test_main_redefinition() {
     main2->right = create_ast_node(AST_BLOCK, NULL);
 
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result;
 }
 
@@ -340,7 +341,7 @@ int test_func_and_builtin_conflict() {
     func->right = create_ast_node(AST_BLOCK, NULL);
 
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result;
 }
 
@@ -366,7 +367,7 @@ int test_func_param_scope_shadowed_block_var() {
     var_decl->left = create_ast_node(AST_IDENTIFIER, "a");
 
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result; // NO_ERROR
 }
 
@@ -382,7 +383,7 @@ int test_simple_getter() {
     getter->right = block;
 
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result; // Should return NO_ERROR
 }
 
@@ -402,7 +403,7 @@ int test_simple_setter() {
     setter->right = block;
 
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result; // Should return NO_ERROR
 }
 
@@ -424,7 +425,7 @@ int test_getter_setter_same_name() {
     setter->right = create_ast_node(AST_BLOCK, NULL);
 
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result; // Should return NO_ERROR
 }
 
@@ -443,7 +444,7 @@ int test_getter_redefinition() {
     getter2->right = create_ast_node(AST_BLOCK, NULL);
 
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result;
 }
 
@@ -468,7 +469,7 @@ int test_setter_redefinition() {
     setter2->right = create_ast_node(AST_BLOCK, NULL);
 
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result;
 }
 
@@ -501,7 +502,7 @@ int test_getter_in_rhs() {
     expr->expr = create_identifier_node("g");
 
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result; // expect NO_ERROR
 }
 
@@ -536,7 +537,7 @@ int test_getter_in_binary_expr() {
     expr->expr = add;
 
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result; // expect NO_ERROR
 }
 
@@ -573,7 +574,7 @@ int test_getter_as_argument() {
     expr->expr = create_identifier_node("g");
 
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result; // expect NO_ERROR
 }
 
@@ -600,7 +601,7 @@ int test_getter_in_condition() {
     ifnode->right = thenb;
 
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result; // expect NO_ERROR
 }
 
@@ -630,7 +631,7 @@ int test_setter_call_simple() {
     expr->expr = create_num_literal_node(7.0);
 
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result; // Expect NO_ERROR
 }
 
@@ -661,7 +662,7 @@ int test_setter_call_type_mismatch() {
     expr->expr = create_num_literal_node(123.0);
 
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result; // Expect SEM_ERROR_TYPE_COMPATIBILITY
 }
 
@@ -688,7 +689,7 @@ int test_getter_setter_function_same_name() {
     setter->right = create_ast_node(AST_BLOCK, NULL);
 
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result; // Should return NO_ERROR
 }
 
@@ -735,7 +736,7 @@ int test_complex_getter_setter_program() {
     main_func->right = create_ast_node(AST_BLOCK, NULL);
 
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result; // Should return NO_ERROR
 }
 
@@ -757,7 +758,7 @@ int test_getter_inner_scope() {
     getter->right = create_ast_node(AST_BLOCK, NULL);
 
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result; // Should return NO_ERROR
 }
 
@@ -778,7 +779,7 @@ int test_func_call_simple() {
     func_call->right = NULL;
 
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result;
 }
 
@@ -792,7 +793,7 @@ int test_func_call_undefined() {
     func_call->right = NULL;
 
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result;
 }
 
@@ -828,7 +829,7 @@ int test_func_call_wrong_arg_count() {
     expr->expr = create_num_literal_node(1.0);
 
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result;
 }
 
@@ -873,7 +874,7 @@ int test_func_call_correct_arg_types() {
     expr2->expr = create_string_literal_node("hello");
 
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result;
 }
 
@@ -920,7 +921,7 @@ int test_func_call_wrong_arg_types() {
     expr2->expr = create_num_literal_node(123.0); // Should be string
 
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result;
 }
 
@@ -950,7 +951,7 @@ int test_func_call_chained() {
     call_bar->left = NULL;
 
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result;
 }
 
@@ -976,7 +977,7 @@ int test_simple_assignment() {
     expression->expr = create_num_literal_node(5.0);
 
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result;
 }
 
@@ -994,7 +995,7 @@ int test_assignment_undefined_var() {
     equals->expr = create_num_literal_node(10.0);
 
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result;
 }
 
@@ -1036,7 +1037,7 @@ int test_multiple_assignments() {
     expr2->expr = create_identifier_node("a");
 
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result;
 }
 
@@ -1063,7 +1064,7 @@ int test_use_uninitialized_var() {
     equals->expr = create_identifier_node("x"); // uninitialized!
 
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result;
 }
 
@@ -1116,7 +1117,7 @@ int test_assignment_different_scopes() {
     expression2->expr = create_num_literal_node(20.0);
 
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result;
 }
 
@@ -1184,7 +1185,7 @@ int test_chained_assignments() {
     expression3->expr = mul_expr;
 
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result;
 }
 
@@ -1217,7 +1218,7 @@ int test_assignment_to_parameter() {
     expression->expr = create_num_literal_node(5.0);
 
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result;
 }
 
@@ -1273,7 +1274,7 @@ int test_complex_nested_assignments() {
     expression2->expr = create_num_literal_node(42.0);
 
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result;
 }
 
@@ -1300,7 +1301,7 @@ int test_string_assignment() {
     expression->expr = create_string_literal_node("hello");
 
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result;
 }
 
@@ -1326,7 +1327,7 @@ int test_null_assignment() {
     expression->expr = create_null_literal_node();
 
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result;
 }
 
@@ -1352,7 +1353,7 @@ int test_simple_if() {
     if_stmt->right = then_block;
 
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result;
 }
 
@@ -1403,7 +1404,7 @@ int test_if_else() {
     else_stmt->right = else_block;
 
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result;
 }
 // Test 41: If with non-numeric condition - should fail (SEM_ERROR_TYPE_COMPATIBILITY)
@@ -1428,7 +1429,7 @@ int test_if_non_numeric_condition() {
     if_stmt->right = then_block;
 
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result;
 }
 
@@ -1450,7 +1451,7 @@ int test_return_with_value() {
     return_stmt->expr = create_num_literal_node(42.0);
 
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result;
 }
 
@@ -1472,7 +1473,7 @@ int test_void_return() {
     // No expr set - void return
 
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result;
 }
 
@@ -1500,7 +1501,7 @@ int test_return_with_expression() {
     return_stmt->expr = complex_expr;
 
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result;
 }
 
@@ -1559,7 +1560,7 @@ int test_complex_if_else_returns() {
     return2->expr = create_identifier_node("b");
 
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result;
 }
 
@@ -1627,7 +1628,7 @@ int test_nested_ifs() {
     if_inner->right = then_inner;
 
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result;
 }
 
@@ -1709,7 +1710,7 @@ int test_multiple_if_else() {
     return_zero->expr = create_num_literal_node(0.0);
 
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result;
 }
 
@@ -1731,7 +1732,7 @@ int test_return_string() {
     return_stmt->expr = create_string_literal_node("Hello");
 
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result;
 }
 
@@ -1753,7 +1754,7 @@ int test_return_null() {
     return_stmt->expr = create_null_literal_node();
 
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result;
 }
 
@@ -1902,7 +1903,7 @@ int test_complex_program_fixed() {
 
     printf("Expected: %d, got: %d\n", NO_ERROR, result);
 
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result;
 }
 
@@ -1952,7 +1953,7 @@ int test_global_var_simple() {
 
     int result = semantic_analyze(program);
     printf("Test 51 - Expected: %d, got: %d\n", NO_ERROR, result);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result;
 }
 
@@ -2045,7 +2046,7 @@ int test_global_var_multiple_funcs() {
 
     int result = semantic_analyze(program);
     printf("Test 52 - Expected: %d, got: %d\n", NO_ERROR, result);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result;
 }
 
@@ -2149,7 +2150,7 @@ int test_global_var_multiple_types() {
 
     int result = semantic_analyze(program);
     printf("Test 53 - Expected: %d, got: %d\n", NO_ERROR, result);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result;
 }
 // Test 54: Global variable in blocks and conditions (NO_ERROR)
@@ -2243,7 +2244,7 @@ int test_global_var_blocks_conditions() {
 
     int result = semantic_analyze(program);
     printf("Test 54 - Expected: %d, got: %d\n", NO_ERROR, result);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result;
 }
 
@@ -2278,7 +2279,7 @@ int test_same_functions() {
     func2->right = create_ast_node(AST_BLOCK, NULL);
 
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result;
 }
 
@@ -2372,7 +2373,7 @@ int test_substring_function() {
     assign_c->right = substring_call;
 
     int result = semantic_analyze(program);
-    free_ast_tree(program);
+    phase_arenas_free_all();
     return result;
 }
 
@@ -0,0 +1,156 @@
+/**
+ * @file test_string_escape.c
+ * @author xcernoj00
+ * @brief Differential test and benchmark of the IFJcode25 string escaper.
+ *
+ * Random strings full of escape-relevant bytes are converted with the
+ * run-based print_convert_string() and with the former per-character
+ * version kept below; the outputs must be byte-identical. Afterwards both
+ * are timed on a string-heavy workload.
+ *
+ * Usage: ./test_string_escape
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "generator.h"
+#include "test_util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief The per-character escaper print_convert_string() replaced.
+ */
+static void legacy_convert_string(const char *input, FILE *output) {
+    for (int i = 0; input[i] != '\0'; i++) {
+        unsigned char c = (unsigned char)input[i];
+        if (input[i] == '\\' && input[i + 1] != '\0') {
+            i++;
+            switch (input[i]) {
+            case 'n':
+                fprintf(output, "\\010");
+                break;
+            case 't':
+                fprintf(output, "\\009");
+                break;
+            case 's':
+                fprintf(output, "\\032");
+                break;
+            case '\\':
+                fprintf(output, "\\092");
+                break;
+            case '"':
+                fprintf(output, "\\034");
+                break;
+            case 'x':
+                if (input[i + 1] != '\0' && input[i + 2] != '\0') {
+                    char hex[3] = {input[i + 1], input[i + 2], '\0'};
+                    long decimal = strtol(hex, NULL, 16);
+                    fprintf(output, "\\%03ld", decimal);
+                    i += 2;
+                } else {
+                    fprintf(output, "\\%03d", (int)input[i]);
+                }
+                break;
+            default:
+                fprintf(output, "\\092");
+                fprintf(output, "\\%03d", (unsigned char)input[i]);
+                break;
+            }
+        } else if (c <= 32) {
+            fprintf(output, "\\%03d", c);
+        } else if (c == 35) {
+            fprintf(output, "\\035");
+        } else if (c == 92) {
+            fprintf(output, "\\092");
+        } else {
+            fprintf(output, "%c", c);
+        }
+    }
+}
+
+typedef void (*ConvertFn)(const char *, FILE *);
+
+/**
+ * @brief Convert `input` and return the output (caller frees).
+ */
+static char *convert(ConvertFn fn, const char *input, size_t *length) {
+    char *text = NULL;
+    FILE *f = open_memstream(&text, length);
+    fn(input, f);
+    fclose(f);
+    return text;
+}
+
+static double time_convert(ConvertFn fn, char **strings, int count) {
+    FILE *sink = fopen("/dev/null", "w");
+    double t0 = now_seconds();
+    for (int round = 0; round < 20; round++) {
+        for (int i = 0; i < count; i++) {
+            fn(strings[i], sink);
+        }
+    }
+    double elapsed = now_seconds() - t0;
+    fclose(sink);
+    return elapsed;
+}
+
+int main(void) {
+    static const char alphabet[] =
+        "\\\\\\nts\"xX09afAFgz #\t\n\r\x01\x1f !~+-\x80\xff";
+    char input[2048];
+    int failures = 0;
+
+    // Differential test on random strings of any length
+    srand(2025);
+    for (int i = 0; i < 200000 && failures < 10; i++) {
+        size_t length = (size_t)(i % 7 == 0 ? rand() % 2000 : rand() % 16);
+        for (size_t j = 0; j < length; j++) {
+            input[j] = alphabet[rand() % (sizeof(alphabet) - 1)];
+        }
+        input[length] = '\0';
+
+        size_t expect_length, got_length;
+        char *expect = convert(legacy_convert_string, input, &expect_length);
+        char *got = convert(print_convert_string, input, &got_length);
+        if (expect_length != got_length ||
+            memcmp(expect, got, expect_length) != 0) {
+            printf("FAIL: outputs differ for input of %zu bytes\n", length);
+            failures++;
+        }
+        free(expect);
+        free(got);
+    }
+
+    // Benchmark: mostly plain text with a few escapes, like real programs
+    enum { STRING_COUNT = 20000 };
+    static char *strings[STRING_COUNT];
+    size_t total = 0;
+    for (int i = 0; i < STRING_COUNT; i++) {
+        size_t length = 16 + (size_t)(rand() % 96);
+        strings[i] = malloc(length + 1);
+        for (size_t j = 0; j < length; j++) {
+            int r = rand() % 40;
+            strings[i][j] = r == 0 ? ' ' : r == 1 ? '\n' : (char)('a' + r % 26);
+        }
+        strings[i][length] = '\0';
+        total += length;
+    }
+    double t_legacy = time_convert(legacy_convert_string, strings, STRING_COUNT);
+    double t_runs = time_convert(print_convert_string, strings, STRING_COUNT);
+    double mb = total * 20 / (1024.0 * 1024.0);
+    printf("per-character escaper: %.1f MB/s\n", mb / t_legacy);
+    printf("run-based escaper:     %.1f MB/s (%.2fx)\n", mb / t_runs,
+           t_legacy / t_runs);
+    for (int i = 0; i < STRING_COUNT; i++) {
+        free(strings[i]);
+    }
+
+    if (failures) {
+        printf("%d failure(s)\n", failures);
+        return 1;
+    }
+    printf("Run-based escaper matches the per-character one\n");
+    return 0;
+}
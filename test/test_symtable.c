@@ -5,6 +5,7 @@
  */
 
 #include "../src/symtable.h"
+#include "../src/arena.h"
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -75,6 +76,7 @@ int main(void) {
 
     // Clean up
     symtable_free(&table);
+    phase_arenas_free_all();
 
     return 0;
 }
@@ -0,0 +1,194 @@
+/**
+ * @file test_util.h
+ * @author xcernoj00
+ * @brief Helpers shared by the test and benchmark programs.
+ *
+ * - now_seconds: monotonic clock for timings,
+ * - read_file: whole file into memory,
+ * - Text: growing text buffer, for generated sources and serialized trees,
+ * - serialize_expr / serialize: an AST as text, to compare two trees,
+ * - check / tests_summary: PASS/FAIL lines and the final "Tests passed".
+ *
+ * Everything is static inline, so each program keeps only what it uses
+ * and links no extra sources. Include after defining _POSIX_C_SOURCE.
+ */
+
+#ifndef TEST_UTIL_H
+#define TEST_UTIL_H
+
+#include "ast.h"
+#include "expr_ast.h"
+#include "intern.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static inline double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Reads a whole file (caller frees), NUL-terminated.
+ * @return The contents, or NULL when the file cannot be read.
+ */
+static inline char *read_file(const char *path, size_t *length) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        return NULL;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char *data = size >= 0 ? malloc((size_t)size + 1) : NULL;
+    *length = data ? fread(data, 1, (size_t)size, file) : 0;
+    if (data) {
+        data[*length] = '\0';
+    }
+    fclose(file);
+    return data;
+}
+
+/**
+ * @brief Growing text buffer; zero-initialized it is empty.
+ */
+typedef struct {
+    char *data;
+    size_t length;
+    size_t capacity;
+} Text;
+
+static inline void append(Text *text, const char *format, ...)
+    __attribute__((format(printf, 2, 3)));
+
+static inline void append(Text *text, const char *format, ...) {
+    for (;;) {
+        size_t room = text->capacity - text->length;
+        va_list args;
+        va_start(args, format);
+        int n = vsnprintf(text->data + text->length, room, format, args);
+        va_end(args);
+        if (n >= 0 && (size_t)n < room) {
+            text->length += (size_t)n;
+            return;
+        }
+        size_t capacity = text->capacity ? text->capacity * 2 : 1 << 12;
+        while (n >= 0 && capacity < text->length + (size_t)n + 1) {
+            capacity *= 2;
+        }
+        text->data = realloc(text->data, capacity);
+        if (!text->data) {
+            abort();
+        }
+        text->capacity = capacity;
+    }
+}
+
+/**
+ * @brief Appends `piece` `count` times.
+ */
+static inline void repeat(Text *text, const char *piece, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        append(text, "%s", piece);
+    }
+}
+
+/**
+ * @brief Writes a name with its intern id, which orders symbol tables.
+ */
+static inline void append_name(Text *text, const char *name) {
+    if (name) {
+        append(text, " %s#%u", name, intern_id(name));
+    }
+}
+
+/**
+ * @brief Writes an expression tree: kinds, exact numbers, names and the
+ * scopes identifiers were resolved to.
+ */
+static inline void serialize_expr(Text *text, const ExprNode *node) {
+    if (!node) {
+        append(text, " -");
+        return;
+    }
+    append(text, " (%d", node->type);
+    switch (node->type) {
+    case EXPR_NUM_LITERAL:
+        append(text, " %a", node->data.num_literal);
+        break;
+    case EXPR_STRING_LITERAL:
+        append(text, " \"%s\"", node->data.string_literal);
+        break;
+    case EXPR_IDENTIFIER:
+    case EXPR_GETTER_CALL:
+        // identifier_name and getter_name share the storage
+        append_name(text, node->data.identifier_name);
+        append(text, " %p", (void *)node->current_scope);
+        break;
+    case EXPR_TYPE_LITERAL:
+        append_name(text, node->data.identifier_name);
+        break;
+    case EXPR_BINARY_OP:
+        append(text, " %d", node->data.binary.op);
+        serialize_expr(text, node->data.binary.left);
+        serialize_expr(text, node->data.binary.right);
+        break;
+    default:
+        break;
+    }
+    append(text, ")");
+}
+
+/**
+ * @brief Writes a statement chain and everything below it.
+ */
+static inline void serialize(Text *text, const ASTNode *node) {
+    append(text, " [");
+    for (; node; node = node->right) {
+        append(text, " (%d", node->type);
+        append_name(text, node->name);
+        serialize_expr(text, node->expr);
+        serialize(text, node->left);
+        serialize(text, node->var_next);
+        append(text, ")");
+    }
+    append(text, " ]");
+}
+
+/// Results of the checks of a test program
+typedef struct {
+    int run;
+    int passed;
+} TestTally;
+
+static inline TestTally *test_tally(void) {
+    static TestTally tally;
+    return &tally;
+}
+
+/**
+ * @brief Records and prints the result of one check.
+ */
+static inline void check(int condition, const char *name) {
+    TestTally *tally = test_tally();
+    tally->run++;
+    if (condition) {
+        tally->passed++;
+    }
+    printf("%s: %s\n", condition ? "PASS" : "FAIL", name);
+}
+
+/**
+ * @brief Prints the number of passed checks.
+ * @return The exit status of the test program.
+ */
+static inline int tests_summary(void) {
+    TestTally *tally = test_tally();
+    printf("\nTests passed: %d/%d\n", tally->passed, tally->run);
+    return tally->passed == tally->run ? 0 : 1;
+}
+
+#endif // TEST_UTIL_H
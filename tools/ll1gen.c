@@ -0,0 +1,543 @@
+/**
+ * @file ll1gen.c
+ * @author xcernoj00
+ * @brief Generates the LL(1) parse table of the parser from grammar.txt
+ *
+ * Reads the annotated grammar (see the header of grammar.txt), computes the
+ * FIRST and FOLLOW sets, fills the parse table and writes it as a C header
+ * to stdout. A conflict in the table means the grammar is not LL(1); it is
+ * reported and nothing is written.
+ *
+ * The columns of the table are the token classes of the parser. A symbol
+ * handed off to another parser (`%handoff`) may start with any token, but
+ * only weakly: an alternative starting with a terminal takes precedence,
+ * so `PARAMETER_LIST -> expression ... | ε` means "ε on ), an expression on
+ * anything else" just as the hand-written parser decided.
+ *
+ * Usage: ll1gen grammar.txt > src/parse_table.h
+ */
+
+#include <ctype.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_SYMBOLS 256
+#define MAX_PRODUCTIONS 256
+#define MAX_RHS 32
+#define MAX_CLASSES 64
+
+typedef enum {
+    SYMBOL_CLASS,       ///< token class (terminal and table column)
+    SYMBOL_DERIVED,     ///< token of a class with a fixed text
+    SYMBOL_NONTERMINAL, ///< left side of a rule
+    SYMBOL_ACTION,      ///< @action
+    SYMBOL_HANDOFF,     ///< parsed by another parser
+} SymbolKind;
+
+typedef struct {
+    char name[64];
+    SymbolKind kind;
+    int base;  ///< class of a derived terminal
+    int index; ///< index within its kind
+} Symbol;
+
+typedef struct {
+    int lhs;
+    int rhs[MAX_RHS];
+    int length;
+} Production;
+
+typedef uint64_t ClassSet;
+
+static Symbol symbols[MAX_SYMBOLS];
+static int symbol_count;
+static Production productions[MAX_PRODUCTIONS];
+static int production_count;
+static int counts[SYMBOL_HANDOFF + 1];
+static int other_class; ///< class of tokens the grammar does not use
+
+static ClassSet first_strong[MAX_SYMBOLS], first_weak[MAX_SYMBOLS];
+static ClassSet follow_strong[MAX_SYMBOLS], follow_weak[MAX_SYMBOLS];
+static bool nullable[MAX_SYMBOLS];
+
+static void die(const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    fprintf(stderr, "ll1gen: ");
+    vfprintf(stderr, format, args);
+    fprintf(stderr, "\n");
+    va_end(args);
+    exit(1);
+}
+
+static int find_symbol(const char *name) {
+    for (int i = 0; i < symbol_count; i++) {
+        if (strcmp(symbols[i].name, name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static int add_symbol(const char *name, SymbolKind kind) {
+    int found = find_symbol(name);
+    if (found >= 0) {
+        return found;
+    }
+    if (symbol_count == MAX_SYMBOLS || strlen(name) >= sizeof(symbols[0].name)) {
+        die("too many symbols or name too long: %s", name);
+    }
+    Symbol *symbol = &symbols[symbol_count];
+    snprintf(symbol->name, sizeof(symbol->name), "%s", name);
+    symbol->kind = kind;
+    symbol->base = -1;
+    symbol->index = counts[kind]++;
+    if (kind == SYMBOL_CLASS && symbol->index >= MAX_CLASSES) {
+        die("too many token classes");
+    }
+    return symbol_count++;
+}
+
+static bool is_nonterminal_name(const char *word) {
+    if (!isupper((unsigned char)word[0])) {
+        return false;
+    }
+    for (const char *c = word; *c; c++) {
+        if (!isupper((unsigned char)*c) && *c != '_') {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Symbol of a word on the right side of a rule.
+ */
+static int symbol_of(const char *word) {
+    if (word[0] == '@') {
+        return add_symbol(word, SYMBOL_ACTION);
+    }
+    int found = find_symbol(word);
+    if (found >= 0) {
+        return found;
+    }
+    if (is_nonterminal_name(word)) {
+        die("nonterminal %s has no rule", word);
+    }
+    const char *colon = strchr(word, ':');
+    if (colon && colon != word && colon[1]) {
+        char base[64];
+        snprintf(base, sizeof(base), "%.*s", (int)(colon - word), word);
+        int base_symbol = add_symbol(base, SYMBOL_CLASS);
+        int derived = add_symbol(word, SYMBOL_DERIVED);
+        symbols[derived].base = base_symbol;
+        return derived;
+    }
+    return add_symbol(word, SYMBOL_CLASS);
+}
+
+/**
+ * @brief Splits a line into words (at most `max`), in place.
+ */
+static int split_words(char *line, char **words, int max) {
+    int count = 0;
+    for (char *word = strtok(line, " \t\r\n"); word;
+         word = strtok(NULL, " \t\r\n")) {
+        if (count == max) {
+            die("line too long");
+        }
+        words[count++] = word;
+    }
+    return count;
+}
+
+static void read_grammar(FILE *file) {
+    char line[4096];
+    char *words[512];
+    int start = -1;
+
+    // First pass: nonterminals, so that rules may refer to later ones
+    while (fgets(line, sizeof(line), file)) {
+        int n = split_words(line, words, 512);
+        if (n >= 2 && words[0][0] != '#' && strcmp(words[1], "->") == 0) {
+            if (find_symbol(words[0]) >= 0) {
+                die("second rule for %s", words[0]);
+            }
+            int lhs = add_symbol(words[0], SYMBOL_NONTERMINAL);
+            if (start < 0) {
+                start = lhs;
+            }
+        }
+    }
+    if (start < 0) {
+        die("no rules");
+    }
+
+    rewind(file);
+    while (fgets(line, sizeof(line), file)) {
+        int n = split_words(line, words, 512);
+        if (n == 0 || words[0][0] == '#') {
+            continue;
+        }
+        if (strcmp(words[0], "%handoff") == 0) {
+            for (int i = 1; i < n; i++) {
+                add_symbol(words[i], SYMBOL_HANDOFF);
+            }
+            continue;
+        }
+        if (n < 2 || strcmp(words[1], "->") != 0) {
+            die("not a rule: %s", words[0]);
+        }
+        int lhs = find_symbol(words[0]);
+        for (int i = 2; i <= n; i++) {
+            if (production_count == MAX_PRODUCTIONS) {
+                die("too many productions");
+            }
+            Production *production = &productions[production_count++];
+            production->lhs = lhs;
+            production->length = 0;
+            for (; i < n && strcmp(words[i], "|") != 0; i++) {
+                if (strcmp(words[i], "ε") == 0) {
+                    continue;
+                }
+                if (production->length == MAX_RHS) {
+                    die("alternative of %s too long", words[0]);
+                }
+                production->rhs[production->length++] = symbol_of(words[i]);
+            }
+        }
+    }
+    other_class = add_symbol("other", SYMBOL_CLASS);
+}
+
+static ClassSet all_classes(void) {
+    return counts[SYMBOL_CLASS] == 64 ? ~(ClassSet)0
+                                      : ((ClassSet)1 << counts[SYMBOL_CLASS]) -
+                                            1;
+}
+
+/**
+ * @brief FIRST of `rhs[from..length)`; returns whether it derives ε.
+ */
+static bool first_of(const int *rhs, int from, int length, ClassSet *strong,
+                     ClassSet *weak) {
+    for (int i = from; i < length; i++) {
+        const Symbol *symbol = &symbols[rhs[i]];
+        switch (symbol->kind) {
+        case SYMBOL_ACTION:
+            continue;
+        case SYMBOL_CLASS:
+            *strong |= (ClassSet)1 << symbol->index;
+            return false;
+        case SYMBOL_DERIVED:
+            *strong |= (ClassSet)1 << symbols[symbol->base].index;
+            return false;
+        case SYMBOL_HANDOFF:
+            *weak |= all_classes();
+            return false;
+        case SYMBOL_NONTERMINAL:
+            *strong |= first_strong[rhs[i]];
+            *weak |= first_weak[rhs[i]];
+            if (!nullable[rhs[i]]) {
+                return false;
+            }
+            continue;
+        }
+    }
+    return true;
+}
+
+static void compute_sets(void) {
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int p = 0; p < production_count; p++) {
+            const Production *production = &productions[p];
+            int lhs = production->lhs;
+            ClassSet strong = first_strong[lhs], weak = first_weak[lhs];
+            bool empty = first_of(production->rhs, 0, production->length,
+                                  &strong, &weak);
+            if (strong != first_strong[lhs] || weak != first_weak[lhs] ||
+                (empty && !nullable[lhs])) {
+                first_strong[lhs] = strong;
+                first_weak[lhs] = weak;
+                nullable[lhs] = nullable[lhs] || empty;
+                changed = true;
+            }
+        }
+    }
+
+    changed = true;
+    while (changed) {
+        changed = false;
+        for (int p = 0; p < production_count; p++) {
+            const Production *production = &productions[p];
+            for (int i = 0; i < production->length; i++) {
+                int symbol = production->rhs[i];
+                if (symbols[symbol].kind != SYMBOL_NONTERMINAL) {
+                    continue;
+                }
+                ClassSet strong = follow_strong[symbol];
+                ClassSet weak = follow_weak[symbol];
+                if (first_of(production->rhs, i + 1, production->length,
+                             &strong, &weak)) {
+                    strong |= follow_strong[production->lhs];
+                    weak |= follow_weak[production->lhs];
+                }
+                if (strong != follow_strong[symbol] ||
+                    weak != follow_weak[symbol]) {
+                    follow_strong[symbol] = strong;
+                    follow_weak[symbol] = weak;
+                    changed = true;
+                }
+            }
+        }
+    }
+}
+
+static const Symbol *class_symbol(int index) {
+    for (int i = 0; i < symbol_count; i++) {
+        if (symbols[i].kind == SYMBOL_CLASS && symbols[i].index == index) {
+            return &symbols[i];
+        }
+    }
+    return NULL;
+}
+
+static void print_production(FILE *out, int p) {
+    fprintf(out, "%s ->", symbols[productions[p].lhs].name);
+    for (int i = 0; i < productions[p].length; i++) {
+        fprintf(out, " %s", symbols[productions[p].rhs[i]].name);
+    }
+    if (productions[p].length == 0) {
+        fprintf(out, " ε");
+    }
+}
+
+/**
+ * @brief Fills the parse table; a strong entry beats a weak one.
+ */
+static void fill_table(int (*table)[MAX_CLASSES]) {
+    int strength[MAX_SYMBOLS][MAX_CLASSES] = {{0}};
+    bool conflicts = false;
+
+    for (int n = 0; n < counts[SYMBOL_NONTERMINAL]; n++) {
+        for (int c = 0; c < MAX_CLASSES; c++) {
+            table[n][c] = -1;
+        }
+    }
+    for (int p = 0; p < production_count; p++) {
+        const Production *production = &productions[p];
+        int row = symbols[production->lhs].index;
+        ClassSet strong = 0, weak = 0;
+        if (first_of(production->rhs, 0, production->length, &strong, &weak)) {
+            strong |= follow_strong[production->lhs];
+            weak |= follow_weak[production->lhs];
+        }
+        for (int c = 0; c < counts[SYMBOL_CLASS]; c++) {
+            int level = strong >> c & 1 ? 2 : weak >> c & 1 ? 1 : 0;
+            if (level == 0 || level < strength[row][c]) {
+                continue;
+            }
+            if (level == strength[row][c] && table[row][c] != p) {
+                fprintf(stderr, "ll1gen: conflict on %s:\n  ",
+                        class_symbol(c)->name);
+                print_production(stderr, table[row][c]);
+                fprintf(stderr, "\n  ");
+                print_production(stderr, p);
+                fprintf(stderr, "\n");
+                conflicts = true;
+            }
+            table[row][c] = p;
+            strength[row][c] = level;
+        }
+    }
+    if (conflicts) {
+        exit(1);
+    }
+}
+
+/**
+ * @brief C name of a symbol: LL_T_..., LL_N_..., LL_A_... or LL_H_...
+ */
+static void c_name(const Symbol *symbol, char *out, size_t size) {
+    static const char *const punctuation[][2] = {
+        {"(", "LPAREN"}, {")", "RPAREN"}, {"{", "LCURLY"},
+        {"}", "RCURLY"}, {"=", "EQUAL"},  {",", "COMMA"},
+    };
+    static const char prefixes[] = {'T', 'T', 'N', 'A', 'H'};
+    const char *name = symbol->name + (symbol->kind == SYMBOL_ACTION);
+    for (size_t i = 0; i < sizeof(punctuation) / sizeof(punctuation[0]); i++) {
+        if (strcmp(name, punctuation[i][0]) == 0) {
+            name = punctuation[i][1];
+        }
+    }
+    size_t used = (size_t)snprintf(out, size, "LL_%c_", prefixes[symbol->kind]);
+    for (; *name && used + 1 < size; name++) {
+        out[used++] = isalnum((unsigned char)*name)
+                          ? (char)toupper((unsigned char)*name)
+                          : '_';
+    }
+    out[used] = '\0';
+}
+
+static void print_enum(FILE *out, SymbolKind kind, SymbolKind also,
+                       const char *count_name) {
+    char name[80];
+    fprintf(out, "typedef enum {\n");
+    int total = counts[kind] + (also != kind ? counts[also] : 0);
+    for (int index = 0; index < total; index++) {
+        for (int i = 0; i < symbol_count; i++) {
+            const Symbol *symbol = &symbols[i];
+            int position = symbol->kind == kind ? symbol->index
+                           : symbol->kind == also
+                               ? counts[kind] + symbol->index
+                               : -1;
+            if (position == index) {
+                c_name(symbol, name, sizeof(name));
+                fprintf(out, "    %s,\n", name);
+            }
+        }
+    }
+    fprintf(out, "    %s\n", count_name);
+}
+
+static void write_header(FILE *out, int (*table)[MAX_CLASSES]) {
+    char name[80];
+    static const char *const kinds[] = {"LL_TERMINAL", "LL_TERMINAL",
+                                        "LL_NONTERMINAL", "LL_ACTION",
+                                        "LL_HANDOFF"};
+
+    fprintf(out, "/**\n"
+                 " * @file parse_table.h\n"
+                 " * @brief LL(1) parse table of the parser.\n"
+                 " *\n"
+                 " * Generated by tools/ll1gen from grammar.txt, do not edit.\n"
+                 " */\n\n"
+                 "#ifndef PARSE_TABLE_H\n"
+                 "#define PARSE_TABLE_H\n\n"
+                 "#include <stdint.h>\n\n"
+                 "/// Grammar symbol: kind in the top bits, index below\n"
+                 "#define LL_SYMBOL(kind, index) ((uint16_t)((kind) << 12 | "
+                 "(index)))\n"
+                 "#define LL_KIND(symbol) ((symbol) >> 12)\n"
+                 "#define LL_INDEX(symbol) ((symbol) & 0x0fff)\n\n"
+                 "enum {\n"
+                 "    LL_TERMINAL,\n"
+                 "    LL_NONTERMINAL,\n"
+                 "    LL_ACTION,\n"
+                 "    LL_HANDOFF\n"
+                 "};\n\n");
+
+    fprintf(out, "/// Terminals: token classes (the table columns), then "
+                 "tokens with a fixed text\n");
+    print_enum(out, SYMBOL_CLASS, SYMBOL_DERIVED, "LL_TERMINAL_COUNT");
+    fprintf(out, "} LLTerminal;\n\n");
+    c_name(&symbols[other_class], name, sizeof(name));
+    fprintf(out, "#define LL_CLASS_COUNT (%s + 1)\n\n", name);
+    print_enum(out, SYMBOL_NONTERMINAL, SYMBOL_NONTERMINAL,
+               "LL_NONTERMINAL_COUNT");
+    fprintf(out, "} LLNonterminal;\n\n");
+    print_enum(out, SYMBOL_ACTION, SYMBOL_ACTION, "LL_ACTION_COUNT");
+    fprintf(out, "} LLAction;\n\n");
+    print_enum(out, SYMBOL_HANDOFF, SYMBOL_HANDOFF, "LL_HANDOFF_COUNT");
+    fprintf(out, "} LLHandoff;\n\n");
+
+    // Terminal class and text
+    fprintf(out, "/// Class of each terminal\n"
+                 "static const uint8_t ll_terminal_class[LL_TERMINAL_COUNT] "
+                 "= {\n");
+    for (int index = 0; index < counts[SYMBOL_CLASS] + counts[SYMBOL_DERIVED];
+         index++) {
+        for (int i = 0; i < symbol_count; i++) {
+            const Symbol *symbol = &symbols[i];
+            if (symbol->kind == SYMBOL_CLASS && symbol->index == index) {
+                c_name(symbol, name, sizeof(name));
+                fprintf(out, "    %s,\n", name);
+            } else if (symbol->kind == SYMBOL_DERIVED &&
+                       counts[SYMBOL_CLASS] + symbol->index == index) {
+                c_name(&symbols[symbol->base], name, sizeof(name));
+                fprintf(out, "    %s,\n", name);
+            }
+        }
+    }
+    fprintf(out, "};\n\n"
+                 "/// Text a terminal must have (NULL: any)\n"
+                 "static const char *const ll_terminal_text[LL_TERMINAL_COUNT] "
+                 "= {\n");
+    for (int i = 0; i < symbol_count; i++) {
+        if (symbols[i].kind == SYMBOL_DERIVED) {
+            c_name(&symbols[i], name, sizeof(name));
+            fprintf(out, "    [%s] = \"%s\",\n", name,
+                    strchr(symbols[i].name, ':') + 1);
+        }
+    }
+    fprintf(out, "};\n\n");
+
+    // Right sides, reversed so that the driver pushes them as they are
+    fprintf(out, "/// Right sides of the productions, last symbol first\n"
+                 "static const uint16_t ll_rhs[] = {\n");
+    int offset = 0;
+    int offsets[MAX_PRODUCTIONS];
+    for (int p = 0; p < production_count; p++) {
+        offsets[p] = offset;
+        fprintf(out, "    // ");
+        print_production(out, p);
+        fprintf(out, "\n");
+        for (int i = productions[p].length - 1; i >= 0; i--) {
+            const Symbol *symbol = &symbols[productions[p].rhs[i]];
+            c_name(symbol, name, sizeof(name));
+            fprintf(out, "    LL_SYMBOL(%s, %s),\n", kinds[symbol->kind], name);
+            offset++;
+        }
+    }
+    if (offset == 0) {
+        fprintf(out, "    0,\n");
+    }
+    fprintf(out, "};\n\n"
+                 "/// Productions: offset into ll_rhs and length\n"
+                 "static const struct {\n"
+                 "    uint16_t offset;\n"
+                 "    uint8_t length;\n"
+                 "} ll_productions[] = {\n");
+    for (int p = 0; p < production_count; p++) {
+        fprintf(out, "    {%d, %d},\n", offsets[p], productions[p].length);
+    }
+    fprintf(out, "};\n\n");
+
+    fprintf(out, "/// Production to expand a nonterminal by on a token "
+                 "class (-1: syntax error)\n"
+                 "static const int16_t "
+                 "ll_table[LL_NONTERMINAL_COUNT][LL_CLASS_COUNT] = {\n");
+    for (int n = 0; n < counts[SYMBOL_NONTERMINAL]; n++) {
+        fprintf(out, "    {");
+        for (int c = 0; c < counts[SYMBOL_CLASS]; c++) {
+            fprintf(out, c ? ", %d" : "%d", table[n][c]);
+        }
+        fprintf(out, "},\n");
+    }
+    fprintf(out, "};\n\n#endif // PARSE_TABLE_H\n");
+}
+
+int main(int argc, char **argv) {
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s grammar.txt > parse_table.h\n", argv[0]);
+        return 2;
+    }
+    FILE *file = fopen(argv[1], "r");
+    if (!file) {
+        die("cannot open %s", argv[1]);
+    }
+    read_grammar(file);
+    fclose(file);
+    compute_sets();
+
+    static int table[MAX_SYMBOLS][MAX_CLASSES];
+    fill_table(table);
+    write_header(stdout, table);
+    return 0;
+}